@@ -0,0 +1,46 @@
+#include "synthetic_instances.hxx"
+#include "kernels.hxx"
+#include "solvers/discrete_tomography/discrete_tomography.h"
+#include "visitors/standard_visitor.hxx"
+
+using namespace LP_MP;
+using bench::update_factors;
+using bench::message_kernel;
+
+using dt_solver = Solver<FMC_DT, bench::bench_lp, StandardVisitor>;
+
+// row and column projections of a grid, sequential dt factors along each projection
+struct dt_grid {
+   static dt_solver& get()
+   {
+      static auto s = [] {
+         auto s = bench::construct_solver<dt_solver>(bench::dt_grid(16, 3), DiscreteTomographyTextInput::ParseProblem<dt_solver>);
+         bench::begin(*s);
+         return s;
+      }();
+      return *s;
+   }
+};
+
+BENCHMARK_TEMPLATE(update_factors, dt_grid, FMC_DT::UnaryFactor);
+BENCHMARK_TEMPLATE(update_factors, dt_grid, FMC_DT::dt_sequential_pairwise_factor);
+// messages between consecutive sum factors, between sum factors and the pairwise and unary factors they sum over.
+// dt_sum_pairwise_message is commented out in dt_sequential.hxx, consecutive sum factors are connected by dt_pairwise_message (dt_sequential_message) instead.
+BENCHMARK_TEMPLATE(message_kernel, dt_grid, FMC_DT::dt_sequential_message);
+BENCHMARK_TEMPLATE(message_kernel, dt_grid, FMC_DT::dt_pairwise_pairwise_message);
+BENCHMARK_TEMPLATE(message_kernel, dt_grid, FMC_DT::dt_sum_unary_message_left);
+
+// argument: grid side length
+static void parse_discrete_tomography(benchmark::State& state)
+{
+   const std::string instance = bench::dt_grid(state.range(0), 3);
+   while(state.KeepRunning()) {
+      UaiMrfInput::MrfInput mrf_input;
+      DiscreteTomographyTextInput::Projections projections;
+      const bool success = pegtl::parse<UaiMrfInput::grammar, UaiMrfInput::action>(instance, "", mrf_input) &&
+         pegtl::parse<DiscreteTomographyTextInput::grammar, DiscreteTomographyTextInput::action>(instance, "", projections);
+      benchmark::DoNotOptimize(success);
+   }
+   state.SetBytesProcessed(state.iterations() * instance.size());
+}
+BENCHMARK(parse_discrete_tomography)->Arg(32)->Arg(128)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,61 @@
+#include "synthetic_instances.hxx"
+#include "kernels.hxx"
+#include "solvers/graph_matching/graph_matching.h"
+#include "visitors/standard_visitor.hxx"
+
+using namespace LP_MP;
+using bench::update_factors;
+using bench::message_kernel;
+
+using mcf_fmc = FMC_MCF<PairwiseConstruction::Left>;
+using mcf_solver = Solver<mcf_fmc, bench::bench_lp, StandardVisitor>;
+
+struct graph_matching_mcf {
+   static mcf_solver& get()
+   {
+      static auto s = [] {
+         auto s = bench::construct_solver<mcf_solver>(bench::torresani_graph_matching(200, 10), TorresaniEtAlInput::ParseProblemMCF<mcf_solver>);
+         bench::begin(*s);
+         return s;
+      }();
+      return *s;
+   }
+};
+
+BENCHMARK_TEMPLATE(update_factors, graph_matching_mcf, mcf_fmc::UnaryFactor);
+BENCHMARK_TEMPLATE(message_kernel, graph_matching_mcf, mcf_fmc::UnaryPairwiseMessageLeftContainer);
+BENCHMARK_TEMPLATE(message_kernel, graph_matching_mcf, mcf_fmc::UnaryPairwiseMessageRightContainer);
+
+// UnaryToAssignmentMessageCS2 sends reduced costs of the min cost flow factor to the unaries. Its batch operation takes the reparametrization of the min cost flow factor as additional argument,
+// hence it is not called through the message container and is benchmarked on the messages of the min cost flow factor directly.
+static void mcf_send_messages_to_left(benchmark::State& state)
+{
+   using msg_container = mcf_fmc::UnaryToAssignmentMessageContainer;
+   auto msgs = bench::messages_of_type<msg_container>(graph_matching_mcf::get().GetLP());
+   if(msgs.size() == 0) {
+      state.SkipWithError("instance has no messages of benchmarked type");
+      return;
+   }
+   auto& mcf = *msgs[0]->GetRightFactor()->GetFactor();
+   mcf.LowerBound(); // reduced costs of optimal flow
+   const std::vector<REAL> omega(msgs.size(), 1.0/REAL(msgs.size()));
+   using msg_iterator = msg_container::MessageIteratorView<Chirality::right, decltype(msgs.begin())>;
+   while(state.KeepRunning()) {
+      mcf_fmc::UnaryToAssignmentMessageType::SendMessagesToLeft(mcf, mcf, msg_iterator(msgs.begin()), msg_iterator(msgs.end()), omega.begin());
+   }
+   state.SetItemsProcessed(state.iterations() * msgs.size());
+}
+BENCHMARK(mcf_send_messages_to_left);
+
+// arguments: number of nodes, candidates per node
+static void parse_torresani(benchmark::State& state)
+{
+   const std::string instance = bench::torresani_graph_matching(state.range(0), state.range(1));
+   while(state.KeepRunning()) {
+      TorresaniEtAlInput::GraphMatchingInput input;
+      const bool success = pegtl::parse<TorresaniEtAlInput::grammar, TorresaniEtAlInput::action>(instance, "", input);
+      benchmark::DoNotOptimize(success);
+   }
+   state.SetBytesProcessed(state.iterations() * instance.size());
+}
+BENCHMARK(parse_torresani)->Args({200, 10})->Args({1000, 20})->Unit(benchmark::kMillisecond);
@@ -0,0 +1,52 @@
+#include "synthetic_instances.hxx"
+#include "kernels.hxx"
+#include "solvers/graphical_model/graphical_model.h"
+#include "visitors/standard_visitor.hxx"
+
+using namespace LP_MP;
+using bench::update_factors;
+using bench::message_kernel;
+
+using mrf_solver = Solver<FMC_SRMP, bench::bench_lp, StandardVisitor>;
+
+struct mrf_grid {
+   static mrf_solver& get()
+   {
+      static auto s = [] {
+         auto s = bench::construct_solver<mrf_solver>(bench::uai_grid(64, 5), UaiMrfInput::ParseProblem<mrf_solver>);
+         bench::begin(*s);
+         return s;
+      }();
+      return *s;
+   }
+};
+
+BENCHMARK_TEMPLATE(update_factors, mrf_grid, FMC_SRMP::UnaryFactor);
+BENCHMARK_TEMPLATE(message_kernel, mrf_grid, FMC_SRMP::UnaryPairwiseMessageLeftContainer);
+BENCHMARK_TEMPLATE(message_kernel, mrf_grid, FMC_SRMP::UnaryPairwiseMessageRightContainer);
+
+// arguments: grid side length, number of labels
+static void compute_pass_mrf_grid(benchmark::State& state)
+{
+   auto s = bench::construct_solver<mrf_solver>(bench::uai_grid(state.range(0), state.range(1)), UaiMrfInput::ParseProblem<mrf_solver>);
+   bench::begin(*s);
+   bench::compute_pass(state, *s);
+}
+BENCHMARK(compute_pass_mrf_grid)
+   ->Args({32, 2})->Args({32, 8})->Args({32, 32})
+   ->Args({128, 2})->Args({128, 8})->Args({128, 32})
+   ->Args({512, 2})
+   ->Unit(benchmark::kMillisecond);
+
+// argument: grid side length
+static void parse_uai(benchmark::State& state)
+{
+   const std::string instance = bench::uai_grid(state.range(0), 8);
+   while(state.KeepRunning()) {
+      UaiMrfInput::MrfInput input;
+      const bool success = pegtl::parse<UaiMrfInput::grammar, UaiMrfInput::action>(instance, "", input);
+      benchmark::DoNotOptimize(success);
+   }
+   state.SetBytesProcessed(state.iterations() * instance.size());
+}
+BENCHMARK(parse_uai)->Arg(32)->Arg(128)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,115 @@
+#ifndef LP_MP_BENCH_KERNELS_HXX
+#define LP_MP_BENCH_KERNELS_HXX
+
+#include <vector>
+#include "benchmark/benchmark.h"
+#include "LP_MP.h"
+#include "static_if.hxx"
+
+// Benchmarks of single kernels on problem instances.
+// INSTANCE has a static function get() returning a solver on which bench::begin has been called. Instances are constructed once and shared between all benchmarks on them.
+// Factors are updated in place, hence later benchmarks run on the reparametrization left by earlier ones. This does not change the amount of work done by the kernels.
+
+namespace LP_MP {
+
+namespace bench {
+
+template<typename FACTOR_CONTAINER, typename LP_TYPE>
+std::vector<INDEX> factors_of_type(const LP_TYPE& lp)
+{
+   std::vector<INDEX> idx;
+   const auto& ordering = lp.forward_update_ordering();
+   for(INDEX k=0; k<ordering.size(); ++k) {
+      if(dynamic_cast<FACTOR_CONTAINER*>(ordering[k]) != nullptr) {
+         idx.push_back(k);
+      }
+   }
+   return idx;
+}
+
+template<typename MESSAGE_CONTAINER, typename LP_TYPE>
+std::vector<MESSAGE_CONTAINER*> messages_of_type(const LP_TYPE& lp)
+{
+   std::vector<MESSAGE_CONTAINER*> msgs;
+   for(INDEX i=0; i<lp.GetNumberOfMessages(); ++i) {
+      auto* m = dynamic_cast<MESSAGE_CONTAINER*>(lp.GetMessage(i));
+      if(m != nullptr) {
+         msgs.push_back(m);
+      }
+   }
+   return msgs;
+}
+
+// UpdateFactor on all factors of one type in forward order with the weights used by ComputePass.
+// Factors which are not updated by the LP, e.g. pairwise factors in SRMP, only change through messages and are covered by message_kernel.
+template<typename INSTANCE, typename FACTOR_CONTAINER>
+void update_factors(benchmark::State& state)
+{
+   auto& lp = INSTANCE::get().GetLP();
+   const auto omega = lp.get_omega();
+   const auto& ordering = lp.forward_update_ordering();
+   const auto idx = factors_of_type<FACTOR_CONTAINER>(lp);
+   if(idx.size() == 0) {
+      state.SkipWithError("no factors of benchmarked type are updated in instance");
+      return;
+   }
+
+   while(state.KeepRunning()) {
+      for(const INDEX k : idx) {
+         lp.UpdateFactor(ordering[k], omega.forward[k]);
+      }
+   }
+   state.SetItemsProcessed(state.iterations() * idx.size());
+}
+
+// send and receive every message of one type once in each direction the message supports
+template<typename INSTANCE, typename MESSAGE_CONTAINER>
+void message_kernel(benchmark::State& state)
+{
+   static_assert(MESSAGE_CONTAINER::CanCallSendMessageToRightContainer() || MESSAGE_CONTAINER::CanCallSendMessageToLeftContainer() ||
+         MESSAGE_CONTAINER::CanCallReceiveMessageFromRightContainer() || MESSAGE_CONTAINER::CanCallReceiveMessageFromLeftContainer(),
+         "message has no single message operations");
+
+   const auto msgs = messages_of_type<MESSAGE_CONTAINER>(INSTANCE::get().GetLP());
+   if(msgs.size() == 0) {
+      state.SkipWithError("instance has no messages of benchmarked type");
+      return;
+   }
+
+   const REAL omega = 0.5;
+   while(state.KeepRunning()) {
+      for(auto* m : msgs) {
+         static_if<MESSAGE_CONTAINER::CanCallSendMessageToRightContainer()>([&](auto f) {
+               f(m)->SendMessageToRightContainer(m->GetLeftFactor()->GetFactor(), omega);
+         });
+         static_if<MESSAGE_CONTAINER::CanCallReceiveMessageFromRightContainer()>([&](auto f) {
+               f(m)->ReceiveMessageFromRightContainer();
+         });
+         static_if<MESSAGE_CONTAINER::CanCallSendMessageToLeftContainer()>([&](auto f) {
+               f(m)->SendMessageToLeftContainer(m->GetRightFactor()->GetFactor(), omega);
+         });
+         static_if<MESSAGE_CONTAINER::CanCallReceiveMessageFromLeftContainer()>([&](auto f) {
+               f(m)->ReceiveMessageFromLeftContainer();
+         });
+      }
+   }
+   state.SetItemsProcessed(state.iterations() * msgs.size());
+}
+
+// one forward and one backward pass over all factors
+template<typename SOLVER>
+void compute_pass(benchmark::State& state, SOLVER& s)
+{
+   auto& lp = s.GetLP();
+   while(state.KeepRunning()) {
+      lp.ComputePass();
+   }
+   state.SetItemsProcessed(state.iterations() * lp.GetNumberOfFactors());
+   state.counters["lower_bound"] = lp.LowerBound();
+}
+
+} // end namespace bench
+
+} // end namespace LP_MP
+
+#endif // LP_MP_BENCH_KERNELS_HXX
@@ -0,0 +1,55 @@
+#include <stack>
+#include "synthetic_instances.hxx"
+#include "kernels.hxx"
+#include "solvers/multicut/multicut.h"
+#include "visitors/standard_visitor.hxx"
+
+using namespace LP_MP;
+using bench::update_factors;
+using bench::message_kernel;
+
+using multicut_fmc = FMC_MULTICUT<MessageSendingType::SRMP>;
+using multicut_solver = Solver<multicut_fmc, bench::bench_lp, StandardVisitor>;
+
+// grid with both diagonals of every cell covered by triplets, as would be added by cycle separation
+struct multicut_grid {
+   static multicut_solver& get()
+   {
+      static auto s = [] {
+         constexpr INDEX n = 64;
+         auto s = bench::construct_solver<multicut_solver>(bench::multicut_grid(n), MulticutTextInput::ParseProblem<multicut_solver>);
+         auto& mc = s->template GetProblemConstructor<0>();
+         for(INDEX r=0; r+1<n; ++r) {
+            for(INDEX c=0; c+1<n; ++c) {
+               const INDEX v = r*n + c;
+               mc.AddTripletFactor(v, v+1, v+n+1);
+               mc.AddTripletFactor(v, v+n, v+n+1);
+            }
+         }
+         bench::begin(*s);
+         return s;
+      }();
+      return *s;
+   }
+};
+
+BENCHMARK_TEMPLATE(update_factors, multicut_grid, multicut_fmc::edge_factor_container);
+BENCHMARK_TEMPLATE(message_kernel, multicut_grid, multicut_fmc::edge_triplet_message_0_container);
+BENCHMARK_TEMPLATE(message_kernel, multicut_grid, multicut_fmc::edge_triplet_message_1_container);
+BENCHMARK_TEMPLATE(message_kernel, multicut_grid, multicut_fmc::edge_triplet_message_2_container);
+
+// argument: grid side length
+static void parse_multicut(benchmark::State& state)
+{
+   const std::string instance = bench::multicut_grid(state.range(0));
+   auto& s = multicut_grid::get();
+   while(state.KeepRunning()) {
+      std::stack<SIGNED_INDEX> integer_stack;
+      std::stack<REAL> real_stack;
+      MulticutTextInput::MulticutInput input;
+      const bool success = pegtl::parse<MulticutTextInput::grammar, MulticutTextInput::actionSpecialization<multicut_solver>::template type>(instance, "", s, integer_stack, real_stack, input);
+      benchmark::DoNotOptimize(success);
+   }
+   state.SetBytesProcessed(state.iterations() * instance.size());
+}
+BENCHMARK(parse_multicut)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
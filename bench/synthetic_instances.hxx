@@ -0,0 +1,191 @@
+#ifndef LP_MP_BENCH_SYNTHETIC_INSTANCES_HXX
+#define LP_MP_BENCH_SYNTHETIC_INSTANCES_HXX
+
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <random>
+#include <memory>
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include "LP_MP.h"
+#include "solver.hxx"
+
+// Synthetic problem instances for the benchmarks.
+// Instances are written in the text formats read by the solvers, such that the benchmarks go through the same input functions and problem constructors as the solvers do.
+// All random numbers come from generators with fixed seeds, hence every run benchmarks the same instances.
+
+namespace LP_MP {
+
+namespace bench {
+
+constexpr std::mt19937::result_type default_seed = 1234;
+
+// exposes the factor update ordering, so that single factor types can be updated with the weights ComputePass would use
+class bench_lp : public LP {
+public:
+   using LP::LP;
+   const std::vector<FactorTypeAdapter*>& forward_update_ordering() const { return forwardUpdateOrdering_; }
+};
+
+// n x n grid with Potts-like pairwise potentials, uai format
+inline std::string uai_grid(const INDEX n, const INDEX no_labels, const std::mt19937::result_type seed = default_seed)
+{
+   std::mt19937 gen(seed);
+   std::uniform_real_distribution<REAL> unary_dist(0.0, 1.0);
+   std::uniform_real_distribution<REAL> pairwise_dist(0.0, 0.5);
+   std::ostringstream s;
+
+   const INDEX no_vars = n*n;
+   const INDEX no_pairwise = 2*n*(n-1);
+   s << "MARKOV\n" << no_vars << "\n";
+   for(INDEX i=0; i<no_vars; ++i) {
+      s << no_labels << (i+1 < no_vars ? " " : "\n");
+   }
+   s << no_vars + no_pairwise << "\n";
+   for(INDEX i=0; i<no_vars; ++i) {
+      s << "1 " << i << "\n";
+   }
+   for(INDEX r=0; r<n; ++r) {
+      for(INDEX c=0; c<n; ++c) {
+         if(c+1 < n) { s << "2 " << r*n+c << " " << r*n+c+1 << "\n"; }
+         if(r+1 < n) { s << "2 " << r*n+c << " " << (r+1)*n+c << "\n"; }
+      }
+   }
+   s << "\n";
+   for(INDEX i=0; i<no_vars; ++i) {
+      s << no_labels << "\n";
+      for(INDEX x=0; x<no_labels; ++x) {
+         s << unary_dist(gen) << (x+1 < no_labels ? " " : "\n");
+      }
+   }
+   for(INDEX p=0; p<no_pairwise; ++p) {
+      const REAL w = pairwise_dist(gen);
+      s << no_labels*no_labels << "\n";
+      for(INDEX x1=0; x1<no_labels; ++x1) {
+         for(INDEX x2=0; x2<no_labels; ++x2) {
+            s << (x1 == x2 ? 0.0 : w) << (x2+1 < no_labels ? " " : "\n");
+         }
+      }
+   }
+   return s.str();
+}
+
+// discrete tomography: uai grid followed by row and column projections with soft penalty on deviating from a target sum
+inline std::string dt_grid(const INDEX n, const INDEX no_labels, const std::mt19937::result_type seed = default_seed)
+{
+   std::mt19937 gen(seed);
+   std::uniform_int_distribution<INDEX> label_dist(0, no_labels-1);
+   std::vector<INDEX> image(n*n);
+   for(auto& x : image) { x = label_dist(gen); }
+
+   std::ostringstream s;
+   s << uai_grid(n, no_labels, seed) << "\nPROJECTIONS\n";
+   auto write_projection = [&](const INDEX first, const INDEX stride) {
+      INDEX sum = 0;
+      for(INDEX i=0; i<n; ++i) {
+         const INDEX var = first + i*stride;
+         sum += image[var];
+         s << var << (i+1 < n ? " + " : " = (");
+      }
+      const INDEX max_sum = n*(no_labels-1);
+      for(INDEX k=0; k<=max_sum; ++k) {
+         s << (k > sum ? k - sum : sum - k) << (k < max_sum ? ", " : ")\n");
+      }
+   };
+   for(INDEX r=0; r<n; ++r) { write_projection(r*n, 1); }
+   for(INDEX c=0; c<n; ++c) { write_projection(c, n); }
+   return s.str();
+}
+
+// multicut on n x n grid with mixed attractive/repulsive edges
+inline std::string multicut_grid(const INDEX n, const std::mt19937::result_type seed = default_seed)
+{
+   std::mt19937 gen(seed);
+   std::uniform_real_distribution<REAL> cost_dist(-1.0, 1.0);
+   std::ostringstream s;
+   s << "MULTICUT\n" << n*n << "\n";
+   for(INDEX r=0; r<n; ++r) {
+      for(INDEX c=0; c<n; ++c) {
+         if(c+1 < n) { s << r*n+c << " " << r*n+c+1 << " " << cost_dist(gen) << "\n"; }
+         if(r+1 < n) { s << r*n+c << " " << (r+1)*n+c << " " << cost_dist(gen) << "\n"; }
+      }
+   }
+   return s.str();
+}
+
+// graph matching in the format of Torresani et al. Each left node may be assigned to candidates right nodes, quadratic terms connect assignments of consecutive left nodes.
+inline std::string torresani_graph_matching(const INDEX no_nodes, const INDEX candidates, const std::mt19937::result_type seed = default_seed)
+{
+   assert(candidates <= no_nodes);
+   std::mt19937 gen(seed);
+   std::uniform_real_distribution<REAL> cost_dist(-1.0, 1.0);
+   std::ostringstream assignments;
+   std::ostringstream quadratic;
+   INDEX no_assignments = 0;
+   INDEX no_quadratic = 0;
+   std::vector<std::vector<INDEX>> right_nodes(no_nodes);
+   for(INDEX i=0; i<no_nodes; ++i) {
+      for(INDEX k=0; k<candidates; ++k) {
+         right_nodes[i].push_back((i + k) % no_nodes);
+      }
+      std::sort(right_nodes[i].begin(), right_nodes[i].end());
+      for(const INDEX j : right_nodes[i]) {
+         assignments << "a " << no_assignments++ << " " << i << " " << j << " " << cost_dist(gen) << "\n";
+      }
+   }
+   // assignments of left node i are i*candidates, ..., (i+1)*candidates-1
+   for(INDEX i=0; i+1<no_nodes; ++i) {
+      for(INDEX k1=0; k1<candidates; ++k1) {
+         for(INDEX k2=0; k2<candidates; ++k2) {
+            if(right_nodes[i][k1] != right_nodes[i+1][k2]) {
+               quadratic << "e " << i*candidates + k1 << " " << (i+1)*candidates + k2 << " " << 0.5*cost_dist(gen) << "\n";
+               ++no_quadratic;
+            }
+         }
+      }
+   }
+   std::ostringstream s;
+   s << "c synthetic graph matching instance\n";
+   s << "p " << no_nodes << " " << no_nodes << " " << no_assignments << " " << no_quadratic << "\n";
+   s << assignments.str() << quadratic.str();
+   return s.str();
+}
+
+// constructs a solver and reads instance through input function. Instance is written into a temporary file, as input functions read files.
+template<typename SOLVER, typename INPUT_FUNCTION>
+std::unique_ptr<SOLVER> construct_solver(const std::string& instance, INPUT_FUNCTION input_function)
+{
+   const std::string filename = "lp_mp_bench_instance.txt";
+   {
+      std::ofstream f(filename);
+      if(!f) { throw std::runtime_error("could not open file " + filename); }
+      f << instance;
+   }
+   std::vector<std::string> options = {
+      {"lp_mp_bench"},
+      {"-i"}, {filename},
+      {"--maxIter"}, {"1"}
+   };
+   std::unique_ptr<SOLVER> s(new SOLVER(options));
+   s->ReadProblem(input_function);
+   std::remove(filename.c_str());
+   return s;
+}
+
+// prepare solver for calling ComputePass and UpdateFactor directly
+template<typename SOLVER>
+void begin(SOLVER& s)
+{
+   s.Begin();
+   s.GetLP().set_reparametrization(LPReparametrizationMode::Anisotropic);
+}
+
+} // end namespace bench
+
+} // end namespace LP_MP
+
+#endif // LP_MP_BENCH_SYNTHETIC_INSTANCES_HXX
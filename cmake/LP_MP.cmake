@@ -29,6 +29,10 @@ include_directories("${CMAKE_CURRENT_BINARY_DIR}/Dependencies/Source/TCLAP_Proje
 #link_directories("${CMAKE_CURRENT_BINARY_DIR}/Dependencies/Build/CryptoMiniSat_Project/lib")
 include_directories("${CMAKE_CURRENT_BINARY_DIR}/Dependencies/Source/Lingeling_Project")
 link_directories("${CMAKE_CURRENT_BINARY_DIR}/Dependencies/Source/Lingeling_Project")
+if(BUILD_BENCHMARKS)
+   include_directories("${CMAKE_CURRENT_BINARY_DIR}/Dependencies/Install/GoogleBenchmark_Project/include")
+   link_directories("${CMAKE_CURRENT_BINARY_DIR}/Dependencies/Install/GoogleBenchmark_Project/lib")
+endif()
 
 #add_subdirectory("${CMAKE_CURRENT_BINARY_DIR}/Dependencies/Source/LEMON_Project")
 #set(LEMON_INCLUDE_DIRS
@@ -47,7 +51,7 @@ link_directories("${CMAKE_CURRENT_BINARY_DIR}/Dependencies/Source/Lingeling_Proj
 
 # HDF5 for reading OpenGM and Andres models
 # set (HDF5_USE_STATIC_LIBRARIES ON)
-if(BUILD_MULTICUT OR BUILD_MULTICUT_EVALUATION OR BUILD_GRAPHICAL_MODEL)
+if(BUILD_MULTICUT OR BUILD_MULTICUT_EVALUATION OR BUILD_GRAPHICAL_MODEL OR BUILD_BENCHMARKS)
    find_package(HDF5 1.8.15 REQUIRED)
    include_directories (${HDF5_INCLUDE_DIR})
    add_definitions(${HDF5_DEFINITIONS})
@@ -71,10 +75,17 @@ if(WITH_SAT_BASED_ROUNDING)
    add_definitions(-DWITH_SAT)
 endif()
 
+if(SINGLE_PRECISION)
+   add_definitions(-DLP_MP_SINGLE_PRECISION)
+endif()
+
 # Parallelisation support
 if(PARALLEL_OPTIMIZATION)
 
   add_definitions(-DLP_MP_PARALLEL) 
+  if(PARALLEL_COLOURING)
+     add_definitions(-DLP_MP_PARALLEL_COLOURING)
+  endif()
 
   FIND_PACKAGE(OpenMP REQUIRED)
   if(OPENMP_FOUND)
@@ -101,5 +112,10 @@ include_directories(lib)
 include_directories(.)
 add_subdirectory(solvers)
 add_subdirectory(lib)
-add_subdirectory(test)
+if(BUILD_TESTS)
+   add_subdirectory(test)
+endif()
+if(BUILD_BENCHMARKS)
+   add_subdirectory(bench)
+endif()
 
@@ -69,6 +69,17 @@ ExternalProject_Add(
 ExternalProject_Get_Property(Catch_Project install_dir)
 include_directories(${install_dir}/Dependencies/Source/Catch_Project/include)
 
+# microbenchmarks
+if(BUILD_BENCHMARKS)
+   list(APPEND DEPENDENCIES GoogleBenchmark_Project)
+   ExternalProject_Add(
+      GoogleBenchmark_Project
+      GIT_REPOSITORY "https://github.com/google/benchmark.git"
+      GIT_TAG "v1.3.0"
+      CMAKE_ARGS "-DCMAKE_INSTALL_PREFIX=${CMAKE_CURRENT_BINARY_DIR}/Dependencies/Install/GoogleBenchmark_Project" "-DCMAKE_BUILD_TYPE=Release" "-DBENCHMARK_ENABLE_TESTING=OFF"
+      )
+endif()
+
 # sorting routines
 list(APPEND DEPENDENCIES cpp_sort_Project)
 ExternalProject_Add(
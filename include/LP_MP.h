@@ -17,12 +17,17 @@
 #include "topological_sort.hxx"
 #include <memory>
 #include <iterator>
+#include <typeindex>
+#include <cstdint>
 #include "primal_solution_storage.hxx"
 #include "lp_interface/lp_interface.h"
 #include "two_dimensional_variable_array.hxx"
 #include <thread>
 #include <future>
+#include <chrono>
 #include "memory_allocator.hxx"
+#include "thread_pool.hxx"
+#include "numa.hxx"
 #include "cereal/archives/binary.hpp"
 #include "sat_interface.hxx"
 #include "tclap/CmdLine.h"
@@ -46,6 +51,19 @@ public:
    virtual ~FactorTypeAdapter() {}
    virtual FactorTypeAdapter* clone() const = 0;
    virtual void UpdateFactor(const weight_vector& omega) = 0;
+   // update factors[0], ..., factors[n-1], which must all have the same type as this factor. Weights of factors[i] are [omega[i], omega[i+1]).
+   // Factor containers override this to update a whole run of factors without virtual dispatch. This only batches dispatch, potentials stay in per-factor storage.
+   virtual void UpdateFactors(FactorTypeAdapter* const* factors, const INDEX n, REAL* const* omega)
+   {
+      for(INDEX i=0; i<n; ++i) {
+         factors[i]->UpdateFactor(weight_vector(omega[i], omega[i+1]));
+      }
+   }
+   // append the pages holding the factor and its dual data, used for moving the factor to another NUMA node
+   virtual void collect_pages(std::vector<std::uintptr_t>& pages) { numa::add_pages(pages, this, sizeof(*this)); }
+   // write and read dual and, if available, primal state of the factor for checkpoints. load_checkpoint must read exactly what save_checkpoint wrote, and the layout must not depend on compile-time vector widths.
+   virtual void save_checkpoint(cereal::BinaryOutputArchive& ar) { assert(false); }
+   virtual void load_checkpoint(cereal::BinaryInputArchive& ar) { assert(false); }
    virtual void UpdateFactorPrimal(const weight_vector& omega, const INDEX iteration) = 0;
    virtual void UpdateFactorSAT(const weight_vector& omega, const REAL th, sat_var begin, sat_vec<sat_literal>& assumptions) = 0;
    //virtual void convert_primal(Glucose::SimpSolver&, sat_var) = 0; // this is not nice: the solver should be templatized
@@ -172,6 +190,7 @@ public:
       }
 
       ordering_valid_ = o.ordering_valid_;
+      ordering_generation_ = o.ordering_generation_;
       omega_anisotropic_valid_ = o.omega_anisotropic_valid_ ;
       omega_isotropic_valid_ = o.omega_isotropic_valid_ ;
       omega_isotropic_damped_valid_ = o.omega_isotropic_damped_valid_ ;
@@ -354,11 +373,270 @@ public:
    {
       if(ordering_valid_) { return; }
       ordering_valid_ = true;
+      ++ordering_generation_;
 
       SortFactors(forward_pass_factor_rel_, forwardOrdering_, forwardUpdateOrdering_);
       SortFactors(backward_pass_factor_rel_, backwardOrdering_, backwardUpdateOrdering_);
       std::reverse(backwardOrdering_.begin(), backwardOrdering_.end());
       std::reverse(backwardUpdateOrdering_.begin(), backwardUpdateOrdering_.end());
+
+      if(colour_schedule_) {
+         ColourFactors();
+      }
+      ComputeDispatchRuns(forwardUpdateOrdering_, forward_dispatch_runs_);
+      ComputeDispatchRuns(backwardUpdateOrdering_, backward_dispatch_runs_);
+      if(incremental_lower_bound_) {
+         PrepareIncrementalLowerBound();
+      }
+   }
+
+   // Greedy distance-2 colouring of the updated factors: Updating a factor writes into the reparametrizations of all its neighbours,
+   // hence two factors may be updated concurrently only if they are not adjacent and do not share a neighbour.
+   // Orderings are rearranged such that colour classes are contiguous, classes are visited in increasing colour in the forward pass and in decreasing colour in the backward pass.
+   // Within a class the previous forward resp. backward ordering is kept, hence the backward pass still follows backward_pass_factor_rel_ there.
+   // Neighbours of a factor of high degree all get distinct colours. Classes with less than min_colour_class_size_ factors are merged
+   // into one last class, which is updated sequentially.
+   void ColourFactors()
+   {
+      const INDEX n = f_.size();
+      std::vector<INDEX> adjacency_begin, adjacency;
+      FactorAdjacency(adjacency_begin, adjacency);
+
+      constexpr INDEX no_colour = std::numeric_limits<INDEX>::max();
+      std::vector<INDEX> colour(n, no_colour);
+      std::vector<INDEX> colour_used_by(1, no_colour); // colour_used_by[c] == i iff colour c is blocked for the factor with index i
+      INDEX no_colours = 0;
+      for(auto* f : forwardUpdateOrdering_) {
+         const INDEX i = factor_address_to_index_[f];
+         auto block_colour = [&](const INDEX j) {
+            if(j != i && colour[j] != no_colour) {
+               colour_used_by[colour[j]] = i;
+            }
+         };
+         for(INDEX a=adjacency_begin[i]; a<adjacency_begin[i+1]; ++a) {
+            const INDEX j = adjacency[a];
+            block_colour(j);
+            for(INDEX b=adjacency_begin[j]; b<adjacency_begin[j+1]; ++b) {
+               block_colour(adjacency[b]);
+            }
+         }
+         INDEX c = 0;
+         while(c < no_colours && colour_used_by[c] == i) { ++c; }
+         if(c == no_colours) {
+            ++no_colours;
+            colour_used_by.push_back(no_colour);
+         }
+         colour[i] = c;
+      }
+
+      std::vector<INDEX> class_size(no_colours, 0);
+      for(auto* f : forwardUpdateOrdering_) {
+         ++class_size[ colour[factor_address_to_index_[f]] ];
+      }
+      no_parallel_colours_ = std::count_if(class_size.begin(), class_size.end(), [&](const INDEX s) { return s >= min_colour_class_size_; });
+      std::vector<INDEX> merged_colour(no_colours);
+      for(INDEX c=0, p=0; c<no_colours; ++c) {
+         merged_colour[c] = class_size[c] >= min_colour_class_size_ ? p++ : no_parallel_colours_;
+      }
+      for(auto& c : colour) {
+         if(c != no_colour) { c = merged_colour[c]; }
+      }
+
+      // factors that are not updated are put in front resp. at the end. Within a colour class factors of the same type are grouped, so that they can be updated in dispatch runs.
+      // If forward and backward relations coincide, the backward ordering is the reverse of the forward one.
+      std::unordered_map<std::type_index, INDEX> type_rank;
+      for(auto* f : forwardOrdering_) {
+         type_rank.insert(std::make_pair(std::type_index(typeid(*f)), type_rank.size()));
+      }
+      auto colour_rank = [&](FactorTypeAdapter* f) {
+         const INDEX c = colour[ factor_address_to_index_[f] ];
+         return c == no_colour ? 0 : c+1;
+      };
+      std::stable_sort(forwardOrdering_.begin(), forwardOrdering_.end(), [&](FactorTypeAdapter* f1, FactorTypeAdapter* f2) {
+         const INDEX k1 = colour_rank(f1);
+         const INDEX k2 = colour_rank(f2);
+         if(k1 != k2) { return k1 < k2; }
+         return type_rank[std::type_index(typeid(*f1))] < type_rank[std::type_index(typeid(*f2))];
+      });
+      std::stable_sort(backwardOrdering_.begin(), backwardOrdering_.end(), [&](FactorTypeAdapter* f1, FactorTypeAdapter* f2) {
+         const INDEX k1 = colour_rank(f1);
+         const INDEX k2 = colour_rank(f2);
+         if(k1 != k2) { return k1 > k2; }
+         return type_rank[std::type_index(typeid(*f1))] > type_rank[std::type_index(typeid(*f2))];
+      });
+      f_sorted_.clear();
+      forwardUpdateOrdering_.clear();
+      for(auto* f : forwardOrdering_) {
+         f_sorted_.push_back(factor_address_to_index_[f]);
+         if(f->FactorUpdated()) {
+            forwardUpdateOrdering_.push_back(f);
+         }
+      }
+      backwardUpdateOrdering_.clear();
+      for(auto* f : backwardOrdering_) {
+         if(f->FactorUpdated()) {
+            backwardUpdateOrdering_.push_back(f);
+         }
+      }
+
+      auto compute_colour_boundaries = [&](const std::vector<FactorTypeAdapter*>& ordering, std::vector<INDEX>& colour_boundaries) {
+         colour_boundaries.clear();
+         colour_boundaries.push_back(0);
+         for(INDEX k=1; k<ordering.size(); ++k) {
+            if(colour[ factor_address_to_index_[ordering[k]] ] != colour[ factor_address_to_index_[ordering[k-1]] ]) {
+               colour_boundaries.push_back(k);
+            }
+         }
+         colour_boundaries.push_back(ordering.size());
+      };
+      compute_colour_boundaries(forwardUpdateOrdering_, forward_colour_boundaries_);
+      compute_colour_boundaries(backwardUpdateOrdering_, backward_colour_boundaries_);
+      assert(forward_colour_boundaries_.size() == backward_colour_boundaries_.size());
+      assert(forward_colour_boundaries_.size() == std::min(no_colours, no_parallel_colours_+1)+1 || forwardUpdateOrdering_.size() == 0);
+   }
+
+   // dispatch batching: consecutive factors of identical type in ordering form a run [dispatch_runs[r], dispatch_runs[r+1]), which is updated by one virtual call
+   static void ComputeDispatchRuns(const std::vector<FactorTypeAdapter*>& ordering, std::vector<INDEX>& dispatch_runs)
+   {
+      dispatch_runs.clear();
+      dispatch_runs.push_back(0);
+      for(INDEX i=1; i<ordering.size(); ++i) {
+         if(typeid(*ordering[i]) != typeid(*ordering[i-1])) {
+            dispatch_runs.push_back(i);
+         }
+      }
+      dispatch_runs.push_back(ordering.size());
+   }
+
+   // update ordering[begin], ..., ordering[end-1]. Each run of factors of identical type is updated by one call to UpdateFactors.
+   // omega holds the weight boundaries of all factors in ordering.
+   static void UpdateFactors(const std::vector<FactorTypeAdapter*>& ordering, const std::vector<INDEX>& dispatch_runs, const INDEX begin, const INDEX end, REAL* const* omega)
+   {
+      assert(dispatch_runs.size() >= 2 && dispatch_runs.back() == ordering.size() && end <= ordering.size());
+      auto run_it = std::upper_bound(dispatch_runs.begin(), dispatch_runs.end(), begin);
+      for(INDEX i=begin; i<end; ++run_it) {
+         assert(run_it != dispatch_runs.end());
+         const INDEX run_end = std::min(end, *run_it);
+         ordering[i]->UpdateFactors(ordering.data() + i, run_end - i, omega + i);
+         i = run_end;
+      }
+   }
+
+   // neighbours of factor f_[i] are adjacency[adjacency_begin[i]], ..., adjacency[adjacency_begin[i+1]-1] (compressed row format)
+   void FactorAdjacency(std::vector<INDEX>& adjacency_begin, std::vector<INDEX>& adjacency)
+   {
+      adjacency_begin.assign(f_.size()+1, 0);
+      for(auto* m : m_) {
+         assert(factor_address_to_index_.find(m->GetLeftFactor()) != factor_address_to_index_.end());
+         assert(factor_address_to_index_.find(m->GetRightFactor()) != factor_address_to_index_.end());
+         ++adjacency_begin[ factor_address_to_index_[m->GetLeftFactor()] + 1 ];
+         ++adjacency_begin[ factor_address_to_index_[m->GetRightFactor()] + 1 ];
+      }
+      std::partial_sum(adjacency_begin.begin(), adjacency_begin.end(), adjacency_begin.begin());
+      adjacency.resize(adjacency_begin.back());
+      std::vector<INDEX> fill(adjacency_begin.begin(), adjacency_begin.end()-1);
+      for(auto* m : m_) {
+         const INDEX l = factor_address_to_index_[m->GetLeftFactor()];
+         const INDEX r = factor_address_to_index_[m->GetRightFactor()];
+         adjacency[fill[l]++] = r;
+         adjacency[fill[r]++] = l;
+      }
+   }
+
+   // For the incremental lower bound, the lower bound of each factor is evaluated in the backward pass directly after the last update modifying it.
+   // An update of a factor modifies the factor itself and its neighbours. Factors evaluated after updating backwardUpdateOrdering_[k] are
+   // lower_bound_eval_[lower_bound_eval_begin_[k]], ..., lower_bound_eval_[lower_bound_eval_begin_[k+1]-1]. Factors not modified at all come last.
+   void PrepareIncrementalLowerBound()
+   {
+      std::vector<INDEX> adjacency_begin, adjacency;
+      FactorAdjacency(adjacency_begin, adjacency);
+
+      const INDEX n = backwardUpdateOrdering_.size();
+      std::vector<INDEX> last_update(f_.size(), n);
+      for(INDEX k=0; k<n; ++k) {
+         const INDEX i = factor_address_to_index_[backwardUpdateOrdering_[k]];
+         last_update[i] = k;
+         for(INDEX a=adjacency_begin[i]; a<adjacency_begin[i+1]; ++a) {
+            last_update[adjacency[a]] = k;
+         }
+      }
+
+      lower_bound_eval_begin_.assign(n+2, 0);
+      for(const INDEX k : last_update) {
+         ++lower_bound_eval_begin_[k+1];
+      }
+      std::partial_sum(lower_bound_eval_begin_.begin(), lower_bound_eval_begin_.end(), lower_bound_eval_begin_.begin());
+      lower_bound_eval_.resize(f_.size());
+      std::vector<INDEX> fill(lower_bound_eval_begin_.begin(), lower_bound_eval_begin_.end()-1);
+      for(INDEX i=0; i<f_.size(); ++i) {
+         lower_bound_eval_[fill[last_update[i]]++] = i;
+      }
+      factor_lower_bound_.resize(f_.size());
+   }
+
+   // evaluate lower bounds of those factors not modified anymore after update k in the backward pass
+   void EvaluateIncrementalLowerBound(const INDEX k)
+   {
+      assert(k+1 < lower_bound_eval_begin_.size());
+      for(INDEX e=lower_bound_eval_begin_[k]; e<lower_bound_eval_begin_[k+1]; ++e) {
+         const INDEX i = lower_bound_eval_[e];
+         factor_lower_bound_[i] = f_[i]->LowerBound();
+      }
+   }
+
+   // backward pass which additionally computes the lower bound
+   template<typename OMEGA_ITERATOR>
+   void ComputeBackwardPassAndLowerBound(OMEGA_ITERATOR omegaIt)
+   {
+      assert(incremental_lower_bound_ && ordering_valid_);
+      lower_bound_valid_ = false;
+      for(INDEX k=0; k<backwardUpdateOrdering_.size(); ++k, ++omegaIt) {
+         UpdateFactor(backwardUpdateOrdering_[k], *omegaIt);
+         EvaluateIncrementalLowerBound(k);
+      }
+      EvaluateIncrementalLowerBound(backwardUpdateOrdering_.size());
+      lower_bound_valid_ = true;
+   }
+
+   void set_incremental_lower_bound(const bool i)
+   {
+      if(i != incremental_lower_bound_) {
+         incremental_lower_bound_ = i;
+         set_flags_dirty();
+      }
+   }
+   bool incremental_lower_bound() const { return incremental_lower_bound_; }
+   // whether the lower bound will be queried after the next pass. Only then the incremental lower bound is evaluated during the backward pass.
+   void set_lower_bound_requested(const bool r) { lower_bound_requested_ = r; }
+   bool evaluate_incremental_lower_bound() const { return incremental_lower_bound_ && lower_bound_requested_; }
+
+   void set_colour_schedule(const bool c)
+   {
+      if(c != colour_schedule_) {
+         colour_schedule_ = c;
+         set_flags_dirty();
+      }
+   }
+   bool colour_schedule() const { return colour_schedule_; }
+   void set_min_colour_class_size(const INDEX s)
+   {
+      if(s != min_colour_class_size_) {
+         min_colour_class_size_ = s;
+         set_flags_dirty();
+      }
+   }
+   // incremented whenever the update orderings are recomputed
+   INDEX ordering_generation() const { return ordering_generation_; }
+   // boundaries of colour classes in forwardUpdateOrdering_ and backwardUpdateOrdering_, valid after SortFactors if colour_schedule() is true
+   const std::vector<INDEX>& forward_colour_boundaries() const { assert(colour_schedule_ && ordering_valid_); return forward_colour_boundaries_; }
+   const std::vector<INDEX>& backward_colour_boundaries() const { assert(colour_schedule_ && ordering_valid_); return backward_colour_boundaries_; }
+   // index of the colour class whose factors are not independent and must be updated sequentially, no class if equal to the number of classes
+   INDEX sequential_colour_class(const Direction dir) const
+   {
+      assert(colour_schedule_ && ordering_valid_);
+      const INDEX no_classes = forward_colour_boundaries_.size()-1;
+      if(no_classes <= no_parallel_colours_) { return no_classes; }
+      return dir == Direction::forward ? no_classes-1 : 0;
    }
 
    template<typename FACTOR_ITERATOR>
@@ -396,9 +674,13 @@ public:
       }
    }
 
-   REAL LowerBound() const
+   LONG_REAL LowerBound() const
    {
-      REAL lb = 0.0;
+      if(lower_bound_valid_) { // computed during last backward pass
+         assert(factor_lower_bound_.size() == f_.size());
+         return std::accumulate(factor_lower_bound_.begin(), factor_lower_bound_.end(), LONG_REAL(0.0));
+      }
+      LONG_REAL lb = 0.0;
       for(auto fIt=f_.begin(); fIt!=f_.end(); fIt++) {
          lb += (*fIt)->LowerBound();
          assert( (*fIt)->LowerBound() > -10000000.0);
@@ -407,6 +689,41 @@ public:
       return lb;
    }
 
+   // state of all factors for checkpoints, see checkpoint.hxx. Messages hold no state of their own, the reparametrization lives in the factors.
+   // Factors must have been constructed in the same order as when the checkpoint was written, factors added by tightening are added again from the tightening logs before loading. This is checked with the factor count and a hash of the factor types.
+   void save_checkpoint(cereal::BinaryOutputArchive& ar) const
+   {
+      ar(std::uint64_t(f_.size()), factor_types_hash());
+      for(auto* f : f_) {
+         f->save_checkpoint(ar);
+      }
+   }
+
+   void load_checkpoint(cereal::BinaryInputArchive& ar)
+   {
+      std::uint64_t no_factors, types_hash;
+      ar(no_factors, types_hash);
+      if(no_factors != f_.size() || types_hash != factor_types_hash()) {
+         throw std::runtime_error("checkpoint does not match problem: " + std::to_string(no_factors) + " factors in checkpoint, " + std::to_string(f_.size()) + " in problem");
+      }
+      for(auto* f : f_) {
+         f->load_checkpoint(ar);
+      }
+      lower_bound_valid_ = false;
+   }
+
+   // FNV-1a over the type names of all factors
+   std::uint64_t factor_types_hash() const
+   {
+      std::uint64_t h = 14695981039346656037ull;
+      for(auto* f : f_) {
+         for(const char* c = typeid(*f).name(); *c != '\0'; ++c) {
+            h = (h ^ std::uint64_t(*c)) * 1099511628211ull;
+         }
+      }
+      return h;
+   }
+
    void InitializePrimalVector(PrimalSolutionStorage& p) { InitializePrimalVector(f_.begin(), f_.end(), p); }
    template<typename FACTOR_ITERATOR>
       void InitializePrimalVector(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorEndIt, PrimalSolutionStorage& v);
@@ -423,11 +740,11 @@ public:
       assert(std::distance(factor_begin, factor_end) == f_.size());
 
    }
-   REAL EvaluatePrimal() {
+   LONG_REAL EvaluatePrimal() {
       return EvaluatePrimal(f_.begin(), f_.end());
    }
    template<typename FACTOR_ITERATOR>
-   REAL EvaluatePrimal(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorEndIt) const;
+   LONG_REAL EvaluatePrimal(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorEndIt) const;
 
    void UpdateFactor(FactorTypeAdapter* f, const weight_vector& omega) // perform one block coordinate step for factor f
    {
@@ -460,6 +777,16 @@ public:
 
    template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR>
    void ComputePass(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorItEnd, OMEGA_ITERATOR omegaIt);
+   // pass over the forward or backward update ordering
+   template<typename OMEGA_ITERATOR>
+   void ComputePass(const Direction dir, OMEGA_ITERATOR omegaIt)
+   {
+      if(dir == Direction::forward) {
+         ComputePass(forwardUpdateOrdering_.begin(), forwardUpdateOrdering_.end(), omegaIt);
+      } else {
+         ComputePass(backwardUpdateOrdering_.begin(), backwardUpdateOrdering_.end(), omegaIt);
+      }
+   }
    void UpdateFactorPrimal(FactorTypeAdapter* f, const weight_vector& omega, const INDEX iteration)
    {
       f->UpdateFactorPrimal(omega, iteration);
@@ -479,6 +806,7 @@ public:
       omega_isotropic_valid_ = false;
       omega_isotropic_damped_valid_ = false;
       omega_mixed_valid_ = false;
+      lower_bound_valid_ = false;
    }
 
    // return type for get_omega
@@ -513,6 +841,7 @@ protected:
    std::vector<MessageTypeAdapter*> m_;
 
    bool ordering_valid_ = false;
+   INDEX ordering_generation_ = 0;
    std::vector<FactorTypeAdapter*> forwardOrdering_, backwardOrdering_; // separate forward and backward ordering are not needed: Just store factorOrdering_ and generate forward order by begin() and backward order by rbegin().
    std::vector<FactorTypeAdapter*> forwardUpdateOrdering_, backwardUpdateOrdering_; // like forwardOrdering_, but includes only those factors where UpdateFactor actually does something
 
@@ -531,6 +860,19 @@ protected:
    std::unordered_map<FactorTypeAdapter*,INDEX> factor_address_to_index_;
    std::vector<INDEX> f_sorted_; // sorted indices in factor vector f_ 
 
+   bool colour_schedule_ = false;
+   INDEX min_colour_class_size_ = 1;
+   INDEX no_parallel_colours_ = 0; // colour classes with smaller colour are independent sets
+   std::vector<INDEX> forward_colour_boundaries_, backward_colour_boundaries_;
+
+   std::vector<INDEX> forward_dispatch_runs_, backward_dispatch_runs_; // dispatch runs of factors of identical type in forwardUpdateOrdering_ and backwardUpdateOrdering_
+
+   bool incremental_lower_bound_ = false;
+   bool lower_bound_requested_ = true;
+   bool lower_bound_valid_ = false; // factor_lower_bound_ holds current lower bounds of all factors
+   std::vector<LONG_REAL> factor_lower_bound_;
+   std::vector<INDEX> lower_bound_eval_begin_, lower_bound_eval_;
+
    LPReparametrizationMode repamMode_ = LPReparametrizationMode::Undefined;
 };
 
@@ -539,56 +881,172 @@ class LP_concurrent : public BASE_LP_CLASS {
 public:
   LP_concurrent(TCLAP::CmdLine& cmd) 
     : BASE_LP_CLASS(cmd),
-    num_lp_threads_arg_("","numLpThreads","number of threads for message passing, default = 1",false,1,&positiveIntegerConstraint,cmd)
+    num_lp_threads_arg_("","numLpThreads","number of threads for message passing, default = 1",false,1,&positiveIntegerConstraint,cmd),
+    chunks_per_thread_arg_("","chunksPerThread","number of chunks each message passing pass is split into per thread for work stealing, default = 8",false,8,&positiveIntegerConstraint,cmd),
+    colour_schedule_arg_("","colourSchedule","update only factors of one colour class of a distance-2 colouring of the factor graph concurrently. Needs no locking. Always on when compiled with LP_MP_PARALLEL_COLOURING",cmd,false),
+    numa_arg_("","numa","pin threads to NUMA nodes, move factors to the node of the thread updating them and steal work preferably from threads on the same node",cmd,false)
   {}
   void Begin()
   {
-    threads_ = decltype(threads_)(num_lp_threads_arg_.getValue());
-    std::cout << "number of threads = " << threads_.size() << "\n";
+    // the pool is persistent: threads are created once here and reused by all subsequent passes
+    const INDEX no_threads = num_lp_threads_arg_.getValue();
+    numa_ = numa_arg_.getValue();
+    // threads are distributed contiguously onto nodes, hence consecutive chunks of a pass are processed on the same node
+    thread_node_.assign(no_threads, 0);
+    if(numa_) {
+       for(INDEX t=0; t<no_threads; ++t) {
+          thread_node_[t] = (LONG_INDEX(t)*numa::topology::get().no_nodes())/no_threads;
+       }
+    }
+    // with NUMA placement all threads of a node share one block arena, so that its buffers are first touched on that node.
+    // The calling thread acts as thread 0 and is left as it is: it keeps block arena 0 and is not pinned, since passes may be run by another thread than the one calling Begin.
+    pool_ = std::make_unique<thread_pool>(no_threads, thread_node_, [this](const INDEX t) {
+       if(numa_) {
+          numa::pin_current_thread(thread_node_[t]);
+          stack_allocator_index = thread_node_[t] % global_real_block_allocator_array.size();
+       } else {
+          stack_allocator_index = t % global_real_block_allocator_array.size();
+       }
+    });
+    chunks_per_thread_ = chunks_per_thread_arg_.getValue();
+    // updating a colour class of a few factors in parallel does not pay off the synchronization afterwards
+    this->set_min_colour_class_size(std::min(no_threads, INDEX(4)));
+#ifdef LP_MP_PARALLEL_COLOURING
+    this->set_colour_schedule(true);
+#else
+    this->set_colour_schedule(colour_schedule_arg_.getValue());
+#endif
+    std::cout << "number of threads = " << pool_->size() << "\n";
+    if(numa_) {
+       std::cout << "number of NUMA nodes = " << numa::topology::get().no_nodes() << "\n";
+    }
     BASE_LP_CLASS::Begin();
   }
 
-  //LP_concurrent(const INDEX no_threads = std::thread::hardware_concurrency())
-  //  : threads_(no_threads)
-  //{
-  //  std::cout << "number of threads = " << threads_.size() << "\n";
-  //  assert(no_threads >= 1);
-  //}
-
+  // pass over an arbitrary range of factors
   template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR>
    void ComputePass(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorItEnd, OMEGA_ITERATOR omegaIt)
    {
+     ComputePassImpl(factorIt, factorItEnd, omegaIt, false, Direction::forward);
+   }
 
-     // idea for load-balancing: measure time a thread needs to finish. Adjust numbers of factors given to each thread based on this.
+  // pass over the forward or backward update ordering, with chunk sizes adapting to measured factor update costs
+  template<typename OMEGA_ITERATOR>
+   void ComputePass(const Direction dir, OMEGA_ITERATOR omegaIt)
+   {
+     auto& ordering = dir == Direction::forward ? this->forwardUpdateOrdering_ : this->backwardUpdateOrdering_;
+     ComputePassImpl(ordering.begin(), ordering.end(), omegaIt, true, dir);
+   }
 
-     auto worker = [this] (auto factor_begin, auto factor_end, auto omega_it, const INDEX allocator_index ) {
-       stack_allocator_index = allocator_index;
-       for(; factor_begin!=factor_end; ++factor_begin, ++omega_it) {
-         this->UpdateFactor(*factor_begin, *omega_it);
+  // update_ordering signifies that factorIt, ..., factorItEnd is the update ordering of direction dir
+  template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR>
+   void ComputePassImpl(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorItEnd, OMEGA_ITERATOR omegaIt, const bool update_ordering, const Direction dir)
+   {
+     assert(pool_ != nullptr);
+     this->lower_bound_valid_ = false;
+     const INDEX n = std::distance(factorIt, factorItEnd);
+     if(n == 0) { return; }
+
+     pass_schedule* schedule = nullptr;
+     const std::vector<INDEX>* colour_boundaries = nullptr;
+     const std::vector<FactorTypeAdapter*>* ordering = nullptr;
+     const std::vector<INDEX>* dispatch_runs = nullptr;
+     const bool backward = update_ordering && dir == Direction::backward;
+     if(update_ordering) {
+        schedule = backward ? &backward_schedule_ : &forward_schedule_;
+        ordering = backward ? &this->backwardUpdateOrdering_ : &this->forwardUpdateOrdering_;
+        dispatch_runs = backward ? &this->backward_dispatch_runs_ : &this->forward_dispatch_runs_;
+        assert(&*factorIt == ordering->data() && n == ordering->size());
+        if(this->colour_schedule()) { colour_boundaries = backward ? &this->backward_colour_boundaries() : &this->forward_colour_boundaries(); }
+     }
+     // with the colour schedule all modifications of a factor after its lower bound has been evaluated are done by factors of the same colour class, which are processed by the same thread
+     const bool compute_lower_bound = this->evaluate_incremental_lower_bound() && colour_boundaries != nullptr && backward;
+
+     // in the backward pass, threads get the chunks they processed in the forward pass, which were placed on their node
+     const bool reverse_assignment = numa_ && backward;
+
+     auto update_chunk = [&] (const INDEX chunk_begin, const INDEX chunk_end, const INDEX thread_no) {
+       const auto begin_time = std::chrono::steady_clock::now();
+       if(ordering != nullptr && !compute_lower_bound) {
+         BASE_LP_CLASS::UpdateFactors(*ordering, *dispatch_runs, chunk_begin, chunk_end, omegaIt.x_);
+       } else {
+         auto omega_it = omegaIt;
+         omega_it += chunk_begin;
+         for(INDEX k=chunk_begin; k<chunk_end; ++k, ++omega_it) {
+           this->UpdateFactor(*(factorIt + k), *omega_it);
+           if(compute_lower_bound) {
+              this->EvaluateIncrementalLowerBound(k);
+           }
+         }
+       }
+       if(schedule != nullptr) {
+          const REAL elapsed = std::chrono::duration<REAL>(std::chrono::steady_clock::now() - begin_time).count();
+          schedule->record_time(chunk_begin, chunk_end, elapsed);
        }
      };
 
-     const int grainsize = std::distance(factorIt, factorItEnd) / threads_.size();
-
-     INDEX c=0;
-     for(auto it = std::begin(threads_); it != std::end(threads_) - 1; ++it) {
-       *it = std::thread(worker, factorIt, factorIt + grainsize, omegaIt, c%global_real_block_allocator_array.size());
-       factorIt += grainsize;
-       omegaIt += grainsize;
-       ++c;
+     if(colour_boundaries != nullptr) {
+        // colour classes are processed one after the other, factors within a class are independent
+        assert(colour_boundaries->back() == n);
+        schedule->compute_chunks(n, chunks_per_thread_*pool_->size(), *colour_boundaries);
+        const INDEX sequential_class = this->sequential_colour_class(dir);
+        for(INDEX c=0; c+1<schedule->class_chunk_begin.size(); ++c) {
+           if(c == sequential_class) {
+              update_chunk((*colour_boundaries)[c], (*colour_boundaries)[c+1], 0);
+              continue;
+           }
+           const INDEX* chunks_begin = schedule->chunk_boundaries.data() + schedule->class_chunk_begin[c];
+           const INDEX* chunks_end = schedule->chunk_boundaries.data() + schedule->class_chunk_begin[c+1] + 1;
+           pool_->run_chunks(chunks_begin, chunks_end, update_chunk, reverse_assignment);
+        }
+        if(compute_lower_bound) {
+           this->EvaluateIncrementalLowerBound(n);
+           this->lower_bound_valid_ = true;
+        }
+     } else if(this->colour_schedule()) {
+        // no colouring is known for arbitrary factor ranges and factors are not protected by locks
+        update_chunk(0, n, 0);
+     } else if(schedule != nullptr) {
+        schedule->compute_chunks(n, chunks_per_thread_*pool_->size());
+        pool_->run_chunks(schedule->chunk_boundaries, update_chunk, reverse_assignment);
+     } else {
+        pool_->parallel_for(n, update_chunk, chunks_per_thread_);
      }
-     threads_.back() = std::thread(worker, factorIt, factorItEnd, omegaIt, c%global_real_block_allocator_array.size());
-
-     for(auto&& i : threads_) {
-       i.join();
-     } 
    }
 
   void ComputePass()
   {
      const auto omega = this->get_omega();
-     this->ComputePass(this->forwardUpdateOrdering_.begin(), this->forwardUpdateOrdering_.end(), omega.forward.begin());
-     this->ComputePass(this->backwardUpdateOrdering_.begin(), this->backwardUpdateOrdering_.end(), omega.backward.begin());
+     if(numa_ && placed_generation_ != this->ordering_generation()) {
+        PlaceFactors();
+     }
+     this->ComputePass(Direction::forward, omega.forward.begin());
+     this->ComputePass(Direction::backward, omega.backward.begin());
+  }
+
+  // parallel reduction over factors. Partial sums of chunks are added up in a fixed order, hence the result does not depend on which thread processed which chunk.
+  LONG_REAL LowerBound() const
+  {
+     if(this->lower_bound_valid_ || pool_ == nullptr) {
+        return BASE_LP_CLASS::LowerBound();
+     }
+     const INDEX n = this->f_.size();
+     const INDEX no_chunks = std::max(INDEX(1), std::min(n, chunks_per_thread_*pool_->size()));
+     std::vector<INDEX> chunk_boundaries(no_chunks+1);
+     for(INDEX c=0; c<=no_chunks; ++c) {
+        chunk_boundaries[c] = (LONG_INDEX(c)*n)/no_chunks;
+     }
+     std::vector<LONG_REAL> partial_lb(no_chunks, 0.0);
+     pool_->run_chunks(chunk_boundaries, [&](const INDEX chunk_begin, const INDEX chunk_end, const INDEX thread_no) {
+        const INDEX c = std::distance(chunk_boundaries.begin(), std::lower_bound(chunk_boundaries.begin(), chunk_boundaries.end(), chunk_begin));
+        LONG_REAL lb = 0.0;
+        for(INDEX i=chunk_begin; i<chunk_end; ++i) {
+           lb += this->f_[i]->LowerBound();
+           assert(std::isfinite(lb));
+        }
+        partial_lb[c] = lb;
+     });
+     return std::accumulate(partial_lb.begin(), partial_lb.end(), LONG_REAL(0.0));
   }
 
 private:
@@ -596,22 +1054,139 @@ private:
   template<typename LAMBDA, typename FACTOR_ITERATOR>
   void iterate_over_factors(LAMBDA& f, FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end)
   {
-     const int grainsize = std::distance(factor_begin, factor_end) / threads_.size();
+     assert(pool_ != nullptr);
+     pool_->parallel_for(std::distance(factor_begin, factor_end), [&](const INDEX chunk_begin, const INDEX chunk_end, const INDEX thread_no) {
+        f(factor_begin + chunk_begin, factor_begin + chunk_end);
+     }, chunks_per_thread_);
+  }
 
-     for(auto it = std::begin(threads_); it != std::end(threads_) - 1; ++it) {
-       *it = std::thread(f, factor_begin, factor_begin + grainsize);
-       factor_begin += grainsize;
+  // Move every factor in the forward update ordering to the NUMA node of the thread that processes it in the forward pass.
+  // Chunks are computed as in the next forward pass. Factors are built by the thread running the problem constructor, hence their memory initially resides on its node.
+  // Thread 0 is the unpinned calling thread whose node is not known, hence its chunks and the sequential colour class are left where they are.
+  void PlaceFactors()
+  {
+     const INDEX n = this->forwardUpdateOrdering_.size();
+     if(this->colour_schedule()) {
+        forward_schedule_.compute_chunks(n, chunks_per_thread_*pool_->size(), this->forward_colour_boundaries());
+     } else {
+        forward_schedule_.compute_chunks(n, chunks_per_thread_*pool_->size());
      }
-     threads_.back() = std::thread(f, factor_begin, factor_end);
-
-     for(auto&& i : threads_) {
-       i.join();
+     constexpr INDEX not_moved = std::numeric_limits<INDEX>::max();
+     std::vector<INDEX> factor_node(n);
+     const auto& s = forward_schedule_;
+     // the sequential colour class is updated by the calling thread
+     const INDEX sequential_class = this->colour_schedule() ? this->sequential_colour_class(Direction::forward) : s.class_chunk_begin.size();
+     for(INDEX c=0; c+1<s.class_chunk_begin.size(); ++c) {
+        const INDEX no_chunks = s.class_chunk_begin[c+1] - s.class_chunk_begin[c];
+        for(INDEX j=0; j<no_chunks; ++j) {
+           const INDEX t = c == sequential_class ? 0 : pool_->initial_thread(j, no_chunks);
+           const INDEX node = t == 0 ? not_moved : thread_node_[t];
+           const INDEX chunk = s.class_chunk_begin[c] + j;
+           std::fill(factor_node.begin() + s.chunk_boundaries[chunk], factor_node.begin() + s.chunk_boundaries[chunk+1], node);
+        }
      }
+
+     std::atomic<INDEX> no_pages(0), no_moved_pages(0);
+     pool_->parallel_for(n, [&](const INDEX chunk_begin, const INDEX chunk_end, const INDEX thread_no) {
+        std::vector<std::uintptr_t> pages, factor_pages;
+        std::vector<INDEX> nodes;
+        for(INDEX k=chunk_begin; k<chunk_end; ++k) {
+           if(factor_node[k] == not_moved) { continue; }
+           factor_pages.clear();
+           this->forwardUpdateOrdering_[k]->collect_pages(factor_pages);
+           for(const auto p : factor_pages) {
+              // a page shared by consecutive factors is moved only once
+              if(pages.empty() || pages.back() != p) {
+                 pages.push_back(p);
+                 nodes.push_back(factor_node[k]);
+              }
+           }
+        }
+        no_pages += pages.size();
+        no_moved_pages += numa::move_pages(pages, nodes);
+     }, chunks_per_thread_);
+     std::cout << "placed " << no_moved_pages << " of " << no_pages << " factor pages on their NUMA node\n";
+
+     placed_generation_ = this->ordering_generation();
   }
 
-  mutable std::vector<std::thread> threads_; // thread pool to be reused
+  // per-factor cost estimates for one update ordering. Chunk boundaries are chosen such that every chunk has roughly equal estimated cost.
+  // After each chunk its measured time is distributed onto its factors proportionally to their previous estimates (exponential moving average).
+  struct pass_schedule {
+     std::vector<REAL> cost;
+     std::vector<char> measured; // cost of factor has been measured. Until then its cost is 1.0
+     std::vector<INDEX> chunk_boundaries;
+     std::vector<INDEX> class_chunk_begin; // chunks of colour class c are chunk_boundaries[class_chunk_begin[c]], ..., chunk_boundaries[class_chunk_begin[c+1]]
+
+     void compute_chunks(const INDEX n, const INDEX no_chunks_target)
+     {
+        compute_chunks(n, no_chunks_target, std::vector<INDEX>({0, n}));
+     }
+
+     // each class [class_boundaries[c], class_boundaries[c+1]) is split separately into no_chunks_target chunks
+     void compute_chunks(const INDEX n, const INDEX no_chunks_target, const std::vector<INDEX>& class_boundaries)
+     {
+        assert(class_boundaries.size() >= 2 && class_boundaries.front() == 0 && class_boundaries.back() == n);
+        if(cost.size() != n) { // ordering has changed, e.g. due to tightening: restart with uniform costs
+           cost.assign(n, 1.0);
+           measured.assign(n, 0);
+        }
+
+        chunk_boundaries.clear();
+        class_chunk_begin.clear();
+        chunk_boundaries.push_back(0);
+        for(INDEX c=0; c+1<class_boundaries.size(); ++c) {
+           const INDEX class_begin = class_boundaries[c];
+           const INDEX class_end = class_boundaries[c+1];
+           class_chunk_begin.push_back(chunk_boundaries.size()-1);
+           const INDEX no_chunks = std::max(INDEX(1), std::min(class_end - class_begin, no_chunks_target));
+           const REAL total_cost = std::accumulate(cost.begin() + class_begin, cost.begin() + class_end, REAL(0.0));
+           const REAL chunk_cost = total_cost / REAL(no_chunks);
+
+           REAL cur_cost = 0.0;
+           for(INDEX i=class_begin; i<class_end; ++i) {
+              cur_cost += cost[i];
+              if(cur_cost >= chunk_cost && i+1 < class_end) {
+                 chunk_boundaries.push_back(i+1);
+                 cur_cost = 0.0;
+              }
+           }
+           chunk_boundaries.push_back(class_end);
+        }
+        class_chunk_begin.push_back(chunk_boundaries.size()-1);
+     }
+
+     // called concurrently for disjoint chunks only
+     void record_time(const INDEX chunk_begin, const INDEX chunk_end, const REAL elapsed)
+     {
+        constexpr REAL smoothing = 0.5;
+        const REAL estimated = std::accumulate(cost.begin() + chunk_begin, cost.begin() + chunk_end, REAL(0.0));
+        if(!(estimated > 0.0) || !(elapsed > 0.0)) { return; }
+        // costs are kept in microseconds to stay away from denormalized values
+        const REAL scale = 1e6 * elapsed / estimated;
+        for(INDEX i=chunk_begin; i<chunk_end; ++i) {
+           if(measured[i]) {
+              cost[i] = (1.0-smoothing)*cost[i] + smoothing*scale*cost[i];
+           } else { // the initial cost is no measurement, do not average with it
+              cost[i] = scale*cost[i];
+              measured[i] = 1;
+           }
+        }
+     }
+  };
+
+  std::unique_ptr<thread_pool> pool_;
+  pass_schedule forward_schedule_, backward_schedule_;
+  INDEX chunks_per_thread_ = 8;
+
+  bool numa_ = false;
+  std::vector<INDEX> thread_node_;
+  INDEX placed_generation_ = 0; // generation of the update ordering for which factors were last placed on NUMA nodes, orderings start at generation 1
 
   TCLAP::ValueArg<INDEX> num_lp_threads_arg_;
+  TCLAP::ValueArg<INDEX> chunks_per_thread_arg_;
+  TCLAP::SwitchArg colour_schedule_arg_;
+  TCLAP::SwitchArg numa_arg_;
 };
 
 template<typename BASE_LP_CLASS>
@@ -766,7 +1341,7 @@ public:
          compute_pass_reduce_sat(this->forwardUpdateOrdering_.begin(), this->forwardUpdateOrdering_.end(), omega.forward.begin(), forward_sat_th_);
          cur_sat_reduction_direction_ = Direction::backward; 
       } else {
-         this->ComputePass(this->forwardUpdateOrdering_.begin(), this->forwardUpdateOrdering_.end(), omega.forward.begin());
+         this->ComputePass(Direction::forward, omega.forward.begin());
       }
    }
    void ComputeBackwardPassAndPrimal(const INDEX iteration)
@@ -779,7 +1354,7 @@ public:
          for(auto it = this->backwardUpdateOrdering_.begin(); it != this->backwardUpdateOrdering_.end(); ++it) {
             assert((*it)->no_send_messages() == omega.backward[ std::distance(this->backwardUpdateOrdering_.begin(), it) ].size());
          }
-         this->ComputePass(this->backwardUpdateOrdering_.begin(), this->backwardUpdateOrdering_.end(), omega.backward.begin());
+         this->ComputePass(Direction::backward, omega.backward.begin());
       }
    }
    void ComputePassAndPrimal(const INDEX iteration)
@@ -898,9 +1473,9 @@ public:
       assert(std::abs(lower_bound() - primal_cost()) <= eps);
    }
 
-   REAL primal_cost() const
+   LONG_REAL primal_cost() const
    {
-      REAL cost = 0.0;
+      LONG_REAL cost = 0.0;
       for(auto it = tree_messages_.begin(); it!= tree_messages_.end(); ++it) {
          auto* m = std::get<0>(*it);
          Chirality c = std::get<1>(*it);
@@ -918,9 +1493,9 @@ public:
       return cost;
    }
 
-   REAL lower_bound() const 
+   LONG_REAL lower_bound() const 
    {
-      REAL lb = 0.0;
+      LONG_REAL lb = 0.0;
       for(auto it = tree_messages_.begin(); it!= tree_messages_.end(); ++it) {
          auto* m = std::get<0>(*it);
          Chirality c = std::get<1>(*it);
@@ -989,14 +1564,20 @@ inline void LP::ComputePass()
    const auto omega = get_omega();
    assert(forwardUpdateOrdering_.size() == omega.forward.size());
    assert(forwardUpdateOrdering_.size() == omega.backward.size());
-   ComputePass(forwardUpdateOrdering_.begin(), forwardUpdateOrdering_.end(), omega.forward.begin());
-   ComputePass(backwardUpdateOrdering_.begin(), backwardUpdateOrdering_.end(), omega.backward.begin());
+   lower_bound_valid_ = false;
+   UpdateFactors(forwardUpdateOrdering_, forward_dispatch_runs_, 0, forwardUpdateOrdering_.size(), omega.forward.begin().x_);
+   if(evaluate_incremental_lower_bound()) {
+      ComputeBackwardPassAndLowerBound(omega.backward.begin());
+   } else {
+      UpdateFactors(backwardUpdateOrdering_, backward_dispatch_runs_, 0, backwardUpdateOrdering_.size(), omega.backward.begin().x_);
+   }
 }
 
 template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR>
 void LP::ComputePass(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorItEnd, OMEGA_ITERATOR omegaIt)
 {
    //assert(std::distance(factorItEnd, factorIt) == std::distance(omegaIt, omegaItEnd));
+   lower_bound_valid_ = false;
    for(; factorIt!=factorItEnd; ++factorIt, ++omegaIt) {
       UpdateFactor(*factorIt, *omegaIt);
    }
@@ -1068,15 +1649,15 @@ bool LP::CheckPrimalConsistency(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR
 }
 
 template<typename FACTOR_ITERATOR>
-REAL LP::EvaluatePrimal(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorEndIt) const
+LONG_REAL LP::EvaluatePrimal(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorEndIt) const
 {
    const bool consistent = CheckPrimalConsistency(factorIt, factorEndIt);
-   if(consistent == false) return std::numeric_limits<REAL>::infinity();
+   if(consistent == false) return std::numeric_limits<LONG_REAL>::infinity();
 
-   REAL cost = 0.0;
+   LONG_REAL cost = 0.0;
    for(; factorIt!=factorEndIt; ++factorIt) {
       cost += (*factorIt)->EvaluatePrimal();
-      if(cost == std::numeric_limits<REAL>::infinity()) {
+      if(cost == std::numeric_limits<LONG_REAL>::infinity()) {
          break;
       }
    }
@@ -1459,6 +2040,7 @@ template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR>
 void LP::ComputePassAndPrimal(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorEndIt, OMEGA_ITERATOR omegaIt, INDEX iteration)
 {
    //assert(false); // initialize primal before going over it
+   lower_bound_valid_ = false;
    for(auto factorItTmp = factorIt; factorItTmp!=factorEndIt; ++factorItTmp, ++omegaIt) {
       UpdateFactorPrimal(*factorItTmp, *omegaIt, iteration);
    }
@@ -0,0 +1,143 @@
+#ifndef LP_MP_CHECKPOINT_HXX
+#define LP_MP_CHECKPOINT_HXX
+
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <array>
+#include <initializer_list>
+#include <cassert>
+#include "config.hxx"
+#include "cereal/archives/binary.hpp"
+#include "cereal/types/string.hpp"
+#include "cereal/types/vector.hpp"
+#include "cereal/types/array.hpp"
+
+// Checkpoints of the solver state, such that long running optimizations can be restarted after being interrupted.
+// Layout: 8 byte magic, then a cereal binary archive holding version, sizeof(REAL), sizeof(INDEX), the solver state and the state of all factors as written by LP::save_checkpoint.
+// Factors added by tightening are part of the solver state as tightening logs of the problem constructors. When resuming, they are added again before the factor states are read.
+// Factors write their state without padding of vectorized storage, hence a checkpoint can be resumed by a binary compiled for another vector width. Version 2 checkpoints could hold padded pairwise tables and are rejected.
+// The checkpoint is first written into a temporary file which is then renamed, hence an interruption while writing leaves the previous checkpoint intact.
+
+namespace LP_MP {
+
+namespace checkpoint {
+
+constexpr char magic[8] = {'L','P','M','P','C','H','K','P'};
+constexpr std::uint32_t version = 3;
+
+// factors added by a problem constructor while tightening, such that they can be added again in the same order when resuming.
+// Right after adding a factor to the LP, the constructor records its kind and the indices describing it, e.g. the nodes of a triplet.
+// Replaying all entries in order adds the same factors in the same order. Factors added while replaying an entry are recorded as entries of their own as well, hence constructors must skip entries of factors that already exist.
+class tightening_log {
+public:
+   template<typename ITERATOR>
+   void record(const INDEX kind, ITERATOR begin, ITERATOR end)
+   {
+      if(!recording_) { return; }
+      kind_.push_back(kind);
+      data_.insert(data_.end(), begin, end);
+      entry_end_.push_back(data_.size());
+   }
+   void record(const INDEX kind, std::initializer_list<INDEX> data) { record(kind, data.begin(), data.end()); }
+
+   // only factors added between start and stop are recorded, i.e. not those of the initial problem
+   void start() { recording_ = true; }
+   void stop() { recording_ = false; }
+
+   INDEX size() const { return kind_.size(); }
+
+   // call f(kind, data_begin, data_end) for entries [first,last)
+   template<typename FUNCTION>
+   void for_each(const INDEX first, const INDEX last, FUNCTION f) const
+   {
+      assert(first <= last && last <= size());
+      for(INDEX e=first; e<last; ++e) {
+         const std::uint64_t begin = e == 0 ? 0 : entry_end_[e-1];
+         f(kind_[e], data_.data() + begin, data_.data() + entry_end_[e]);
+      }
+   }
+
+   template<class ARCHIVE> void serialize(ARCHIVE& ar) { ar(kind_, data_, entry_end_); }
+
+private:
+   bool recording_ = false;
+   std::vector<INDEX> kind_;
+   std::vector<INDEX> data_;
+   std::vector<std::uint64_t> entry_end_;
+};
+
+// everything besides the factors
+struct solver_state {
+   std::uint64_t iteration = 0;
+   LONG_REAL lower_bound = -std::numeric_limits<LONG_REAL>::infinity();
+   LONG_REAL primal_cost = std::numeric_limits<LONG_REAL>::infinity();
+   std::string solution; // best primal solution as written by the problem constructors
+   std::vector<tightening_log> tightening_logs; // one for every problem constructor
+   std::vector<std::array<std::uint64_t,2>> tightening_rounds; // problem constructor and size of its log after each of its tightening rounds that added factors, in the order they were done
+
+   template<class ARCHIVE> void serialize(ARCHIVE& ar) { ar(iteration, lower_bound, primal_cost, solution, tightening_logs, tightening_rounds); }
+};
+
+template<typename LP_TYPE>
+void write(const std::string& filename, const solver_state& state, const LP_TYPE& lp)
+{
+   const std::string tmp_filename = filename + ".tmp";
+   {
+      std::ofstream f(tmp_filename, std::ios::binary);
+      if(!f) { throw std::runtime_error("could not open file " + tmp_filename); }
+      f.write(magic, sizeof(magic));
+      {
+         cereal::BinaryOutputArchive ar(f);
+         ar(version, std::uint32_t(sizeof(REAL)), std::uint32_t(sizeof(INDEX)), state);
+         lp.save_checkpoint(ar);
+      }
+      f.flush();
+      if(!f) { throw std::runtime_error("could not write checkpoint " + tmp_filename); }
+   }
+   if(std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+      throw std::runtime_error("could not rename " + tmp_filename + " to " + filename);
+   }
+   std::cout << "wrote checkpoint " << filename << " after iteration " << state.iteration << "\n";
+}
+
+// replay_tightening is called with the solver state before the factor states are read, so that factors added by tightening can be added again
+template<typename LP_TYPE, typename REPLAY_FUNCTION>
+solver_state read(const std::string& filename, LP_TYPE& lp, REPLAY_FUNCTION replay_tightening)
+{
+   std::cout << "resuming from checkpoint " << filename << "\n";
+   std::ifstream f(filename, std::ios::binary);
+   if(!f) { throw std::runtime_error("could not open file " + filename); }
+   char m[sizeof(magic)];
+   if(!f.read(m, sizeof(magic)) || !std::equal(m, m + sizeof(magic), magic)) {
+      throw std::runtime_error(filename + " is not a checkpoint");
+   }
+   cereal::BinaryInputArchive ar(f);
+   std::uint32_t v, real_size, index_size;
+   ar(v, real_size, index_size);
+   if(v != version) { throw std::runtime_error("checkpoint " + filename + " has unsupported version " + std::to_string(v)); }
+   if(real_size != sizeof(REAL) || index_size != sizeof(INDEX)) { throw std::runtime_error("checkpoint " + filename + " was written with different floating point or index type"); }
+   solver_state state;
+   ar(state);
+   replay_tightening(state);
+   lp.load_checkpoint(ar);
+   return state;
+}
+
+template<typename LP_TYPE>
+solver_state read(const std::string& filename, LP_TYPE& lp)
+{
+   return read(filename, lp, [](const solver_state&) {});
+}
+
+} // end namespace checkpoint
+
+} // end namespace LP_MP
+
+#endif // LP_MP_CHECKPOINT_HXX
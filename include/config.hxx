@@ -12,12 +12,24 @@
 #include <limits>
 #include "tclap/CmdLine.h"
 
+// In parallel mode, factors are either protected by per-factor mutexes or scheduled by a conflict-free colouring of the factor graph.
+// With LP_MP_PARALLEL_COLOURING factors updated concurrently never share a neighbour, hence no locking is needed.
+#if defined(LP_MP_PARALLEL) && !defined(LP_MP_PARALLEL_COLOURING)
+#define LP_MP_PARALLEL_LOCKING
+#endif
+
 // type definitions for LP_MP
 
 namespace LP_MP {
 
    // data types for all floating point/integer operations 
+   // With LP_MP_SINGLE_PRECISION potentials and messages are stored in single precision. Sums over all factors (lower bound, primal cost) are always accumulated in LONG_REAL.
+#ifdef LP_MP_SINGLE_PRECISION
+   using REAL = float;
+#else
    using REAL = double;
+#endif
+   using LONG_REAL = double;
    using INDEX = unsigned int;
    using UNSIGNED_INDEX = INDEX;
    using SIGNED_INDEX = int; // note: must be the same as flow type in MinCost
@@ -29,7 +41,11 @@ namespace LP_MP {
    enum class MessageSendingType {SRMP,MPLP}; // also add full, for always sending and receiving messages
    enum class Direction {forward, backward};
 
+#ifdef LP_MP_SINGLE_PRECISION
+   constexpr REAL eps = 1e-5;
+#else
    constexpr REAL eps = 1e-8;
+#endif
    
    // shortcuts to indicate how many messages a factor holds
    constexpr SIGNED_INDEX variableMessageNumber = 0;
@@ -82,7 +98,7 @@ namespace LP_MP {
    // hash function for various types
    namespace hash {
       // equivalent of boost hash combine
-      size_t hash_combine( size_t lhs, size_t rhs ) {
+      inline size_t hash_combine( size_t lhs, size_t rhs ) {
          lhs^= rhs + 0x9e3779b9 + (lhs << 6) + (lhs >> 2);
          return lhs;
       }
@@ -98,7 +114,7 @@ namespace LP_MP {
       }
    }
 
-   REAL normalize(const REAL x) {
+   inline REAL normalize(const REAL x) {
       assert(!std::isnan(x));
       if(std::isfinite(x)) {
          return x;
@@ -0,0 +1,754 @@
+#ifndef LP_MP_ASSIGNMENT_FACTOR_HXX
+#define LP_MP_ASSIGNMENT_FACTOR_HXX
+
+#include "config.hxx"
+#include "lp_interface/lp_interface.h"
+#include <vector>
+#include <array>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <cmath>
+#include <cassert>
+
+namespace LP_MP {
+
+// linear assignment between left and right nodes, where every node may also stay unassigned at the cost of its slack.
+// Costs are indexed as in the assignment factor via min cost flow: first the assignment edges, then the slack of every left node, then the slack of every right node.
+//
+// The factors below work on the mirrored problem, in which every left node i has a slack object s_i and every right node j a slack person t_j:
+//    person i -> object j   with cost of edge (i,j),
+//    person i -> object s_i with slack cost of i,
+//    person t_j -> object j with slack cost of j,
+//    person t_j -> object s_i with cost 0 for every edge (i,j),
+// such that perfect assignments of the mirrored problem correspond to partial assignments of the original one.
+// assignment_factor_base holds the mirrored problem and the primal solution, derived factors add the solver state.
+class assignment_factor_base {
+public:
+   INDEX size() const { return no_edges_ + no_left_ + no_right_; }
+   INDEX no_left_nodes() const { return no_left_; }
+   INDEX no_right_nodes() const { return no_right_; }
+   INDEX no_edges() const { return no_edges_; }
+
+   REAL operator[](const INDEX e) const { assert(e < size()); return cost_[e]; }
+
+   // assignment edges are covered by the unaries of both of their end nodes, slack edges only by one
+   INDEX coverage(const INDEX e) const { return e < no_edges_ ? 2 : 1; }
+   bool left_slack(const INDEX e) const { return e >= no_edges_ && e < no_edges_ + no_left_; }
+
+   // every node must be covered exactly once, by an assignment edge or by its slack
+   REAL EvaluatePrimal() const
+   {
+      std::vector<INDEX> left_count(no_left_, 0);
+      std::vector<INDEX> right_count(no_right_, 0);
+      LONG_REAL cost = 0.0;
+      for(INDEX e=0; e<size(); ++e) {
+         if(primal_[e] == 1) {
+            cost += cost_[e];
+            if(e < no_edges_) {
+               ++left_count[left_node(e)];
+               ++right_count[right_node(e)];
+            } else if(e < no_edges_ + no_left_) {
+               ++left_count[e - no_edges_];
+            } else {
+               ++right_count[e - no_edges_ - no_left_];
+            }
+         } else if(primal_[e] != 0) {
+            return std::numeric_limits<REAL>::infinity();
+         }
+      }
+      const auto is_one = [](const INDEX c) { return c == 1; };
+      if(!std::all_of(left_count.begin(), left_count.end(), is_one) || !std::all_of(right_count.begin(), right_count.end(), is_one)) {
+         return std::numeric_limits<REAL>::infinity();
+      }
+      return cost;
+   }
+
+   INDEX left_node(const INDEX e) const { assert(e < no_edges_); return arc_person_[edge_arc_[e]]; }
+   INDEX right_node(const INDEX e) const { assert(e < no_edges_); return arcs_[edge_arc_[e]].object; }
+
+   void init_primal() { std::fill(primal_.begin(), primal_.end(), 2); }
+   template<class ARCHIVE> void serialize_primal(ARCHIVE& ar) { ar(primal_); }
+
+   std::vector<unsigned char> primal_;
+
+protected:
+   assignment_factor_base(const INDEX no_left_nodes, const INDEX no_right_nodes, const std::vector<std::array<INDEX,2>>& edges, const std::vector<REAL>& cost)
+      : no_left_(no_left_nodes),
+      no_right_(no_right_nodes),
+      no_edges_(edges.size()),
+      cost_(cost)
+   {
+      assert(cost_.size() == size());
+      const INDEX no_persons = no_left_ + no_right_;
+      std::vector<INDEX> degree(no_persons, 1);
+      for(const auto& e : edges) {
+         assert(e[0] < no_left_ && e[1] < no_right_);
+         ++degree[e[0]];
+         ++degree[no_left_ + e[1]];
+      }
+      person_begin_.resize(no_persons+1, 0);
+      for(INDEX p=0; p<no_persons; ++p) {
+         person_begin_[p+1] = person_begin_[p] + degree[p];
+      }
+      arcs_.resize(person_begin_.back());
+      std::vector<INDEX> pos(person_begin_.begin(), person_begin_.end()-1);
+      edge_arc_.resize(size());
+      for(INDEX e=0; e<edges.size(); ++e) {
+         const INDEX i = edges[e][0];
+         const INDEX j = edges[e][1];
+         edge_arc_[e] = pos[i];
+         arcs_[pos[i]++] = {j, e};
+         arcs_[pos[no_left_ + j]++] = {no_right_ + i, no_cost};
+      }
+      for(INDEX i=0; i<no_left_; ++i) {
+         edge_arc_[no_edges_ + i] = pos[i];
+         arcs_[pos[i]++] = {no_right_ + i, no_edges_ + i};
+      }
+      for(INDEX j=0; j<no_right_; ++j) {
+         edge_arc_[no_edges_ + no_left_ + j] = pos[no_left_ + j];
+         arcs_[pos[no_left_ + j]++] = {j, no_edges_ + no_left_ + j};
+      }
+
+      arc_person_.resize(arcs_.size());
+      for(INDEX p=0; p<no_persons; ++p) {
+         for(INDEX a=person_begin_[p]; a<person_begin_[p+1]; ++a) {
+            arc_person_[a] = p;
+         }
+      }
+
+      primal_.resize(size(), 0);
+   }
+
+   enum : INDEX { 
+      no_cost = std::numeric_limits<INDEX>::max(),
+      unassigned = std::numeric_limits<INDEX>::max()
+   };
+   struct arc {
+      INDEX object;
+      INDEX cost; // index into cost_ or no_cost for mirror arcs
+   };
+
+   LONG_REAL arc_cost(const arc& a) const { return a.cost == no_cost ? 0.0 : cost_[a.cost]; }
+
+   // primal solution from a perfect assignment of the mirrored problem
+   void set_primal(const std::vector<INDEX>& person_object)
+   {
+      std::fill(primal_.begin(), primal_.end(), 0);
+      for(INDEX p=0; p<no_left_ + no_right_; ++p) {
+         for(INDEX a=person_begin_[p]; a<person_begin_[p+1]; ++a) {
+            if(arcs_[a].object == person_object[p] && arcs_[a].cost != no_cost) {
+               primal_[arcs_[a].cost] = 1;
+            }
+         }
+      }
+   }
+
+   const INDEX no_left_, no_right_, no_edges_;
+   std::vector<REAL> cost_;
+
+   std::vector<INDEX> person_begin_; // persons are left nodes followed by slack persons of right nodes, objects are right nodes followed by slack objects of left nodes
+   std::vector<arc> arcs_;
+   std::vector<INDEX> arc_person_;
+   std::vector<INDEX> edge_arc_; // arc of the person covering each cost entry
+};
+
+// assignment solved by the auction algorithm with epsilon scaling (Bertsekas).
+// While many persons are unassigned, their bids are computed in parallel (Jacobi auction), the last few bid one after the other (Gauss-Seidel auction).
+//
+// Any prices give a lower bound via the dual objective, hence the lower bound is valid also when the auction is stopped at epsilon > 0.
+// Reduced costs w.r.t. prices and person profits are nonnegative and can be sent as (lower bounds on) min-marginals.
+class AssignmentFactor : public assignment_factor_base {
+public:
+   AssignmentFactor(const INDEX no_left_nodes, const INDEX no_right_nodes, const std::vector<std::array<INDEX,2>>& edges, const std::vector<REAL>& cost)
+      : assignment_factor_base(no_left_nodes, no_right_nodes, edges, cost)
+   {
+      const INDEX no_persons = no_left_ + no_right_;
+      price_.resize(no_persons, 0.0);
+      profit_.resize(no_persons, 0.0);
+      object_owner_.resize(no_persons, unassigned);
+      person_object_.resize(no_persons, unassigned);
+      edge_change_.resize(size(), 0.0);
+      solve();
+   }
+
+   // updates also record the largest accumulated change of an edge for warm starting the auction, hence they must not be done concurrently
+   constexpr static bool concurrent_cost_updates = false;
+   void update_cost(const INDEX e, const REAL delta)
+   {
+      assert(e < size());
+      assert(std::isfinite(delta));
+      cost_[e] += delta;
+      edge_change_[e] += std::abs(delta);
+      max_change_ = std::max(max_change_, edge_change_[e]);
+      changed_ = true;
+   }
+
+   // nonnegative reduced cost of edge w.r.t. the duals of the last solve
+   REAL reduced_cost(const INDEX e) const
+   {
+      const INDEX a = edge_arc_[e];
+      return std::max(LONG_REAL(0.0), cost_[e] + price_[arcs_[a].object] + profit_[arc_person_[a]]);
+   }
+
+   REAL LowerBound() const
+   {
+      solve();
+      return lower_bound_;
+   }
+
+   void MaximizePotential()
+   {
+      solve();
+   }
+
+   void MaximizePotentialAndComputePrimal()
+   {
+      solve();
+      set_primal(person_object_);
+   }
+
+   // Loaded costs need a cold start. Writing costs, also when collecting pages for NUMA placement, keeps the warm start.
+   template<class ARCHIVE> void serialize_dual(ARCHIVE& ar)
+   {
+      ar(cost_);
+      if(ARCHIVE::is_loading::value) {
+         changed_ = true;
+         max_change_ = std::numeric_limits<LONG_REAL>::infinity();
+      }
+   }
+
+   // relative accuracy of the auction: the final epsilon is accuracy times the largest absolute cost, divided by the number of persons
+   REAL accuracy = 1e-6;
+
+private:
+   enum : INDEX { parallel_bidders = 4096 }; // number of unassigned persons above which bids are computed in parallel
+
+   // best and second best value -cost - price among the arcs of person p
+   void best_objects(const INDEX p, INDEX& best_object, LONG_REAL& best, LONG_REAL& second_best) const
+   {
+      best = -std::numeric_limits<LONG_REAL>::infinity();
+      second_best = -std::numeric_limits<LONG_REAL>::infinity();
+      best_object = unassigned;
+      for(INDEX a=person_begin_[p]; a<person_begin_[p+1]; ++a) {
+         const LONG_REAL v = -arc_cost(arcs_[a]) - price_[arcs_[a].object];
+         if(v > best) {
+            second_best = best;
+            best = v;
+            best_object = arcs_[a].object;
+         } else if(v > second_best) {
+            second_best = v;
+         }
+      }
+      assert(best_object != unassigned);
+   }
+
+   // keep the assignment of persons fulfilling epsilon-complementary slackness, i.e. their object is at most epsilon worse than their best one
+   void unassign_violating(const LONG_REAL epsilon) const
+   {
+      unassigned_persons_.clear();
+      for(INDEX p=0; p<no_left_ + no_right_; ++p) {
+         const INDEX o = person_object_[p];
+         INDEX best_object;
+         LONG_REAL best, second_best;
+         best_objects(p, best_object, best, second_best);
+         LONG_REAL value = -std::numeric_limits<LONG_REAL>::infinity();
+         for(INDEX a=person_begin_[p]; a<person_begin_[p+1]; ++a) {
+            if(arcs_[a].object == o) {
+               value = -arc_cost(arcs_[a]) - price_[o];
+            }
+         }
+         if(value < best - epsilon) {
+            if(o != unassigned) {
+               object_owner_[o] = unassigned;
+               person_object_[p] = unassigned;
+            }
+            unassigned_persons_.push_back(p);
+         }
+      }
+   }
+
+   // auction with fixed epsilon, starting from the current prices and the current partial assignment
+   void auction(const LONG_REAL epsilon, const LONG_REAL cost_range) const
+   {
+      const INDEX no_persons = no_left_ + no_right_;
+      bid_object_.resize(no_persons);
+      bid_.resize(no_persons);
+      best_bid_.resize(no_persons);
+      best_bidder_.resize(no_persons);
+      std::fill(best_bidder_.begin(), best_bidder_.end(), unassigned);
+
+      while(unassigned_persons_.size() > parallel_bidders) {
+         // bidding phase: every unassigned person bids for its best object such that it is at most epsilon worse than the second best one
+         const INDEX no_bidders = unassigned_persons_.size();
+#pragma omp parallel for
+         for(INDEX k=0; k<no_bidders; ++k) {
+            const INDEX p = unassigned_persons_[k];
+            INDEX o;
+            LONG_REAL best, second_best;
+            best_objects(p, o, best, second_best);
+            if(second_best == -std::numeric_limits<LONG_REAL>::infinity()) {
+               second_best = best - cost_range;
+            }
+            bid_object_[k] = o;
+            bid_[k] = price_[o] + best - second_best + epsilon;
+         }
+
+         // assignment phase: every object goes to its highest bidder, the previous owner becomes unassigned
+         for(INDEX k=0; k<no_bidders; ++k) {
+            const INDEX o = bid_object_[k];
+            if(best_bidder_[o] == unassigned || bid_[k] > best_bid_[o]) {
+               best_bidder_[o] = k;
+               best_bid_[o] = bid_[k];
+            }
+         }
+         next_unassigned_persons_.clear();
+         for(INDEX k=0; k<no_bidders; ++k) {
+            const INDEX p = unassigned_persons_[k];
+            const INDEX o = bid_object_[k];
+            if(best_bidder_[o] != k) {
+               next_unassigned_persons_.push_back(p);
+            }
+         }
+         for(INDEX k=0; k<no_bidders; ++k) {
+            const INDEX o = bid_object_[k];
+            if(best_bidder_[o] != k) { continue; }
+            const INDEX p = unassigned_persons_[k];
+            if(object_owner_[o] != unassigned) {
+               person_object_[object_owner_[o]] = unassigned;
+               next_unassigned_persons_.push_back(object_owner_[o]);
+            }
+            object_owner_[o] = p;
+            person_object_[p] = o;
+            price_[o] = best_bid_[o];
+            best_bidder_[o] = unassigned;
+         }
+         std::swap(unassigned_persons_, next_unassigned_persons_);
+      }
+
+      // Gauss-Seidel auction for the remaining few persons: every bid is accepted immediately
+      while(!unassigned_persons_.empty()) {
+         const INDEX p = unassigned_persons_.back();
+         unassigned_persons_.pop_back();
+         INDEX o;
+         LONG_REAL best, second_best;
+         best_objects(p, o, best, second_best);
+         if(second_best == -std::numeric_limits<LONG_REAL>::infinity()) {
+            second_best = best - cost_range;
+         }
+         if(object_owner_[o] != unassigned) {
+            person_object_[object_owner_[o]] = unassigned;
+            unassigned_persons_.push_back(object_owner_[o]);
+         }
+         object_owner_[o] = p;
+         person_object_[p] = o;
+         price_[o] += best - second_best + epsilon;
+      }
+   }
+
+   // epsilon scaling, warm started from the prices and assignment of the last solve.
+   // After small cost changes, scaling starts at the largest accumulated change of an edge and in each phase only persons violating epsilon-complementary slackness bid again.
+   void solve() const
+   {
+      if(!changed_) { return; }
+      const INDEX no_persons = no_left_ + no_right_;
+      LONG_REAL max_cost = 0.0;
+      for(const REAL c : cost_) {
+         assert(std::isfinite(c));
+         max_cost = std::max(max_cost, LONG_REAL(std::abs(c)));
+      }
+      const LONG_REAL final_epsilon = LONG_REAL(accuracy)*std::max(max_cost, LONG_REAL(1.0))/no_persons;
+      const LONG_REAL cost_range = 2.0*max_cost + final_epsilon;
+      LONG_REAL epsilon = std::max(final_epsilon, std::min(max_cost/4.0, max_change_));
+      while(true) {
+         unassign_violating(epsilon);
+         auction(epsilon, cost_range);
+         if(epsilon <= final_epsilon) { break; }
+         epsilon = std::max(final_epsilon, epsilon/4.0);
+      }
+
+      // dual objective: persons get their best profit w.r.t. the final prices
+      LONG_REAL lb = 0.0;
+      for(INDEX p=0; p<no_persons; ++p) {
+         INDEX o;
+         LONG_REAL best, second_best;
+         best_objects(p, o, best, second_best);
+         profit_[p] = best;
+         lb -= best;
+      }
+      for(INDEX o=0; o<no_persons; ++o) {
+         lb -= price_[o];
+      }
+      lower_bound_ = lb;
+      changed_ = false;
+      max_change_ = 0.0;
+      std::fill(edge_change_.begin(), edge_change_.end(), 0.0);
+   }
+
+   mutable std::vector<LONG_REAL> price_;
+   mutable std::vector<LONG_REAL> profit_;
+   mutable std::vector<INDEX> object_owner_;
+   mutable std::vector<INDEX> person_object_;
+   mutable LONG_REAL lower_bound_ = 0.0;
+   mutable bool changed_ = true;
+   mutable LONG_REAL max_change_ = std::numeric_limits<LONG_REAL>::infinity(); // largest entry of edge_change_
+   mutable std::vector<LONG_REAL> edge_change_; // sum of absolute cost updates per edge since the last solve
+
+   // auction workspace
+   mutable std::vector<INDEX> unassigned_persons_, next_unassigned_persons_;
+   mutable std::vector<INDEX> bid_object_, best_bidder_;
+   mutable std::vector<LONG_REAL> bid_, best_bid_;
+};
+
+// assignment solved by the Hungarian method, i.e. by successive shortest augmenting paths w.r.t. reduced costs cost - u - v, where u are labels of persons and v of objects.
+// Matching and labels are kept between solves, so that message passing, which changes costs a little in every round, only triggers incremental updates:
+// Persons with a changed arc cost take their smallest reduced cost as new label, which restores dual feasibility. They stay matched if their object is still among their best ones.
+// Unmatched persons are matched to their best object if it is free, the remaining ones by augmenting paths.
+// Matched arcs may have reduced cost up to eps, hence the primal is optimal up to eps per node.
+// Since labels are dual feasible after every step, the lower bound is valid also when only max_augmenting_paths augmentations are done per solve.
+// Complete matchings are only computed for primal solutions.
+class HungarianAssignmentFactor : public assignment_factor_base {
+public:
+   HungarianAssignmentFactor(const INDEX no_left_nodes, const INDEX no_right_nodes, const std::vector<std::array<INDEX,2>>& edges, const std::vector<REAL>& cost)
+      : assignment_factor_base(no_left_nodes, no_right_nodes, edges, cost)
+   {
+      const INDEX no_persons = no_left_ + no_right_;
+      u_.resize(no_persons, 0.0);
+      v_.resize(no_persons, 0.0);
+      object_owner_.resize(no_persons, unassigned);
+      person_object_.resize(no_persons, unassigned);
+      best_object_.resize(no_persons, unassigned);
+      changed_cost_.resize(size(), 1);
+      dist_.resize(no_persons, std::numeric_limits<LONG_REAL>::infinity());
+      scanned_.resize(no_persons, 0);
+      pred_.resize(no_persons);
+   }
+
+   // costs of different edges may be updated concurrently
+   constexpr static bool concurrent_cost_updates = true;
+   void update_cost(const INDEX e, const REAL delta)
+   {
+      assert(e < size());
+      assert(std::isfinite(delta));
+      cost_[e] += delta;
+      changed_cost_[e] = 1;
+   }
+
+   // nonnegative reduced cost of edge w.r.t. the labels of the last solve
+   REAL reduced_cost(const INDEX e) const
+   {
+      const INDEX a = edge_arc_[e];
+      return std::max(LONG_REAL(0.0), cost_[e] - u_[arc_person_[a]] - v_[arcs_[a].object]);
+   }
+
+   REAL LowerBound() const
+   {
+      solve(max_augmenting_paths);
+      return lower_bound_;
+   }
+
+   void MaximizePotential()
+   {
+      solve(max_augmenting_paths);
+   }
+
+   void MaximizePotentialAndComputePrimal()
+   {
+      solve(std::numeric_limits<INDEX>::max());
+      assert(free_persons_.empty());
+      set_primal(person_object_);
+   }
+
+   // only loaded costs are marked as changed, writing them, also when collecting pages for NUMA placement, keeps labels and matching
+   template<class ARCHIVE> void serialize_dual(ARCHIVE& ar)
+   {
+      ar(cost_);
+      if(ARCHIVE::is_loading::value) {
+         std::fill(changed_cost_.begin(), changed_cost_.end(), 1);
+      }
+   }
+
+   INDEX no_unmatched_persons() const { solve(0); return free_persons_.size(); }
+
+   // augmenting paths per solve during message passing
+   INDEX max_augmenting_paths = 64;
+
+private:
+   // new labels for persons with changed costs and for unmatched persons, then greedy matching of unmatched persons to their best object
+   void reduce() const
+   {
+      const INDEX no_persons = no_left_ + no_right_;
+#pragma omp parallel for
+      for(INDEX p=0; p<no_persons; ++p) {
+         bool changed = person_object_[p] == unassigned;
+         for(INDEX a=person_begin_[p]; a<person_begin_[p+1]; ++a) {
+            if(arcs_[a].cost != no_cost && changed_cost_[arcs_[a].cost]) {
+               changed_cost_[arcs_[a].cost] = 0;
+               changed = true;
+            }
+         }
+         if(!changed) { continue; }
+
+         LONG_REAL best = std::numeric_limits<LONG_REAL>::infinity();
+         LONG_REAL matched = std::numeric_limits<LONG_REAL>::infinity();
+         INDEX best_object = unassigned;
+         for(INDEX a=person_begin_[p]; a<person_begin_[p+1]; ++a) {
+            const INDEX o = arcs_[a].object;
+            const LONG_REAL c = arc_cost(arcs_[a]) - v_[o];
+            if(c < best) {
+               best = c;
+               best_object = o;
+            }
+            if(o == person_object_[p]) {
+               matched = c;
+            }
+         }
+         u_[p] = best;
+         best_object_[p] = best_object;
+         // objects are matched to one person only, hence no conflicting writes
+         if(person_object_[p] != unassigned && matched > best + eps) {
+            object_owner_[person_object_[p]] = unassigned;
+            person_object_[p] = unassigned;
+         }
+      }
+
+      free_persons_.clear();
+      for(INDEX p=0; p<no_persons; ++p) {
+         if(person_object_[p] != unassigned) { continue; }
+         const INDEX o = best_object_[p];
+         if(object_owner_[o] == unassigned) {
+            object_owner_[o] = p;
+            person_object_[p] = o;
+         } else {
+            free_persons_.push_back(p);
+         }
+      }
+   }
+
+   // Dijkstra from a free person to the nearest free object w.r.t. reduced costs.
+   // Afterwards labels of scanned nodes are changed such that the path is tight and all reduced costs stay nonnegative, the dual objective increases by the length of the path.
+   void augment(const INDEX s) const
+   {
+      assert(person_object_[s] == unassigned);
+      using heap_entry = std::pair<LONG_REAL,INDEX>;
+      const auto relax = [this](const INDEX p, const LONG_REAL d) {
+         for(INDEX a=person_begin_[p]; a<person_begin_[p+1]; ++a) {
+            const INDEX o = arcs_[a].object;
+            if(scanned_[o]) { continue; }
+            const LONG_REAL d_o = d + std::max(LONG_REAL(0.0), arc_cost(arcs_[a]) - u_[p] - v_[o]);
+            if(d_o < dist_[o]) {
+               if(dist_[o] == std::numeric_limits<LONG_REAL>::infinity()) {
+                  reached_objects_.push_back(o);
+               }
+               dist_[o] = d_o;
+               pred_[o] = p;
+               heap_.push_back({d_o, o});
+               std::push_heap(heap_.begin(), heap_.end(), std::greater<heap_entry>());
+            }
+         }
+      };
+
+      relax(s, 0.0);
+      INDEX free_object = unassigned;
+      LONG_REAL path_length = 0.0;
+      while(!heap_.empty()) {
+         std::pop_heap(heap_.begin(), heap_.end(), std::greater<heap_entry>());
+         const heap_entry top = heap_.back();
+         heap_.pop_back();
+         const INDEX o = top.second;
+         if(scanned_[o] || top.first > dist_[o]) { continue; }
+         if(object_owner_[o] == unassigned) {
+            free_object = o;
+            path_length = top.first;
+            break;
+         }
+         scanned_[o] = 1;
+         scanned_objects_.push_back(o);
+         relax(object_owner_[o], top.first);
+      }
+      assert(free_object != unassigned); // every person can take its slack object
+
+      u_[s] += path_length;
+      for(const INDEX o : scanned_objects_) {
+         const LONG_REAL delta = path_length - dist_[o];
+         v_[o] -= delta;
+         u_[object_owner_[o]] += delta;
+      }
+      for(INDEX o = free_object;;) {
+         const INDEX p = pred_[o];
+         const INDEX next_object = person_object_[p];
+         object_owner_[o] = p;
+         person_object_[p] = o;
+         if(p == s) { break; }
+         o = next_object;
+      }
+
+      for(const INDEX o : reached_objects_) { dist_[o] = std::numeric_limits<LONG_REAL>::infinity(); }
+      for(const INDEX o : scanned_objects_) { scanned_[o] = 0; }
+      reached_objects_.clear();
+      scanned_objects_.clear();
+      heap_.clear();
+   }
+
+   void solve(const INDEX max_paths) const
+   {
+      const bool changed = std::find(changed_cost_.begin(), changed_cost_.end(), 1) != changed_cost_.end();
+      if(!changed && (free_persons_.empty() || max_paths == 0)) { return; }
+      if(changed) {
+         reduce();
+      }
+      for(INDEX k=0; k<max_paths && !free_persons_.empty(); ++k) {
+         const INDEX p = free_persons_.back();
+         free_persons_.pop_back();
+         augment(p);
+      }
+
+      LONG_REAL lb = 0.0;
+      for(INDEX p=0; p<no_left_ + no_right_; ++p) {
+         lb += u_[p] + v_[p];
+      }
+      lower_bound_ = lb;
+   }
+
+   mutable std::vector<LONG_REAL> u_; // labels of persons
+   mutable std::vector<LONG_REAL> v_; // labels of objects
+   mutable std::vector<INDEX> object_owner_;
+   mutable std::vector<INDEX> person_object_;
+   mutable std::vector<INDEX> free_persons_;
+   mutable std::vector<unsigned char> changed_cost_;
+   mutable LONG_REAL lower_bound_ = 0.0;
+
+   // workspace
+   mutable std::vector<INDEX> best_object_;
+   mutable std::vector<LONG_REAL> dist_;
+   mutable std::vector<unsigned char> scanned_;
+   mutable std::vector<INDEX> pred_;
+   mutable std::vector<INDEX> reached_objects_, scanned_objects_;
+   mutable std::vector<std::pair<LONG_REAL,INDEX>> heap_;
+};
+
+// connects a unary simplex factor of a left or right node with an assignment factor.
+// Labels of the unary are the assignment edges of its node followed by its slack edge, edges_ holds their indices in the assignment factor.
+// With PRIMAL_FROM_ASSIGNMENT the assignment factor computes the primal solution and hands it to the unaries, otherwise the unaries compute it.
+template<bool PRIMAL_FROM_ASSIGNMENT = false>
+class UnaryToAssignmentMessage {
+public:
+   UnaryToAssignmentMessage(const std::vector<INDEX>& edges) : edges_(edges)
+   {
+      assert(edges_.size() >= 1);
+   }
+
+   INDEX size() const { return edges_.size(); }
+
+   template<typename LEFT_FACTOR, typename MSG>
+   void SendMessageToRight(const LEFT_FACTOR& l, MSG& msg, const REAL omega)
+   {
+      assert(l.size() == edges_.size());
+      for(INDEX i=0; i<edges_.size(); ++i) {
+         msg[i] -= omega*l[i];
+      }
+   }
+
+   template<typename LEFT_FACTOR, typename MSG>
+   void ReceiveMessageFromLeft(const LEFT_FACTOR& l, MSG& msg)
+   {
+      SendMessageToRight(l, msg, 1.0);
+   }
+
+   // reduced costs of the assignment factor are lower bounds on min-marginals. Sending them split among the unaries covering an edge keeps the duals feasible, hence the lower bound of the assignment factor does not change.
+   // Messages of left nodes cover disjoint sets of edges, as do messages of right nodes, hence each of the two groups is updated in parallel, if the factor allows concurrent cost updates.
+   template<typename RIGHT_FACTOR, typename MSG_ITERATOR, typename ITERATOR>
+   static void SendMessagesToLeft(const RIGHT_FACTOR& r, MSG_ITERATOR msg_begin, const MSG_ITERATOR msg_end, ITERATOR omega_it)
+   {
+      r.LowerBound(); // computes reduced costs for current costs
+      REAL omega_sum = 0.0;
+      using msg_type = typename std::remove_reference<decltype(*msg_begin)>::type;
+      std::array<std::vector<msg_type*>,2> msgs;
+      for(; msg_begin!=msg_end; ++msg_begin, ++omega_it) {
+         omega_sum += *omega_it;
+         const INDEX slack = (*msg_begin).GetMessageOp().edges_.back();
+         msgs[r.left_slack(slack) ? 0 : 1].push_back(&*msg_begin);
+      }
+      assert(0.0 <= omega_sum && omega_sum < 1.0 + eps);
+
+      // assignment edges are shared by a message of each group, hence compute all reduced costs before the costs change
+      std::array<std::vector<INDEX>,2> offset;
+      std::array<std::vector<REAL>,2> delta;
+      for(INDEX g=0; g<2; ++g) {
+         offset[g].resize(msgs[g].size()+1, 0);
+         for(INDEX k=0; k<msgs[g].size(); ++k) {
+            offset[g][k+1] = offset[g][k] + msgs[g][k]->GetMessageOp().size();
+         }
+         delta[g].resize(offset[g].back());
+#pragma omp parallel for
+         for(INDEX k=0; k<msgs[g].size(); ++k) {
+            const auto& edges = msgs[g][k]->GetMessageOp().edges_;
+            for(INDEX i=0; i<edges.size(); ++i) {
+               delta[g][offset[g][k] + i] = omega_sum*r.reduced_cost(edges[i])/REAL(r.coverage(edges[i]));
+            }
+         }
+      }
+      for(INDEX g=0; g<2; ++g) {
+#pragma omp parallel for if(RIGHT_FACTOR::concurrent_cost_updates)
+         for(INDEX k=0; k<msgs[g].size(); ++k) {
+            auto& msg = *msgs[g][k];
+            for(INDEX i=0; i<msg.GetMessageOp().size(); ++i) {
+               msg[i] -= delta[g][offset[g][k] + i];
+            }
+         }
+      }
+   }
+
+   template<bool ENABLE = !PRIMAL_FROM_ASSIGNMENT, typename LEFT_FACTOR, typename RIGHT_FACTOR>
+   typename std::enable_if<ENABLE,void>::type
+   ComputeRightFromLeftPrimal(const LEFT_FACTOR& l, RIGHT_FACTOR& r)
+   {
+      for(INDEX i=0; i<edges_.size(); ++i) {
+         r.primal_[edges_[i]] = l.primal() == i ? 1 : 0;
+      }
+   }
+
+   template<bool ENABLE = PRIMAL_FROM_ASSIGNMENT, typename LEFT_FACTOR, typename RIGHT_FACTOR>
+   typename std::enable_if<ENABLE,void>::type
+   ComputeLeftFromRightPrimal(LEFT_FACTOR& l, const RIGHT_FACTOR& r)
+   {
+      for(INDEX i=0; i<edges_.size(); ++i) {
+         if(r.primal_[edges_[i]] == 1) {
+            l.primal() = i;
+         }
+      }
+   }
+
+   template<typename G>
+   void RepamLeft(G& l, const REAL msg, const INDEX dim)
+   {
+      assert(dim < edges_.size());
+      l[dim] += msg;
+   }
+
+   template<typename RIGHT_FACTOR>
+   void RepamRight(RIGHT_FACTOR& r, const REAL msg, const INDEX dim)
+   {
+      assert(dim < edges_.size());
+      r.update_cost(edges_[dim], msg);
+   }
+
+   template<class LEFT_FACTOR_TYPE,class RIGHT_FACTOR_TYPE>
+   void CreateConstraints(LpInterfaceAdapter* lp, LEFT_FACTOR_TYPE* l, RIGHT_FACTOR_TYPE* r) const
+   { 
+      for(INDEX i=0; i<edges_.size(); ++i) {
+         LinExpr lhs = lp->CreateLinExpr();
+         LinExpr rhs = lp->CreateLinExpr();
+         lhs += lp->GetLeftVariable(i);
+         rhs += lp->GetRightVariable(edges_[i]);
+         lp->addLinearEquality(lhs,rhs);
+      }
+   }
+
+   const std::vector<INDEX> edges_;
+};
+
+} // end namespace LP_MP
+
+#endif // LP_MP_ASSIGNMENT_FACTOR_HXX
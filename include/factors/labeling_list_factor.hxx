@@ -185,7 +185,7 @@ public:
    REAL LowerBound() const
    {
       if(IMPLICIT_ORIGIN) {
-         return std::min(0.0, *std::min_element(this->begin(), this->end()));
+         return std::min(REAL(0.0), *std::min_element(this->begin(), this->end()));
       } else {
          return *std::min_element(this->begin(), this->end());
       }
@@ -166,11 +166,11 @@ public:
       for(INDEX e=0; e<active_edges.size(); ++e) {
          if(active_edges[e] == true) {
             if(minCostFlow_->GetFlow(e) == 1) {
-               repam_cost.push_back( std::max(minCostFlowRepamUpdate_->GetReducedCost(e), 0.0) );
+               repam_cost.push_back( std::max(minCostFlowRepamUpdate_->GetReducedCost(e), REAL(0.0)) );
                //repam_cost.push_back( -minCostFlowRepamUpdate_->GetReducedCost(e) );
                assert(minCostFlowRepamUpdate_->GetReducedCost(e) > -eps);
             } else if(minCostFlow_->GetFlow(e) == 0) {
-               repam_cost.push_back( std::min(minCostFlowRepamUpdate_->GetReducedCost(e), 0.0) );
+               repam_cost.push_back( std::min(minCostFlowRepamUpdate_->GetReducedCost(e), REAL(0.0)) );
                //repam_cost.push_back( +minCostFlowRepamUpdate_->GetReducedCost(e) );
                assert(minCostFlowRepamUpdate_->GetReducedCost(e) < eps);
             } else {
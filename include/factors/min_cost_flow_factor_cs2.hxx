@@ -4,6 +4,12 @@
 //#include "mcmf.hxx"
 #include "lib/MinCost/MinCost.h"
 #include "config.hxx"
+#include "numa.hxx"
+#include "lp_interface/lp_interface.h"
+#include <iostream>
+#include <cmath>
+#include "cereal/archives/binary.hpp"
+#include "cereal/types/vector.hpp"
 
 //do zrobienia: remove again
 //#include <ilcplex/ilocplex.h>
@@ -30,19 +36,16 @@ public:
       INDEX noEdges_ = edges.size();
 
       minCostFlow_ = new MinCostFlowSolverType(noNodes_, noEdges_);
-      repamUpdateFlow_ = new MinCostFlowSolverType(noNodes_, noEdges_);
       for(auto& e : edges) {
          minCostFlow_->AddEdge(e.start_node, e.end_node, e.upper_bound, e.lower_bound, e.cost);
-         repamUpdateFlow_->AddEdge(e.start_node, e.end_node, std::numeric_limits<SIGNED_INDEX>::max(), 0, 0);
       }
       for(INDEX i=0; i<supply_demand.size(); ++i) {
          minCostFlow_->AddNodeExcess(i, supply_demand[i]);
       }
       //minCostFlow_->SortArcs();
-      minCostFlow_->Solve(); // to initialize data structures
+      lower_bound_ = minCostFlow_->Solve(); // to initialize data structures
       primal_.resize(edges.size());
-      //repamUpdateFlow_->SortArcs();
-      //repamUpdateFlow_->run_cs2(); // to initialize data structures
+      cost_delta_.resize(no_binary_edges_, 0.0);
    }
 
    ~MinCostFlowFactorCS2()
@@ -55,6 +58,7 @@ public:
    REAL EvaluatePrimal() const
    {
       assert(primal_.size() == this->size());
+      apply_cost_deltas();
       REAL cost = 0.0;
       for(INDEX i=0; i<primal_.size(); ++i) {
          cost += primal_[i]*minCostFlow_->GetCost(i);
@@ -114,7 +118,7 @@ public:
 
    void MaximizePotential()
    { 
-      minCostFlow_->Solve();
+      solve();
       //for(INDEX e; e<repam.size(); ++e) {
       //   minCostFlow_->set_cost(e,repam[e]);
       //}
@@ -135,7 +139,7 @@ public:
       //for(INDEX e; e<repam.size(); ++e) {
       //   minCostFlow_->set_cost(e,repam[e]);
       //}
-      minCostFlow_->Solve();
+      solve();
       for(INDEX e=0; e<primal_.size(); ++e) {
          // here we assume that flow is 0/1
          // but there may be edges that are not 0/1, e.g. slack edges, which are auxiliary ones
@@ -166,17 +170,15 @@ public:
 
    REAL LowerBound() const
    {
-      return minCostFlow_->Solve();
+      return solve();
    }
 
+   // pending cost changes are applied before the solver is handed out, such that costs and reduced costs read from it are current
    MinCostFlowSolverType* GetMinCostFlowSolver() const
    {
+      apply_cost_deltas();
       return minCostFlow_;
    }
-   MinCostFlowSolverType* GetRepamFlowSolver() const
-   {
-      return repamUpdateFlow_;
-   }
 
    const INDEX size() const 
    { 
@@ -185,7 +187,40 @@ public:
    const REAL operator[](const INDEX i) const 
    {
       assert(i<no_binary_edges_);
-      return minCostFlow_->GetCost(i);
+      return minCostFlow_->GetCost(i) + cost_delta_[i];
+   }
+
+   // cost changes coming from messages are only recorded here and are applied all at once before the next solve.
+   // Several changes of the same arc are merged, and the solver is not touched for every single message.
+   void update_cost(const INDEX i, const REAL delta)
+   {
+      assert(i<no_binary_edges_);
+      assert(std::isfinite(delta));
+      cost_delta_[i] += delta;
+   }
+
+   // UpdateCost keeps the current flow and node potentials and only saturates arcs whose reduced cost became negative.
+   // The subsequent Solve then repairs the flow starting from the nodes with excess created thereby, instead of solving from scratch.
+   void apply_cost_deltas() const
+   {
+      for(INDEX e=0; e<cost_delta_.size(); ++e) {
+         if(cost_delta_[e] != 0.0) {
+            minCostFlow_->UpdateCost(e, cost_delta_[e]);
+            cost_delta_[e] = 0.0;
+            solved_ = false;
+         }
+      }
+   }
+
+   // the flow is only repaired and its cost recomputed if some cost changed since the last solve
+   REAL solve() const
+   {
+      apply_cost_deltas();
+      if(!solved_) {
+         lower_bound_ = minCostFlow_->Solve();
+         solved_ = true;
+      }
+      return lower_bound_;
    }
 
    // for the SendMessages update step, compute maximal cost change such that current labeling stays optimal
@@ -365,14 +400,38 @@ public:
   { 
      assert(false);
   }
+  void serialize_dual(numa::page_archive& ar) {} // costs are held by the min cost flow solver, only the factor itself is moved between NUMA nodes
+  // the reparametrization are the edge costs held by the min cost flow solver
+  void serialize_dual(cereal::BinaryOutputArchive& ar)
+  {
+     apply_cost_deltas();
+     std::vector<REAL> cost(minCostFlow_->GetEdgeNum());
+     for(INDEX e=0; e<cost.size(); ++e) {
+        cost[e] = minCostFlow_->GetCost(e);
+     }
+     ar(cost);
+  }
+  void serialize_dual(cereal::BinaryInputArchive& ar)
+  {
+     std::vector<REAL> cost;
+     ar(cost);
+     assert(cost.size() == minCostFlow_->GetEdgeNum());
+     std::fill(cost_delta_.begin(), cost_delta_.end(), 0.0);
+     for(INDEX e=0; e<cost.size(); ++e) {
+        minCostFlow_->SetCost(e, cost[e]);
+     }
+     solved_ = false;
+  }
 
    std::vector<unsigned char> primal_;
 private:
    // note: this is also given to the reparametrization storage and hence points to the reparametrized potential. Use shared_ptr?
    MinCostFlowSolverType* minCostFlow_;
-   MinCostFlowSolverType* repamUpdateFlow_;
    const std::vector<SIGNED_INDEX> demand_;
    const INDEX no_binary_edges_;
+   mutable std::vector<REAL> cost_delta_; // cost changes not yet applied to minCostFlow_
+   mutable REAL lower_bound_;
+   mutable bool solved_ = true;
 
 
 };
@@ -581,7 +640,7 @@ public:
          }
          */
          //for(INDEX l=0; l<msgs[i].size(); ++l) {
-         for(INDEX l=0; l<(*msg_begin).size(); ++l) {
+         for(INDEX l=0; l<(*msg_begin).GetMessageOp().size(); ++l) {
             //msgs[i][l] -= omega_sum*1.0/REAL(COVERING_FACTOR)*(-mcf->GetReducedCost(start_arc + l) + mcf->GetCost(start_arc + l));
             /*
             const INDEX e = start_arc + l;
@@ -632,11 +691,11 @@ public:
       leftRepamPot[dim] += msg;
    }
 
-   template<typename G>
-   void RepamRight(G& rightRepamPot, const REAL msg, const INDEX dim) 
+   template<typename RIGHT_FACTOR>
+   void RepamRight(RIGHT_FACTOR& r, const REAL msg, const INDEX dim) 
    {
       assert(dim < edges_.size());
-      rightRepamPot[edges_[dim]] += msg;
+      r.update_cost(edges_[dim], msg);
    }
 
    template<class LEFT_FACTOR_TYPE,class RIGHT_FACTOR_TYPE>
@@ -0,0 +1,180 @@
+#ifndef LP_MP_PAIRWISE_SIMPLEX_KERNELS_HXX
+#define LP_MP_PAIRWISE_SIMPLEX_KERNELS_HXX
+
+#include "config.hxx"
+#include <limits>
+#include <array>
+#include <algorithm>
+#include <cassert>
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+// vectorized kernels for pairwise tables with padded rows as used by PairwiseSimplexFactor.
+// Layout: pairwise[x1*stride + x2], stride is a multiple of simd_width, padding entries of pairwise are +infinity, padding entries of msg2 are 0.
+// Reparametrized values are computed as (pairwise + msg1) + msg2, in the same order as the scalar code, hence results are bitwise identical to it.
+// The instruction set is chosen at compile time from the target (-march=native is set by default), with LP_MP_SINGLE_PRECISION twice as many lanes are used.
+
+namespace LP_MP {
+
+namespace pairwise_simplex_kernels {
+
+#if defined(__AVX512F__) && defined(LP_MP_SINGLE_PRECISION)
+
+constexpr INDEX simd_width = 16;
+struct simd_vec {
+   __m512 v;
+   static simd_vec load(const REAL* p) { return {_mm512_loadu_ps(p)}; }
+   static simd_vec broadcast(const REAL x) { return {_mm512_set1_ps(x)}; }
+   void store(REAL* p) const { _mm512_storeu_ps(p, v); }
+   friend simd_vec operator+(const simd_vec a, const simd_vec b) { return {_mm512_add_ps(a.v, b.v)}; }
+   friend simd_vec min(const simd_vec a, const simd_vec b) { return {_mm512_min_ps(a.v, b.v)}; }
+   REAL horizontal_min() const { return _mm512_reduce_min_ps(v); }
+   // bit i is set iff lane i equals x
+   INDEX equal_mask(const REAL x) const { return _mm512_cmp_ps_mask(v, _mm512_set1_ps(x), _CMP_EQ_OQ); }
+};
+
+#elif defined(__AVX512F__)
+
+constexpr INDEX simd_width = 8;
+struct simd_vec {
+   __m512d v;
+   static simd_vec load(const REAL* p) { return {_mm512_loadu_pd(p)}; }
+   static simd_vec broadcast(const REAL x) { return {_mm512_set1_pd(x)}; }
+   void store(REAL* p) const { _mm512_storeu_pd(p, v); }
+   friend simd_vec operator+(const simd_vec a, const simd_vec b) { return {_mm512_add_pd(a.v, b.v)}; }
+   friend simd_vec min(const simd_vec a, const simd_vec b) { return {_mm512_min_pd(a.v, b.v)}; }
+   REAL horizontal_min() const { return _mm512_reduce_min_pd(v); }
+   INDEX equal_mask(const REAL x) const { return _mm512_cmp_pd_mask(v, _mm512_set1_pd(x), _CMP_EQ_OQ); }
+};
+
+#elif defined(__AVX__) && defined(LP_MP_SINGLE_PRECISION)
+
+constexpr INDEX simd_width = 8;
+struct simd_vec {
+   __m256 v;
+   static simd_vec load(const REAL* p) { return {_mm256_loadu_ps(p)}; }
+   static simd_vec broadcast(const REAL x) { return {_mm256_set1_ps(x)}; }
+   void store(REAL* p) const { _mm256_storeu_ps(p, v); }
+   friend simd_vec operator+(const simd_vec a, const simd_vec b) { return {_mm256_add_ps(a.v, b.v)}; }
+   friend simd_vec min(const simd_vec a, const simd_vec b) { return {_mm256_min_ps(a.v, b.v)}; }
+   REAL horizontal_min() const
+   {
+      __m128 m = _mm_min_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+      m = _mm_min_ps(m, _mm_movehl_ps(m, m));
+      return _mm_cvtss_f32(_mm_min_ss(m, _mm_shuffle_ps(m, m, 1)));
+   }
+   INDEX equal_mask(const REAL x) const { return _mm256_movemask_ps(_mm256_cmp_ps(v, _mm256_set1_ps(x), _CMP_EQ_OQ)); }
+};
+
+#elif defined(__AVX__)
+
+constexpr INDEX simd_width = 4;
+struct simd_vec {
+   __m256d v;
+   static simd_vec load(const REAL* p) { return {_mm256_loadu_pd(p)}; }
+   static simd_vec broadcast(const REAL x) { return {_mm256_set1_pd(x)}; }
+   void store(REAL* p) const { _mm256_storeu_pd(p, v); }
+   friend simd_vec operator+(const simd_vec a, const simd_vec b) { return {_mm256_add_pd(a.v, b.v)}; }
+   friend simd_vec min(const simd_vec a, const simd_vec b) { return {_mm256_min_pd(a.v, b.v)}; }
+   REAL horizontal_min() const
+   {
+      const __m128d m = _mm_min_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+      return _mm_cvtsd_f64(_mm_min_sd(m, _mm_unpackhi_pd(m, m)));
+   }
+   INDEX equal_mask(const REAL x) const { return _mm256_movemask_pd(_mm256_cmp_pd(v, _mm256_set1_pd(x), _CMP_EQ_OQ)); }
+};
+
+#else
+
+constexpr INDEX simd_width = 1;
+struct simd_vec {
+   REAL v;
+   static simd_vec load(const REAL* p) { return {*p}; }
+   static simd_vec broadcast(const REAL x) { return {x}; }
+   void store(REAL* p) const { *p = v; }
+   friend simd_vec operator+(const simd_vec a, const simd_vec b) { return {a.v + b.v}; }
+   friend simd_vec min(const simd_vec a, const simd_vec b) { return {std::min(a.v, b.v)}; }
+   REAL horizontal_min() const { return v; }
+   INDEX equal_mask(const REAL x) const { return v == x ? 1 : 0; }
+};
+
+#endif
+
+inline INDEX padded_size(const INDEX n) { return ((n + simd_width - 1)/simd_width)*simd_width; }
+
+// min_{x2} (pairwise[x1,x2] + msg1[x1]) + msg2[x2] for row x1
+inline REAL row_min(const REAL* pairwise_row, const REAL msg1, const REAL* msg2, const INDEX stride)
+{
+   const simd_vec m1 = simd_vec::broadcast(msg1);
+   simd_vec acc = simd_vec::broadcast(std::numeric_limits<REAL>::infinity());
+   for(INDEX x2=0; x2<stride; x2+=simd_width) {
+      acc = min(acc, (simd_vec::load(pairwise_row + x2) + m1) + simd_vec::load(msg2 + x2));
+   }
+   return acc.horizontal_min();
+}
+
+// m[x1] = min_{x2} pairwise[x1,x2] + msg1[x1] + msg2[x2]
+template<typename VECTOR>
+void min_marginal_1(const REAL* pairwise, const REAL* msg1, const REAL* msg2, const INDEX dim1, const INDEX stride, VECTOR& m)
+{
+   assert(stride % simd_width == 0);
+   for(INDEX x1=0; x1<dim1; ++x1) {
+      m[x1] = row_min(pairwise + x1*stride, msg1[x1], msg2, stride);
+   }
+}
+
+// m[x2] = min_{x1} pairwise[x1,x2] + msg1[x1] + msg2[x2]
+template<typename VECTOR>
+void min_marginal_2(const REAL* pairwise, const REAL* msg1, const REAL* msg2, const INDEX dim1, const INDEX dim2, const INDEX stride, VECTOR& m)
+{
+   assert(stride % simd_width == 0 && dim2 <= stride);
+   alignas(64) REAL tmp[simd_width];
+   for(INDEX x2=0; x2<dim2; x2+=simd_width) {
+      const simd_vec m2 = simd_vec::load(msg2 + x2);
+      simd_vec acc = simd_vec::broadcast(std::numeric_limits<REAL>::infinity());
+      for(INDEX x1=0; x1<dim1; ++x1) {
+         acc = min(acc, (simd_vec::load(pairwise + x1*stride + x2) + simd_vec::broadcast(msg1[x1])) + m2);
+      }
+      acc.store(tmp);
+      for(INDEX i=0; i<std::min(simd_width, dim2-x2); ++i) {
+         m[x2+i] = tmp[i];
+      }
+   }
+}
+
+inline REAL lower_bound(const REAL* pairwise, const REAL* msg1, const REAL* msg2, const INDEX dim1, const INDEX stride)
+{
+   REAL lb = std::numeric_limits<REAL>::infinity();
+   for(INDEX x1=0; x1<dim1; ++x1) {
+      lb = std::min(lb, row_min(pairwise + x1*stride, msg1[x1], msg2, stride));
+   }
+   return lb;
+}
+
+// last minimizer in row-major order (as in the scalar code, which breaks ties with >=)
+inline std::array<INDEX,2> argmin(const REAL* pairwise, const REAL* msg1, const REAL* msg2, const INDEX dim1, const INDEX dim2, const INDEX stride)
+{
+   const REAL min_val = lower_bound(pairwise, msg1, msg2, dim1, stride);
+   for(INDEX x1=dim1; x1>0; --x1) {
+      const simd_vec m1 = simd_vec::broadcast(msg1[x1-1]);
+      for(INDEX x2=stride; x2>0; x2-=simd_width) {
+         const simd_vec val = (simd_vec::load(pairwise + (x1-1)*stride + x2-simd_width) + m1) + simd_vec::load(msg2 + x2-simd_width);
+         const INDEX mask = val.equal_mask(min_val);
+         for(INDEX lane=simd_width; lane>0; --lane) {
+            const INDEX col = x2-simd_width+lane-1;
+            if(col < dim2 && (mask & (INDEX(1) << (lane-1)))) { // padding is skipped
+               return {x1-1, col};
+            }
+         }
+      }
+   }
+   assert(false);
+   return {0,0};
+}
+
+} // end namespace pairwise_simplex_kernels
+
+} // end namespace LP_MP
+
+#endif // LP_MP_PAIRWISE_SIMPLEX_KERNELS_HXX
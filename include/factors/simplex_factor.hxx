@@ -4,6 +4,7 @@
 #include "LP_MP.h"
 #include "memory_allocator.hxx"
 #include "vector.hxx"
+#include "factors/pairwise_simplex_kernels.hxx"
 #ifdef WITH_SAT
 #include "sat_interface.hxx"
 #endif
@@ -90,17 +91,24 @@ private:
 // do zrobienia: if pairwise was supplied to us (e.g. external factor, then reflect this in constructor and only allocate space for messages.
 // When tightening, we can simply replace pairwise pointer to external factor with an explicit copy. Reallocate left_msg_ and right_msg_ to make memory contiguous? Not sure, depends whether we use block_allocator, which will not acually release the memory
 // when factor is copied, then pairwise_ must only be copied if it is actually modified. This depends on whether we execute SMRP or MPLP style message passing. Templatize for this possibility
+// rows of the pairwise table are padded to a multiple of the simd width, padding entries hold infinity. Memory layout is pairwise_, right_msg_, left_msg_
+// pairwise cost that equals default_cost except for explicitly given entries (x1,x2,cost)
+struct pairwise_sparse_cost {
+   REAL default_cost = 0.0;
+   std::vector<std::tuple<INDEX,INDEX,REAL>> entries;
+};
+
 class PairwiseSimplexFactor : public matrix_expression<REAL, PairwiseSimplexFactor> {
 public:
-   PairwiseSimplexFactor(const INDEX dim1, const INDEX dim2) : dim1_(dim1), dim2_(dim2)
+   PairwiseSimplexFactor(const INDEX dim1, const INDEX dim2) : dim1_(dim1), dim2_(dim2), stride_(pairwise_simplex_kernels::padded_size(dim2))
    {
-      const INDEX size = dim1_*dim2_ + dim1_ + dim2_;
-      pairwise_ = global_real_block_allocator.allocate(size);
+      pairwise_ = global_real_block_allocator.allocate(storage_size(), 64);
       //pairwise_ = new REAL[size]; // possibly use block allocator!
       assert(pairwise_ != nullptr);
-      std::fill(pairwise_, pairwise_ + size, 0.0);
-      left_msg_ = pairwise_ + dim1_*dim2_;
-      right_msg_ = left_msg_ + dim1_;
+      std::fill(pairwise_, pairwise_ + storage_size(), 0.0);
+      right_msg_ = pairwise_ + dim1_*stride_;
+      left_msg_ = right_msg_ + stride_;
+      set_padding();
    }
 
    template<typename MATRIX>
@@ -114,49 +122,52 @@ public:
       }
    }
 
+   PairwiseSimplexFactor(const INDEX dim1, const INDEX dim2, const pairwise_sparse_cost& c) 
+   : PairwiseSimplexFactor(dim1,dim2)
+   {
+      for(INDEX x1=0; x1<this->dim1(); ++x1) {
+         for(INDEX x2=0; x2<this->dim2(); ++x2) {
+            this->cost(x1,x2) = c.default_cost;
+         }
+      }
+      for(const auto& e : c.entries) {
+         this->cost(std::get<0>(e), std::get<1>(e)) = std::get<2>(e);
+      }
+   }
+
    ~PairwiseSimplexFactor() {
       global_real_block_allocator.deallocate(pairwise_,1);
    }
-   PairwiseSimplexFactor(const PairwiseSimplexFactor& o) : dim1_(o.dim1_), dim2_(o.dim2_) {
-      const INDEX size = dim1_*dim2_ + dim1_ + dim2_;
-      pairwise_ = global_real_block_allocator.allocate(size);
+   PairwiseSimplexFactor(const PairwiseSimplexFactor& o) : dim1_(o.dim1_), dim2_(o.dim2_), stride_(o.stride_) {
+      pairwise_ = global_real_block_allocator.allocate(storage_size(), 64);
       //pairwise_ = new REAL[dim1_*dim2_ + dim1_ + dim2_]; // possibly use block allocator!
       assert(pairwise_ != nullptr);
-      left_msg_ = pairwise_ + dim1_*dim2_;
-      right_msg_ = left_msg_ + dim1_;
-      for(INDEX i=0; i<dim1_*dim2_; ++i) { pairwise_[i] = o.pairwise_[i]; }
-      for(INDEX i=0; i<dim1_; ++i) { left_msg_[i] = o.left_msg_[i]; }
-      for(INDEX i=0; i<dim2_; ++i) { right_msg_[i] = o.right_msg_[i]; }
+      right_msg_ = pairwise_ + dim1_*stride_;
+      left_msg_ = right_msg_ + stride_;
+      std::copy(o.pairwise_, o.pairwise_ + storage_size(), pairwise_);
    }
    void operator=(const PairwiseSimplexFactor& o) {
       assert(dim1_ == o.dim1_ && dim2_ == o.dim2_);
-      for(INDEX i=0; i<dim1_*dim2_; ++i) { pairwise_[i] = o.pairwise_[i]; }
-      for(INDEX i=0; i<dim1_; ++i) { left_msg_[i] = o.left_msg_[i]; }
-      for(INDEX i=0; i<dim2_; ++i) { right_msg_[i] = o.right_msg_[i]; }
+      std::copy(o.pairwise_, o.pairwise_ + storage_size(), pairwise_);
    }
 
    REAL operator[](const INDEX x) const {
       const INDEX x1 = x/dim2_;
       const INDEX x2 = x%dim2_;
       assert(x1 < dim1_ && x2 < dim2_);
-      return pairwise_[x] + left_msg_[x1] + right_msg_[x2];
+      return pairwise_[x1*stride_ + x2] + left_msg_[x1] + right_msg_[x2];
    }
    // below is not nice: two different values, only differ by const!
    REAL operator()(const INDEX x1, const INDEX x2) const {
       assert(x1 < dim1_ && x2 < dim2_);
-      return pairwise_[x1*dim2_ + x2] + left_msg_[x1] + right_msg_[x2];
+      return pairwise_[x1*stride_ + x2] + left_msg_[x1] + right_msg_[x2];
    }
    REAL& cost(const INDEX x1, const INDEX x2) {
       assert(x1 < dim1_ && x2 < dim2_);
-      return pairwise_[x1*dim2_ + x2];
+      return pairwise_[x1*stride_ + x2];
    }
    REAL LowerBound() const {
-      REAL lb = std::numeric_limits<REAL>::infinity();
-      for(INDEX x1=0; x1<dim1_; ++x1) {
-         for(INDEX x2=0; x2<dim2_; ++x2) {
-            lb = std::min(lb, (*this)(x1,x2));
-         }
-      }
+      const REAL lb = pairwise_simplex_kernels::lower_bound(pairwise_, left_msg_, right_msg_, dim1_, stride_);
       assert(std::isfinite(lb));
       return lb;
    }
@@ -165,7 +176,7 @@ public:
    INDEX dim1() const { return dim1_; }
    INDEX dim2() const { return dim2_; }
      
-   REAL& pairwise(const INDEX x1, const INDEX x2) { return pairwise_[x1*dim2_ + x2]; }
+   REAL& pairwise(const INDEX x1, const INDEX x2) { assert(x1 < dim1_ && x2 < dim2_); return pairwise_[x1*stride_ + x2]; }
    REAL& msg1(const INDEX x1) { return left_msg_[x1]; }
    REAL& msg2(const INDEX x2) { return right_msg_[x2]; }
 
@@ -188,43 +199,34 @@ public:
    }
    void MaximizePotentialAndComputePrimal() 
    {
-      REAL min_val = std::numeric_limits<REAL>::infinity();
-      for(INDEX x1=0; x1<dim1(); ++x1) {
-         for(INDEX x2=0; x2<dim2(); ++x2) {
-            if(min_val >= (*this)(x1,x2)) {
-               min_val = (*this)(x1,x2);
-               primal_[0] = x1;
-               primal_[1] = x2;
-            }
-         }
-      }
+      primal_ = pairwise_simplex_kernels::argmin(pairwise_, left_msg_, right_msg_, dim1_, dim2_, stride_);
    }
 
    template<class ARCHIVE> void serialize_primal(ARCHIVE& ar) { ar( primal_[0], primal_[1] ); }
-   template<class ARCHIVE> void serialize_dual(ARCHIVE& ar) { ar( cereal::binary_data( pairwise_, sizeof(REAL)*(size()+dim1()+dim2()) ) ); }
+   // only the dim1*dim2 entries and the messages are written, hence the layout does not depend on the vector width rows are padded to. Padding is set anew, as needed after loading.
+   template<class ARCHIVE> void serialize_dual(ARCHIVE& ar)
+   {
+      for(INDEX x1=0; x1<dim1_; ++x1) {
+         ar( cereal::binary_data( pairwise_ + x1*stride_, sizeof(REAL)*dim2_ ) );
+      }
+      ar( cereal::binary_data( right_msg_, sizeof(REAL)*dim2_ ), cereal::binary_data( left_msg_, sizeof(REAL)*dim1_ ) );
+      set_padding();
+   }
+   // moving the factor to another NUMA node takes the whole block including padding
+   void serialize_dual(numa::page_archive& ar) { ar( cereal::binary_data( pairwise_, sizeof(REAL)*storage_size() ) ); }
 
    template<typename VECTOR>
    void min_marginal_1(VECTOR& m) const
    {
       assert(m.size() == dim1());
-      std::fill(m.begin(), m.end(), std::numeric_limits<REAL>::infinity());
-      for(INDEX x1=0; x1<dim1(); ++x1) {
-          for(INDEX x2=0; x2<dim2(); ++x2) {
-             m[x1] = std::min(m[x1],(*this)(x1,x2));
-          }
-       } 
+      pairwise_simplex_kernels::min_marginal_1(pairwise_, left_msg_, right_msg_, dim1_, stride_, m);
    }
 
    template<typename VECTOR>
    void min_marginal_2(VECTOR& m) const
    {
       assert(m.size() == dim2());
-      std::fill(m.begin(), m.end(), std::numeric_limits<REAL>::infinity());
-      for(INDEX x1=0; x1<dim1(); ++x1) {
-          for(INDEX x2=0; x2<dim2(); ++x2) {
-             m[x2] = std::min(m[x2],(*this)(x1,x2));
-          }
-       } 
+      pairwise_simplex_kernels::min_marginal_2(pairwise_, left_msg_, right_msg_, dim1_, dim2_, stride_, m);
    }
 
 #ifdef WITH_SAT
@@ -294,12 +296,24 @@ public:
 
    //INDEX primal_[0], primal_[1]; // not so nice: make getters and setters!
 private:
+   INDEX storage_size() const { return dim1_*stride_ + stride_ + dim1_; }
+
+   // padding entries of pairwise_ are infinity and those of right_msg_ are zero, such that the kernels never pick them
+   void set_padding()
+   {
+      for(INDEX x1=0; x1<dim1_; ++x1) {
+         std::fill(pairwise_ + x1*stride_ + dim2_, pairwise_ + (x1+1)*stride_, std::numeric_limits<REAL>::infinity());
+      }
+      std::fill(right_msg_ + dim2_, right_msg_ + stride_, 0.0);
+   }
+
    // those three pointers should lie contiguously in memory.
    REAL* pairwise_;
    REAL* left_msg_;
    REAL* right_msg_;
    std::array<INDEX,2> primal_;
    const INDEX dim1_, dim2_;
+   const INDEX stride_; // row length of pairwise_ including padding
 
 };
 
@@ -661,7 +675,7 @@ public:
    }
 
    pairwise_potts_factor(const INDEX dim1, const INDEX dim2)
-      : pairwise_potts_factor(dim1, 0.0)
+      : pairwise_potts_factor(dim1, REAL(0.0))
    {
       assert(dim1 == dim2);
    }
@@ -781,6 +795,299 @@ protected:
    std::array<INDEX,2> primal_;
 
 };
+
+// pairwise factor storing only the entries of the cost differing from a common default value, e.g. the quadratic terms of graph matching.
+// Min-marginals are computed in O(nnz + dim log dim) instead of O(dim1*dim2): for every label the minimum is taken over its explicit entries and over the smallest message of the other side not covered by them.
+// If at least a quarter of all entries is explicit, the cost is stored as a dense table laid out as in PairwiseSimplexFactor and the vectorized kernels are used.
+// The dense table is then not larger than entries plus index, and faster to traverse.
+class pairwise_sparse_factor {
+public:
+   pairwise_sparse_factor(const INDEX dim1, const INDEX dim2)
+      : pairwise_sparse_factor(dim1, dim2, pairwise_sparse_cost{})
+   {}
+
+   pairwise_sparse_factor(const INDEX dim1, const INDEX dim2, const pairwise_sparse_cost& c)
+      : msg1_(dim1, 0.0),
+      msg2_(use_dense(dim1, dim2, c.entries.size()) ? pairwise_simplex_kernels::padded_size(dim2) : dim2, 0.0),
+      dim2_(dim2),
+      default_cost_(c.default_cost)
+   {
+      if(use_dense(dim1, dim2, c.entries.size())) {
+         stride_ = pairwise_simplex_kernels::padded_size(dim2);
+         dense_.assign(dim1*stride_, std::numeric_limits<REAL>::infinity());
+         for(INDEX x1=0; x1<dim1; ++x1) {
+            std::fill(dense_.begin() + x1*stride_, dense_.begin() + x1*stride_ + dim2, default_cost_);
+         }
+         for(const auto& e : c.entries) {
+            assert(std::get<0>(e) < dim1 && std::get<1>(e) < dim2);
+            dense_[std::get<0>(e)*stride_ + std::get<1>(e)] = std::get<2>(e);
+         }
+         return;
+      }
+      entries_.reserve(c.entries.size());
+      for(const auto& e : c.entries) {
+         assert(std::get<0>(e) < dim1 && std::get<1>(e) < dim2);
+         entries_.push_back({std::get<0>(e), std::get<1>(e), std::get<2>(e)});
+      }
+      build_index();
+   }
+
+   // dense cost, only entries differing from zero are explicit
+   template<typename MATRIX>
+   pairwise_sparse_factor(const INDEX dim1, const INDEX dim2, const MATRIX& m) 
+      : pairwise_sparse_factor(dim1, dim2, sparse_cost(dim1, dim2, m))
+   {}
+
+   bool dense() const { return !dense_.empty(); }
+
+   REAL cost(const INDEX x1, const INDEX x2) const
+   {
+      assert(x1 < dim1() && x2 < dim2());
+      if(dense()) { return dense_[x1*stride_ + x2]; }
+      const auto begin = entries_.begin() + row_begin_[x1];
+      const auto end = entries_.begin() + row_begin_[x1+1];
+      const auto it = std::lower_bound(begin, end, x2, [](const entry& e, const INDEX x) { return e.x2 < x; });
+      return it != end && it->x2 == x2 ? it->cost : default_cost_;
+   }
+
+   // inserts an explicit entry if not present yet. Meant for construction only, as the column index is rebuilt.
+   // Explicit entries known beforehand should be passed to the constructor.
+   REAL& cost(const INDEX x1, const INDEX x2)
+   {
+      assert(x1 < dim1() && x2 < dim2());
+      if(dense()) { return dense_[x1*stride_ + x2]; }
+      const auto begin = entries_.begin() + row_begin_[x1];
+      const auto end = entries_.begin() + row_begin_[x1+1];
+      const auto it = std::lower_bound(begin, end, x2, [](const entry& e, const INDEX x) { return e.x2 < x; });
+      const INDEX k = it - entries_.begin();
+      if(it == end || it->x2 != x2) {
+         entries_.insert(it, {x1, x2, default_cost_});
+         build_index();
+      }
+      return entries_[k].cost;
+   }
+
+   REAL operator()(const INDEX x1, const INDEX x2) const
+   {
+      return cost(x1,x2) + msg1_[x1] + msg2_[x2];
+   }
+
+   REAL operator[](const INDEX x) const
+   {
+      return (*this)(x/dim2(), x%dim2());
+   }
+
+   INDEX dim1() const { return msg1_.size(); }
+   INDEX dim2() const { return dim2_; }
+   INDEX size() const { return dim1()*dim2(); }
+   INDEX no_entries() const { assert(!dense()); return entries_.size(); }
+   REAL default_cost() const { return default_cost_; }
+
+   REAL msg1(const INDEX x1) const { assert(x1 < dim1()); return msg1_[x1]; }
+   REAL& msg1(const INDEX x1) { assert(x1 < dim1()); return msg1_[x1]; }
+   REAL msg2(const INDEX x2) const { assert(x2 < dim2()); return msg2_[x2]; }
+   REAL& msg2(const INDEX x2) { assert(x2 < dim2()); return msg2_[x2]; }
+
+   REAL LowerBound() const
+   {
+      if(dense()) {
+         const REAL lb = pairwise_simplex_kernels::lower_bound(dense_.data(), msg1_.begin(), msg2_.begin(), dim1(), stride_);
+         assert(std::isfinite(lb));
+         return lb;
+      }
+      std::vector<REAL> m(dim1());
+      min_marginal_1(m);
+      const REAL lb = *std::min_element(m.begin(), m.end());
+      assert(std::isfinite(lb));
+      return lb;
+   }
+
+   template<typename VECTOR>
+   void min_marginal_1(VECTOR& m) const
+   {
+      assert(m.size() == dim1());
+      if(dense()) {
+         pairwise_simplex_kernels::min_marginal_1(dense_.data(), msg1_.begin(), msg2_.begin(), dim1(), stride_, m);
+         return;
+      }
+      min_marginal(msg1_, msg2_, row_begin_, max_row_entries_, [this](const INDEX k) -> const entry& { return entries_[k]; }, [](const entry& e) { return e.x2; }, m, nullptr);
+   }
+
+   template<typename VECTOR>
+   void min_marginal_2(VECTOR& m) const
+   {
+      assert(m.size() == dim2());
+      if(dense()) {
+         pairwise_simplex_kernels::min_marginal_2(dense_.data(), msg1_.begin(), msg2_.begin(), dim1(), dim2(), stride_, m);
+         return;
+      }
+      min_marginal(msg2_, msg1_, col_begin_, max_col_entries_, [this](const INDEX k) -> const entry& { return entries_[col_entries_[k]]; }, [](const entry& e) { return e.x1; }, m, nullptr);
+   }
+
+   void init_primal() 
+   {
+      primal_[0] = dim1();
+      primal_[1] = dim2();
+   }
+   REAL EvaluatePrimal() const
+   { 
+      if(primal_[0] >= dim1() || primal_[1] >= dim2()) {
+         return std::numeric_limits<REAL>::infinity();
+      }
+      return (*this)(primal_[0], primal_[1]); 
+   }
+   void MaximizePotentialAndComputePrimal() 
+   {
+      if(dense()) {
+         primal_ = pairwise_simplex_kernels::argmin(dense_.data(), msg1_.begin(), msg2_.begin(), dim1(), dim2(), stride_);
+         return;
+      }
+      std::vector<REAL> m(dim1());
+      std::vector<INDEX> arg(dim1());
+      min_marginal(msg1_, msg2_, row_begin_, max_row_entries_, [this](const INDEX k) -> const entry& { return entries_[k]; }, [](const entry& e) { return e.x2; }, m, arg.data());
+      primal_[0] = std::min_element(m.begin(), m.end()) - m.begin();
+      primal_[1] = arg[primal_[0]];
+   }
+
+   const std::array<INDEX,2>& primal() const { return primal_; }
+   std::array<INDEX,2>& primal() { return primal_; }
+
+   template<class ARCHIVE> void serialize_primal(ARCHIVE& ar) { ar( primal_[0], primal_[1] ); }
+   // padding of msg2_ in dense mode is not written, hence the layout does not depend on the vector width
+   template<class ARCHIVE> void serialize_dual(ARCHIVE& ar) { ar( msg1_, cereal::binary_data( msg2_.begin(), sizeof(REAL)*dim2() ) ); }
+
+private:
+   struct entry {
+      INDEX x1, x2;
+      REAL cost;
+   };
+
+   static bool use_dense(const INDEX dim1, const INDEX dim2, const INDEX no_entries)
+   {
+      return 4*LONG_INDEX(no_entries) >= LONG_INDEX(dim1)*LONG_INDEX(dim2) && no_entries > 0;
+   }
+
+   template<typename MATRIX>
+   static pairwise_sparse_cost sparse_cost(const INDEX dim1, const INDEX dim2, const MATRIX& m)
+   {
+      pairwise_sparse_cost c;
+      for(INDEX x1=0; x1<dim1; ++x1) {
+         for(INDEX x2=0; x2<dim2; ++x2) {
+            if(m(x1,x2) != 0.0) {
+               c.entries.push_back(std::make_tuple(x1, x2, m(x1,x2)));
+            }
+         }
+      }
+      return c;
+   }
+
+   // sort entries row-wise and build row and column offsets
+   void build_index()
+   {
+      std::sort(entries_.begin(), entries_.end(), [](const entry& a, const entry& b) { return std::make_tuple(a.x1, a.x2) < std::make_tuple(b.x1, b.x2); });
+      assert(std::adjacent_find(entries_.begin(), entries_.end(), [](const entry& a, const entry& b) { return a.x1 == b.x1 && a.x2 == b.x2; }) == entries_.end());
+      row_begin_.assign(dim1()+1, 0);
+      col_begin_.assign(dim2()+1, 0);
+      for(const auto& e : entries_) {
+         ++row_begin_[e.x1+1];
+         ++col_begin_[e.x2+1];
+      }
+      max_row_entries_ = *std::max_element(row_begin_.begin(), row_begin_.end());
+      max_col_entries_ = *std::max_element(col_begin_.begin(), col_begin_.end());
+      std::partial_sum(row_begin_.begin(), row_begin_.end(), row_begin_.begin());
+      std::partial_sum(col_begin_.begin(), col_begin_.end(), col_begin_.begin());
+      col_entries_.resize(entries_.size());
+      std::vector<INDEX> pos(col_begin_.begin(), col_begin_.end()-1);
+      for(INDEX k=0; k<entries_.size(); ++k) {
+         col_entries_[pos[entries_[k].x2]++] = k;
+      }
+   }
+
+   // m[x] = msg[x] + min_y (cost(x,y) + other_msg[y]), arg[x] the minimizing y.
+   // For few labels every row is expanded into a dense buffer.
+   // Otherwise labels y not explicitly given for x are candidates only if they are among the max_entries+1 smallest other_msg.
+   template<typename ENTRY, typename OTHER, typename VECTOR>
+   void min_marginal(const vector<REAL>& msg, const vector<REAL>& other_msg, const std::vector<INDEX>& begin, const INDEX max_entries, ENTRY get_entry, OTHER other, VECTOR& m, INDEX* arg) const
+   {
+      if(other_msg.size() <= small_dim) {
+         std::array<REAL,small_dim> base;
+         for(INDEX y=0; y<other_msg.size(); ++y) {
+            base[y] = default_cost_ + other_msg[y];
+         }
+         std::array<REAL,small_dim> row;
+         for(INDEX x=0; x<msg.size(); ++x) {
+            std::copy(base.begin(), base.begin() + other_msg.size(), row.begin());
+            for(INDEX k=begin[x]; k<begin[x+1]; ++k) {
+               const entry& e = get_entry(k);
+               row[other(e)] = e.cost + other_msg[other(e)];
+            }
+            const auto it = std::min_element(row.begin(), row.begin() + other_msg.size());
+            m[x] = msg[x] + *it;
+            if(arg != nullptr) { arg[x] = it - row.begin(); }
+         }
+         return;
+      }
+
+      const INDEX no_candidates = std::min(INDEX(other_msg.size()), max_entries + 1);
+      std::vector<INDEX> order(other_msg.size());
+      std::iota(order.begin(), order.end(), 0);
+      const auto msg_less = [&](const INDEX a, const INDEX b) { return other_msg[a] < other_msg[b]; };
+      if(2*no_candidates >= order.size()) {
+         std::sort(order.begin(), order.end(), msg_less);
+      } else {
+         std::partial_sort(order.begin(), order.begin() + no_candidates, order.end(), msg_less);
+      }
+
+      for(INDEX x=0; x<msg.size(); ++x) {
+         REAL val = std::numeric_limits<REAL>::infinity();
+         INDEX y_min = other_msg.size();
+         for(INDEX k=begin[x]; k<begin[x+1]; ++k) {
+            const entry& e = get_entry(k);
+            const INDEX y = other(e);
+            if(e.cost + other_msg[y] < val) {
+               val = e.cost + other_msg[y];
+               y_min = y;
+            }
+         }
+         const auto is_explicit = [&](const INDEX y) {
+            INDEX lo = begin[x], hi = begin[x+1];
+            while(lo < hi) {
+               const INDEX mid = (lo + hi)/2;
+               if(other(get_entry(mid)) < y) { lo = mid+1; } else { hi = mid; }
+            }
+            return lo < begin[x+1] && other(get_entry(lo)) == y;
+         };
+         for(INDEX c=0; c<no_candidates; ++c) {
+            const INDEX y = order[c];
+            if(!is_explicit(y)) {
+               if(default_cost_ + other_msg[y] < val) {
+                  val = default_cost_ + other_msg[y];
+                  y_min = y;
+               }
+               break;
+            }
+         }
+         m[x] = msg[x] + val;
+         if(arg != nullptr) { arg[x] = y_min; }
+      }
+   }
+
+   vector<REAL> msg1_, msg2_; // in dense mode msg2_ is padded with zeros to stride_
+   INDEX dim2_;
+   REAL default_cost_;
+   // dense mode: rows padded to stride_, padding entries hold infinity
+   INDEX stride_ = 0;
+   std::vector<REAL> dense_;
+   // sparse mode
+   std::vector<entry> entries_; // sorted by (x1,x2)
+   std::vector<INDEX> row_begin_, col_begin_;
+   std::vector<INDEX> col_entries_; // entries sorted by (x2,x1)
+   INDEX max_row_entries_, max_col_entries_;
+   std::array<INDEX,2> primal_;
+
+   static constexpr INDEX small_dim = 16;
+};
+
 } // end namespace LP_MP
 
 #endif // LP_MP_SIMPLEX_FACTOR_HXX
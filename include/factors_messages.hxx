@@ -82,6 +82,8 @@ LP_MP_FUNCTION_EXISTENCE_CLASS(HasCreateConstraints, CreateConstraints)
 LP_MP_FUNCTION_EXISTENCE_CLASS(HasGetNumberOfAuxVariables, GetNumberOfAuxVariables)
 LP_MP_FUNCTION_EXISTENCE_CLASS(HasReduceLp, ReduceLp)
 
+LP_MP_FUNCTION_EXISTENCE_CLASS(has_serialize_primal, serialize_primal)
+
 LP_MP_ASSIGNMENT_FUNCTION_EXISTENCE_CLASS(IsAssignable, operator[])
 }
 
@@ -503,7 +505,7 @@ public:
    }
    void ReceiveMessageFromRightContainer()
    {
-#ifdef LP_MP_PARALLEL
+#ifdef LP_MP_PARALLEL_LOCKING
      auto& mtx = GetRightFactor()->mutex_;
      std::unique_lock<std::recursive_mutex> lck(mtx,std::defer_lock);
      if(lck.try_lock()) 
@@ -531,7 +533,7 @@ public:
    }
    void ReceiveMessageFromLeftContainer()
    { 
-#ifdef LP_MP_PARALLEL
+#ifdef LP_MP_PARALLEL_LOCKING
      auto& mtx = GetLeftFactor()->mutex_;
      std::unique_lock<std::recursive_mutex> lck(mtx,std::defer_lock);
      if(lck.try_lock())
@@ -561,7 +563,7 @@ public:
 
    void SendMessageToRightContainer(LeftFactorType* l, const REAL omega)
    {
-#ifdef LP_MP_PARALLEL
+#ifdef LP_MP_PARALLEL_LOCKING
      auto& mtx = GetRightFactor()->mutex_;
      std::unique_lock<std::recursive_mutex> lck(mtx,std::defer_lock);
      if(lck.try_lock())
@@ -578,7 +580,7 @@ public:
 
    void SendMessageToLeftContainer(RightFactorType* r, const REAL omega)
    {
-#ifdef LP_MP_PARALLEL
+#ifdef LP_MP_PARALLEL_LOCKING
      auto& mtx = GetLeftFactor()->mutex_;
      std::unique_lock<std::recursive_mutex> lck(mtx,std::defer_lock);
      if(lck.try_lock()) 
@@ -598,7 +600,7 @@ public:
    template<Chirality C> class MessageContainerView; // forward declaration. Put MessageIteratorView after definition of MessageContainerView
    template<Chirality CHIRALITY, typename MESSAGE_ITERATOR>
    struct MessageIteratorView {
-#ifdef LP_MP_PARALLEL
+#ifdef LP_MP_PARALLEL_LOCKING
      MessageIteratorView(MESSAGE_ITERATOR it, std::vector<bool>::iterator lock_it) : it_(it), lock_it_(lock_it) {}
 #else
      MessageIteratorView(MESSAGE_ITERATOR it) : it_(it) {} 
@@ -608,7 +610,7 @@ public:
      }
      MessageIteratorView<CHIRALITY,MESSAGE_ITERATOR>& operator++() {
        ++it_;
-#ifdef LP_MP_PARALLEL
+#ifdef LP_MP_PARALLEL_LOCKING
        ++lock_it_;
        while(*lock_it_ == false) { // this will always terminate: the lock_rec has one more entry than there are msgs and last entry is always true
          ++it_;
@@ -625,7 +627,7 @@ public:
      }
      private:
      MESSAGE_ITERATOR it_;
-#ifdef LP_MP_PARALLEL
+#ifdef LP_MP_PARALLEL_LOCKING
      std::vector<bool>::iterator lock_it_;
 #endif
    };
@@ -662,7 +664,7 @@ public:
    template<typename RIGHT_FACTOR, typename MSG_ARRAY, typename ITERATOR>
    static void SendMessagesToLeftContainer(const RIGHT_FACTOR& rightFactor, const MSG_ARRAY& msgs, ITERATOR omegaBegin) 
    {
-#ifdef LP_MP_PARALLEL
+#ifdef LP_MP_PARALLEL_LOCKING
       // record which factors were locked here
       std::vector<bool> lock_rec(msgs.size()+1); // replace with own vector
       lock_rec[msgs.size()] = true;
@@ -710,7 +712,7 @@ public:
    template<typename LEFT_FACTOR, typename MSG_ARRAY, typename ITERATOR>
    static void SendMessagesToRightContainer(const LEFT_FACTOR& leftFactor, const MSG_ARRAY& msgs, ITERATOR omegaBegin) 
    {
-#ifdef LP_MP_PARALLEL
+#ifdef LP_MP_PARALLEL_LOCKING
       // record which factors were locked here
       std::vector<bool> lock_rec(msgs.size()+1); // replace with own vector
       lock_rec[msgs.size()] = true;
@@ -1386,6 +1388,36 @@ public:
       return c;
    }
 
+   // the container and all dual data of the factor, i.e. everything that is serialized by serialize_dual
+   virtual void collect_pages(std::vector<std::uintptr_t>& pages) final
+   {
+      numa::add_pages(pages, this, sizeof(FactorContainerType));
+      numa::page_archive ar(pages);
+      factor_.serialize_dual(ar);
+   }
+
+   // primal is written as well if the factor can serialize it, so that the primal solution last read off survives a restart
+   constexpr static bool can_serialize_primal()
+   {
+      return FunctionExistence::has_serialize_primal<FactorType, void, cereal::BinaryOutputArchive>();
+   }
+
+   virtual void save_checkpoint(cereal::BinaryOutputArchive& ar) final
+   {
+      factor_.serialize_dual(ar);
+      static_if<can_serialize_primal()>([&](auto f) {
+            f(factor_).serialize_primal(ar);
+      });
+   }
+
+   virtual void load_checkpoint(cereal::BinaryInputArchive& ar) final
+   {
+      factor_.serialize_dual(ar);
+      static_if<can_serialize_primal()>([&](auto f) {
+            f(factor_).serialize_primal(ar);
+      });
+   }
+
    template<typename MESSAGE_DISPATCHER_TYPE, typename MESSAGE_TYPE> 
    void AddMessage(MESSAGE_TYPE* m) { 
       constexpr INDEX n = FactorContainerType::FindMessageDispatcherTypeIndex<MESSAGE_DISPATCHER_TYPE>();
@@ -1425,7 +1457,7 @@ public:
    {
       assert(std::accumulate(omega.begin(), omega.end(), 0.0) <= 1.0 + eps);
       assert(std::distance(omega.begin(), omega.end()) == no_send_messages());
-#ifdef LP_MP_PARALLEL
+#ifdef LP_MP_PARALLEL_LOCKING
       std::lock_guard<std::recursive_mutex> lock(mutex_); // only here do we wait for the mutex. In all other places try_lock is allowed only
 #endif
       ReceiveMessages(omega);
@@ -1433,6 +1465,16 @@ public:
       SendMessages(omega);
    }
 
+   // all factors are of type FactorContainerType, hence UpdateFactor can be called directly. Factor containers of one type are allocated consecutively by Allocator.
+   void UpdateFactors(FactorTypeAdapter* const* factors, const INDEX n, REAL* const* omega) final
+   {
+      for(INDEX i=0; i<n; ++i) {
+         assert(dynamic_cast<FactorContainerType*>(factors[i]) != nullptr);
+         if(i+1 < n) { __builtin_prefetch(factors[i+1]); }
+         static_cast<FactorContainerType*>(factors[i])->FactorContainerType::UpdateFactor(weight_vector(omega[i], omega[i+1]));
+      }
+   }
+
    // do zrobienia: possibly also check if method present
    constexpr static bool
    CanComputePrimal()
@@ -1508,7 +1550,7 @@ public:
 
    void UpdateFactorSAT(const weight_vector& omega, const REAL th, sat_var begin, sat_vec<sat_literal>& assumptions) final
    {
-#ifdef LP_MP_PARALLEL
+#ifdef LP_MP_PARALLEL_LOCKING
      std::lock_guard<std::recursive_mutex> lock(mutex_); // only here do we wait for the mutex. In all other places try_lock is allowed only
 #endif
 
@@ -1522,7 +1564,7 @@ public:
 
    void UpdateFactorPrimal(const weight_vector& omega, INDEX primal_access) final
    {
-#ifdef LP_MP_PARALLEL
+#ifdef LP_MP_PARALLEL_LOCKING
      std::lock_guard<std::recursive_mutex> lock(mutex_); // only here do we wait for the mutex. In all other places try_lock is allowed only
 #endif
       assert(primal_access > 0); // otherwise primal is not initialized in first iteration
@@ -2149,7 +2191,7 @@ public:
 
 
    // a recursive mutex is required only for SendMessagesTo{Left|Right}, as multiple messages may be have the same endpoints. Then the corresponding lock is acquired multiple times
-#ifdef LP_MP_PARALLEL
+#ifdef LP_MP_PARALLEL_LOCKING
    std::recursive_mutex mutex_;
 #endif
 };
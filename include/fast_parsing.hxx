@@ -0,0 +1,176 @@
+#ifndef LP_MP_FAST_PARSING_HXX
+#define LP_MP_FAST_PARSING_HXX
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include "config.hxx"
+
+#ifdef LP_MP_PARALLEL
+#include <omp.h>
+#endif
+
+// hand written number parsing on memory ranges for line based text formats, without PEGTL.
+// Input files are memory-mapped (see snapshot::mapped_file) and split at line boundaries, so that chunks can be parsed in parallel.
+// All functions advance the given pointer past what they have read and return false if the input does not match.
+// They are meant as fast paths: on failure the caller should fall back to the validating PEGTL grammar, which reports proper errors.
+
+namespace LP_MP {
+namespace Parsing {
+
+inline INDEX parsing_threads()
+{
+#ifdef LP_MP_PARALLEL
+   return omp_get_max_threads();
+#else
+   return 1;
+#endif
+}
+
+inline bool is_digit(const char c) { return c >= '0' && c <= '9'; }
+inline bool is_blank(const char c) { return c == ' ' || c == '\t'; }
+
+inline void skip_blanks(const char*& p, const char* end)
+{
+   while(p != end && is_blank(*p)) { ++p; }
+}
+
+// at least one blank
+inline bool mand_blanks(const char*& p, const char* end)
+{
+   if(p == end || !is_blank(*p)) { return false; }
+   skip_blanks(p, end);
+   return true;
+}
+
+// only blanks up to the end of the line (the newline itself is not part of [p,end), a carriage return is accepted)
+inline bool at_line_end(const char* p, const char* end)
+{
+   skip_blanks(p, end);
+   return p == end || (*p == '\r' && p+1 == end);
+}
+
+// position after the next newline or end
+inline const char* next_line(const char* p, const char* end)
+{
+   const char* n = static_cast<const char*>(std::memchr(p, '\n', end - p));
+   return n == nullptr ? end : n+1;
+}
+
+// end of the current line, excluding the newline
+inline const char* line_end(const char* p, const char* end)
+{
+   const char* n = static_cast<const char*>(std::memchr(p, '\n', end - p));
+   return n == nullptr ? end : n;
+}
+
+// split [begin,end) into no_chunks ranges of roughly equal size, each boundary lies at the start of a line
+inline std::vector<const char*> split_lines(const char* begin, const char* end, const INDEX no_chunks)
+{
+   assert(no_chunks > 0);
+   std::vector<const char*> boundaries;
+   boundaries.reserve(no_chunks+1);
+   boundaries.push_back(begin);
+   for(INDEX c=1; c<no_chunks; ++c) {
+      const char* p = begin + (end - begin)*c/no_chunks;
+      p = std::max(p, boundaries.back());
+      if(p != begin && *(p-1) != '\n') {
+         p = next_line(p, end);
+      }
+      boundaries.push_back(p);
+   }
+   boundaries.push_back(end);
+   return boundaries;
+}
+
+inline bool parse_index(const char*& p, const char* end, INDEX& x)
+{
+   if(p == end || !is_digit(*p)) { return false; }
+   std::uint64_t v = 0;
+   for(; p != end && is_digit(*p); ++p) {
+      v = 10*v + (*p - '0');
+      if(v > std::numeric_limits<INDEX>::max()) { return false; }
+   }
+   x = v;
+   return true;
+}
+
+// reals as accepted by Parsing::real_number: optional sign, digits with optional fraction, optional exponent, or inf.
+// Mantissas of up to 15 significant digits and small exponents are converted exactly (Clinger's fast path), everything else goes through strtod, hence results agree with stream extraction.
+inline bool parse_real(const char*& p, const char* end, REAL& x)
+{
+   const char* const begin = p;
+   bool negative = false;
+   if(p != end && (*p == '+' || *p == '-')) {
+      negative = *p == '-';
+      ++p;
+   }
+   if(end - p >= 3 && (p[0] == 'i' || p[0] == 'I') && p[1] == 'n' && p[2] == 'f') {
+      p += 3;
+      x = negative ? -std::numeric_limits<REAL>::infinity() : std::numeric_limits<REAL>::infinity();
+      return true;
+   }
+
+   std::uint64_t mantissa = 0;
+   INDEX significant_digits = 0;
+   bool has_digits = false;
+   int exponent = 0;
+   for(; p != end && is_digit(*p); ++p) {
+      has_digits = true;
+      if(significant_digits < 19) {
+         mantissa = 10*mantissa + (*p - '0');
+         if(mantissa != 0) { ++significant_digits; }
+      } else {
+         ++exponent;
+         ++significant_digits;
+      }
+   }
+   if(p != end && *p == '.') {
+      ++p;
+      for(; p != end && is_digit(*p); ++p) {
+         has_digits = true;
+         if(significant_digits < 19) {
+            mantissa = 10*mantissa + (*p - '0');
+            if(mantissa != 0) { ++significant_digits; }
+            --exponent;
+         } else {
+            ++significant_digits;
+         }
+      }
+   }
+   if(!has_digits) { p = begin; return false; }
+   if(p != end && (*p == 'e' || *p == 'E')) {
+      ++p;
+      bool negative_exponent = false;
+      if(p != end && (*p == '+' || *p == '-')) {
+         negative_exponent = *p == '-';
+         ++p;
+      }
+      if(p == end || !is_digit(*p)) { p = begin; return false; }
+      int e = 0;
+      for(; p != end && is_digit(*p); ++p) {
+         if(e < 100000) { e = 10*e + (*p - '0'); }
+      }
+      exponent += negative_exponent ? -e : e;
+   }
+
+   static constexpr double powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+   if(significant_digits <= 15 && exponent >= -22 && exponent <= 22) {
+      double v = double(mantissa);
+      v = exponent < 0 ? v / powers_of_ten[-exponent] : v * powers_of_ten[exponent];
+      x = negative ? -v : v;
+   } else {
+      const std::string s(begin, p);
+      x = std::strtod(s.c_str(), nullptr);
+   }
+   return true;
+}
+
+} // end namespace Parsing
+} // end namespace LP_MP
+
+#endif // LP_MP_FAST_PARSING_HXX
@@ -0,0 +1,167 @@
+#ifndef LP_MP_FLAT_HASH_MAP_HXX
+#define LP_MP_FLAT_HASH_MAP_HXX
+
+#include "config.hxx"
+#include <vector>
+#include <utility>
+#include <functional>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <algorithm>
+
+namespace LP_MP {
+
+// hash map with open addressing and linear probing. Elements are held contiguously in one array, hence lookups touch few cache lines and insertion does not allocate per element.
+// Elements cannot be erased, as is the case for factors held by problem constructors.
+// Iterators and references are invalidated by insertions.
+template<typename KEY, typename VALUE, typename HASH = std::hash<KEY>>
+class flat_hash_map {
+public:
+   using key_type = KEY;
+   using mapped_type = VALUE;
+   using value_type = std::pair<KEY,VALUE>;
+
+   template<bool CONST>
+   class iterator_base {
+      using map_type = typename std::conditional<CONST, const flat_hash_map, flat_hash_map>::type;
+   public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = flat_hash_map::value_type;
+      using difference_type = std::ptrdiff_t;
+      using reference = typename std::conditional<CONST, const value_type&, value_type&>::type;
+      using pointer = typename std::conditional<CONST, const value_type*, value_type*>::type;
+
+      iterator_base(map_type* m, const std::size_t slot) : m_(m), slot_(slot) {}
+      iterator_base(const iterator_base<false>& o) : m_(o.m_), slot_(o.slot_) {}
+
+      reference operator*() const { return m_->slots_[slot_]; }
+      pointer operator->() const { return &m_->slots_[slot_]; }
+      iterator_base& operator++() { slot_ = m_->next_occupied(slot_+1); return *this; }
+      iterator_base operator++(int) { auto it = *this; ++(*this); return it; }
+      bool operator==(const iterator_base& o) const { return slot_ == o.slot_; }
+      bool operator!=(const iterator_base& o) const { return slot_ != o.slot_; }
+
+   private:
+      friend class flat_hash_map;
+      template<bool> friend class iterator_base;
+      map_type* m_;
+      std::size_t slot_;
+   };
+   using iterator = iterator_base<false>;
+   using const_iterator = iterator_base<true>;
+
+   flat_hash_map(const std::size_t expected_size = 0) { reserve(expected_size); }
+
+   std::size_t size() const { return size_; }
+   bool empty() const { return size_ == 0; }
+
+   void reserve(const std::size_t n)
+   {
+      std::size_t capacity = 16;
+      while(capacity * max_load_factor < n) { capacity *= 2; }
+      if(capacity > slots_.size()) {
+         rehash(capacity);
+      }
+   }
+
+   void clear()
+   {
+      std::fill(occupied_.begin(), occupied_.end(), 0);
+      size_ = 0;
+   }
+
+   iterator begin() { return iterator(this, next_occupied(0)); }
+   iterator end() { return iterator(this, slots_.size()); }
+   const_iterator begin() const { return const_iterator(this, next_occupied(0)); }
+   const_iterator end() const { return const_iterator(this, slots_.size()); }
+
+   iterator find(const KEY& key) { return iterator(this, find_slot(key)); }
+   const_iterator find(const KEY& key) const { return const_iterator(this, find_slot(key)); }
+   std::size_t count(const KEY& key) const { return find_slot(key) != slots_.size() ? 1 : 0; }
+
+   // element is not overwritten if key is already present
+   std::pair<iterator,bool> insert(const value_type& v)
+   {
+      if(size_+1 > max_load_factor * slots_.size()) {
+         rehash(std::max(std::size_t(16), 2*slots_.size()));
+      }
+      std::size_t slot = hash_slot(v.first);
+      while(occupied_[slot]) {
+         if(slots_[slot].first == v.first) {
+            return std::make_pair(iterator(this, slot), false);
+         }
+         slot = (slot+1) & (slots_.size()-1);
+      }
+      occupied_[slot] = 1;
+      slots_[slot] = v;
+      ++size_;
+      return std::make_pair(iterator(this, slot), true);
+   }
+
+   VALUE& operator[](const KEY& key) { return insert(std::make_pair(key, VALUE{})).first->second; }
+
+private:
+   static constexpr double max_load_factor = 0.7;
+
+   // hashes of e.g. integers are often the identity, scramble bits so that consecutive keys do not form long probing sequences
+   std::size_t hash_slot(const KEY& key) const
+   {
+      std::uint64_t h = HASH()(key);
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;
+      h *= 0xc4ceb9fe1a85ec53ULL;
+      h ^= h >> 33;
+      return h & (slots_.size()-1);
+   }
+
+   std::size_t find_slot(const KEY& key) const
+   {
+      if(size_ == 0) { return slots_.size(); }
+      std::size_t slot = hash_slot(key);
+      while(occupied_[slot]) {
+         if(slots_[slot].first == key) {
+            return slot;
+         }
+         slot = (slot+1) & (slots_.size()-1);
+      }
+      return slots_.size();
+   }
+
+   std::size_t next_occupied(std::size_t slot) const
+   {
+      while(slot < slots_.size() && !occupied_[slot]) { ++slot; }
+      return slot;
+   }
+
+   void rehash(const std::size_t capacity)
+   {
+      assert((capacity & (capacity-1)) == 0); // power of two
+      std::vector<value_type> slots(capacity);
+      std::vector<unsigned char> occupied(capacity, 0);
+      std::swap(slots, slots_);
+      std::swap(occupied, occupied_);
+      size_ = 0;
+      for(std::size_t s=0; s<slots.size(); ++s) {
+         if(occupied[s]) {
+            insert(slots[s]);
+         }
+      }
+   }
+
+   std::vector<value_type> slots_;
+   std::vector<unsigned char> occupied_;
+   std::size_t size_ = 0;
+};
+
+// node pairs packed into one 64 bit key
+inline std::uint64_t pack_index_pair(const INDEX i, const INDEX j)
+{
+   static_assert(sizeof(INDEX) <= 4, "two indices must fit into 64 bits");
+   return (std::uint64_t(i) << 32) | std::uint64_t(j);
+}
+
+} // end namespace LP_MP
+
+#endif // LP_MP_FLAT_HASH_MAP_HXX
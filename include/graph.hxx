@@ -20,10 +20,10 @@ namespace LP_MP {
 
    };
 
-   bool operator<(const triplet_candidate& l, const triplet_candidate& r) {
+   inline bool operator<(const triplet_candidate& l, const triplet_candidate& r) {
       return l.cost > r.cost;
    }
-   bool operator==(const triplet_candidate& l, const triplet_candidate& r) {
+   inline bool operator==(const triplet_candidate& l, const triplet_candidate& r) {
       return l.i == r.i && l.j == r.j && l.k == r.k;
    }
 
@@ -113,8 +113,108 @@ namespace LP_MP {
          std::vector<arc> arcs_;
    };
 
+   // adjacency index in compressed sparse row format for undirected graphs to which edges are added over time, e.g. by tightening.
+   // Neighbours of every node are sorted, hence common neighbours of two nodes can be enumerated by merging their neighbour lists.
+   // Edges added since the last update() are merged into the existing index in linear time instead of rebuilding it from scratch.
+   class csr_adjacency {
+   public:
+      struct entry {
+         INDEX node; // neighbour
+         INDEX edge; // id of edge to neighbour
+      };
+
+      void add_edge(const INDEX i, const INDEX j, const INDEX edge_id)
+      {
+         assert(i != j);
+         pending_.push_back({i, j, edge_id});
+      }
+
+      bool up_to_date() const { return pending_.empty(); }
+
+      void update()
+      {
+         if(pending_.empty()) { return; }
+
+         // both arcs of each new edge, sorted by tail and then by head
+         std::vector<std::array<INDEX,3>> arcs;
+         arcs.reserve(2*pending_.size());
+         const INDEX old_no_nodes = offsets_.size()-1;
+         INDEX n = old_no_nodes;
+         for(const auto& e : pending_) {
+            arcs.push_back({e[0], e[1], e[2]});
+            arcs.push_back({e[1], e[0], e[2]});
+            n = std::max(n, std::max(e[0], e[1])+1);
+         }
+         std::sort(arcs.begin(), arcs.end());
+
+         std::vector<INDEX> offsets(n+1);
+         std::vector<entry> entries(entries_.size() + arcs.size());
+         auto arc_it = arcs.begin();
+         INDEX pos = 0;
+         for(INDEX i=0; i<n; ++i) {
+            offsets[i] = pos;
+            const entry* old_it = i < old_no_nodes ? neighbors_begin(i) : nullptr;
+            const entry* old_end = i < old_no_nodes ? neighbors_end(i) : nullptr;
+            for(; arc_it != arcs.end() && (*arc_it)[0] == i; ++arc_it) {
+               for(; old_it != old_end && old_it->node < (*arc_it)[1]; ++old_it) {
+                  entries[pos++] = *old_it;
+               }
+               assert(old_it == old_end || old_it->node != (*arc_it)[1]); // no parallel edges
+               entries[pos++] = {(*arc_it)[1], (*arc_it)[2]};
+            }
+            for(; old_it != old_end; ++old_it) {
+               entries[pos++] = *old_it;
+            }
+         }
+         assert(pos == entries.size());
+         offsets[n] = pos;
+
+         std::swap(offsets_, offsets);
+         std::swap(entries_, entries);
+         pending_.clear();
+      }
+
+      INDEX no_nodes() const { assert(up_to_date()); return offsets_.size()-1; }
+      INDEX no_edges() const { assert(up_to_date()); return entries_.size()/2; }
+      INDEX degree(const INDEX i) const { assert(i < no_nodes()); return offsets_[i+1] - offsets_[i]; }
+
+      const entry* neighbors_begin(const INDEX i) const { assert(i < offsets_.size()-1); return entries_.data() + offsets_[i]; }
+      const entry* neighbors_end(const INDEX i) const { assert(i < offsets_.size()-1); return entries_.data() + offsets_[i+1]; }
+
+      // call f(k, edge id of (i,k), edge id of (j,k)) for all common neighbours k >= first_node of i and j in ascending order
+      template<typename FUNC>
+      void for_each_common_neighbor(const INDEX i, const INDEX j, FUNC f, const INDEX first_node = 0) const
+      {
+         assert(up_to_date());
+         auto node_comp = [](const entry& a, const INDEX k) { return a.node < k; };
+         const entry* it_i = std::lower_bound(neighbors_begin(i), neighbors_end(i), first_node, node_comp);
+         const entry* it_j = std::lower_bound(neighbors_begin(j), neighbors_end(j), first_node, node_comp);
+         const entry* end_i = neighbors_end(i);
+         const entry* end_j = neighbors_end(j);
+         while(it_i != end_i && it_j != end_j) {
+            if(it_i->node < it_j->node) {
+               ++it_i;
+            } else if(it_j->node < it_i->node) {
+               ++it_j;
+            } else {
+               f(it_i->node, it_i->edge, it_j->edge);
+               ++it_i;
+               ++it_j;
+            }
+         }
+      }
+
+   private:
+      std::vector<INDEX> offsets_ = {0}; // neighbours of node i are entries_[offsets_[i]], ..., entries_[offsets_[i+1]-1]
+      std::vector<entry> entries_;
+      std::vector<std::array<INDEX,3>> pending_; // edges not yet in index
+   };
+
+   // breadth first search for paths in thresholded graphs, e.g. for cycle separation.
+   // Searches from both end points simultaneously, always expanding the smaller frontier by one level.
+   // Nodes are marked with stamps which are incremented with every search, hence no per-query clearing is needed.
    struct BfsData {
-      struct Item { INDEX parent; REAL cost; INDEX flag; };
+      struct Item { REAL cost; INDEX parent; INDEX flag; INDEX distance; };
       BfsData(const Graph& g) 
       {
          d.resize(g.size());
@@ -126,9 +226,13 @@ namespace LP_MP {
       }
       void Reset() 
       {
-         visit.clear();
-	      flag1 += 2;
-	      flag2 += 2; 
+         if(flag2 >= std::numeric_limits<INDEX>::max()-2) { // stamps wrap around, clear them once
+            for(auto& item : d) { item.flag = 0; }
+            flag1 = 0;
+            flag2 = 1;
+         }
+         flag1 += 2;
+         flag2 += 2; 
       }
       Item& operator[](const INDEX i) { return d[i]; }
 
@@ -142,27 +246,17 @@ namespace LP_MP {
       INDEX Parent(const INDEX i) const { return d[i].parent; }
       REAL& Cost(const INDEX i) { return d[i].cost; }
       REAL Cost(const INDEX i) const { return d[i].cost; }
+      INDEX& Distance(const INDEX i) { return d[i].distance; }
+      INDEX Distance(const INDEX i) const { return d[i].distance; }
 
+      // path from root of i1 to i1, then over arc (i1,i2) with cost cost_i1i2 and from i2 to its root. Cost of path is its minimum arc cost
       std::tuple<REAL,std::vector<INDEX>> TracePath(const INDEX i1, const INDEX i2, const REAL cost_i1i2) const 
       {
-         REAL c = cost_i1i2;
-	      std::vector<INDEX> path({i1});
-	      INDEX j=i1;
-	      while(Parent(j) != j) {
-            c = std::min(c, Cost(j) );
-		      j = Parent(j);
-		      path.push_back(j);
-	      }
+         std::vector<INDEX> path;
+         REAL c = std::min(cost_i1i2, trace_to_root(i1, path));
          std::reverse(path.begin(),path.end());
-         path.push_back(i2);
-         j=i2;
-         while(Parent(j) != j) {
-            c = std::min(c, Cost(j) );
-		      j = Parent(j);
-		      path.push_back(j);
-         }
-
-	      return std::move(std::make_tuple(c,std::move(path)));
+         c = std::min(c, trace_to_root(i2, path));
+         return std::make_tuple(c,std::move(path));
       }
 
       //static auto no_mask_op = [](const INDEX i, const INDEX j, const REAL weight) { return true; };
@@ -175,6 +269,7 @@ namespace LP_MP {
          return FindPath(startNode, endNode, g, th, no_mask_op);
       }
 
+      // shortest path w.r.t. number of arcs from startNode to endNode
       template<typename MASK_OP>
       std::tuple<REAL,std::vector<INDEX>> 
       FindPath(
@@ -183,70 +278,138 @@ namespace LP_MP {
          )
       {
          Reset();
-         visit.push_back({startNode, 0});
+         frontier1.clear();
+         frontier2.clear();
+         init_root(startNode, frontier1);
          Label1(startNode);
-         Parent(startNode) = startNode;
-         Cost(startNode) = std::numeric_limits<REAL>::infinity();
-         visit.push_back({endNode, 0});
+         init_root(endNode, frontier2);
          Label2(endNode);
-         Parent(endNode) = endNode;
-         Cost(endNode) = std::numeric_limits<REAL>::infinity();
-
-         while(!visit.empty()) {
-            const INDEX i = visit.front()[0];
-            const INDEX distance = visit.front()[1];
-            visit.pop_front();
 
+         while(!frontier1.empty() && !frontier2.empty()) {
+            // best meeting arc found in current level: tail and head node in search from startNode resp. endNode, cost and length of path
+            std::array<INDEX,2> meeting = {std::numeric_limits<INDEX>::max(), std::numeric_limits<INDEX>::max()};
+            REAL meeting_cost = std::numeric_limits<REAL>::infinity();
+            INDEX meeting_length = std::numeric_limits<INDEX>::max();
+            if(frontier1.size() <= frontier2.size()) {
+               expand_level(g, th, mask_op, frontier1, true, false, [&](const INDEX i, const INDEX j, const REAL cost) {
+                  if(Distance(i) + 1 + Distance(j) < meeting_length) {
+                     meeting = {i,j};
+                     meeting_cost = cost;
+                     meeting_length = Distance(i) + 1 + Distance(j);
+                  }
+               });
+            } else {
+               expand_level(g, th, mask_op, frontier2, false, false, [&](const INDEX i, const INDEX j, const REAL cost) {
+                  if(Distance(i) + 1 + Distance(j) < meeting_length) {
+                     meeting = {j,i};
+                     meeting_cost = cost;
+                     meeting_length = Distance(i) + 1 + Distance(j);
+                  }
+               });
+            }
+            if(meeting_length < std::numeric_limits<INDEX>::max()) {
+               assert(meeting[0] < d.size() && meeting[1] < d.size()); // meeting arc was found
+               return TracePath(meeting[0], meeting[1], meeting_cost);
+            }
+         }
+         return std::make_tuple(-std::numeric_limits<REAL>::infinity(),std::vector<INDEX>(0));
+      }
 
-            if(Labelled1(i)) {
-               for(auto* a=g[i].begin(); a->cost>=th && a!=g[i].end(); ++a) { 
-                  auto* head = a->head;
-                  const INDEX j = g[head];
+      // shortest paths from startNode to each of endNodes with one search, stopping when all end nodes are reached.
+      // Returned paths correspond to endNodes and are empty for unreachable end nodes.
+      std::vector<std::tuple<REAL,std::vector<INDEX>>> FindPaths(const INDEX startNode, const std::vector<INDEX>& endNodes, const Graph& g, const REAL th = 0.0)
+      {
+         return FindPaths(startNode, endNodes, g, th, no_mask_op);
+      }
 
-                  if(mask_op(i,j,a->cost)) {
+      template<typename MASK_OP>
+      std::vector<std::tuple<REAL,std::vector<INDEX>>>
+      FindPaths(
+         const INDEX startNode, const std::vector<INDEX>& endNodes, const Graph& g, const REAL th,
+         MASK_OP mask_op
+         )
+      {
+         Reset();
+         // end nodes not yet reached carry label 2
+         INDEX no_unreached = 0;
+         for(const INDEX j : endNodes) {
+            if(j != startNode && !Labelled2(j)) {
+               Label2(j);
+               ++no_unreached;
+            }
+         }
+         frontier1.clear();
+         init_root(startNode, frontier1);
+         Label1(startNode);
 
-                     if(!Labelled(j)) {
-                        visit.push_back({j, distance+1});
-                        Parent(j) = i;
-                        Cost(j) = a->cost;
-                        Label1(j);
-                     } else if(Labelled2(j)) { // shortest path found
-                        // trace back path from j to endNode and from i to startNode
-                        return std::move(TracePath(i,j, a->cost));
-                     }
+         while(!frontier1.empty() && no_unreached > 0) {
+            expand_level(g, th, mask_op, frontier1, true, true, [&](const INDEX, const INDEX, const REAL) { --no_unreached; });
+         }
 
-                  }
-               }
+         std::vector<std::tuple<REAL,std::vector<INDEX>>> paths;
+         paths.reserve(endNodes.size());
+         for(const INDEX j : endNodes) {
+            if(Labelled1(j) && j != startNode) {
+               std::vector<INDEX> path;
+               const REAL c = trace_to_root(j, path);
+               std::reverse(path.begin(), path.end());
+               paths.push_back(std::make_tuple(c, std::move(path)));
             } else {
-               assert(Labelled2(i));
-               for(auto* a=g[i].begin(); a->cost>=th && a!=g[i].end(); ++a) { 
-                  auto* head = a->head;
-                  const INDEX j = g[head];
-
-                  if(mask_op(i,j,a->cost)) {
-
-                     if(!Labelled(j)) {
-                        visit.push_back({j, distance+1});
-                        Parent(j) = i;
-                        Cost(j) = a->cost;
-                        Label2(j);
-                     } else if(Labelled1(j)) { // shortest path found
-                        // trace back path from j to endNode and from i to startNode
-                        return std::move(TracePath(i,j, a->cost));
-                     }
-
-                  }
-               }
+               paths.push_back(std::make_tuple(-std::numeric_limits<REAL>::infinity(),std::vector<INDEX>(0)));
             }
-
-            
          }
-         return std::make_tuple(-std::numeric_limits<REAL>::infinity(),std::vector<INDEX>(0));
+         return paths;
       }
 
 private:
+   void init_root(const INDEX i, std::vector<INDEX>& frontier)
+   {
+      Parent(i) = i;
+      Cost(i) = std::numeric_limits<REAL>::infinity();
+      Distance(i) = 0;
+      frontier.push_back(i);
+   }
+
+   // append path from i to root of its search tree, return its minimum arc cost
+   REAL trace_to_root(INDEX i, std::vector<INDEX>& path) const
+   {
+      REAL c = std::numeric_limits<REAL>::infinity();
+      path.push_back(i);
+      while(Parent(i) != i) {
+         c = std::min(c, Cost(i));
+         i = Parent(i);
+         path.push_back(i);
+      }
+      return c;
+   }
+
+   // replace frontier by all nodes reachable over one arc with cost >= th which are not yet labelled by the search.
+   // Arcs to nodes labelled by the other search are passed to meet_op. Such nodes are taken over when take_over_other is set.
+   template<typename MASK_OP, typename MEET_OP>
+   void expand_level(const Graph& g, const REAL th, MASK_OP mask_op, std::vector<INDEX>& frontier, const bool first_search, const bool take_over_other, MEET_OP meet_op)
+   {
+      next_frontier.clear();
+      for(const INDEX i : frontier) {
+         for(auto* a=g[i].begin(); a!=g[i].end() && a->cost>=th; ++a) { 
+            const INDEX j = g[a->head];
+            if(!mask_op(i,j,a->cost)) { continue; }
+            if(first_search ? Labelled1(j) : Labelled2(j)) { continue; }
+            if(Labelled(j)) {
+               meet_op(i, j, a->cost);
+               if(!take_over_other) { continue; }
+            }
+            Parent(j) = i;
+            Cost(j) = a->cost;
+            Distance(j) = Distance(i) + 1;
+            if(first_search) { Label1(j); } else { Label2(j); }
+            next_frontier.push_back(j);
+         }
+      }
+      std::swap(frontier, next_frontier);
+   }
+
    std::vector<Item> d;
-   std::deque<std::array<INDEX,2>> visit; // node number, distance from start or end 
+   std::vector<INDEX> frontier1, frontier2, next_frontier;
    INDEX flag1, flag2;
 };
 
@@ -0,0 +1,181 @@
+#ifndef LP_MP_HDF5_STREAM_HXX
+#define LP_MP_HDF5_STREAM_HXX
+
+#include "config.hxx"
+#include "hdf5.h"
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <future>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+
+namespace LP_MP {
+
+   template<typename T> hid_t hdf5_native_type();
+   template<> inline hid_t hdf5_native_type<float>() { return H5T_NATIVE_FLOAT; }
+   template<> inline hid_t hdf5_native_type<double>() { return H5T_NATIVE_DOUBLE; }
+   template<> inline hid_t hdf5_native_type<unsigned int>() { return H5T_NATIVE_UINT; }
+   template<> inline hid_t hdf5_native_type<unsigned long>() { return H5T_NATIVE_ULONG; }
+   template<> inline hid_t hdf5_native_type<unsigned long long>() { return H5T_NATIVE_ULLONG; }
+
+   // HDF5 is usually not built thread safe. All calls from streams are serialized, the caller must not access HDF5 concurrently to a stream reading ahead.
+   inline std::mutex& hdf5_mutex()
+   {
+      static std::mutex m;
+      return m;
+   }
+
+   // owns an HDF5 identifier and closes it with the matching close function, also when an exception is thrown.
+   // Closing does not lock hdf5_mutex(), owners which share HDF5 with streams reading ahead must lock it themselves.
+   class hdf5_handle {
+   public:
+      hdf5_handle(const hid_t id, herr_t (*close)(hid_t)) : id_(id), close_(close) {}
+      hdf5_handle(const hdf5_handle&) = delete;
+      hdf5_handle& operator=(const hdf5_handle&) = delete;
+      ~hdf5_handle() { reset(); }
+
+      // close the held identifier and take over id
+      void reset(const hid_t id = -1)
+      {
+         if(id_ >= 0) {
+            close_(id_);
+         }
+         id_ = id;
+      }
+      // give up ownership without closing
+      hid_t release()
+      {
+         const hid_t id = id_;
+         id_ = -1;
+         return id;
+      }
+
+      bool valid() const { return id_ >= 0; }
+      operator hid_t() const { return id_; }
+
+   private:
+      hid_t id_;
+      herr_t (*close_)(hid_t);
+   };
+
+   // reads a dataset block by block along its last dimension, so that arbitrarily large datasets can be processed in bounded memory.
+   // A block holds all leading rows for a range of columns, stored row-major: e.g. for a 2 x n dataset of edges, the first endpoints of the block's edges followed by the second ones.
+   // With read_ahead, the next block is read by a background thread while the current one is processed.
+   // Values are converted by HDF5 into T.
+   template<typename T>
+   class hdf5_stream {
+   public:
+      hdf5_stream(const hid_t parent, const std::string& dataset_name, const std::size_t block_columns, const bool read_ahead = false)
+         : dataset_(-1, H5Dclose),
+         filespace_(-1, H5Sclose),
+         block_columns_(std::max(std::size_t(1), block_columns)),
+         read_ahead_(read_ahead)
+      {
+         std::lock_guard<std::mutex> lock(hdf5_mutex());
+         hdf5_handle dataset(H5Dopen(parent, dataset_name.c_str(), H5P_DEFAULT), H5Dclose);
+         if(!dataset.valid()) {
+            throw std::runtime_error("cannot open dataset " + dataset_name);
+         }
+         hdf5_handle filespace(H5Dget_space(dataset), H5Sclose);
+         const int dimension = filespace.valid() ? H5Sget_simple_extent_ndims(filespace) : -1;
+         if(dimension < 1) {
+            throw std::runtime_error("dataset " + dataset_name + " is not an array");
+         }
+         shape_.resize(dimension);
+         H5Sget_simple_extent_dims(filespace, shape_.data(), NULL);
+         dataset_.reset(dataset.release());
+         filespace_.reset(filespace.release());
+         rows_ = 1;
+         for(int d=0; d+1<dimension; ++d) {
+            rows_ *= shape_[d];
+         }
+      }
+
+      hdf5_stream(const hdf5_stream&) = delete;
+      hdf5_stream& operator=(const hdf5_stream&) = delete;
+
+      ~hdf5_stream()
+      {
+         if(pending_.valid()) {
+            pending_.wait();
+         }
+         std::lock_guard<std::mutex> lock(hdf5_mutex());
+         filespace_.reset();
+         dataset_.reset();
+      }
+
+      const std::vector<hsize_t>& shape() const { return shape_; }
+      std::size_t rows() const { return rows_; } // product of all but the last dimension
+      std::size_t columns() const { return shape_.back(); }
+
+      // block holds rows() x n values of the next n columns, n is returned and is zero at the end of the dataset.
+      std::size_t next(std::vector<T>& block)
+      {
+         std::size_t n;
+         if(pending_.valid()) {
+            n = pending_.get();
+            std::swap(block, ahead_);
+         } else {
+            n = read(next_column_, block);
+         }
+         next_column_ += n;
+         if(read_ahead_ && next_column_ < columns()) {
+            const std::size_t first_column = next_column_;
+            pending_ = std::async(std::launch::async, [this,first_column]() { return read(first_column, ahead_); });
+         }
+         return n;
+      }
+
+      // start again with the first block
+      void rewind()
+      {
+         if(pending_.valid()) {
+            pending_.get();
+         }
+         next_column_ = 0;
+      }
+
+   private:
+      std::size_t read(const std::size_t first_column, std::vector<T>& block)
+      {
+         const std::size_t n = std::min(block_columns_, columns() - first_column);
+         block.resize(rows_ * n);
+         if(n == 0) { return 0; }
+
+         std::lock_guard<std::mutex> lock(hdf5_mutex());
+         std::vector<hsize_t> offset(shape_.size(), 0);
+         std::vector<hsize_t> count(shape_);
+         offset.back() = first_column;
+         count.back() = n;
+         herr_t status = H5Sselect_hyperslab(filespace_, H5S_SELECT_SET, offset.data(), NULL, count.data(), NULL);
+         hdf5_handle memspace(H5Screate_simple(count.size(), count.data(), NULL), H5Sclose);
+         if(status >= 0 && memspace.valid()) {
+            status = H5Dread(dataset_, hdf5_native_type<T>(), memspace, filespace_, H5P_DEFAULT, block.data());
+         } else {
+            status = -1;
+         }
+         memspace.reset();
+         if(status < 0) {
+            throw std::runtime_error("reading dataset block failed");
+         }
+         return n;
+      }
+
+      hdf5_handle dataset_;
+      hdf5_handle filespace_;
+      std::vector<hsize_t> shape_;
+      std::size_t rows_;
+      const std::size_t block_columns_;
+      const bool read_ahead_;
+
+      std::size_t next_column_ = 0;
+      std::vector<T> ahead_;
+      std::future<std::size_t> pending_;
+   };
+
+} // end namespace LP_MP
+
+#endif // LP_MP_HDF5_STREAM_HXX
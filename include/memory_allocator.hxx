@@ -749,6 +749,7 @@ std::array<block_allocator<REAL>, no_stack_allocators> make_block_allocator_arra
 
 static std::array<block_allocator<REAL>, no_stack_allocators> global_real_block_allocator_array ( make_block_allocator_array(global_real_block_arena_array, std::make_integer_sequence<size_t,no_stack_allocators>{} ) ) ;
 
+// arena used by the current thread. Set by LP_concurrent: either one arena per thread or, with NUMA placement, one arena per node shared by all threads of that node.
 static thread_local INDEX stack_allocator_index = 0;
 // do zrobienia: both above allocators do not destroy their arenas
 } // end namespace LP_MP
@@ -0,0 +1,205 @@
+#ifndef LP_MP_NUMA_HXX
+#define LP_MP_NUMA_HXX
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include "config.hxx"
+#include "cereal/cereal.hpp"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+// NUMA support without dependency on libnuma: the topology is read from sysfs, threads are pinned with pthread_setaffinity_np and pages are migrated with the move_pages system call.
+// On other systems or when sysfs is not available a single node is assumed and all operations do nothing.
+
+namespace LP_MP {
+
+namespace numa {
+
+// parse lists like "0-3,8-11" as used in sysfs
+inline std::vector<INDEX> parse_list(const std::string& s)
+{
+   std::vector<INDEX> l;
+   std::stringstream ss(s);
+   std::string range;
+   while(std::getline(ss, range, ',')) {
+      range.erase(std::remove_if(range.begin(), range.end(), [](const char c) { return std::isspace(c); }), range.end());
+      if(range.empty()) { continue; }
+      const auto dash = range.find('-');
+      const INDEX first = std::stoul(range.substr(0, dash));
+      const INDEX last = dash == std::string::npos ? first : std::stoul(range.substr(dash+1));
+      for(INDEX i=first; i<=last; ++i) {
+         l.push_back(i);
+      }
+   }
+   return l;
+}
+
+class topology {
+public:
+   static const topology& get()
+   {
+      static const topology t;
+      return t;
+   }
+
+   INDEX no_nodes() const { return nodes_.size(); }
+   // nodes are numbered consecutively, node_id is the number the operating system uses
+   int node_id(const INDEX node) const { assert(node < no_nodes()); return nodes_[node]; }
+   const std::vector<INDEX>& cpus(const INDEX node) const { assert(node < no_nodes()); return cpus_[node]; }
+
+private:
+   topology()
+   {
+#ifdef __linux__
+      const std::string sysfs_node = "/sys/devices/system/node/";
+      std::ifstream online(sysfs_node + "online");
+      std::string line;
+      if(online && std::getline(online, line)) {
+         for(const INDEX n : parse_list(line)) {
+            std::ifstream cpulist(sysfs_node + "node" + std::to_string(n) + "/cpulist");
+            std::string cpus;
+            if(cpulist && std::getline(cpulist, cpus) && !parse_list(cpus).empty()) { // memory-only nodes are skipped
+               nodes_.push_back(n);
+               cpus_.push_back(parse_list(cpus));
+            }
+         }
+      }
+#endif
+      if(nodes_.empty()) {
+         nodes_.push_back(0);
+         cpus_.push_back({});
+      }
+   }
+
+   std::vector<int> nodes_;
+   std::vector<std::vector<INDEX>> cpus_;
+};
+
+// restrict the calling thread to the cpus of the given node
+inline bool pin_current_thread(const INDEX node)
+{
+#ifdef __linux__
+   const auto& cpus = topology::get().cpus(node);
+   if(cpus.empty()) { return false; }
+   cpu_set_t set;
+   CPU_ZERO(&set);
+   for(const INDEX c : cpus) {
+      CPU_SET(c, &set);
+   }
+   return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set) == 0;
+#else
+   return false;
+#endif
+}
+
+inline std::uintptr_t page_size()
+{
+#ifdef __linux__
+   static const std::uintptr_t s = sysconf(_SC_PAGESIZE);
+   return s;
+#else
+   return 4096;
+#endif
+}
+
+// append start addresses of all pages overlapping [data, data+size) to pages
+inline void add_pages(std::vector<std::uintptr_t>& pages, const void* data, const std::size_t size)
+{
+   if(size == 0) { return; }
+   const std::uintptr_t mask = ~(page_size()-1);
+   const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(data) & mask;
+   const std::uintptr_t last = (reinterpret_cast<std::uintptr_t>(data) + size - 1) & mask;
+   for(std::uintptr_t p=first; p<=last; p+=page_size()) {
+      if(pages.empty() || pages.back() != p) {
+         pages.push_back(p);
+      }
+   }
+}
+
+// move pages[i] to node[i]. Pages that cannot be moved are left where they are.
+// Returns number of pages that reside on the requested node afterwards.
+inline INDEX move_pages(const std::vector<std::uintptr_t>& pages, const std::vector<INDEX>& nodes)
+{
+   assert(pages.size() == nodes.size());
+#if defined(__linux__) && defined(SYS_move_pages)
+   if(pages.empty() || topology::get().no_nodes() == 1) { return 0; }
+   constexpr int mpol_mf_move = 1 << 1; // MPOL_MF_MOVE from numaif.h: move pages owned by this process only
+   std::vector<void*> p(pages.size());
+   std::vector<int> n(pages.size());
+   std::vector<int> status(pages.size(), -1);
+   for(INDEX i=0; i<pages.size(); ++i) {
+      p[i] = reinterpret_cast<void*>(pages[i]);
+      n[i] = topology::get().node_id(nodes[i]);
+   }
+   if(syscall(SYS_move_pages, 0, p.size(), p.data(), n.data(), status.data(), mpol_mf_move) < 0) {
+      return 0;
+   }
+   INDEX moved = 0;
+   for(INDEX i=0; i<status.size(); ++i) {
+      if(status[i] == n[i]) { ++moved; }
+   }
+   return moved;
+#else
+   return 0;
+#endif
+}
+
+// output archive that does not write anything but collects the pages holding the serialized data.
+// Used with serialize_dual of factors to find the memory that is accessed when updating a factor.
+class page_archive : public cereal::OutputArchive<page_archive, cereal::AllowEmptyClassElision>
+{
+public:
+   page_archive(std::vector<std::uintptr_t>& pages)
+      : cereal::OutputArchive<page_archive, cereal::AllowEmptyClassElision>(this),
+      pages_(pages)
+   {}
+
+   void saveBinary(const void* data, const std::size_t size) { add_pages(pages_, data, size); }
+
+private:
+   std::vector<std::uintptr_t>& pages_;
+};
+
+template<class T> inline
+typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+CEREAL_SAVE_FUNCTION_NAME(page_archive& ar, const T& t)
+{
+   ar.saveBinary(std::addressof(t), sizeof(t));
+}
+
+template<class T> inline
+void CEREAL_SERIALIZE_FUNCTION_NAME(page_archive& ar, cereal::NameValuePair<T>& t)
+{
+   ar(t.value);
+}
+
+template<class T> inline
+void CEREAL_SERIALIZE_FUNCTION_NAME(page_archive& ar, cereal::SizeTag<T>& t)
+{
+   ar(t.size);
+}
+
+template<class T> inline
+void CEREAL_SAVE_FUNCTION_NAME(page_archive& ar, const cereal::BinaryData<T>& bd)
+{
+   ar.saveBinary(bd.data, static_cast<std::size_t>(bd.size));
+}
+
+} // end namespace numa
+
+} // end namespace LP_MP
+
+CEREAL_REGISTER_ARCHIVE(LP_MP::numa::page_archive)
+
+#endif // LP_MP_NUMA_HXX
@@ -2,11 +2,14 @@
 #define LP_MP_MRF_PROBLEM_CONSTRUCTION_HXX
 
 #include "solver.hxx"
+#include "factors/simplex_factor.hxx"
 #include "cycle_inequalities.hxx"
 #include "parse_rules.h"
 #include "pegtl/parse.hh"
 
 #include <string>
+#include <unordered_map>
+#include <algorithm>
 
 namespace LP_MP {
 
@@ -315,6 +318,27 @@ public:
 
    void SetGraph(const std::vector<std::vector<INDEX>> graph) { graph_ = graph; }
 
+   using MRF_PROBLEM_CONSTRUCTOR::AddPairwiseFactor;
+   // infinities are put into the sparse cost before the factor is built, inserting them into a sparse factor one by one would rebuild its index every time
+   auto* AddPairwiseFactor(const INDEX i1, const INDEX i2, pairwise_sparse_cost cost)
+   {
+      if(i1 < graph_.size() && i2 < graph_.size()) {
+         std::unordered_map<INDEX,INDEX> label_to_x2;
+         for(INDEX x2=0; x2<graph_[i2].size(); ++x2) {
+            label_to_x2.insert(std::make_pair(graph_[i2][x2], x2));
+         }
+         auto conflict = [&](const INDEX x1, const INDEX x2) { return x1 < graph_[i1].size() && x2 < graph_[i2].size() && graph_[i1][x1] == graph_[i2][x2]; };
+         cost.entries.erase(std::remove_if(cost.entries.begin(), cost.entries.end(), [&](const auto& e) { return conflict(std::get<0>(e), std::get<1>(e)); }), cost.entries.end());
+         for(INDEX x1=0; x1<graph_[i1].size(); ++x1) {
+            auto it = label_to_x2.find(graph_[i1][x1]);
+            if(it != label_to_x2.end()) {
+               cost.entries.push_back(std::make_tuple(x1, it->second, std::numeric_limits<REAL>::infinity()));
+            }
+         }
+      }
+      return MRF_PROBLEM_CONSTRUCTOR::AddPairwiseFactor(i1, i2, cost);
+   }
+
    virtual void ConstructPairwiseFactor(PairwiseFactorType& p, const INDEX i1, const INDEX i2) 
    { 
       assert(i1 < graph_.size()+1 && i2 < graph_.size()+1);
@@ -480,12 +504,24 @@ public:
 
          const INDEX tripletSize = this->GetNumberOfLabels(var1) *  this->GetNumberOfLabels(var2) * this->GetNumberOfLabels(var3);
          AddTripletFactor(var1,var2,var3, std::vector<REAL>(tripletSize,0.0));
+         tightening_log_.record(0, {INDEX(var1), INDEX(var2), INDEX(var3)});
          return true;
       } else {
          return false;
       }
    }
 
+   // triplets added by tightening, such that they can be restored from checkpoints
+   checkpoint::tightening_log& tightening_log() { return tightening_log_; }
+
+   void replay_tightening(const INDEX kind, const INDEX* begin, const INDEX* end)
+   {
+      if(kind != 0 || end - begin != 3) {
+         throw std::runtime_error("tightening log has unknown factor kind " + std::to_string(kind));
+      }
+      AddTighteningTriplet(begin[0], begin[1], begin[2]);
+   }
+
    INDEX add_triplets(const std::vector<triplet_candidate>& tc, const INDEX max_triplets_to_add = std::numeric_limits<INDEX>::max())
    {
       INDEX no_triplets_added = 0;
@@ -576,6 +612,7 @@ protected:
    std::vector<TripletFactorContainer*> tripletFactor_;
    std::vector<std::tuple<INDEX,INDEX,INDEX>> tripletIndices_;
    std::map<std::tuple<INDEX,INDEX,INDEX>, INDEX> tripletMap_; // given two sorted indices, return factorId belonging to that index.
+   checkpoint::tightening_log tightening_log_;
 };
 
 
@@ -594,6 +631,9 @@ namespace UaiMrfInput {
       std::vector<INDEX> cardinality_;
       std::vector<std::vector<INDEX>> clique_scopes_;
       std::vector<std::vector<REAL>> function_tables_;
+
+      template<class ARCHIVE>
+      void serialize(ARCHIVE& ar) { ar(number_of_variables_, number_of_cliques_, cardinality_, clique_scopes_, function_tables_); }
    };
 
    // import basic parsers
@@ -800,10 +840,12 @@ namespace UaiMrfInput {
    template<typename SOLVER>
    bool ParseProblem(const std::string& filename, SOLVER& s)
    {
-      std::cout << "parsing " << filename << "\n";
-      pegtl::file_parser problem(filename);
       MrfInput input;
-      bool read_suc = problem.parse< grammar, action >(input);
+      const bool read_suc = snapshot::read_or_parse(filename, "uai", s, input, [](const std::string& filename, MrfInput& input) {
+         std::cout << "parsing " << filename << "\n";
+         pegtl::file_parser problem(filename);
+         return problem.parse< grammar, action >(input);
+      });
       if(read_suc) {
          auto& mrf_constructor = s.template GetProblemConstructor<0>();
          build_mrf(mrf_constructor, input);
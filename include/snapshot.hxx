@@ -0,0 +1,165 @@
+#ifndef LP_MP_SNAPSHOT_HXX
+#define LP_MP_SNAPSHOT_HXX
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <streambuf>
+#include <istream>
+#include <iostream>
+#include <iterator>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include "config.hxx"
+#include "cereal/archives/binary.hpp"
+#include "cereal/types/vector.hpp"
+#include "cereal/types/string.hpp"
+#include "cereal/types/tuple.hpp"
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Binary snapshots of parsed problem input.
+// Parsing text input dominates start-up time on big instances. Input functions can write the structure they parsed into a snapshot and read it back instead of parsing on later runs.
+// Only the input is stored, not the constructed factor graph: problem constructors build factors and messages from it as from parsed text, and orderings and weights are computed in Begin as usual.
+// The snapshot is memory-mapped, hence function tables are copied directly out of the page cache.
+// Layout: 8 byte magic, then a cereal binary archive holding version, sizeof(REAL), sizeof(INDEX), format name and the input structure.
+
+namespace LP_MP {
+
+namespace snapshot {
+
+constexpr char magic[8] = {'L','P','M','P','S','N','A','P'};
+constexpr std::uint32_t version = 1;
+
+// read-only mapping of a whole file
+class mapped_file {
+public:
+   mapped_file(const std::string& filename)
+   {
+#if defined(__unix__) || defined(__APPLE__)
+      const int fd = open(filename.c_str(), O_RDONLY);
+      if(fd < 0) { throw std::runtime_error("could not open file " + filename); }
+      struct stat s;
+      if(fstat(fd, &s) != 0) { close(fd); throw std::runtime_error("could not stat file " + filename); }
+      size_ = s.st_size;
+      if(size_ > 0) {
+         void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+         if(p == MAP_FAILED) { close(fd); throw std::runtime_error("could not map file " + filename); }
+         madvise(p, size_, MADV_SEQUENTIAL);
+         data_ = static_cast<const char*>(p);
+      }
+      close(fd);
+#else
+      std::ifstream f(filename, std::ios::binary);
+      if(!f) { throw std::runtime_error("could not open file " + filename); }
+      buffer_.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+      data_ = buffer_.data();
+      size_ = buffer_.size();
+#endif
+   }
+   ~mapped_file()
+   {
+#if defined(__unix__) || defined(__APPLE__)
+      if(data_ != nullptr) { munmap(const_cast<char*>(data_), size_); }
+#endif
+   }
+   mapped_file(const mapped_file&) = delete;
+   mapped_file& operator=(const mapped_file&) = delete;
+
+   const char* data() const { return data_; }
+   std::size_t size() const { return size_; }
+
+private:
+   const char* data_ = nullptr;
+   std::size_t size_ = 0;
+#if !(defined(__unix__) || defined(__APPLE__))
+   std::vector<char> buffer_;
+#endif
+};
+
+// input stream buffer over a memory range. Bulk reads (cereal reads arithmetic vectors at once) are a single memcpy.
+class memory_streambuf : public std::streambuf {
+public:
+   memory_streambuf(const char* begin, const char* end)
+   {
+      setg(const_cast<char*>(begin), const_cast<char*>(begin), const_cast<char*>(end));
+   }
+protected:
+   std::streamsize xsgetn(char* s, std::streamsize n) override
+   {
+      n = std::min(n, std::streamsize(egptr() - gptr()));
+      std::memcpy(s, gptr(), n);
+      setg(eback(), gptr() + n, egptr());
+      return n;
+   }
+};
+
+inline bool is_snapshot(const std::string& filename)
+{
+   std::ifstream f(filename, std::ios::binary);
+   char m[sizeof(magic)];
+   return f.read(m, sizeof(magic)) && std::equal(m, m + sizeof(magic), magic);
+}
+
+// format names the input function, so that a snapshot is not read into the wrong input structure
+template<typename INPUT>
+void write(const std::string& filename, const std::string& format, const INPUT& input)
+{
+   std::ofstream f(filename, std::ios::binary);
+   if(!f) { throw std::runtime_error("could not open file " + filename); }
+   f.write(magic, sizeof(magic));
+   {
+      cereal::BinaryOutputArchive ar(f);
+      ar(version, std::uint32_t(sizeof(REAL)), std::uint32_t(sizeof(INDEX)), format, input);
+   }
+   if(!f) { throw std::runtime_error("could not write snapshot " + filename); }
+   std::cout << "wrote input snapshot " << filename << "\n";
+}
+
+template<typename INPUT>
+void read(const std::string& filename, const std::string& format, INPUT& input)
+{
+   std::cout << "reading input snapshot " << filename << "\n";
+   mapped_file file(filename);
+   if(file.size() < sizeof(magic) || !std::equal(file.data(), file.data() + sizeof(magic), magic)) {
+      throw std::runtime_error(filename + " is not a snapshot");
+   }
+   memory_streambuf buf(file.data() + sizeof(magic), file.data() + file.size());
+   std::istream s(&buf);
+   cereal::BinaryInputArchive ar(s);
+   std::uint32_t v, real_size, index_size;
+   std::string f;
+   ar(v, real_size, index_size, f);
+   if(v != version) { throw std::runtime_error("snapshot " + filename + " has unsupported version " + std::to_string(v)); }
+   if(real_size != sizeof(REAL) || index_size != sizeof(INDEX)) { throw std::runtime_error("snapshot " + filename + " was written with different floating point or index type"); }
+   if(f != format) { throw std::runtime_error("snapshot " + filename + " holds " + f + " input, expected " + format); }
+   ar(input);
+}
+
+// for input functions: read input from a snapshot if filename is one, otherwise parse it with parse(filename, input).
+// Parsed input is written into a snapshot if requested on the command line of the solver.
+template<typename INPUT, typename SOLVER, typename PARSE_FUNCTION>
+bool read_or_parse(const std::string& filename, const std::string& format, SOLVER& s, INPUT& input, PARSE_FUNCTION parse)
+{
+   if(is_snapshot(filename)) {
+      read(filename, format, input);
+      return true;
+   }
+   const bool success = parse(filename, input);
+   if(success) {
+      s.WriteInputSnapshot(format, input);
+   }
+   return success;
+}
+
+} // end namespace snapshot
+
+} // end namespace LP_MP
+
+#endif // LP_MP_SNAPSHOT_HXX
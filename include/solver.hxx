@@ -7,8 +7,11 @@
 #include <condition_variable>
 #include <fstream>
 #include <sstream>
+#include <chrono>
 
 #include "LP_MP.h"
+#include "snapshot.hxx"
+#include "checkpoint.hxx"
 #include "function_existence.hxx"
 #include "template_utilities.hxx"
 #include "static_if.hxx"
@@ -37,11 +40,13 @@ public:
 
    Solver(int argc, char** argv) : Solver(ProblemDecompositionList{}) 
    {
+      options_.assign(argv, argv+argc);
       cmd_.parse(argc,argv);
       Init_(); 
    }
    Solver(std::vector<std::string> options) : Solver(ProblemDecompositionList{})
    {
+      options_ = options;
       cmd_.parse(options);
       Init_(); 
    }
@@ -54,6 +59,11 @@ private:
         lp_(cmd_),
         inputFileArg_("i","inputFile","file from which to read problem instance",false,"","file name",cmd_),
         outputFileArg_("o","outputFile","file to write solution",false,"","file name",cmd_),
+        incrementalLowerBoundArg_("","incrementalLowerBound","compute lower bound of factors during the backward pass instead of in a separate sweep over all factors",cmd_,false),
+        inputSnapshotFileArg_("","writeInputSnapshot","write the parsed problem input into a binary snapshot file. The snapshot can be given as input file in later runs and is read without parsing, the factor graph is constructed from it as from text input",false,"","file name",cmd_),
+        checkpointFileArg_("","checkpoint","periodically write dual state, best primal solution and iteration counter into file",false,"","file name",cmd_),
+        checkpointIntervalArg_("","checkpointInterval","time between checkpoints in seconds, default = 600",false,600,"positive integer",cmd_),
+        resumeFromArg_("","resumeFrom","continue optimization from a checkpoint. Problem and solver options must be the same as when writing it",false,"","file name",cmd_),
         visitor_(cmd_)
    {
       for_each_tuple(this->problemConstructor_, [this](auto& l) {
@@ -73,6 +83,9 @@ public:
    }
 
    TCLAP::CmdLine& get_cmd() { return cmd_; }
+   // options the solver was constructed with, the first one is the program name
+   const std::vector<std::string>& get_options() const { return options_; }
+   bool resuming() const { return resumeFromArg_.isSet(); }
 
    void Init_()
    {
@@ -97,6 +110,15 @@ public:
       return success;
    }
 
+   // called by input functions with the structure they parsed, see snapshot::read_or_parse
+   template<typename INPUT>
+   void WriteInputSnapshot(const std::string& format, const INPUT& input)
+   {
+      if(inputSnapshotFileArg_.isSet()) {
+         snapshot::write(inputSnapshotFileArg_.getValue(), format, input);
+      }
+   }
+
    LP_MP_FUNCTION_EXISTENCE_CLASS(HasWritePrimal,WritePrimal)
    template<typename PC>
    constexpr static bool
@@ -184,19 +206,80 @@ public:
       return HasTighten<PROBLEM_CONSTRUCTOR, INDEX, INDEX>();
    }
 
+   // problem constructors that record the factors they add while tightening, see checkpoint::tightening_log. They must also provide replay_tightening(kind, data_begin, data_end), which adds the factor of a log entry again.
+   LP_MP_FUNCTION_EXISTENCE_CLASS(HasTighteningLog,tightening_log)
+   template<typename PROBLEM_CONSTRUCTOR>
+   constexpr static bool
+   CanReplayTightening()
+   {
+      return HasTighteningLog<PROBLEM_CONSTRUCTOR, checkpoint::tightening_log&>();
+   }
+
    // maxConstraints gives maximum number of constraints to add for each problem constructor
    INDEX Tighten(const INDEX maxConstraints) 
    {
       INDEX constraints_added = 0;
-      for_each_tuple(this->problemConstructor_, [this,maxConstraints,&constraints_added](auto* l) {
+      INDEX pc_no = 0;
+      for_each_tuple(this->problemConstructor_, [this,maxConstraints,&constraints_added,&pc_no](auto* l) {
             using pc_type = typename std::remove_pointer<decltype(l)>::type;
             static_if<SolverType::CanTighten<pc_type>()>([&](auto f) {
-                  constraints_added += f(*l).Tighten(maxConstraints);
+                  const INDEX no_factors = lp_.GetNumberOfFactors();
+                  static_if<SolverType::CanReplayTightening<pc_type>()>([&](auto g) {
+                        auto& log = g(*l).tightening_log();
+                        const INDEX log_size = log.size();
+                        log.start();
+                        constraints_added += f(*l).Tighten(maxConstraints);
+                        log.stop();
+                        if(log.size() != log_size) {
+                           tightening_rounds_.push_back({pc_no, log.size()});
+                        }
+                  }).else_([&](auto g) {
+                        constraints_added += f(*l).Tighten(maxConstraints);
+                        if(lp_.GetNumberOfFactors() != no_factors) {
+                           tightening_restorable_ = false;
+                        }
+                  });
             });
+            ++pc_no;
        });
 
       return constraints_added;
    }
+
+   // add the factors of all tightening rounds recorded in a checkpoint again, in the order in which they were added originally
+   void ReplayTightening(const checkpoint::solver_state& state)
+   {
+      if(state.tightening_rounds.empty()) { return; }
+      if(state.tightening_logs.size() != std::tuple_size<decltype(problemConstructor_)>::value) {
+         throw std::runtime_error("checkpoint does not match problem: different number of problem constructors");
+      }
+      std::vector<INDEX> replayed(state.tightening_logs.size(), 0);
+      for(const auto& round : state.tightening_rounds) {
+         INDEX pc_no = 0;
+         for_each_tuple(this->problemConstructor_, [&](auto* l) {
+               using pc_type = typename std::remove_pointer<decltype(l)>::type;
+               if(pc_no == round[0]) {
+                  static_if<SolverType::CanReplayTightening<pc_type>()>([&](auto f) {
+                        const auto& recorded = state.tightening_logs[pc_no];
+                        if(round[1] < replayed[pc_no] || round[1] > recorded.size()) {
+                           throw std::runtime_error("checkpoint has corrupt tightening log");
+                        }
+                        auto& log = f(*l).tightening_log();
+                        log.start();
+                        recorded.for_each(replayed[pc_no], round[1], [&](const INDEX kind, const INDEX* begin, const INDEX* end) {
+                              f(*l).replay_tightening(kind, begin, end);
+                        });
+                        log.stop();
+                        replayed[pc_no] = round[1];
+                        tightening_rounds_.push_back({pc_no, log.size()});
+                  }).else_([&](auto f) {
+                        throw std::runtime_error("checkpoint does not match problem: problem constructor cannot replay tightening");
+                  });
+               }
+               ++pc_no;
+         });
+      }
+   }
    
    template<INDEX PROBLEM_CONSTRUCTOR_NO>
    meta::at_c<ProblemDecompositionList, PROBLEM_CONSTRUCTOR_NO>& GetProblemConstructor() 
@@ -216,16 +299,38 @@ public:
    
 
    
+   LP_MP_FUNCTION_EXISTENCE_CLASS(has_resume,resume)
+   constexpr static bool
+   visitor_has_resume()
+   {
+      return has_resume<VISITOR, void, INDEX>();
+   }
+
+   LP_MP_FUNCTION_EXISTENCE_CLASS(has_rounding_progress,rounding_progress)
+   template<typename ROUNDING_PROGRESS>
+   constexpr static bool
+   visitor_has_rounding_progress()
+   {
+      return has_rounding_progress<VISITOR, void, const ROUNDING_PROGRESS&>();
+   }
+
    int Solve()
    {
       this->Begin();
       LpControl c = visitor_.begin(this->lp_);
+      if(resumeFromArg_.isSet()) {
+         ReadCheckpoint(resumeFromArg_.getValue());
+      }
       while(!c.end && !c.error) {
          this->PreIterate(c);
          this->Iterate(c);
          this->PostIterate(c);
          c = visitor_.visit(c, this->lowerBound_, this->bestPrimalCost_);
+         ++iteration_;
          this->WritePrimal();
+         if(!c.end && !c.error) {
+            this->WriteCheckpoint();
+         }
       }
       if(!c.error) {
          this->End();
@@ -240,9 +345,24 @@ public:
    }
 
 
-   // called before first iterations
+   LP_MP_FUNCTION_EXISTENCE_CLASS(HasBegin,Begin)
+   template<typename PROBLEM_CONSTRUCTOR>
+   constexpr static bool
+   CanCallBegin()
+   {
+      return HasBegin<PROBLEM_CONSTRUCTOR, void>();
+   }
+
+   // called before first iterations. Problem constructors may still add factors
    virtual void Begin() 
    {
+      for_each_tuple(this->problemConstructor_, [this](auto* l) {
+            using pc_type = typename std::remove_pointer<decltype(l)>::type;
+            static_if<SolverType::CanCallBegin<pc_type>()>([&](auto f) {
+                  f(*l).Begin();
+            });
+      }); 
+      lp_.set_incremental_lower_bound(incrementalLowerBoundArg_.getValue());
       lp_.Begin(); 
    }
 
@@ -250,6 +370,7 @@ public:
    virtual void PreIterate(LpControl c) 
    {
       lp_.set_reparametrization(c.repam);
+      lp_.set_lower_bound_requested(c.computeLowerBound);
    } 
 
    // what to do for improving lower bound, typically ComputePass or ComputePassAndPrimal
@@ -289,7 +410,7 @@ public:
    }
 
    // register evaluated primal solution
-   void RegisterPrimal(const REAL cost)
+   void RegisterPrimal(const LONG_REAL cost)
    {
       assert(false);
       if(cost < bestPrimalCost_) {
@@ -302,7 +423,7 @@ public:
    // evaluate and register primal solution
    void RegisterPrimal()
    {
-      const REAL cost = lp_.EvaluatePrimal();
+      const LONG_REAL cost = lp_.EvaluatePrimal();
       std::cout << "register primal cost = " << cost << "\n"; 
       if(cost < bestPrimalCost_) {
          // assume solution is feasible
@@ -314,11 +435,56 @@ public:
       }
    }
 
-   REAL lower_bound() const { return lowerBound_; }
-   REAL primal_cost() const { return bestPrimalCost_; }
+   // write checkpoint if one is requested and the checkpoint interval has passed since the last one
+   void WriteCheckpoint()
+   {
+      if(!checkpointFileArg_.isSet()) { return; }
+      const auto now = std::chrono::steady_clock::now();
+      if(std::chrono::duration_cast<std::chrono::seconds>(now - lastCheckpointTime_).count() < checkpointIntervalArg_.getValue()) { return; }
+      lastCheckpointTime_ = now;
+      if(!tightening_restorable_) { // a checkpoint could not be resumed from
+         std::cerr << "no checkpoint written: factors added by tightening cannot be restored for this problem\n";
+         return;
+      }
+      checkpoint::solver_state state;
+      state.iteration = iteration_;
+      state.lower_bound = lowerBound_;
+      state.primal_cost = bestPrimalCost_;
+      state.solution = solution_;
+      for_each_tuple(this->problemConstructor_, [this,&state](auto* l) {
+            using pc_type = typename std::remove_pointer<decltype(l)>::type;
+            state.tightening_logs.push_back(checkpoint::tightening_log());
+            static_if<SolverType::CanReplayTightening<pc_type>()>([&](auto f) {
+                  state.tightening_logs.back() = f(*l).tightening_log();
+            });
+      });
+      state.tightening_rounds = tightening_rounds_;
+      try {
+         checkpoint::write(checkpointFileArg_.getValue(), state, lp_);
+      } catch(const std::exception& e) { // optimization goes on without checkpoint
+         std::cerr << "writing checkpoint failed: " << e.what() << "\n";
+      }
+   }
+
+   void ReadCheckpoint(const std::string& filename)
+   {
+      const checkpoint::solver_state state = checkpoint::read(filename, lp_, [this](const checkpoint::solver_state& s) { ReplayTightening(s); });
+      iteration_ = state.iteration;
+      lowerBound_ = state.lower_bound;
+      bestPrimalCost_ = state.primal_cost;
+      solution_ = state.solution;
+      static_if<visitor_has_resume()>([this](auto f) {
+            f(this)->visitor_.resume(this->iteration_);
+      });
+      std::cout << "resumed after iteration " << iteration_ << ", lower bound = " << lowerBound_ << ", upper bound = " << bestPrimalCost_ << "\n";
+   }
+
+   LONG_REAL lower_bound() const { return lowerBound_; }
+   LONG_REAL primal_cost() const { return bestPrimalCost_; }
 
 protected:
    TCLAP::CmdLine cmd_;
+   std::vector<std::string> options_;
 
    LP_TYPE lp_;
 
@@ -338,14 +504,24 @@ protected:
    // command line arguments
    TCLAP::ValueArg<std::string> inputFileArg_;
    TCLAP::ValueArg<std::string> outputFileArg_;
+   TCLAP::SwitchArg incrementalLowerBoundArg_;
+   TCLAP::ValueArg<std::string> inputSnapshotFileArg_;
+   TCLAP::ValueArg<std::string> checkpointFileArg_;
+   TCLAP::ValueArg<INDEX> checkpointIntervalArg_;
+   TCLAP::ValueArg<std::string> resumeFromArg_;
    std::string inputFile_;
    std::string outputFile_;
 
-   REAL lowerBound_;
+   LONG_REAL lowerBound_;
    // while Solver does not know how to compute primal, derived solvers do know. After computing a primal, they are expected to register their primals with the base solver
-   REAL bestPrimalCost_ = std::numeric_limits<REAL>::infinity();
+   LONG_REAL bestPrimalCost_ = std::numeric_limits<LONG_REAL>::infinity();
    std::string solution_;
 
+   INDEX iteration_ = 0; // iterations done, including those before resuming from a checkpoint
+   std::chrono::steady_clock::time_point lastCheckpointTime_ = std::chrono::steady_clock::now();
+   std::vector<std::array<std::uint64_t,2>> tightening_rounds_; // see checkpoint::solver_state
+   bool tightening_restorable_ = true; // false when a problem constructor without tightening log has added factors
+
    VISITOR visitor_;
 };
 
@@ -388,6 +564,19 @@ public:
       return HasComputePrimal<PROBLEM_CONSTRUCTOR, void>();
    }
 
+   // problem constructors rounding asynchronously can report their progress, its type is given by the problem constructor
+   template<typename PROBLEM_CONSTRUCTOR>
+   static auto rounding_progress_type(const PROBLEM_CONSTRUCTOR* pc) -> decltype(pc->rounding_progress());
+   static void rounding_progress_type(...);
+   template<typename PROBLEM_CONSTRUCTOR>
+   constexpr static bool
+   CanReportRoundingProgress()
+   {
+      using progress_type = decltype(rounding_progress_type(static_cast<const PROBLEM_CONSTRUCTOR*>(nullptr)));
+      using checked_type = typename std::conditional<std::is_void<progress_type>::value, INDEX, progress_type>::type;
+      return !std::is_void<progress_type>::value && SOLVER::template visitor_has_rounding_progress<checked_type>();
+   }
+
    void ComputePrimal()
    {
       // compute the primal in parallel.
@@ -397,6 +586,9 @@ public:
             static_if<ProblemConstructorRoundingSolver<SOLVER>::CanComputePrimal<pc_type>()>([&](auto f) {
                   f(*l).ComputePrimal();
             });
+            static_if<ProblemConstructorRoundingSolver<SOLVER>::CanReportRoundingProgress<pc_type>()>([&](auto f) {
+                  f(this)->visitor_.rounding_progress(f(*l).rounding_progress());
+            });
       });
       this->RegisterPrimal();
    }
@@ -0,0 +1,229 @@
+#ifndef LP_MP_THREAD_POOL_HXX
+#define LP_MP_THREAD_POOL_HXX
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <type_traits>
+#include <memory>
+#include <algorithm>
+#include <iterator>
+#include <cassert>
+#include "config.hxx"
+#include "spinlock.hxx"
+
+// persistent pool of worker threads with a work stealing scheduler.
+// A range of work items is split into chunks given by chunk boundaries. Chunks are distributed contiguously onto per-thread queues.
+// Each thread works off its own queue from the front and, when it runs dry, steals chunks from the back of the other queues.
+// The calling thread participates as thread 0, hence a pool with n threads holds n-1 background threads.
+// Threads can be divided into groups (e.g. NUMA nodes): a thread first steals from threads of its own group.
+
+namespace LP_MP {
+
+class thread_pool {
+public:
+   // thread_group[t] is the group of thread t, all threads are in one group if empty.
+   // thread_init(t) is called once by every worker thread t >= 1 before it processes any chunks.
+   // Thread 0 is the thread calling run_chunks, it is not touched by the pool.
+   thread_pool(const INDEX no_threads = 1, const std::vector<INDEX>& thread_group = {}, std::function<void(const INDEX)> thread_init = nullptr)
+      : no_threads_(std::max(INDEX(1), no_threads)),
+      queues_(new chunk_queue[no_threads_]),
+      steal_order_(no_threads_)
+   {
+      assert(thread_group.size() == 0 || thread_group.size() == no_threads_);
+      auto group = [&](const INDEX t) { return thread_group.size() == 0 ? 0 : thread_group[t]; };
+      for(INDEX t=0; t<no_threads_; ++t) {
+         for(INDEX i=1; i<no_threads_; ++i) {
+            if(group((t+i)%no_threads_) == group(t)) { steal_order_[t].push_back((t+i)%no_threads_); }
+         }
+         for(INDEX i=1; i<no_threads_; ++i) {
+            if(group((t+i)%no_threads_) != group(t)) { steal_order_[t].push_back((t+i)%no_threads_); }
+         }
+      }
+
+      workers_.reserve(no_threads_-1);
+      for(INDEX t=1; t<no_threads_; ++t) {
+         workers_.push_back(std::thread([this,t,thread_init]() {
+            if(thread_init) { thread_init(t); }
+            this->worker_loop(t);
+         }));
+      }
+   }
+
+   ~thread_pool()
+   {
+      {
+         std::lock_guard<std::mutex> guard(wake_mutex_);
+         terminate_ = true;
+         ++generation_;
+      }
+      wake_cond_.notify_all();
+      for(auto& w : workers_) {
+         w.join();
+      }
+   }
+
+   thread_pool(const thread_pool&) = delete;
+   thread_pool& operator=(const thread_pool&) = delete;
+
+   INDEX size() const { return no_threads_; }
+
+   // call f(chunk_begin, chunk_end, thread_no) for every chunk [chunk_boundaries[i], chunk_boundaries[i+1]).
+   // Returns after all chunks have been processed, hence f is referenced and not copied.
+   // With reverse_assignment the first chunks go to the last thread, so that a range traversed in opposite order is processed by the same threads.
+   template<typename FUNC>
+   void run_chunks(const std::vector<INDEX>& chunk_boundaries, FUNC&& f, const bool reverse_assignment = false)
+   {
+      assert(chunk_boundaries.size() >= 1);
+      run_chunks(chunk_boundaries.data(), chunk_boundaries.data() + chunk_boundaries.size(), f, reverse_assignment);
+   }
+
+   // as above, chunk boundaries are given by the range [boundaries_begin, boundaries_end)
+   template<typename FUNC>
+   void run_chunks(const INDEX* boundaries_begin, const INDEX* boundaries_end, FUNC&& f, const bool reverse_assignment = false)
+   {
+      assert(boundaries_end > boundaries_begin);
+      assert(std::is_sorted(boundaries_begin, boundaries_end));
+      const INDEX no_chunks = std::distance(boundaries_begin, boundaries_end) - 1;
+      if(no_chunks == 0) { return; }
+
+      if(no_threads_ == 1 || no_chunks == 1) {
+         for(INDEX c=0; c<no_chunks; ++c) {
+            f(boundaries_begin[c], boundaries_begin[c+1], 0);
+         }
+         return;
+      }
+
+      chunk_boundaries_ = boundaries_begin;
+      using func_type = typename std::remove_reference<FUNC>::type;
+      job_ = const_cast<void*>(static_cast<const void*>(&f));
+      job_call_ = [](void* job, const INDEX chunk_begin, const INDEX chunk_end, const INDEX t) { (*static_cast<func_type*>(job))(chunk_begin, chunk_end, t); };
+      // distribute chunks contiguously onto queues, so that without stealing each thread works on a contiguous range
+      for(INDEX t=0; t<no_threads_; ++t) {
+         const INDEX q = reverse_assignment ? no_threads_-1-t : t;
+         std::lock_guard<spinlock> guard(queues_[t].lock);
+         queues_[t].front = (q*no_chunks)/no_threads_;
+         queues_[t].back = ((q+1)*no_chunks)/no_threads_;
+      }
+      remaining_chunks_.store(no_chunks, std::memory_order_release);
+      {
+         std::lock_guard<std::mutex> guard(wake_mutex_);
+         ++generation_;
+      }
+      wake_cond_.notify_all();
+
+      process_chunks(0);
+      // wait until chunks stolen by other threads are finished as well
+      while(remaining_chunks_.load(std::memory_order_acquire) > 0) {
+         std::this_thread::yield();
+      }
+      job_ = nullptr;
+      job_call_ = nullptr;
+      chunk_boundaries_ = nullptr;
+   }
+
+   // thread that processes chunk c out of no_chunks in run_chunks unless the chunk is stolen
+   INDEX initial_thread(const INDEX c, const INDEX no_chunks, const bool reverse_assignment = false) const
+   {
+      assert(c < no_chunks);
+      if(no_threads_ == 1 || no_chunks == 1) { return 0; }
+      const INDEX q = ((LONG_INDEX(c)+1)*no_threads_ + no_chunks - 1)/no_chunks - 1; // last queue q with q*no_chunks/no_threads_ <= c
+      return reverse_assignment ? no_threads_-1-q : q;
+   }
+
+   // split [0,n) uniformly into chunks_per_thread*size() chunks
+   template<typename FUNC>
+   void parallel_for(const INDEX n, FUNC&& f, const INDEX chunks_per_thread = 4)
+   {
+      const INDEX no_chunks = std::max(INDEX(1), std::min(n, chunks_per_thread*no_threads_));
+      std::vector<INDEX> chunk_boundaries(no_chunks+1);
+      for(INDEX c=0; c<=no_chunks; ++c) {
+         chunk_boundaries[c] = (LONG_INDEX(c)*n)/no_chunks;
+      }
+      run_chunks(chunk_boundaries, f);
+   }
+
+private:
+   // queues are padded to two cache lines, hence no two queues share a cache line whatever the alignment of the array is.
+   // Over-aligned types are not supported by new before C++17.
+   struct chunk_queue {
+      spinlock lock;
+      INDEX front = 0;
+      INDEX back = 0;
+      char padding[128 - sizeof(spinlock) - 2*sizeof(INDEX)];
+   };
+
+   // the owner takes chunks from the front of its queue, thieves from the back
+   bool pop_front(const INDEX t, INDEX& chunk)
+   {
+      auto& q = queues_[t];
+      std::lock_guard<spinlock> guard(q.lock);
+      if(q.front == q.back) { return false; }
+      chunk = q.front++;
+      return true;
+   }
+
+   bool steal_back(const INDEX t, INDEX& chunk)
+   {
+      auto& q = queues_[t];
+      std::lock_guard<spinlock> guard(q.lock);
+      if(q.front == q.back) { return false; }
+      chunk = --q.back;
+      return true;
+   }
+
+   bool get_chunk(const INDEX t, INDEX& chunk)
+   {
+      if(pop_front(t, chunk)) { return true; }
+      for(const INDEX victim : steal_order_[t]) {
+         if(steal_back(victim, chunk)) { return true; }
+      }
+      return false;
+   }
+
+   void process_chunks(const INDEX t)
+   {
+      INDEX c;
+      while(get_chunk(t, c)) {
+         job_call_(job_, chunk_boundaries_[c], chunk_boundaries_[c+1], t);
+         remaining_chunks_.fetch_sub(1, std::memory_order_acq_rel);
+      }
+   }
+
+   void worker_loop(const INDEX t)
+   {
+      INDEX seen_generation = 0;
+      while(true) {
+         {
+            std::unique_lock<std::mutex> guard(wake_mutex_);
+            wake_cond_.wait(guard, [&]() { return generation_ != seen_generation; });
+            seen_generation = generation_;
+            if(terminate_) { return; }
+         }
+         process_chunks(t);
+      }
+   }
+
+   const INDEX no_threads_;
+   std::unique_ptr<chunk_queue[]> queues_;
+   std::vector<std::vector<INDEX>> steal_order_; // threads of the same group come first
+   std::vector<std::thread> workers_;
+
+   // job of current run_chunks call, type erased without copying it
+   void* job_ = nullptr;
+   void (*job_call_)(void*, const INDEX, const INDEX, const INDEX) = nullptr; // job, chunk begin, chunk end, thread number
+   const INDEX* chunk_boundaries_ = nullptr;
+   std::atomic<INDEX> remaining_chunks_{0};
+
+   std::mutex wake_mutex_;
+   std::condition_variable wake_cond_;
+   INDEX generation_ = 0;
+   bool terminate_ = false;
+};
+
+} // end namespace LP_MP
+
+#endif // LP_MP_THREAD_POOL_HXX
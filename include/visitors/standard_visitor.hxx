@@ -13,7 +13,7 @@ class Visitor {
 public:
    Visitor(TCLAP::CmdLine& cmd);
    LpControl begin(LP& lp);
-   LpControl visit(LpControl, const REAL lower_bound, const REAL primal)
+   LpControl visit(LpControl, const LONG_REAL lower_bound, const LONG_REAL primal)
 };
 */
 
@@ -104,7 +104,7 @@ namespace LP_MP {
 
       // LpControl says what was last command to solver, return type gives next
       //template<typename SOLVER>
-      LpControl visit(const LpControl c, const REAL lowerBound, const REAL primalBound)
+      LpControl visit(const LpControl c, const LONG_REAL lowerBound, const LONG_REAL primalBound)
       {
          lowerBound_.push_back(lowerBound); // rename to lowerBoundHistory_
          const INDEX timeElapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - beginTime_).count();
@@ -155,9 +155,8 @@ namespace LP_MP {
                std::cout << "Solver uses " << memoryUsed << " MB memory, aborting optimization\n";
             }
          }
-         if(c.computeLowerBound && curIter_ >= minDualImprovementInterval_ && minDualImprovementArg_.isSet()) {
-            assert(lowerBound_.size() >= minDualImprovementInterval_);
-            const REAL prevLowerBound = lowerBound_[lowerBound_.size() - 1 - minDualImprovementInterval_];
+         if(c.computeLowerBound && lowerBound_.size() > minDualImprovementInterval_ && minDualImprovementArg_.isSet()) { // history starts anew when resuming from a checkpoint
+            const LONG_REAL prevLowerBound = lowerBound_[lowerBound_.size() - 1 - minDualImprovementInterval_];
             if(minDualImprovement_ > 0 && lowerBound - prevLowerBound < minDualImprovement_) {
                std::cout << "Dual improvement smaller than " << minDualImprovement_ << " after " << minDualImprovementInterval_ << " iterations, terminating optimization\n";
                remainingIter_ = std::min(INDEX(1),remainingIter_);
@@ -189,7 +188,28 @@ namespace LP_MP {
          return ret;
       }
 
-      void end(const REAL lower_bound, const REAL upper_bound)
+      // continue counting iterations after the solver has resumed from a checkpoint
+      void resume(const INDEX iteration)
+      {
+         curIter_ = iteration;
+         remainingIter_ = iteration < maxIter_ ? maxIter_ - iteration : 1;
+      }
+
+      // p as RoundingProgress of multicut_rounding.hxx
+      template<typename ROUNDING_PROGRESS>
+      void rounding_progress(const ROUNDING_PROGRESS& p)
+      {
+         std::cout << "rounding: " << p.jobsFinished << " finished, " << p.jobsCancelled << " cancelled";
+         if(p.running) {
+            std::cout << ", running for " << p.localSearchIterations << " local search iterations";
+         }
+         if(p.jobsFinished + p.jobsCancelled > 0) {
+            std::cout << ", last cost = " << p.cost;
+         }
+         std::cout << "\n";
+      }
+
+      void end(const LONG_REAL lower_bound, const LONG_REAL upper_bound)
       {
          auto endTime = std::chrono::steady_clock::now();
          std::cout << "final lower bound = " << lower_bound << ", upper bound = " << upper_bound << "\n";
@@ -225,7 +245,7 @@ namespace LP_MP {
       INDEX lowerBoundComputationInterval_;
       REAL minDualImprovement_;
       INDEX minDualImprovementInterval_;
-      std::vector<REAL> lowerBound_; // do zrobienia: possibly make circular list out of this
+      std::vector<LONG_REAL> lowerBound_; // do zrobienia: possibly make circular list out of this
       // do zrobienia: make enum for reparametrization mode
       LPReparametrizationMode standardReparametrization_;
       LPReparametrizationMode roundingReparametrization_;
@@ -233,8 +253,8 @@ namespace LP_MP {
       // internal state of visitor
       INDEX remainingIter_;
       INDEX curIter_ = 0;
-      REAL prevLowerBound_ = -std::numeric_limits<REAL>::max();
-      REAL curLowerBound_ = -std::numeric_limits<REAL>::max();
+      LONG_REAL prevLowerBound_ = -std::numeric_limits<LONG_REAL>::max();
+      LONG_REAL curLowerBound_ = -std::numeric_limits<LONG_REAL>::max();
       TimeType beginTime_;
 
       // primal
@@ -312,7 +332,7 @@ namespace LP_MP {
       }
       // the default
       //template<LPVisitorReturnType LP_STATE>
-      LpControl visit(const LpControl c, const REAL lowerBound, const REAL primalBound)
+      LpControl visit(const LpControl c, const LONG_REAL lowerBound, const LONG_REAL primalBound)
       {
          auto ret = BaseVisitorType::visit(c, lowerBound, primalBound);
 
@@ -333,7 +353,7 @@ namespace LP_MP {
                // check whether too small dual improvement necessitates tightening
                if(c.computeLowerBound && this->GetIter() > tightenMinDualImprovementInterval_ + lastTightenIteration_ && tightenMinDualImprovementArg_.isSet()) {
                   assert(this->lowerBound_.size() >= tightenMinDualImprovementInterval_);
-                  const REAL prevLowerBound = lowerBound_[lowerBound_.size() - 1 - tightenMinDualImprovementInterval_];
+                  const LONG_REAL prevLowerBound = lowerBound_[lowerBound_.size() - 1 - tightenMinDualImprovementInterval_];
                   if(tightenMinDualImprovement_ > 0 && lowerBound - prevLowerBound < tightenMinDualImprovement_) {
                      std::cout << "cur lower bound = " << lowerBound << " prev lower bound = " << prevLowerBound << "\n";
                      std::cout << "Dual improvement smaller than " << tightenMinDualImprovement_ << " after " << tightenMinDualImprovementInterval_ << " iterations, tighten\n";
@@ -371,7 +391,7 @@ namespace LP_MP {
       TCLAP::ValueArg<INDEX> tightenMinDualImprovementIntervalArg_;
       OpenUnitIntervalConstraint unitIntervalConstraint_;
 
-      REAL prev_lower_bound_ = -std::numeric_limits<REAL>::infinity();
+      LONG_REAL prev_lower_bound_ = -std::numeric_limits<LONG_REAL>::infinity();
       TCLAP::ValueArg<REAL> tightenSlopeArg_;
       REAL tighten_slope_ = -std::numeric_limits<REAL>::infinity(); 
       INDEX iteration_after_tightening_ = 2; // this way tighten_slope will not be recomputed
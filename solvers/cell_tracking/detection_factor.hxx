@@ -142,7 +142,7 @@ public:
     }
   }
   REAL LowerBound() const {
-    return std::min(cost_of_detection(), 0.0);
+    return std::min(cost_of_detection(), REAL(0.0));
   }
 
   //REAL& detection_cost() { return *pot_; }
@@ -444,7 +444,7 @@ public:
      assert(max_detections_ <= no_outgoing_edges() || no_outgoing_edges() == 0);
 
      auto min_detection_cost = cost01(detection_begin(), smallest_incoming, smallest_outgoing, current_arc_cost);
-     min_detection_cost[0] = std::min(min_detection_cost[0], 0.0);
+     min_detection_cost[0] = std::min(min_detection_cost[0], REAL(0.0));
 
      // disappearance cost
      const REAL min_disappearance_cost = disappearance_cost(smallest_incoming); // here outgoing edge is 0 by default
@@ -528,7 +528,7 @@ public:
      assert(max_detections_ <= no_outgoing_edges() || no_outgoing_edges() == 0);
 
      auto min_detection_cost = cost01(detection_begin(), smallest_outgoing, smallest_incoming, current_arc_cost);
-     min_detection_cost[0] = std::min(min_detection_cost[0], 0.0);
+     min_detection_cost[0] = std::min(min_detection_cost[0], REAL(0.0));
 
      // appearance cost
      const REAL min_appearance_cost = appearance_cost(smallest_outgoing); // here incoming edge is 0 by default
@@ -680,8 +680,8 @@ public:
     }
     */
 
-    msg[0] -= std::min(detection_outgoing_cost + r.incoming(incoming_edge_index_) , 0.0)
-      - std::min(detection_outgoing_cost + min_incoming_val, 0.0); // or +- exchanged 
+    msg[0] -= std::min(detection_outgoing_cost + r.incoming(incoming_edge_index_) , REAL(0.0))
+      - std::min(detection_outgoing_cost + min_incoming_val, REAL(0.0)); // or +- exchanged 
   }
   template<typename RIGHT_FACTOR, typename G2>
   void ReceiveMessageFromRight(RIGHT_FACTOR& r, G2& msg)
@@ -739,8 +739,8 @@ public:
     }
     */
 
-    msg[0] -= std::min(detection_incoming_cost + l.outgoing(outgoing_edge_index_),  0.0)
-      - std::min(detection_incoming_cost + min_outgoing_val,  0.0);
+    msg[0] -= std::min(detection_incoming_cost + l.outgoing(outgoing_edge_index_), REAL(0.0))
+      - std::min(detection_incoming_cost + min_outgoing_val, REAL(0.0));
   }
 
   template<typename LEFT_FACTOR, typename G2>
@@ -927,7 +927,7 @@ public:
    {}
 
    REAL LowerBound() const {
-     return std::min(0.0, *std::min_element(this->begin(), this->end()));
+     return std::min(REAL(0.0), *std::min_element(this->begin(), this->end()));
    }
 
    REAL EvaluatePrimal() const {
@@ -1051,7 +1051,7 @@ public:
       //make_right_factor_uniform(r, msg);
       const REAL cur_detection_cost = r[at_most_one_cell_factor_index_];
       r[at_most_one_cell_factor_index_] = std::numeric_limits<REAL>::infinity();
-      const REAL rest_cost = std::min(0.0, *std::min_element(r.begin(), r.end()));
+      const REAL rest_cost = std::min(REAL(0.0), *std::min_element(r.begin(), r.end()));
       r[at_most_one_cell_factor_index_] = cur_detection_cost;
 
       msg[0] -= (cur_detection_cost - rest_cost);
@@ -1109,7 +1109,7 @@ public:
   {
     const REAL cur_detection_cost = r[at_most_one_cell_factor_index_];
     r[at_most_one_cell_factor_index_] = std::numeric_limits<REAL>::infinity();
-    const REAL rest_cost = std::min(0.0, *std::min_element(r.begin(), r.end()));
+    const REAL rest_cost = std::min(REAL(0.0), *std::min_element(r.begin(), r.end()));
     r[at_most_one_cell_factor_index_] = cur_detection_cost;
 
     msg[0] -= omega*(cur_detection_cost - rest_cost);
@@ -1154,7 +1154,7 @@ public:
   using repam_type = std::array<REAL,2>;
   REAL LowerBound() const 
   {
-    return std::min(0.0, std::min( (*this)[0], (*this)[1] )); 
+    return std::min(REAL(0.0), std::min( (*this)[0], (*this)[1] )); 
   }
   REAL EvaluatePrimal() const 
   {
@@ -1298,9 +1298,9 @@ public:
   {
     assert(r.size() == 2);
     if(POSITION == exit_constraint_position::lower) {
-      msg[0] -= r[0] - std::min(0.0, r[1]);
+      msg[0] -= r[0] - std::min(REAL(0.0), r[1]);
     } else {
-      msg[0] -= r[1] - std::min(0.0, r[0]);
+      msg[0] -= r[1] - std::min(REAL(0.0), r[0]);
     }
   }
 
@@ -1347,7 +1347,7 @@ class transition_factor {
 public:
   transition_factor(const REAL cost) : pot_(cost) {}
   REAL LowerBound() const {
-    return std::min(0.0, REAL());
+    return std::min(REAL(0.0), REAL());
   }
   REAL EvaluatePrimal(PrimalSolutionStorage::Element primal) const {
     assert(*primal != unknownState);
@@ -1364,7 +1364,7 @@ class split_factor : public std::array<REAL,3> {
 public:
   split_factor() {}
   REAL LowerBound() const {
-    return std::min(*std::min_element(this->begin(), this->end()), 0.0);
+    return std::min(*std::min_element(this->begin(), this->end()), REAL(0.0));
   }
   REAL EvaluatePrimal(PrimalSolutionStorage::Element primal) const {
     if(std::accumulate(primal, primal + size(),0) > 1) {
@@ -1406,7 +1406,7 @@ public:
     const REAL detection_incoming_cost = l[0] + *std::min_element(l.incoming_begin(), l.incoming_end());
 
     for(; msg_begin!=msg_end; ++msg_begin) {
-      (*msg_begin)[0] -= omega*(std::min(detection_incoming_cost + l[(*msg_begin).outgoing_edge_index_], 0.0));
+      (*msg_begin)[0] -= omega*(std::min(detection_incoming_cost + l[(*msg_begin).outgoing_edge_index_], REAL(0.0)));
     }
   }
   template<typename RIGHT_FACTOR, typename G2>
@@ -1451,7 +1451,7 @@ public:
     const REAL detection_outgoing_cost = r[0] + *std::min_element(r.outgoing_begin(), r.outgoing_end());
 
     for(; msg_begin!=msg_end; ++msg_begin) {
-      (*msg_begin)[0] -= omega*(std::min(detection_outgoing_cost + r[(*msg_begin).incoming_edge_index_], 0.0));
+      (*msg_begin)[0] -= omega*(std::min(detection_outgoing_cost + r[(*msg_begin).incoming_edge_index_], REAL(0.0)));
     }
   }
 private:
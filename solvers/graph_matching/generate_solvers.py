@@ -18,6 +18,9 @@ FMC = [
       'FMC_HUNGARIAN_BP<PairwiseConstruction::Left>',
       'FMC_HUNGARIAN_BP<PairwiseConstruction::Right>',
       'FMC_HUNGARIAN_BP<PairwiseConstruction::BothSides>',
+      'FMC_AUCTION<PairwiseConstruction::Left>',
+      'FMC_AUCTION<PairwiseConstruction::Right>',
+      'FMC_AUCTION<PairwiseConstruction::BothSides>',
       'FMC_MCF_T<PairwiseConstruction::Left>',
       'FMC_MCF_T<PairwiseConstruction::Right>',
       'FMC_MCF_T<PairwiseConstruction::BothSides>',
@@ -43,6 +46,9 @@ parse_fun = [
       'ParseProblemHungarian',
       'ParseProblemHungarian',
       'ParseProblemHungarian',
+      'ParseProblemAuction',
+      'ParseProblemAuction',
+      'ParseProblemAuction',
       'ParseProblemMCF',
       'ParseProblemMCF',
       'ParseProblemMCF',
@@ -68,6 +74,9 @@ file_name = [
       "hungarian_bp_left.cpp",
       "hungarian_bp_right.cpp",
       "hungarian_bp_both_sides.cpp",
+      "graph_matching_via_auction_left.cpp",
+      "graph_matching_via_auction_right.cpp",
+      "graph_matching_via_auction_both_sides.cpp",
       "graph_matching_via_mcf_left_tightening.cpp",
       "graph_matching_via_mcf_right_tightening.cpp",
       "graph_matching_via_mcf_both_sides_tightening.cpp",
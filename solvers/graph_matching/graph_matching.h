@@ -12,10 +12,12 @@
 #include "problem_constructors/mrf_problem_construction.hxx"
 //#include "factors/min_cost_flow_factor_lemon.hxx"
 #include "factors/min_cost_flow_factor_cs2.hxx"
+#include "factors/assignment_factor.hxx"
 
 #include "problem_constructors/cycle_inequalities.hxx"
 
 #include "parse_rules.h"
+#include "fast_parsing.hxx"
 
 #include <vector>
 #include <fstream>
@@ -25,7 +27,9 @@
 // solvers:
 // FMC_MP implements graph matching with the uniqueness constraints implemented via messages.
 // FMC_MCF implements graph matching with a global min cost flow factor.
+// FMC_AUCTION implements graph matching with a global assignment factor solved by the auction algorithm.
 // FMC_GM amounts to TRWS with infinity on diagonals
+// FMC_HUNGARIAN_BP implements Hungarian BP with an incrementally updated assignment factor, which also rounds primal solutions.
 // iFMC_${MODEL}_T implements tightening version of all three solvers using violated cycle tightening of Sontag
 //
 // input grammars:
@@ -60,7 +64,7 @@ struct FMC_MP {
       : "unknown variant"));
       
    typedef FactorContainer<UnarySimplexFactor, FMC_MP_PARAM, 0, true > UnaryFactor; // set to true if labeling by unaries is desired
-   typedef FactorContainer<PairwiseSimplexFactor, FMC_MP_PARAM, 1, false > PairwiseFactor;
+   typedef FactorContainer<pairwise_sparse_factor, FMC_MP_PARAM, 1, false > PairwiseFactor;
 
    constexpr static const Chirality primal_propagation_direction = (PAIRWISE_CONSTRUCTION == PairwiseConstruction::Left || PAIRWISE_CONSTRUCTION == PairwiseConstruction::BothSides) ? Chirality::right : Chirality::left;
    using EqualityMessageType = EqualityMessage<primal_propagation_direction>;
@@ -140,7 +144,7 @@ struct FMC_MCF {
 
    typedef FactorContainer<MinCostFlowFactorCS2, FMC_MCF_PARAM, 0, false > MinCostFlowAssignmentFactor;
    typedef FactorContainer<UnarySimplexFactor, FMC_MCF_PARAM, 1, true > UnaryFactor;
-   typedef FactorContainer<PairwiseSimplexFactor, FMC_MCF_PARAM, 2 > PairwiseFactor;
+   typedef FactorContainer<pairwise_sparse_factor, FMC_MCF_PARAM, 2 > PairwiseFactor;
 
    typedef MessageContainer<UnaryPairwiseMessageLeft<MessageSendingType::SRMP>, 1, 2, variableMessageNumber, 1, FMC_MCF_PARAM, 0 > UnaryPairwiseMessageLeftContainer;
    typedef MessageContainer<UnaryPairwiseMessageRight<MessageSendingType::SRMP>, 1, 2, variableMessageNumber, 1, FMC_MCF_PARAM, 1 > UnaryPairwiseMessageRightContainer;
@@ -225,6 +229,43 @@ struct FMC_MCF_T {
    using ProblemDecompositionList = meta::list<mrfLeft,mrfRight>; 
 };
 
+// graph matching with a dedicated assignment factor instead of the general min cost flow factor
+template<PairwiseConstruction PAIRWISE_CONSTRUCTION = PairwiseConstruction::Left>
+struct FMC_AUCTION {
+   using FMC_AUCTION_PARAM = FMC_AUCTION<PAIRWISE_CONSTRUCTION>;
+   constexpr static const char* name =
+      PAIRWISE_CONSTRUCTION == PairwiseConstruction::Left ? "AUCTION-O"
+      : (PAIRWISE_CONSTRUCTION == PairwiseConstruction::Right ? "AUCTION-I"
+      : (PAIRWISE_CONSTRUCTION == PairwiseConstruction::BothSides ? "AUCTION-B"
+      : "unknown variant"));
+
+   typedef FactorContainer<AssignmentFactor, FMC_AUCTION_PARAM, 0, false > AssignmentFactorContainer;
+   typedef FactorContainer<UnarySimplexFactor, FMC_AUCTION_PARAM, 1, true > UnaryFactor;
+   typedef FactorContainer<pairwise_sparse_factor, FMC_AUCTION_PARAM, 2 > PairwiseFactor;
+
+   typedef MessageContainer<UnaryPairwiseMessageLeft<MessageSendingType::SRMP>, 1, 2, variableMessageNumber, 1, FMC_AUCTION_PARAM, 0 > UnaryPairwiseMessageLeftContainer;
+   typedef MessageContainer<UnaryPairwiseMessageRight<MessageSendingType::SRMP>, 1, 2, variableMessageNumber, 1, FMC_AUCTION_PARAM, 1 > UnaryPairwiseMessageRightContainer;
+   using UnaryToAssignmentMessageType = UnaryToAssignmentMessage<>;
+   typedef MessageContainer<UnaryToAssignmentMessageType, 1, 0, 1, variableMessageNumber, FMC_AUCTION_PARAM, 2> UnaryToAssignmentMessageContainer;
+
+   constexpr static const Chirality primal_propagation_direction = (PAIRWISE_CONSTRUCTION == PairwiseConstruction::Left || PAIRWISE_CONSTRUCTION == PairwiseConstruction::BothSides) ? Chirality::left : Chirality::right;
+   using EqualityMessageType = EqualityMessage<primal_propagation_direction,false>;
+   typedef MessageContainer<EqualityMessageType, 1, 1, variableMessageNumber, variableMessageNumber, FMC_AUCTION_PARAM, 3 > AssignmentConstraintMessage;
+
+   using FactorList = meta::list<AssignmentFactorContainer, UnaryFactor, PairwiseFactor>;
+   using MessageList = meta::list<
+       UnaryPairwiseMessageLeftContainer,  
+       UnaryPairwiseMessageRightContainer, 
+       UnaryToAssignmentMessageContainer,
+       AssignmentConstraintMessage
+      >;
+
+   using mrf = AssignmentGmConstructor<StandardMrfConstructor<FMC_AUCTION_PARAM,1,2,0,1>>;
+   using mrfLeft = mrf;
+   using mrfRight = disable_write_constructor<mrf>;
+   using ProblemDecompositionList = meta::list<mrfLeft,mrfRight>;
+};
+
 
 // naive version where the assignment is enforced through inf on pairwise diagonals. One has to insert all possible diagonals then.
 // this results in a dense standard pairwise graphical model
@@ -237,7 +278,7 @@ struct FMC_GM {
       : "unknown variant");
       
    typedef FactorContainer<UnarySimplexFactor, FMC_GM_PARAM, 0, true > UnaryFactor; // make true, if primal rounding similar to TRW-S is required
-   typedef FactorContainer<PairwiseSimplexFactor, FMC_GM_PARAM, 1, false > PairwiseFactor;
+   typedef FactorContainer<pairwise_sparse_factor, FMC_GM_PARAM, 1, false > PairwiseFactor;
 
    typedef MessageContainer<UnaryPairwiseMessageLeft<MessageSendingType::SRMP>, 0, 1, variableMessageNumber, 1, FMC_GM_PARAM, 0 > UnaryPairwiseMessageLeftContainer;
    typedef MessageContainer<UnaryPairwiseMessageRight<MessageSendingType::SRMP>, 0, 1, variableMessageNumber, 1, FMC_GM_PARAM, 1 > UnaryPairwiseMessageRightContainer;
@@ -305,21 +346,19 @@ struct FMC_HUNGARIAN_BP {
       : (PAIRWISE_CONSTRUCTION == PairwiseConstruction::BothSides ? "HBP-B"
       : "unknown variant"));
       
-   constexpr static INDEX McfCoveringFactor = PAIRWISE_CONSTRUCTION == PairwiseConstruction::BothSides ? 2 : 1;
-
-   // rounding is done by the mcf factor
-   typedef FactorContainer<MinCostFlowFactorCS2, FMC_PARAM, 0, true > MinCostFlowAssignmentFactor;
+   // rounding is done by the assignment factor
+   typedef FactorContainer<HungarianAssignmentFactor, FMC_PARAM, 0, true > AssignmentFactorContainer;
    typedef FactorContainer<UnarySimplexFactor, FMC_PARAM, 1, false > UnaryFactor;
-   typedef FactorContainer<PairwiseSimplexFactor, FMC_PARAM, 2 > PairwiseFactor;
+   typedef FactorContainer<pairwise_sparse_factor, FMC_PARAM, 2 > PairwiseFactor;
 
    typedef MessageContainer<UnaryPairwiseMessageLeft<MessageSendingType::MPLP>, 1, 2, variableMessageNumber, 1, FMC_PARAM, 0 > UnaryPairwiseMessageLeftContainer;
    typedef MessageContainer<UnaryPairwiseMessageRight<MessageSendingType::MPLP>, 1, 2, variableMessageNumber, 1, FMC_PARAM, 1 > UnaryPairwiseMessageRightContainer;
    //typedef MessageContainer<LeftMargMessageMPLP, 1, 2, variableMessageNumber, 1, variableMessageSize, FMC_PARAM, 0 > UnaryPairwiseMessageLeft;
    //typedef MessageContainer<RightMargMessageMPLP, 1, 2, variableMessageNumber, 1, variableMessageSize, FMC_PARAM, 1 > UnaryPairwiseMessageRight;
-   using UnaryToAssignmentMessageType = UnaryToAssignmentMessageCS2<McfCoveringFactor,MessagePassingType::HUNGARIAN>;
+   using UnaryToAssignmentMessageType = UnaryToAssignmentMessage<true>;
    typedef MessageContainer<UnaryToAssignmentMessageType, 1, 0, 1, variableMessageNumber, FMC_PARAM, 2> UnaryToAssignmentMessageContainer;
 
-   using FactorList = meta::list<MinCostFlowAssignmentFactor, UnaryFactor, PairwiseFactor>;
+   using FactorList = meta::list<AssignmentFactorContainer, UnaryFactor, PairwiseFactor>;
    using MessageList = meta::list<
        UnaryPairwiseMessageLeftContainer,  
        UnaryPairwiseMessageRightContainer, 
@@ -342,10 +381,8 @@ struct FMC_HUNGARIAN_BP_T {
       : (PAIRWISE_CONSTRUCTION == PairwiseConstruction::BothSides ? "HBP-B-T"
       : "unknown variant"));
       
-   constexpr static INDEX McfCoveringFactor = PAIRWISE_CONSTRUCTION == PairwiseConstruction::BothSides ? 2 : 1;
-
-   // rounding is done by the mcf factor
-   typedef FactorContainer<MinCostFlowFactorCS2, FMC_PARAM, 0, true > MinCostFlowAssignmentFactor;
+   // rounding is done by the assignment factor
+   typedef FactorContainer<HungarianAssignmentFactor, FMC_PARAM, 0, true > AssignmentFactorContainer;
    typedef FactorContainer<UnarySimplexFactor, FMC_PARAM, 1, false > UnaryFactor;
    typedef FactorContainer<PairwiseSimplexFactor, FMC_PARAM, 2 > PairwiseFactor;
 
@@ -353,7 +390,7 @@ struct FMC_HUNGARIAN_BP_T {
    typedef MessageContainer<UnaryPairwiseMessageRight<MessageSendingType::MPLP>, 1, 2, variableMessageNumber, 1, FMC_PARAM, 1 > UnaryPairwiseMessageRightContainer;
    //typedef MessageContainer<LeftMargMessageMPLP, 1, 2, variableMessageNumber, 1, variableMessageSize, FMC_PARAM, 0 > UnaryPairwiseMessageLeft;
    //typedef MessageContainer<RightMargMessageMPLP, 1, 2, variableMessageNumber, 1, variableMessageSize, FMC_PARAM, 1 > UnaryPairwiseMessageRight;
-   using UnaryToAssignmentMessageType = UnaryToAssignmentMessageCS2<McfCoveringFactor,MessagePassingType::HUNGARIAN>;
+   using UnaryToAssignmentMessageType = UnaryToAssignmentMessage<true>;
    typedef MessageContainer<UnaryToAssignmentMessageType, 1, 0, 1, variableMessageNumber, FMC_PARAM, 2> UnaryToAssignmentMessageContainer;
 
    // tightening
@@ -365,7 +402,7 @@ struct FMC_HUNGARIAN_BP_T {
    //typedef MessageContainer<PairwiseTriplet13MessageMPLP, 2, 3, variableMessageNumber, 1, variableMessageSize, FMC_PARAM, 4> PairwiseTriplet13MessageContainer;
    //typedef MessageContainer<PairwiseTriplet23MessageMPLP, 2, 3, variableMessageNumber, 1, variableMessageSize, FMC_PARAM, 5> PairwiseTriplet23MessageContainer;
 
-   using FactorList = meta::list<MinCostFlowAssignmentFactor, UnaryFactor, PairwiseFactor, EmptyTripletFactor>;
+   using FactorList = meta::list<AssignmentFactorContainer, UnaryFactor, PairwiseFactor, EmptyTripletFactor>;
    using MessageList = meta::list<
        UnaryPairwiseMessageLeftContainer,  
        UnaryPairwiseMessageRightContainer, 
@@ -425,11 +462,16 @@ namespace TorresaniEtAlInput {
    using Parsing::real_number;
 
    struct GraphMatchingInput {
-      struct Assignment { INDEX left_node_, right_node_; REAL cost_; };
+      struct Assignment { 
+         INDEX left_node_, right_node_; REAL cost_;
+         template<class ARCHIVE> void serialize(ARCHIVE& ar) { ar(left_node_, right_node_, cost_); }
+      };
       std::vector<Assignment> assignment_;
       std::vector<std::vector<INDEX> >  leftGraph_, rightGraph_;
       // meaning of tuple: (leftNode1, leftNode2) matched to (rightNode1, rightNode2) with given cost
       std::vector<std::tuple<INDEX,INDEX,INDEX,INDEX,REAL>> pairwise_potentials;
+
+      template<class ARCHIVE> void serialize(ARCHIVE& ar) { ar(assignment_, leftGraph_, rightGraph_, pairwise_potentials); }
    };
 
    // first two integers are number of left nodes, number of right nodes, then comes number of assignments, and then number of quadratic terms
@@ -576,37 +618,13 @@ namespace TorresaniEtAlInput {
          std::swap(index1,index2);
       }
 
-      const INDEX leftDim = graph[node1].size()+1;
-      const INDEX rightDim = graph[node2].size()+1;
-
-      // initialize empty pairwise cost with infinity on diagonal
-      if(q.find(std::make_pair(node1,node2)) == q.end()) {
-         matrix<REAL> cost(leftDim, rightDim, 0.0);
-         
-         for(INDEX i1=0; i1<graph[node1].size(); ++i1) {
-            for(INDEX i2=0; i2<graph[node2].size(); ++i2) {
-               if(graph[node1][i1] == graph[node2][i2]) {
-                  //cost(i1, i2) = std::numeric_limits<REAL>::infinity();
-               }
-            }
-         }
-         q.insert(std::make_pair(std::make_pair(node1,node2), std::move(cost)));
-      }
-
-      // now add specific cost
-      assert(q.find(std::make_pair(node1,node2)) != q.end());
-      matrix<REAL>& costVec = (*q.find(std::make_pair(node1,node2))).second;
-      // do zrobienia: correct, or transpose?
-      assert(costVec(index1, index2) == 0.0);
-      costVec(index1, index2) = cost;
-      // transposed version
-      //assert(costVec[index1*rightDim + index2] == 0.0);
-      //costVec[index1*rightDim + index2] = cost;
+      // only the given quadratic terms are stored, all other label pairs have zero cost
+      q[std::make_pair(node1,node2)].entries.push_back(std::make_tuple(index1, index2, cost));
    }
 
-   std::map<std::pair<INDEX,INDEX>, matrix<REAL>> BuildLeftPairwisePotentials(const GraphMatchingInput& gmInput, const REAL weight)
+   std::map<std::pair<INDEX,INDEX>, pairwise_sparse_cost> BuildLeftPairwisePotentials(const GraphMatchingInput& gmInput, const REAL weight)
    {
-      std::map<std::pair<INDEX,INDEX>, matrix<REAL>> q;
+      std::map<std::pair<INDEX,INDEX>, pairwise_sparse_cost> q;
       for(auto i : gmInput.pairwise_potentials) {
          const INDEX leftNode1 = std::get<0>(i);
          const INDEX leftNode2 = std::get<1>(i);
@@ -623,9 +641,9 @@ namespace TorresaniEtAlInput {
       }
       return q;
    }
-   std::map<std::pair<INDEX,INDEX>, matrix<REAL>> BuildRightPairwisePotentials(const GraphMatchingInput& gmInput, const REAL weight)
+   std::map<std::pair<INDEX,INDEX>, pairwise_sparse_cost> BuildRightPairwisePotentials(const GraphMatchingInput& gmInput, const REAL weight)
    {
-      std::map<std::pair<INDEX,INDEX>, matrix<REAL>> q;
+      std::map<std::pair<INDEX,INDEX>, pairwise_sparse_cost> q;
       for(auto i : gmInput.pairwise_potentials) {
          const INDEX leftNode1 = std::get<0>(i);
          const INDEX leftNode2 = std::get<1>(i);
@@ -654,7 +672,7 @@ namespace TorresaniEtAlInput {
 
       // construct pairwise potentials of mrfs
       if(pairwise_weight > 0) {
-         std::map<std::pair<INDEX,INDEX>, matrix<REAL>> leftQuadraticPot = BuildLeftPairwisePotentials(gmInput, pairwise_weight);
+         std::map<std::pair<INDEX,INDEX>, pairwise_sparse_cost> leftQuadraticPot = BuildLeftPairwisePotentials(gmInput, pairwise_weight);
          for(auto& q : leftQuadraticPot) {
             auto p = left_mrf.AddPairwiseFactor(q.first.first, q.first.second, q.second);
          }
@@ -671,7 +689,7 @@ namespace TorresaniEtAlInput {
 
       // construct pairwise potentials of mrfs
       if(pairwise_weight > 0) {
-         std::map<std::pair<INDEX,INDEX>, matrix<REAL>> rightQuadraticPot = BuildRightPairwisePotentials(gmInput, pairwise_weight);
+         std::map<std::pair<INDEX,INDEX>, pairwise_sparse_cost> rightQuadraticPot = BuildRightPairwisePotentials(gmInput, pairwise_weight);
          for(auto& q : rightQuadraticPot) {
             auto p = right_mrf.AddPairwiseFactor(q.first.first, q.first.second, q.second);
          }
@@ -832,6 +850,45 @@ namespace TorresaniEtAlInput {
       }
    }
 
+   // add assignment factor solved by auction, but assume graphical model has already been built.
+   // Cost entries of the assignment factor are ordered as in construct_mcf: assignment edges, slack of left nodes, slack of right nodes.
+   template<typename SOLVER>
+   void construct_assignment(SOLVER& s, GraphMatchingInput& gm_input)
+   {
+      using FMC = typename SOLVER::FMC;
+      const INDEX no_left_nodes = std::accumulate(gm_input.assignment_.begin(), gm_input.assignment_.end(), 0, [](INDEX no, auto a) { return std::max(no, a.left_node_); }) + 1;
+      const INDEX no_right_nodes = std::accumulate(gm_input.assignment_.begin(), gm_input.assignment_.end(), 0, [](INDEX no, auto a) { return std::max(no, a.right_node_); }) + 1;
+
+      std::vector<std::array<INDEX,2>> edges;
+      edges.reserve(gm_input.assignment_.size());
+      for(const auto& a : gm_input.assignment_) {
+         edges.push_back({a.left_node_, a.right_node_});
+      }
+      const std::vector<REAL> cost(edges.size() + no_left_nodes + no_right_nodes, 0.0);
+      auto* f = new typename FMC::AssignmentFactorContainer(no_left_nodes, no_right_nodes, edges, cost);
+      s.GetLP().AddFactor(f);
+
+      using MessageType = typename FMC::UnaryToAssignmentMessageType;
+      std::vector<std::vector<INDEX>> left_edges(no_left_nodes);
+      std::vector<std::vector<INDEX>> right_edges(no_right_nodes);
+      for(INDEX e=0; e<edges.size(); ++e) {
+         left_edges[edges[e][0]].push_back(e);
+         right_edges[edges[e][1]].push_back(e);
+      }
+      auto& mrf_left = s.template GetProblemConstructor<0>();
+      for(INDEX i=0; i<no_left_nodes; ++i) {
+         left_edges[i].push_back(edges.size() + i);
+         auto* m = new typename FMC::UnaryToAssignmentMessageContainer(MessageType(left_edges[i]), mrf_left.GetUnaryFactor(i), f);
+         s.GetLP().AddMessage(m);
+      }
+      auto& mrf_right = s.template GetProblemConstructor<1>();
+      for(INDEX i=0; i<no_right_nodes; ++i) {
+         right_edges[i].push_back(edges.size() + no_left_nodes + i);
+         auto* m = new typename FMC::UnaryToAssignmentMessageContainer(MessageType(right_edges[i]), mrf_right.GetUnaryFactor(i), f);
+         s.GetLP().AddMessage(m);
+      }
+   }
+
    /*
    template<typename FMC>
    void construct_mcf(SOLVER& s, GraphMatchingInput& gm_input)
@@ -992,29 +1049,189 @@ namespace TorresaniEtAlInput {
    }
 
    
+   // fast path for the grammar above without PEGTL: the file is memory-mapped and split at line boundaries.
+   // Chunks are parsed in parallel into per-chunk assignment and edge lists, which are then concatenated in file order.
+   // Returns false for any line it does not recognize, the PEGTL grammar is then used to report the error.
+   namespace fast_parser {
+
+      struct chunk {
+         std::vector<GraphMatchingInput::Assignment> assignments;
+         INDEX first_assignment_no = 0;
+         // assignment numbers and cost of quadratic terms
+         std::vector<std::tuple<INDEX,INDEX,REAL>> quadratic_pots;
+      };
+
+      inline bool parse_line(const char* p, const char* end, chunk& c)
+      {
+         using namespace Parsing;
+         skip_blanks(p, end);
+         if(at_line_end(p, end)) { return true; }
+         if(*p == 'a') {
+            ++p;
+            INDEX assignment_no, left_node, right_node;
+            REAL cost;
+            if(!(mand_blanks(p, end) && parse_index(p, end, assignment_no) &&
+                 mand_blanks(p, end) && parse_index(p, end, left_node) &&
+                 mand_blanks(p, end) && parse_index(p, end, right_node) &&
+                 mand_blanks(p, end) && parse_real(p, end, cost) &&
+                 at_line_end(p, end))) {
+               return false;
+            }
+            // assignments must be numbered consecutively
+            if(c.assignments.empty()) {
+               c.first_assignment_no = assignment_no;
+            } else if(assignment_no != c.first_assignment_no + c.assignments.size()) {
+               return false;
+            }
+            c.assignments.push_back({left_node, right_node, cost});
+            return true;
+         }
+         if(*p == 'e') {
+            ++p;
+            INDEX assignment1, assignment2;
+            REAL cost;
+            if(!(mand_blanks(p, end) && parse_index(p, end, assignment1) &&
+                 mand_blanks(p, end) && parse_index(p, end, assignment2) &&
+                 mand_blanks(p, end) && parse_real(p, end, cost) &&
+                 at_line_end(p, end))) {
+               return false;
+            }
+            c.quadratic_pots.push_back(std::make_tuple(assignment1, assignment2, cost));
+            return true;
+         }
+         if(*p == 'c') { return true; }
+         // neighbor and coordinate lines are not used
+         if(end - p >= 2 && (p[0] == 'n' || p[0] == 'i') && (p[1] == '0' || p[1] == '1')) { return true; }
+         return false;
+      }
+
+      inline bool parse(const char* begin, const char* end, GraphMatchingInput& gmInput)
+      {
+         using namespace Parsing;
+         // comment lines and init line are read sequentially
+         const char* p = begin;
+         INDEX no_left_nodes, no_right_nodes, no_assignments, no_quadratic_pots;
+         for(;; p = next_line(p, end)) {
+            if(p == end) { return false; }
+            const char* l = p;
+            const char* l_end = line_end(p, end);
+            skip_blanks(l, l_end);
+            if(l != l_end && *l == 'c') { continue; }
+            if(l == l_end || *l != 'p') { return false; }
+            ++l;
+            if(!(mand_blanks(l, l_end) && parse_index(l, l_end, no_left_nodes) &&
+                 mand_blanks(l, l_end) && parse_index(l, l_end, no_right_nodes) &&
+                 mand_blanks(l, l_end) && parse_index(l, l_end, no_assignments) &&
+                 mand_blanks(l, l_end) && parse_index(l, l_end, no_quadratic_pots) &&
+                 at_line_end(l, l_end))) {
+               return false;
+            }
+            p = next_line(p, end);
+            break;
+         }
+
+         const INDEX no_chunks = std::max(INDEX(1), std::min(parsing_threads(), INDEX((end - p)/(1 << 16) + 1)));
+         const auto boundaries = split_lines(p, end, no_chunks);
+         std::vector<chunk> chunks(no_chunks);
+         std::vector<unsigned char> chunk_valid(no_chunks, 1);
+#pragma omp parallel for schedule(static,1)
+         for(INDEX c=0; c<no_chunks; ++c) {
+            auto& ch = chunks[c];
+            ch.assignments.reserve(no_assignments/no_chunks + 1);
+            ch.quadratic_pots.reserve(no_quadratic_pots/no_chunks + 1);
+            for(const char* l = boundaries[c]; l != boundaries[c+1]; l = next_line(l, boundaries[c+1])) {
+               if(!parse_line(l, line_end(l, boundaries[c+1]), ch)) {
+                  chunk_valid[c] = 0;
+                  break;
+               }
+            }
+         }
+         if(std::find(chunk_valid.begin(), chunk_valid.end(), 0) != chunk_valid.end()) { return false; }
+
+         // concatenate in file order
+         std::vector<INDEX> pot_offset(no_chunks+1, 0);
+         INDEX total_assignments = 0;
+         for(INDEX c=0; c<no_chunks; ++c) {
+            if(!chunks[c].assignments.empty() && chunks[c].first_assignment_no != total_assignments) { return false; }
+            total_assignments += chunks[c].assignments.size();
+            pot_offset[c+1] = pot_offset[c] + chunks[c].quadratic_pots.size();
+         }
+
+         gmInput.leftGraph_.resize(no_left_nodes);
+         gmInput.rightGraph_.resize(no_right_nodes);
+         gmInput.assignment_.reserve(total_assignments);
+         for(const auto& ch : chunks) {
+            for(const auto& a : ch.assignments) {
+               if(a.left_node_ >= no_left_nodes || a.right_node_ >= no_right_nodes) {
+                  throw std::runtime_error("assignment " + std::to_string(gmInput.assignment_.size()) + " refers to a non-existing node");
+               }
+               gmInput.leftGraph_[a.left_node_].push_back(a.right_node_);
+               gmInput.rightGraph_[a.right_node_].push_back(a.left_node_);
+               gmInput.assignment_.push_back(a);
+            }
+         }
+
+         gmInput.pairwise_potentials.resize(pot_offset.back());
+         bool valid_pots = true;
+#pragma omp parallel for schedule(static,1) reduction(&&:valid_pots)
+         for(INDEX c=0; c<no_chunks; ++c) {
+            for(INDEX k=0; k<chunks[c].quadratic_pots.size(); ++k) {
+               const INDEX assignment1 = std::get<0>(chunks[c].quadratic_pots[k]);
+               const INDEX assignment2 = std::get<1>(chunks[c].quadratic_pots[k]);
+               if(assignment1 >= total_assignments || assignment2 >= total_assignments) {
+                  valid_pots = false;
+                  continue;
+               }
+               const auto& a1 = gmInput.assignment_[assignment1];
+               const auto& a2 = gmInput.assignment_[assignment2];
+               gmInput.pairwise_potentials[pot_offset[c] + k] = std::make_tuple(a1.left_node_, a2.left_node_, a1.right_node_, a2.right_node_, std::get<2>(chunks[c].quadratic_pots[k]));
+            }
+         }
+         if(!valid_pots) {
+            throw std::runtime_error("quadratic term refers to a non-existing assignment");
+         }
+         return true;
+      }
+
+   } // end namespace fast_parser
+
    GraphMatchingInput ParseFile(const std::string& filename)
    {
-      GraphMatchingInput gmInput;
-      pegtl::file_parser problem(filename);
       std::cout << "parsing " << filename << "\n";
-
-      for(auto& edges : gmInput.leftGraph_) {
-              assert(std::is_sorted(edges.begin(), edges.end()));
-      }
-      for(auto& edges : gmInput.rightGraph_) {
-              assert(std::is_sorted(edges.begin(), edges.end()));
+      {
+         GraphMatchingInput gmInput;
+         snapshot::mapped_file file(filename);
+         if(fast_parser::parse(file.data(), file.data() + file.size(), gmInput)) {
+            return gmInput;
+         }
       }
+
+      std::cout << "fast parser failed, validating with the full grammar\n";
+      GraphMatchingInput gmInput;
+      pegtl::file_parser problem(filename);
       const bool ret = problem.parse< grammar, action >( gmInput );
       if(!ret) {
          throw std::runtime_error("could not read file " + filename);
       }
-      return std::move(gmInput);
+      return gmInput;
+   }
+
+   // parse filename or read it if it is a snapshot
+   template<typename SOLVER>
+   GraphMatchingInput ReadInput(const std::string& filename, SOLVER& s)
+   {
+      GraphMatchingInput gmInput;
+      snapshot::read_or_parse(filename, "torresani_et_al", s, gmInput, [](const std::string& filename, GraphMatchingInput& gmInput) {
+         gmInput = ParseFile(filename);
+         return true;
+      });
+      return gmInput;
    }
 
    template<typename SOLVER>
    bool ParseProblemGM(const std::string& filename, SOLVER& s)
    {
-      auto input = ParseFile(filename);
+      auto input = ReadInput(filename, s);
       construct_gm( s, input );
       return true;
    }
@@ -1022,7 +1239,7 @@ namespace TorresaniEtAlInput {
    template<typename SOLVER>
    bool ParseProblemMP(const std::string& filename, SOLVER& s)
    {
-      auto input = ParseFile(filename);
+      auto input = ReadInput(filename, s);
       construct_gm( s, input );
       construct_mp( s, input );
       return true;
@@ -1031,19 +1248,29 @@ namespace TorresaniEtAlInput {
    template<typename SOLVER>
    bool ParseProblemMCF(const std::string& filename, SOLVER& s)
    {
-      auto input = ParseFile(filename);
+      auto input = ReadInput(filename, s);
       construct_gm( s, input );
       construct_mp( s, input );
       construct_mcf( s, input );
       return true;
    }
 
+   template<typename SOLVER>
+   bool ParseProblemAuction(const std::string& filename, SOLVER& s)
+   {
+      auto input = ReadInput(filename, s);
+      construct_gm( s, input );
+      construct_mp( s, input );
+      construct_assignment( s, input );
+      return true;
+   }
+
    template<typename SOLVER>
    bool ParseProblemHungarian(const std::string& filename, SOLVER& s)
    {
-      auto input = ParseFile(filename);
+      auto input = ReadInput(filename, s);
       construct_gm( s, input );
-      construct_mcf( s, input );
+      construct_assignment( s, input );
       return true;
    }
 
@@ -0,0 +1,11 @@
+
+#include "graph_matching.h"
+#include "visitors/standard_visitor.hxx"
+int main(int argc, char* argv[])
+
+{
+MpRoundingSolver<Solver<FMC_AUCTION<PairwiseConstruction::BothSides>,LP,StandardTighteningVisitor>> solver(argc,argv);
+solver.ReadProblem(TorresaniEtAlInput::ParseProblemAuction<Solver<FMC_AUCTION<PairwiseConstruction::BothSides>,LP,StandardTighteningVisitor>>);
+return solver.Solve();
+
+}
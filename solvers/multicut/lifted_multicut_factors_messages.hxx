@@ -29,7 +29,7 @@ public:
    {
       assert(noCutEdges_ > 0);
       assert(noLiftedEdges_ > 0);
-      return cutEdgeContrib_ + liftedEdgeContrib_ + std::max(0.0,std::min(liftedEdgeForcedContrib_,-maxCutEdgeVal_));
+      return cutEdgeContrib_ + liftedEdgeContrib_ + std::max(REAL(0.0),std::min(liftedEdgeForcedContrib_,-maxCutEdgeVal_));
 
 
       //std::cout << "lifted factor repam: ";
@@ -48,15 +48,15 @@ public:
       REAL cutEdgeContrib = 0.0;
       for(INDEX i=0; i<noCutEdges_; ++i) {
          maxCutEdgeVal = std::max(maxCutEdgeVal, (*this)[i]);
-         cutEdgeContrib += std::min(0.0,(*this)[i]);
+         cutEdgeContrib += std::min(REAL(0.0),(*this)[i]);
       }
 
       // do zrobienia: start at index 1, initialize with zero value
       REAL liftedEdgeContrib = 0.0; // the value which the lifted edge can contribute to the lower bound
       REAL liftedEdgeForcedContrib = 0.0;
       for(INDEX i=0; i<noLiftedEdges_; ++i) {
-         liftedEdgeContrib += std::min(0.0,(*this)[i + noCutEdges_]);
-         liftedEdgeForcedContrib += std::max(0.0,(*this)[i + noCutEdges_]);
+         liftedEdgeContrib += std::min(REAL(0.0),(*this)[i + noCutEdges_]);
+         liftedEdgeForcedContrib += std::max(REAL(0.0),(*this)[i + noCutEdges_]);
       }
 
       assert(std::abs(liftedEdgeContrib - liftedEdgeContrib_) < eps);
@@ -65,7 +65,7 @@ public:
       assert(std::abs(cutEdgeContrib - cutEdgeContrib_) < eps);
 
       // all one <=> maxCutEdgeVal <= 0
-      return cutEdgeContrib + liftedEdgeContrib + std::max(0.0,std::min(liftedEdgeForcedContrib,-maxCutEdgeVal));
+      return cutEdgeContrib + liftedEdgeContrib + std::max(REAL(0.0),std::min(liftedEdgeForcedContrib,-maxCutEdgeVal));
 
    }
 
@@ -107,8 +107,8 @@ public:
       assert(c < noCutEdges_);
 
       const INDEX edgeIndex = c;
-      if((*this)[edgeIndex] < maxCutEdgeVal_ || liftedEdgeForcedContrib_ <= -maxCutEdgeVal_) { // do zrobienia: take into account std::max(0.0,...)
-         return (*this)[edgeIndex] + std::max(0.0,std::min(liftedEdgeForcedContrib_,-maxCutEdgeVal_));
+      if((*this)[edgeIndex] < maxCutEdgeVal_ || liftedEdgeForcedContrib_ <= -maxCutEdgeVal_) { // do zrobienia: take into account std::max(REAL(0.0),...)
+         return (*this)[edgeIndex] + std::max(REAL(0.0),std::min(liftedEdgeForcedContrib_,-maxCutEdgeVal_));
       } else { // we must recompute maxCutEdgeVal_ without the active repam value
          REAL maxCutEdgeValExcl = -std::numeric_limits<REAL>::max();
          for(INDEX i=0; i<noCutEdges_; ++i) {
@@ -116,13 +116,13 @@ public:
                maxCutEdgeValExcl = std::max(maxCutEdgeValExcl, (*this)[i]);
             }
          }
-         return (*this)[edgeIndex] + std::max(0.0,std::min(liftedEdgeForcedContrib_,-maxCutEdgeValExcl));
+         return (*this)[edgeIndex] + std::max(REAL(0.0),std::min(liftedEdgeForcedContrib_,-maxCutEdgeValExcl));
       }
       assert(false);
 
       //const INDEX edgeIndex = c;
-      //const REAL zeroAssignment = cutEdgeContrib - std::min(0.0,repam[edgeIndex]) + liftedEdgeContrib; // no constraints need to be considered, as all are automatically satisfied
-      //const REAL oneAssignment = cutEdgeContrib - std::min(0.0,repam[edgeIndex]) + repam[edgeIndex] + liftedEdgeContrib + std::max(0.0,std::min(liftedEdgeForcedContrib,-maxCutEdgeValExcl_[edgeIndex]));
+      //const REAL zeroAssignment = cutEdgeContrib - std::min(REAL(0.0),repam[edgeIndex]) + liftedEdgeContrib; // no constraints need to be considered, as all are automatically satisfied
+      //const REAL oneAssignment = cutEdgeContrib - std::min(REAL(0.0),repam[edgeIndex]) + repam[edgeIndex] + liftedEdgeContrib + std::max(REAL(0.0),std::min(liftedEdgeForcedContrib,-maxCutEdgeValExcl_[edgeIndex]));
       //return oneAssignment - zeroAssignment;
  
 
@@ -133,7 +133,7 @@ public:
       for(INDEX i=0; i<noCutEdges_; ++i) {
          if(i != c) {
             maxCutEdgeVal = std::max(maxCutEdgeVal, repam[i]);
-            cutEdgeContrib += std::min(0.0,repam[i]);
+            cutEdgeContrib += std::min(REAL(0.0),repam[i]);
          }
       }
 
@@ -141,15 +141,15 @@ public:
       REAL liftedEdgeContrib = 0.0; // the value which the lifted edge can contribute to the lower bound
       REAL liftedEdgeForcedContrib = 0.0;
       for(INDEX i=0; i<noLiftedEdges_; ++i) {
-         liftedEdgeContrib += std::min(0.0,repam[i + noCutEdges_]);
-         liftedEdgeForcedContrib += std::max(0.0,repam[i + noCutEdges_]);
+         liftedEdgeContrib += std::min(REAL(0.0),repam[i + noCutEdges_]);
+         liftedEdgeForcedContrib += std::max(REAL(0.0),repam[i + noCutEdges_]);
       }
 
 
       // approach: compute the cost for assignment =1 and assignment -0 of current variable c and let change be difference of those two values
       const REAL zeroAssignment = cutEdgeContrib + liftedEdgeContrib; // no constraints need to be considered, as all are automatically satisfied
-      const REAL oneAssignment = cutEdgeContrib + repam[edgeIndex] + liftedEdgeContrib + std::max(0.0,std::min(liftedEdgeForcedContrib,-maxCutEdgeVal));
-      const REAL diff = repam[edgeIndex] + std::max(0.0,std::min(liftedEdgeForcedContrib,-maxCutEdgeVal));
+      const REAL oneAssignment = cutEdgeContrib + repam[edgeIndex] + liftedEdgeContrib + std::max(REAL(0.0),std::min(liftedEdgeForcedContrib,-maxCutEdgeVal));
+      const REAL diff = repam[edgeIndex] + std::max(REAL(0.0),std::min(liftedEdgeForcedContrib,-maxCutEdgeVal));
       assert(std::abs(oneAssignment - zeroAssignment - diff) < eps);
       return diff;
       */ 
@@ -163,29 +163,29 @@ public:
       assert(c >= noCutEdges_);
       const INDEX edgeIndex = c;
 
-      return (*this)[edgeIndex] + std::min(0.0,maxCutEdgeVal_) + std::max(0.0,std::min(liftedEdgeForcedContrib_ - std::max(0.0,(*this)[edgeIndex]),-maxCutEdgeVal_));
+      return (*this)[edgeIndex] + std::min(REAL(0.0),maxCutEdgeVal_) + std::max(REAL(0.0),std::min(liftedEdgeForcedContrib_ - std::max(REAL(0.0),(*this)[edgeIndex]),-maxCutEdgeVal_));
 
       /*
       REAL maxCutEdgeVal = -std::numeric_limits<REAL>::max();
       REAL cutEdgeContrib = 0.0;
       for(INDEX i=0; i<noCutEdges_; ++i) {
          maxCutEdgeVal = std::max(maxCutEdgeVal, repam[i]);
-         cutEdgeContrib += std::min(0.0,repam[i]);
+         cutEdgeContrib += std::min(REAL(0.0),repam[i]);
       }
 
       REAL liftedEdgeContrib = 0.0; // the value which the lifted edge can contribute to the lower bound
       REAL liftedEdgeForcedContrib = 0.0;
       for(INDEX i=0; i<noLiftedEdges_; ++i) {
          if(i + noCutEdges_ != c) {
-            liftedEdgeContrib += std::min(0.0,repam[i + noCutEdges_]);
-            liftedEdgeForcedContrib += std::max(0.0,repam[i + noCutEdges_]);
+            liftedEdgeContrib += std::min(REAL(0.0),repam[i + noCutEdges_]);
+            liftedEdgeForcedContrib += std::max(REAL(0.0),repam[i + noCutEdges_]);
          }
       }
 
 
-      const REAL zeroAssignment = cutEdgeContrib + liftedEdgeContrib - std::min(0.0,maxCutEdgeVal); // this assignment allows at most noCutEdges_-1 cut edges to be active
-      const REAL oneAssignment = cutEdgeContrib + liftedEdgeContrib + repam[edgeIndex] + std::max(0.0,std::min(liftedEdgeForcedContrib,-maxCutEdgeVal));
-      const REAL diff = repam[edgeIndex] + std::min(0.0,maxCutEdgeVal) + std::max(0.0,std::min(liftedEdgeForcedContrib,-maxCutEdgeVal));
+      const REAL zeroAssignment = cutEdgeContrib + liftedEdgeContrib - std::min(REAL(0.0),maxCutEdgeVal); // this assignment allows at most noCutEdges_-1 cut edges to be active
+      const REAL oneAssignment = cutEdgeContrib + liftedEdgeContrib + repam[edgeIndex] + std::max(REAL(0.0),std::min(liftedEdgeForcedContrib,-maxCutEdgeVal));
+      const REAL diff = repam[edgeIndex] + std::min(REAL(0.0),maxCutEdgeVal) + std::max(REAL(0.0),std::min(liftedEdgeForcedContrib,-maxCutEdgeVal));
       assert(std::abs(oneAssignment - zeroAssignment - diff) < eps);
       return oneAssignment - zeroAssignment;
       */
@@ -196,10 +196,10 @@ public:
    {
       assert(c < NoCutEdges());
 
-      CutEdgeContrib() -= std::min(0.0,(*this)[c]);
+      CutEdgeContrib() -= std::min(REAL(0.0),(*this)[c]);
       const REAL prevRepam = (*this)[c];
       (*this)[c] += msg; 
-      CutEdgeContrib() += std::min(0.0,(*this)[c]);
+      CutEdgeContrib() += std::min(REAL(0.0),(*this)[c]);
  
       // update maxCutEdgeVal_, if it needs to be updated.
       if((*this)[c] > MaxCutEdgeVal()) {
@@ -219,11 +219,11 @@ public:
    {
       assert(c < NoLiftedEdges());
 
-      LiftedEdgeContrib() -= std::min(0.0,(*this)[c]);
-      LiftedEdgeForcedContrib() -= std::max(0.0,(*this)[c]);
+      LiftedEdgeContrib() -= std::min(REAL(0.0),(*this)[c]);
+      LiftedEdgeForcedContrib() -= std::max(REAL(0.0),(*this)[c]);
       (*this)[c] += msg; 
-      LiftedEdgeContrib() += std::min(0.0,(*this)[c]);
-      LiftedEdgeForcedContrib() += std::max(0.0,(*this)[c]);
+      LiftedEdgeContrib() += std::min(REAL(0.0),(*this)[c]);
+      LiftedEdgeForcedContrib() += std::max(REAL(0.0),(*this)[c]);
    }
 
    // statistics with which evaluation is fast.
@@ -237,7 +237,7 @@ public:
 
    void init_primal() {}
    template<typename ARCHIVE> void serialize_dual(ARCHIVE& ar) { ar( *static_cast<repam_storage*>(this) ); ar( maxCutEdgeVal_, cutEdgeContrib_, liftedEdgeContrib_, liftedEdgeForcedContrib_ ); } 
-   template<typename ARCHIVE> void primal_serialize(ARCHIVE& ar) { ar( primal_ ); }
+   template<typename ARCHIVE> void serialize_primal(ARCHIVE& ar) { ar( primal_ ); }
 
 private:
    std::vector<bool> primal_;
@@ -286,16 +286,16 @@ public:
    void RepamRight(G& repamPot, const REAL msg, const INDEX msg_dim)
    {
       assert(msg_dim == 0);
-      //const REAL cutEdgeContribDiff = -std::min(0.0,repamPot[i_]) + std::min(0.0,msg);
+      //const REAL cutEdgeContribDiff = -std::min(REAL(0.0),repamPot[i_]) + std::min(REAL(0.0),msg);
       //repamPot.GetFactor()->CutEdgeContrib() += cutEdgeContribDiff;
       
       repamPot.update_cut_edge_contrib(i_, msg);
       return;
 
-      repamPot.CutEdgeContrib() -= std::min(0.0,repamPot[i_]);
+      repamPot.CutEdgeContrib() -= std::min(REAL(0.0),repamPot[i_]);
       const REAL prevRepam = repamPot[i_];
       repamPot[i_] += msg; 
-      repamPot.CutEdgeContrib() += std::min(0.0,repamPot[i_]);
+      repamPot.CutEdgeContrib() += std::min(REAL(0.0),repamPot[i_]);
  
       // update maxCutEdgeVal_, if it needs to be updated.
       if(repamPot[i_] > repamPot.MaxCutEdgeVal()) {
@@ -361,18 +361,18 @@ public:
    void RepamRight(G& repamPot, const REAL msg, const INDEX msg_dim)
    {
       assert(msg_dim == 0);
-      //const REAL liftedEdgeContribDiff = -std::min(0.0,repamPot[i_]) + std::min(0.0,msg);
+      //const REAL liftedEdgeContribDiff = -std::min(REAL(0.0),repamPot[i_]) + std::min(REAL(0.0),msg);
       //repamPot.GetFactor()->LiftedEdgeContrib() += liftedEdgeContribDiff;
-      //const REAL liftedEdgeForcedContribDiff = -std::max(0.0,repamPot[i_]) + std::max(0.0,msg);
+      //const REAL liftedEdgeForcedContribDiff = -std::max(REAL(0.0),repamPot[i_]) + std::max(REAL(0.0),msg);
       //repamPot.GetFactor()->LiftedEdgeForcedContrib() += liftedEdgeForcedContribDiff;
       repamPot.update_lifted_edge_contrib(i_, msg);
       return;
 
-      repamPot.GetFactor()->LiftedEdgeContrib() -= std::min(0.0,repamPot[i_]);
-      repamPot.GetFactor()->LiftedEdgeForcedContrib() -= std::max(0.0,repamPot[i_]);
+      repamPot.GetFactor()->LiftedEdgeContrib() -= std::min(REAL(0.0),repamPot[i_]);
+      repamPot.GetFactor()->LiftedEdgeForcedContrib() -= std::max(REAL(0.0),repamPot[i_]);
       repamPot[i_] += msg; 
-      repamPot.GetFactor()->LiftedEdgeContrib() += std::min(0.0,repamPot[i_]);
-      repamPot.GetFactor()->LiftedEdgeForcedContrib() += std::max(0.0,repamPot[i_]);
+      repamPot.GetFactor()->LiftedEdgeContrib() += std::min(REAL(0.0),repamPot[i_]);
+      repamPot.GetFactor()->LiftedEdgeForcedContrib() += std::max(REAL(0.0),repamPot[i_]);
    }
 
     template<typename LEFT_FACTOR, typename RIGHT_FACTOR>
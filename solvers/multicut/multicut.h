@@ -20,11 +20,11 @@
 #include "parse_rules.h"
 
 #include "hdf5_routines.hxx"
+#include "hdf5_stream.hxx"
+#include "flat_hash_map.hxx"
 
 #include "andres/graph/graph.hxx"
 #include "andres/graph/grid-graph.hxx"
-#include "andres/graph/hdf5/graph.hxx"
-#include "andres/graph/hdf5/grid-graph.hxx"
 #include "andres/functional.hxx"
 #include "andres/graph/multicut-lifted/kernighan-lin.hxx"
 
@@ -92,6 +92,11 @@ struct FMC_ODD_WHEEL_MULTICUT {
    using ProblemDecompositionList = meta::list<multicut_cow>;
 };
 
+template<MessageSendingType MESSAGE_SENDING>
+struct multicut_multilevel_enabled<FMC_MULTICUT<MESSAGE_SENDING>> : std::true_type {};
+template<MessageSendingType MESSAGE_SENDING>
+struct multicut_multilevel_enabled<FMC_ODD_WHEEL_MULTICUT<MESSAGE_SENDING>> : std::true_type {};
+
 struct FMC_LIFTED_MULTICUT {
    constexpr static const char* name = "Lifted Multicut with cycle constraints";
    constexpr static MessageSendingType MESSAGE_SENDING = MessageSendingType::SRMP;
@@ -198,6 +203,8 @@ struct FMC_MULTIWAY_CUT {
 
 namespace MulticutOpenGmInput {
 
+   constexpr std::size_t edgeBlockSize = 1 << 16; // edges read at once
+
    INDEX GetDimension(const hid_t handle, const std::string datasetName) 
    {
       auto dataset = H5Dopen(handle, datasetName.c_str(), H5P_DEFAULT);
@@ -275,54 +282,44 @@ namespace MulticutOpenGmInput {
       std::cout << "Has " << numberOfVariables << " variables\n";
 
       // second, read edges in graph in 'factors' in chunks of 5. (${factorNo},1,2,${i1},${i2}), where (i1,i2) is the edge
+      // third, read edge costs in 'function-id-...16006' in chunks of two. (${x1},${x2}) -> the edge cost is x1-x2 plus some global offset, if x1 != 0
+      // Both are streamed block by block, edge factors are created as blocks arrive.
       // note: we must double check the datatype here
       static_assert(sizeof(size_t) == 8,"HDF5 file format has 64 bits for integers");
-      auto factor = ReadVector<size_t>(gmHandle, "factors");
-      std::vector<std::tuple<INDEX,INDEX,REAL>> edges;
-      for(INDEX i=0; i<factor.size()/5; ++i) {
-         const INDEX factorNo = factor[5*i];
-         const INDEX one = factor[5*i+1];
-         const INDEX two = factor[5*i+2];
-         const INDEX i1 = factor[5*i+3];
-         const INDEX i2 = factor[5*i+4];
-         assert(i1<i2);
-         edges.push_back(std::make_tuple(i1,i2,0.0));
-      }
-
-      // third, read edge costs in 'function-id-...16006' in chunks of two. (${x1},${x2}) -> the edge cost is x1-x2 plus some global offset, if x1 != 0
       auto functionHandle = H5Gopen(gmHandle, "function-id-16006", H5P_DEFAULT);
       assert(functionHandle >= 0);
-      static_assert(sizeof(REAL) == 8, "HDF5 file format has 64 bits for floats");
-      auto edgeCosts = ReadVector<REAL>(functionHandle,"values");
-      assert(edgeCosts.size()/2 == edges.size());
-      auto& mc = pd.template GetProblemConstructor<0>();
-      for(INDEX i=0; i<edges.size(); ++i) {
-         std::get<2>(edges[i]) = -edgeCosts[2*i] + edgeCosts[2*i+1]; // do zrobienia: use constant factor and add edgeCosts[2*i] to it
-         mc.AddToConstant(edgeCosts[2*i]);
-         //std::get<2>(edges[i]) = edgeCosts[2*i] - edgeCosts[2*i+1];
-      }
-      // note: theoretically, this could be much more complicated, if some factors are shared etc. Then this simple approach above will not work.
-      
-      // fourth, sort the edges by edges. There may be multiple edges (e.g. image-seg dataset). Merge such edges
-      std::sort(edges.begin(), edges.end(), [](auto a, auto b) { return std::get<0>(a) == std::get<0>(b) ? std::get<1>(a) < std::get<1>(b) : std::get<0>(a) < std::get<0>(b); });
-
-
-      for(INDEX i=0; i<edges.size(); ++i) {
-         INDEX i1 = std::get<0>(edges[i]); 
-         INDEX i2 = std::get<1>(edges[i]); 
-         REAL cost = std::get<2>(edges[i]);
-
-         while( i+1 < edges.size() && std::get<0>(edges[i+1]) == i1 && std::get<1>(edges[i+1]) == i2) {
-            cost += std::get<2>(edges[i+1]);
-            ++i;
-         }
-         if(i1 > i2) {
-            assert(false);
-            std::swap(i1,i2);
+      {
+         hdf5_stream<size_t> factorStream(gmHandle, "factors", 5*edgeBlockSize, true);
+         hdf5_stream<REAL> costStream(functionHandle, "values", 2*edgeBlockSize, true);
+         assert(costStream.columns()/2 == factorStream.columns()/5);
+         auto& mc = pd.template GetProblemConstructor<0>();
+         std::vector<size_t> factor;
+         std::vector<REAL> edgeCosts;
+         while(factorStream.next(factor) > 0) {
+            costStream.next(edgeCosts);
+            assert(factor.size()/5 == edgeCosts.size()/2);
+            for(INDEX i=0; i<factor.size()/5; ++i) {
+               INDEX i1 = factor[5*i+3];
+               INDEX i2 = factor[5*i+4];
+               assert(i1<i2);
+               if(i1 > i2) {
+                  std::swap(i1,i2);
+               }
+               const REAL cost = -edgeCosts[2*i] + edgeCosts[2*i+1]; // do zrobienia: use constant factor and add edgeCosts[2*i] to it
+               mc.AddToConstant(edgeCosts[2*i]);
+               // note: theoretically, this could be much more complicated, if some factors are shared etc. Then this simple approach above will not work.
+               // There may be multiple edges (e.g. image-seg dataset). Merge such edges
+               if(mc.HasUnaryFactor(i1,i2)) {
+                  (*mc.GetUnaryFactor(i1,i2)->GetFactor())[0] += cost;
+               } else {
+                  mc.AddUnaryFactor(i1, i2, cost);
+               }
+            }
          }
-         //std::cout << "add edge (" << i1 << "," << i2 << ") with cost " << cost << "\n";
-         mc.AddUnaryFactor(i1, i2, cost);
       }
+      H5Gclose(functionHandle);
+      H5Gclose(gmHandle);
+      H5Fclose(fileHandle);
 
       return true;
    }
@@ -387,10 +384,12 @@ namespace MulticutTextInput {
                     pegtl::eof> {};
 
 
-   // do zrobienia: remove this structure
    struct MulticutInput {
       INDEX numberOfVariables_;
       std::vector<std::tuple<INDEX,INDEX,REAL>> edges_;
+      std::vector<std::tuple<INDEX,INDEX,REAL>> lifted_edges_;
+
+      template<class ARCHIVE> void serialize(ARCHIVE& ar) { ar(numberOfVariables_, edges_, lifted_edges_); }
    };
 
    template<typename SOLVER, typename Rule >
@@ -438,8 +437,7 @@ namespace MulticutTextInput {
          }
          assert(i1 < i2);
          assert(i2 < mcInput.numberOfVariables_);
-         auto& mc = pd.template GetProblemConstructor<0>();
-         mc.AddUnaryFactor( i1,i2,cost );
+         mcInput.edges_.push_back(std::make_tuple(i1,i2,cost));
       }
    };
    template<typename SOLVER> struct action<SOLVER, pegtl::eof> {
@@ -471,77 +469,181 @@ namespace MulticutTextInput {
          }
          assert(i1 < i2);
          assert(i2 < mcInput.numberOfVariables_);
-         auto& mc = pd.template GetProblemConstructor<0>();
-         mc.AddLiftedUnaryFactor( i1,i2,cost );
+         mcInput.lifted_edges_.push_back(std::make_tuple(i1,i2,cost));
       }
    };
 
       
    template<typename SOLVER>
-   bool ParseProblem(const std::string filename, SOLVER& pd)
+   void construct_multicut(SOLVER& pd, const MulticutInput& mcInput)
    {
-      std::stack<SIGNED_INDEX> integer_stack;
-      std::stack<REAL> real_stack;
-      MulticutInput mcInput;
-      std::cout << "parsing " << filename << "\n";
+      auto& mc = pd.template GetProblemConstructor<0>();
+      for(const auto& e : mcInput.edges_) {
+         mc.AddUnaryFactor( std::get<0>(e), std::get<1>(e), std::get<2>(e) );
+      }
+   }
 
-      pegtl::file_parser problem(filename);
+   template<typename SOLVER>
+   void construct_lifted_multicut(SOLVER& pd, const MulticutInput& mcInput)
+   {
+      construct_multicut(pd, mcInput);
+      auto& mc = pd.template GetProblemConstructor<0>();
+      for(const auto& e : mcInput.lifted_edges_) {
+         mc.AddLiftedUnaryFactor( std::get<0>(e), std::get<1>(e), std::get<2>(e) );
+      }
+   }
 
-      return problem.parse< grammar, actionSpecialization<SOLVER>::template type >(pd, integer_stack, real_stack, mcInput);
+   template<typename SOLVER>
+   bool ParseProblem(const std::string filename, SOLVER& pd)
+   {
+      MulticutInput mcInput;
+      const bool success = snapshot::read_or_parse(filename, "multicut", pd, mcInput, [&pd](const std::string& filename, MulticutInput& mcInput) {
+         std::stack<SIGNED_INDEX> integer_stack;
+         std::stack<REAL> real_stack;
+         std::cout << "parsing " << filename << "\n";
+         pegtl::file_parser problem(filename);
+         return problem.parse< grammar, actionSpecialization<SOLVER>::template type >(pd, integer_stack, real_stack, mcInput);
+      });
+      if(success) {
+         construct_multicut(pd, mcInput);
+      }
+      return success;
    }
 
    template<typename SOLVER>
    bool ParseLiftedProblem(const std::string filename, SOLVER& pd)
    {
-      std::stack<SIGNED_INDEX> integer_stack;
-      std::stack<REAL> real_stack;
       MulticutInput mcInput;
-      std::cout << "parsing " << filename << "\n";
-
-      pegtl::file_parser problem(filename);
-      return problem.parse< LiftedMulticutGrammar, actionSpecialization<SOLVER>::template type >(pd, integer_stack, real_stack, mcInput);
+      const bool success = snapshot::read_or_parse(filename, "lifted_multicut", pd, mcInput, [&pd](const std::string& filename, MulticutInput& mcInput) {
+         std::stack<SIGNED_INDEX> integer_stack;
+         std::stack<REAL> real_stack;
+         std::cout << "parsing " << filename << "\n";
+         pegtl::file_parser problem(filename);
+         return problem.parse< LiftedMulticutGrammar, actionSpecialization<SOLVER>::template type >(pd, integer_stack, real_stack, mcInput);
+      });
+      if(success) {
+         construct_lifted_multicut(pd, mcInput);
+      }
+      return success;
    }
 
 
 } // end namespace MulticutTextInput
 
 // HDF5 input as in data of Andres et al.
+// Graphs are stored in groups with a dataset "edges" of shape 2 x (number of edges), grid graphs in groups with a dataset "shape".
+// Edges and cut probabilities of the lifted graph are streamed block by block and are never held in memory.
+// Telling original from lifted edges needs the original graph: grid graphs are recognized from their shape, but for general graphs all original edges are kept in a hash set of node pairs, hence memory grows with the size of the original graph.
 namespace MulticutH5Input {
 
+   constexpr std::size_t edgeBlockSize = 1 << 16; // edges read at once
+
+   // andres::graph::GridGraph<2>: vertex (x0,x1) has index x0 + shape[0]*x1, edges join vertices differing by one in exactly one coordinate
+   class grid_graph_edges {
+   public:
+      grid_graph_edges(const hid_t fileHandle, const std::string& graphName)
+      {
+         const hdf5_handle graphHandle(H5Gopen(fileHandle, graphName.c_str(), H5P_DEFAULT), H5Gclose);
+         if(!graphHandle.valid()) {
+            throw std::runtime_error("cannot open HDF5 group " + graphName);
+         }
+         hdf5_stream<std::size_t> shapeStream(graphHandle, "shape", 2);
+         std::vector<std::size_t> shape;
+         if(shapeStream.columns() != 2 || shapeStream.next(shape) != 2) {
+            throw std::runtime_error("grid graph " + graphName + " is not two-dimensional");
+         }
+         width_ = shape[0];
+      }
+
+      bool has_edge(const std::size_t i, const std::size_t j) const
+      {
+         const std::size_t lo = std::min(i,j);
+         const std::size_t hi = std::max(i,j);
+         return (hi - lo == 1 && hi % width_ != 0) || hi - lo == width_;
+      }
+
+   private:
+      std::size_t width_;
+   };
+
+   // edges of an andres::graph::Graph, kept as packed node pairs only. Unlike the lifted graph, the original graph is held in memory in full.
+   class graph_edges {
+   public:
+      graph_edges(const hid_t fileHandle, const std::string& graphName)
+      {
+         const hdf5_handle graphHandle(H5Gopen(fileHandle, graphName.c_str(), H5P_DEFAULT), H5Gclose);
+         if(!graphHandle.valid()) {
+            throw std::runtime_error("cannot open HDF5 group " + graphName);
+         }
+         if(H5Lexists(graphHandle, "edges", H5P_DEFAULT) > 0) {
+            hdf5_stream<std::size_t> edgeStream(graphHandle, "edges", edgeBlockSize, true);
+            assert(edgeStream.rows() == 2);
+            edges_.reserve(edgeStream.columns());
+            std::vector<std::size_t> block;
+            while(const std::size_t n = edgeStream.next(block)) {
+               for(std::size_t e=0; e<n; ++e) {
+                  edges_.insert(std::make_pair(key(block[e], block[n+e]), char(1)));
+               }
+            }
+         }
+      }
+
+      bool has_edge(const std::size_t i, const std::size_t j) const
+      {
+         return edges_.count(key(i,j)) > 0;
+      }
+
+   private:
+      static std::uint64_t key(const std::size_t i, const std::size_t j) { return pack_index_pair(std::min(i,j), std::max(i,j)); }
+      flat_hash_map<std::uint64_t, char> edges_;
+   };
+
    template<typename SOLVER, bool GRID_GRAPH=false>
    bool ParseLiftedProblem(const std::string filename, SOLVER& pd)
    {
       auto& mc = pd.template GetProblemConstructor<0>();
-      
-      using orig_graph_type = typename std::conditional<GRID_GRAPH, andres::graph::GridGraph<2>, andres::graph::Graph<>>::type;
-      orig_graph_type originalGraph;
-      andres::graph::Graph<> liftedGraph;
-      std::vector<REAL> edgeValues;
-
-      auto fileHandle = andres::graph::hdf5::openFile(filename);
-      andres::graph::hdf5::load(fileHandle, "graph", originalGraph);
-      andres::graph::hdf5::load(fileHandle, "graph-lifted", liftedGraph);
-
-      std::vector<size_t> shape;
-      andres::graph::hdf5::load(fileHandle, "edge-cut-probabilities", shape, edgeValues);
-      andres::graph::hdf5::closeFile(fileHandle);
-
-      // transform to energy cost
-      std::transform(edgeValues.begin(), edgeValues.end(), edgeValues.begin(), andres::NegativeLogProbabilityRatio<REAL,REAL>());
-      assert(edgeValues.size() == liftedGraph.numberOfEdges());
-
-      for(std::size_t e=0; e<liftedGraph.numberOfEdges(); ++e) {
-         auto i = liftedGraph.vertexOfEdge(e,0);
-         auto j = liftedGraph.vertexOfEdge(e,1);
-         if(originalGraph.findEdge(i,j).first) {
-            mc.AddUnaryFactor( i, j, edgeValues[e] );
-         }
+
+      // handles are declared before the streams reading from them, hence they are closed after the streams have finished reading ahead
+      const hdf5_handle fileHandle(H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT), H5Fclose);
+      if(!fileHandle.valid()) {
+         throw std::runtime_error("cannot open file " + filename);
       }
-      for(std::size_t e=0; e<liftedGraph.numberOfEdges(); ++e) {
-         auto i = liftedGraph.vertexOfEdge(e,0);
-         auto j = liftedGraph.vertexOfEdge(e,1);
-         if(!originalGraph.findEdge(i,j).first) {
-            mc.AddLiftedUnaryFactor( i, j, edgeValues[e] );
+      {
+         using orig_graph_type = typename std::conditional<GRID_GRAPH, grid_graph_edges, graph_edges>::type;
+         const orig_graph_type originalGraph(fileHandle, "graph");
+
+         const hdf5_handle liftedHandle(H5Gopen(fileHandle, "graph-lifted", H5P_DEFAULT), H5Gclose);
+         if(!liftedHandle.valid()) {
+            throw std::runtime_error("cannot open HDF5 group graph-lifted in " + filename);
+         }
+         hdf5_stream<std::size_t> edgeStream(liftedHandle, "edges", edgeBlockSize, true);
+         hdf5_stream<REAL> probabilityStream(fileHandle, "edge-cut-probabilities", edgeBlockSize, true);
+         assert(edgeStream.rows() == 2);
+         assert(probabilityStream.columns() == edgeStream.columns());
+
+         // transform to energy cost
+         andres::NegativeLogProbabilityRatio<REAL,REAL> cost;
+         std::vector<std::size_t> edges;
+         std::vector<REAL> probabilities;
+         // two passes: edges of the original graph are added first, then the lifted ones
+         for(const bool lifted : {false, true}) {
+            edgeStream.rewind();
+            probabilityStream.rewind();
+            while(const std::size_t n = edgeStream.next(edges)) {
+               probabilityStream.next(probabilities);
+               assert(probabilities.size() == n);
+               for(std::size_t e=0; e<n; ++e) {
+                  const INDEX i = std::min(edges[e], edges[n+e]);
+                  const INDEX j = std::max(edges[e], edges[n+e]);
+                  if(originalGraph.has_edge(i,j) != lifted) {
+                     if(lifted) {
+                        mc.AddLiftedUnaryFactor( i, j, cost(probabilities[e]) );
+                     } else {
+                        mc.AddUnaryFactor( i, j, cost(probabilities[e]) );
+                     }
+                  }
+               }
+            }
          }
       }
       return true;
@@ -2,17 +2,24 @@
 #define LP_MP_MULTICUT_CONSTRUCTOR_HXX
 
 #include "LP_MP.h"
+#include "checkpoint.hxx"
 #include "multicut.h"
 #include "lifted_multicut_factors_messages.hxx"
 
 #include "union_find.hxx"
 #include "graph.hxx"
 #include "max_flow.hxx"
+#include "flat_hash_map.hxx"
+#include "multicut_rounding.hxx"
+#include "multicut_min_cut.hxx"
+#include "multicut_multilevel.hxx"
 
 #include <unordered_map>
+#include <atomic>
 #include <unordered_set>
 #include <queue>
 #include <list>
+#include <limits>
 
 #ifdef LP_MP_PARALLEL
 #include <omp.h>
@@ -20,8 +27,6 @@
 
 #include "andres/graph/graph.hxx"
 #include "andres/graph/grid-graph.hxx"
-#include "andres/graph/multicut/kernighan-lin.hxx"
-#include "andres/graph/multicut/greedy-additive.hxx"
 #include "andres/graph/multicut-lifted/kernighan-lin.hxx"
 #include "andres/graph/multicut-lifted/greedy-additive.hxx"
 
@@ -31,6 +36,25 @@ namespace LP_MP {
 
 // hash function for maps used in constructors. Do zrobienia: define hash functions used somewhere globally in config.hxx
 
+// number of threads in and id of current thread within parallel separation routines, also when compiled without OpenMP
+inline INDEX separation_threads()
+{
+#ifdef LP_MP_PARALLEL
+   return omp_get_max_threads();
+#else
+   return 1;
+#endif
+}
+
+inline INDEX separation_thread_no()
+{
+#ifdef LP_MP_PARALLEL
+   return omp_get_thread_num();
+#else
+   return 0;
+#endif
+}
+
 enum class cut_type { multicut, maxcut };
 
 template<class FACTOR_MESSAGE_CONNECTION, INDEX UNARY_FACTOR_NO, INDEX TRIPLET_FACTOR_NO,
@@ -56,18 +80,21 @@ public:
 
    template<typename SOLVER>
    MulticutConstructor(SOLVER& pd)
-   : lp_(&pd.GetLP())
-   //unaryFactors_(100,hash::array2),
-   //tripletFactors_(100,hash::array3)
+   : lp_(&pd.GetLP()),
+   nativeRoundingArg_(new TCLAP::SwitchArg("","nativeRounding","round with the parallel GAEC and Kernighan&Lin of multicut_gaec_kl instead of those of the andres graph package. Faster on large instances, labelings after GAEC are slightly worse",pd.get_cmd(),false))
    {
-      //unaryFactors_.max_load_factor(0.7);
-      tripletFactors_.max_load_factor(0.7);
       constant_factor_ = new ConstantFactorContainer(0.0);
       pd.GetLP().AddFactor(constant_factor_);
+      static_if<multicut_multilevel_enabled<typename SOLVER::FMC>::value>([&](auto f) {
+            multilevel_.reset(new multicut_multilevel<SOLVER>(f(pd)));
+      });
    }
    MulticutConstructor(const MulticutConstructorType& o)
       : unaryFactors_(o.unaryFactors_),
       unaryFactorsVector_(o.unaryFactorsVector_),
+      edge_heads_(o.edge_heads_),
+      edge_tails_(o.edge_tails_),
+      edge_index_(o.edge_index_),
       tripletFactors_(o.tripletFactors_),
       noNodes_(o.noNodes_),
       constant_factor_(o.constant_factor_), 
@@ -81,18 +108,53 @@ public:
       //static_assert(std::is_same<typename MessageContainer::MessageType, MulticutUnaryTripletMessage<MessageSending::SRMP>>::value,"");
    }
 
+   // called before the first iteration
+   void Begin()
+   {
+      if(nativeRoundingArg_ != nullptr) {
+         rounding_.use_native_gaec_kl(nativeRoundingArg_->getValue());
+      }
+      if(multilevel_ != nullptr) {
+         multilevel_->warm_start();
+      }
+   }
+
    void End() 
    {
       // wait for the primal rounding to finish.
       std::cout << "wait for primal computation to end\n";
-      if(primal_handle_.valid()) {
-         auto labeling = primal_handle_.get();
+      std::vector<char> labeling;
+      if(rounding_.wait(labeling)) {
          write_labeling_into_factors(labeling);
       }
    }
 
    void AddToConstant(const REAL delta) { constant_factor_->GetFactor()->AddToOffset(delta); }
 
+   // factors added by tightening of this and derived constructors, such that they can be restored from checkpoints
+   enum tightening_kind : INDEX { edge_kind, triplet_kind, odd_3_wheel_kind, odd_bicycle_3_wheel_kind, cut_kind, lifted_edge_kind };
+   checkpoint::tightening_log& tightening_log() { return tightening_log_; }
+
+   void replay_tightening(const INDEX kind, const INDEX* begin, const INDEX* end)
+   {
+      switch(kind) {
+         case edge_kind:
+            assert(end - begin == 2);
+            if(!HasUnaryFactor(begin[0], begin[1])) {
+               AddUnaryFactor(begin[0], begin[1], 0.0);
+            }
+            break;
+         case triplet_kind:
+            assert(end - begin == 3);
+            if(!HasTripletFactor(begin[0], begin[1], begin[2])) {
+               AddTripletFactor(begin[0], begin[1], begin[2]);
+            }
+            break;
+         default:
+            throw std::runtime_error("tightening log has unknown factor kind " + std::to_string(kind));
+      }
+   }
+
    bool get_edge_label(const INDEX i0, const INDEX i1) const
    {
       assert(i0 < i1);
@@ -109,25 +171,23 @@ public:
       auto* u = new UnaryFactorContainer();
       (*u->GetFactor())[0] = cost;
       lp_->AddFactor(u);
-      auto it = unaryFactors_.insert(std::make_pair(std::array<INDEX,2>{i1,i2}, u)).first;
+      tightening_log_.record(edge_kind, {i1, i2});
+      unaryFactors_.insert(std::make_pair(pack_index_pair(i1,i2), u));
       unaryFactorsVector_.push_back(std::make_pair(std::array<INDEX,2>{i1,i2}, u));
+      edge_index_.add_edge(i1, i2, unaryFactorsVector_.size()-1);
 
-      //std::cout << "current edge: (" << i1 << "," << i2 << ")";
-      if(it != unaryFactors_.begin()) {
-         auto prevIt = it;
-         --prevIt;
-         //std::cout << ", prev edge: (" << prevIt->first.operator[](0) << "," << prevIt->first.operator[](1) << ")";
-         assert(prevIt->second != u);
-         lp_->AddFactorRelation(prevIt->second, u);
+      // edge factors are ordered lexicographically
+      const INDEX pos = insert_edge_head(i1, i2);
+      auto* prev = preceding_edge_factor(i1, pos);
+      if(prev != nullptr) {
+         assert(prev != u);
+         lp_->AddFactorRelation(prev, u);
       }
-      auto nextIt = it;
-      ++nextIt;
-      if(nextIt != unaryFactors_.end()) {
-         assert(nextIt->second != u);
-         //std::cout << ", next edge: (" << nextIt->first.operator[](0) << "," << nextIt->first.operator[](1) << ")";
-         lp_->AddFactorRelation(u, nextIt->second);
+      auto* next = succeeding_edge_factor(i1, pos);
+      if(next != nullptr) {
+         assert(next != u);
+         lp_->AddFactorRelation(u, next);
       }
-      //std::cout << "\n";
 
       noNodes_ = std::max(noNodes_,std::max(i1,i2)+1);
 
@@ -138,7 +198,7 @@ public:
    }
    UnaryFactorContainer* GetUnaryFactor(const INDEX i1, const INDEX i2) const {
       assert(HasUnaryFactor(i1,i2));
-      return unaryFactors_.find(std::array<INDEX,2>{i1,i2})->second;
+      return unaryFactors_.find(pack_index_pair(i1,i2))->second;
    }
    INDEX number_of_edges() const { return unaryFactors_.size(); }
 
@@ -171,6 +231,7 @@ public:
       assert(HasUnaryFactor(i1,i2) && HasUnaryFactor(i1,i3) && HasUnaryFactor(i2,i3));
       auto* t = new TripletFactorContainer();
       lp_->AddFactor(t);
+      tightening_log_.record(triplet_kind, {i1, i2, i3});
       tripletFactors_.insert(std::make_pair( std::array<INDEX,3>{i1,i2,i3}, t ));
       // use following ordering of unary and triplet factors: triplet comes after edge factor (i1,i2) and before (i2,i3)
       auto* before = GetUnaryFactor(i1,i2);
@@ -195,13 +256,13 @@ public:
    bool HasUnaryFactor(const std::tuple<INDEX,INDEX> e) const 
    {
       assert(std::get<0>(e) < std::get<1>(e));
-      return unaryFactors_.find(std::array<INDEX,2>{std::get<0>(e),std::get<1>(e)}) != unaryFactors_.end();
+      return HasUnaryFactor(std::get<0>(e), std::get<1>(e));
    }
    bool HasUnaryFactor(const INDEX i1, const INDEX i2) const 
    {
       //logger->info() << "Has Unary factor with: " << i1 << ":" << i2;
       assert(i1 < i2);
-      return (unaryFactors_.find(std::array<INDEX,2>{i1,i2}) != unaryFactors_.end());
+      return (unaryFactors_.find(pack_index_pair(i1,i2)) != unaryFactors_.end());
    }
    bool HasTripletFactor(const INDEX i1, const INDEX i2, const INDEX i3) const 
    {
@@ -216,6 +277,14 @@ public:
    }
 
 
+   template<typename FUNC>
+   void for_each_triplet_factor(FUNC f) const
+   {
+      for(const auto& t : tripletFactors_) {
+         f(t.first, t.second);
+      }
+   }
+
    std::tuple<INDEX,INDEX> GetEdge(const INDEX i1, const INDEX i2) const
    {
       return std::make_tuple(std::min(i1,i2), std::max(i1,i2));
@@ -224,7 +293,7 @@ public:
    REAL get_edge_cost(const INDEX i1, const INDEX i2) const
    {
       assert(HasUnaryFactor(i1,i2));
-      return *(unaryFactors_.find(std::array<INDEX,2>{i1,i2})->second->GetFactor());
+      return *(unaryFactors_.find(pack_index_pair(i1,i2))->second->GetFactor());
    }
 
    INDEX NumOfUnaryFactors() const {
@@ -315,123 +384,83 @@ public:
    }
 
 
-   // search for violated triplets, e.g. triplets with one negative edge and two positive ones.
-   INDEX FindViolatedTriplets(const INDEX max_triplets_to_add)
+   // keep the k best elements w.r.t. comp, in no particular order
+   template<typename VECTOR, typename COMPARE>
+   static void keep_best(VECTOR& v, const INDEX k, COMPARE comp)
    {
-      std::vector<INDEX> adjacency_list_count(noNodes_,0);
-      // first determine size for adjacency_list
-      for(auto& it : unaryFactorsVector_) {
-         const INDEX i = std::get<0>(it.first);
-         const INDEX j = std::get<1>(it.first);
-         adjacency_list_count[i]++;
-         adjacency_list_count[j]++; 
-      }
-      two_dim_variable_array<std::tuple<INDEX,REAL>> adjacency_list(adjacency_list_count);
-      std::fill(adjacency_list_count.begin(), adjacency_list_count.end(), 0);
-      for(auto& it : unaryFactorsVector_) {
-         const INDEX i = std::get<0>(it.first);
-         const INDEX j = std::get<1>(it.first);
-         const REAL cost_ij = (*it.second->GetFactor())[0];
-         assert(i<j);
-         adjacency_list[i][adjacency_list_count[i]] = std::make_tuple(j,cost_ij);
-         adjacency_list_count[i]++;
-         adjacency_list[j][adjacency_list_count[j]] = std::make_tuple(i,cost_ij);
-         adjacency_list_count[j]++;
+      if(v.size() > k) {
+         std::nth_element(v.begin(), v.begin() + k, v.end(), comp);
+         v.resize(k);
       }
+   }
 
-      // Sort the adjacency list, for fast intersections later
-      auto adj_sort = [](const auto a, const auto b) { return std::get<0>(a) < std::get<0>(b); };
-
-#pragma omp parallel for schedule(guided)
-      for(int i=0; i < adjacency_list.size(); i++) {
-         std::sort(adjacency_list[i].begin(), adjacency_list[i].end(), adj_sort);
+   // search for violated triplets, e.g. triplets with one negative edge and two positive ones.
+   INDEX FindViolatedTriplets(const INDEX max_triplets_to_add)
+   {
+      edge_index_.update();
+      std::vector<REAL> edge_costs(unaryFactorsVector_.size());
+#pragma omp parallel for
+      for(INDEX e=0; e<unaryFactorsVector_.size(); ++e) {
+         edge_costs[e] = (*unaryFactorsVector_[e].second->GetFactor())[0];
       }
 
-      // Iterate over all of the edge intersection sets
-      // do zrobienia: parallelize
-      // we will intersect two adjacency list by head node, but we want to preserve the costs of either edge pointing to head node
-      using intersection_type = std::tuple<INDEX,REAL,REAL>;
-      auto merge = [](const auto a, const auto b) -> intersection_type { 
-         assert(std::get<0>(a) == std::get<0>(b));
-         return std::make_tuple(std::get<0>(a), std::get<1>(a), std::get<1>(b)); 
-      };
-      std::vector<std::tuple<INDEX,INDEX,INDEX,REAL>> triplet_candidates;
+      using triplet_candidate_type = std::tuple<INDEX,INDEX,INDEX,REAL>;
+      auto candidate_comp = [](const triplet_candidate_type& a, const triplet_candidate_type& b) { return std::get<3>(a) > std::get<3>(b); };
+      // at most max_triplets_to_add+1 triplets are added, hence only so many candidates need to be retained. The +1 must not wrap around for the largest INDEX.
+      const INDEX no_candidates = max_triplets_to_add < std::numeric_limits<INDEX>::max() ? max_triplets_to_add+1 : max_triplets_to_add;
+      // every thread fills its own buffer, hence no synchronization is needed
+      std::vector<std::vector<triplet_candidate_type>> triplet_candidates_per_thread(separation_threads());
 #pragma omp parallel
       {
-         std::vector<intersection_type> commonNodes(noNodes_);
-         std::vector<std::tuple<INDEX,INDEX,INDEX,REAL>> triplet_candidates_per_thread;
+         std::vector<triplet_candidate_type> triplet_candidates;
 #pragma omp for schedule(guided)
          for(INDEX c=0; c<unaryFactorsVector_.size(); ++c) {
-            const REAL cost_ij = (*unaryFactorsVector_[c].second->GetFactor())[0];
             const INDEX i = std::get<0>(unaryFactorsVector_[c].first);
             const INDEX j = std::get<1>(unaryFactorsVector_[c].first);
+            const REAL cost_ij = edge_costs[c];
 
-            // Now find all neighbors of both i and j to see where the triangles are
-            // TEMP TEMP -- fails at i=0, j=1, on i==3.
-            auto intersects_iter_end = set_intersection_merge(adjacency_list[i].begin(), adjacency_list[i].end(), adjacency_list[j].begin(), adjacency_list[j].end(), commonNodes.begin(), adj_sort, merge);
-
-            for(auto n=commonNodes.begin(); n != intersects_iter_end; ++n) {
-               const INDEX k = std::get<0>(*n);
-
-               // Since a triplet shows up three times as an edge plus
-               // a node, we only consider it for the case when i<j<k 
-               if(!(j<k))
-                  continue;
-               const REAL cost_ik = std::get<1>(*n);
-               const REAL cost_jk = std::get<2>(*n);
+            // Since a triplet shows up three times as an edge plus a node, we only consider it for the case when i<j<k
+            edge_index_.for_each_common_neighbor(i, j, [&](const INDEX k, const INDEX e_ik, const INDEX e_jk) {
+               assert(i < j && j < k);
+               const REAL cost_ik = edge_costs[e_ik];
+               const REAL cost_jk = edge_costs[e_jk];
 
+               const REAL lb = std::min(REAL(0.0), cost_ij) + std::min(REAL(0.0), cost_ik) + std::min(REAL(0.0), cost_jk);
+               REAL best_labeling;
                if(CUT_TYPE == cut_type::multicut) {
-                  const REAL lb = std::min(0.0, cost_ij) + std::min(0.0, cost_ik) + std::min(0.0, cost_jk);
-                  const REAL best_labeling = std::min({0.0, cost_ij+cost_ik, cost_ij+cost_jk, cost_ik+cost_jk, cost_ij+cost_ik+cost_jk});
-                  assert(lb <= best_labeling+eps);
-                  const REAL guaranteed_dual_increase = best_labeling - lb;
-                  /*
-                     std::array<REAL,3> c({cost_ij, cost_ik, cost_jk});
-                     const REAL gdi1 = std::min({ -c[0], c[1], c[2] });
-                     const REAL gdi2 = std::min({ c[0], -c[1], c[2] });
-                     const REAL gdi3 = std::min({ c[0], c[1], -c[2] });
-                     const REAL guaranteed_dual_increase = std::max({ gdi1, gdi2, gdi3 });
-                     */
-                  if(guaranteed_dual_increase > 0.0) {
-                     triplet_candidates_per_thread.push_back(std::make_tuple(i,j,k,guaranteed_dual_increase));
-                  } 
-               } else if(CUT_TYPE == cut_type::maxcut) {
-                  const REAL lb = std::min(0.0, cost_ij) + std::min(0.0, cost_ik) + std::min(0.0, cost_jk);
-                  const REAL best_labeling = std::min({0.0, cost_ij+cost_ik, cost_ij+cost_jk, cost_ik+cost_jk});
-                  assert(lb <= best_labeling+eps);
-                  const REAL guaranteed_dual_increase = best_labeling - lb;
-                  if(guaranteed_dual_increase > 0.0) {
-                     triplet_candidates_per_thread.push_back(std::make_tuple(i,j,k,guaranteed_dual_increase));
-                  } 
+                  best_labeling = std::min({REAL(0.0), cost_ij+cost_ik, cost_ij+cost_jk, cost_ik+cost_jk, cost_ij+cost_ik+cost_jk});
+               } else {
+                  assert(CUT_TYPE == cut_type::maxcut);
+                  best_labeling = std::min({REAL(0.0), cost_ij+cost_ik, cost_ij+cost_jk, cost_ik+cost_jk});
                }
-            }
-         }
-#pragma omp critical
-         {
-            triplet_candidates.insert(triplet_candidates.end(), triplet_candidates_per_thread.begin(), triplet_candidates_per_thread.end()); 
+               assert(lb <= best_labeling+eps);
+               const REAL guaranteed_dual_increase = best_labeling - lb;
+               if(guaranteed_dual_increase > 0.0 && !HasTripletFactor(i,j,k)) {
+                  triplet_candidates.push_back(std::make_tuple(i,j,k,guaranteed_dual_increase));
+               }
+            }, j+1);
          }
+         keep_best(triplet_candidates, no_candidates, candidate_comp);
+         triplet_candidates_per_thread[separation_thread_no()] = std::move(triplet_candidates);
       }
-      std::sort(triplet_candidates.begin(), triplet_candidates.end(), [](auto& a, auto& b) { return std::get<3>(a) > std::get<3>(b); });
+
+      std::vector<triplet_candidate_type> triplet_candidates;
+      for(auto& c : triplet_candidates_per_thread) {
+         triplet_candidates.insert(triplet_candidates.end(), c.begin(), c.end());
+      }
+      keep_best(triplet_candidates, no_candidates, candidate_comp);
+      std::sort(triplet_candidates.begin(), triplet_candidates.end(), candidate_comp);
 
       if(triplet_candidates.size() > 0) {
          std::cout << "best triplet candidate in triplet search has guaranteed dual improvement " << std::get<3>(triplet_candidates[0]) << "\n";
       }
 
-      INDEX triplets_added = 0;
       for(const auto& triplet_candidate : triplet_candidates) {
-         const INDEX i = std::get<0>(triplet_candidate);
-         const INDEX j = std::get<1>(triplet_candidate);
-         const INDEX k = std::get<2>(triplet_candidate);
-         if(!HasTripletFactor(i,j,k)) {
-            AddTripletFactor(i,j,k);
-            triplets_added++;
-            if(triplets_added > max_triplets_to_add) {
-               break;
-            } 
-         }
+         assert(!HasTripletFactor(std::get<0>(triplet_candidate), std::get<1>(triplet_candidate), std::get<2>(triplet_candidate)));
+         AddTripletFactor(std::get<0>(triplet_candidate), std::get<1>(triplet_candidate), std::get<2>(triplet_candidate));
       }
 
-      return triplets_added;
+      return triplet_candidates.size();
    }
 
    INDEX find_violated_cycles_maxcut(const INDEX max_triplets_to_add)
@@ -503,7 +532,7 @@ public:
       }
 
       bool zero_th_iteration = true;
-      std::vector<bool> already_searched(noNodes_, false);
+      std::vector<char> already_searched(noNodes_, false); // not std::vector<bool>, as it is written concurrently
       for(REAL th=0.5*initial_th; th>=eps || zero_th_iteration; th*=0.1) {
          if(th < eps) {
             if(tripletsAdded <= 0.01*max_triplets_to_add) {
@@ -529,7 +558,7 @@ public:
          {
             std::vector<CycleType > cycles_local;
             BfsData mp2(g);
-#pragma for schedule(guided)
+#pragma omp for schedule(guided)
             for(INDEX i=0; i<noNodes_; ++i) {
                if(!already_searched[i] && uf.thread_safe_connected(2*i, 2*i+1)) {
                   already_searched[i] = true;
@@ -635,40 +664,63 @@ public:
                uf.merge(i,j);   
             }
          }
+         // negative edges for which a positive path is searched, grouped by first end point. Paths to all second end points of a group are found by one search
+         std::vector<std::array<INDEX,2>> queries; // first end point, index into negative_edges
+         for(INDEX c=0; c<negative_edges.size(); ++c) {
+            const INDEX i = std::get<0>(negative_edges[c]);
+            const INDEX j = std::get<1>(negative_edges[c]);
+            const REAL v = std::get<2>(negative_edges[c]);
+            const bool already_used_for_path_search = std::get<3>(negative_edges[c]);
+            if(-v > th && !already_used_for_path_search && uf.connected(i,j)) {
+               queries.push_back({i,c});
+            }
+         }
+         std::sort(queries.begin(), queries.end());
+         std::vector<INDEX> query_groups; // queries of group g are query_groups[g], ..., query_groups[g+1]-1
+         for(INDEX q=0; q<queries.size(); ++q) {
+            if(q == 0 || queries[q][0] != queries[q-1][0]) {
+               query_groups.push_back(q);
+            }
+         }
+         query_groups.push_back(queries.size());
+         const INDEX no_query_groups = query_groups.size()-1;
+
          using CycleType = std::tuple<REAL, std::vector<INDEX>>;
-         std::vector<CycleType > cycles;
+         std::vector<std::vector<CycleType>> cycles_per_thread(separation_threads());
 #pragma omp parallel 
          {
             std::vector<CycleType > cycles_local;
             BfsData mp2(posEdgesGraph);
-#pragma for schedule(guided)
-            for(INDEX c=0; c<negative_edges.size(); ++c) {
-               const INDEX i = std::get<0>(negative_edges[c]);
-               const INDEX j = std::get<1>(negative_edges[c]);
-               const REAL v = std::get<2>(negative_edges[c]);
-               const bool already_used_for_path_search = std::get<3>(negative_edges[c]);
-               //if(-v <= th) break;
-               //if(already_used_for_path_search) continue;
-               if(-v > th && !already_used_for_path_search && uf.thread_safe_connected(i,j)) {
-                  //auto cycle = mp.FindPath(i,j,posEdgesGraph);
-                  auto cycle = mp2.FindPath(i,j,posEdgesGraph, th);
-                  const REAL dualIncrease = std::min(-v, std::get<0>(cycle));
-                  assert(std::get<1>(cycle).size() > 0);
-                  if(std::get<1>(cycle).size() > 0) {
-                     cycles_local.push_back( std::make_tuple(dualIncrease, std::move(std::get<1>(cycle))) );
-                     //tripletsAdded += AddCycle(std::get<1>(cycle));
-                     //if(tripletsAdded > maxTripletsToAdd) {
-                     //   return tripletsAdded;
-                     //}
+            std::vector<INDEX> end_nodes;
+#pragma omp for schedule(guided)
+            for(INDEX group=0; group<no_query_groups; ++group) {
+               const INDEX i = queries[query_groups[group]][0];
+               end_nodes.clear();
+               for(INDEX q=query_groups[group]; q<query_groups[group+1]; ++q) {
+                  end_nodes.push_back(std::get<1>(negative_edges[queries[q][1]]));
+               }
+               std::vector<CycleType> paths;
+               if(end_nodes.size() == 1) {
+                  paths.push_back(mp2.FindPath(i,end_nodes[0],posEdgesGraph, th));
+               } else {
+                  paths = mp2.FindPaths(i,end_nodes,posEdgesGraph, th);
+               }
+               for(INDEX q=0; q<paths.size(); ++q) {
+                  const REAL v = std::get<2>(negative_edges[queries[query_groups[group]+q][1]]);
+                  const REAL dualIncrease = std::min(-v, std::get<0>(paths[q]));
+                  assert(std::get<1>(paths[q]).size() > 0);
+                  if(std::get<1>(paths[q]).size() > 0) {
+                     cycles_local.push_back( std::make_tuple(dualIncrease, std::move(std::get<1>(paths[q]))) );
                   } else {
                      throw std::runtime_error("No path found although there should be one"); 
                   }
                }
             }
-#pragma omp critical
-            {
-               cycles.insert(cycles.end(), cycles_local.begin(), cycles_local.end());
-            }
+            cycles_per_thread[separation_thread_no()] = std::move(cycles_local);
+         }
+         std::vector<CycleType > cycles;
+         for(auto& c : cycles_per_thread) {
+            std::move(c.begin(), c.end(), std::back_inserter(cycles));
          }
          // sort by guaranteed increase in decreasing order
          std::sort(cycles.begin(), cycles.end(), [](const CycleType& i, const CycleType& j) { return std::get<0>(i) > std::get<0>(j); });
@@ -747,29 +799,18 @@ INDEX FindPositivePath(const GRAPH& g, BFS_STRUCT& mp, const REAL th, const INDE
       }
    }
 
-   void round()
+   // current reparametrized edge costs for rounding
+   std::shared_ptr<const multicut_rounding::snapshot> edge_cost_snapshot() const
    {
-      std::cout << "compute multicut primal with GAEC + KLj\n";
-      andres::graph::Graph<> graph(noNodes_);
-      std::vector<REAL> edgeValues;
-      edgeValues.reserve(unaryFactorsVector_.size());
-
+      auto s = std::make_shared<multicut_rounding::snapshot>();
+      s->no_nodes = noNodes_;
+      s->edges.reserve(unaryFactorsVector_.size());
+      s->costs.reserve(unaryFactorsVector_.size());
       for(const auto& e : unaryFactorsVector_) {
-         graph.insertEdge(e.first[0], e.first[1]);
-         edgeValues.push_back((*e.second->GetFactor())[0]);
+         s->edges.push_back({e.first[0], e.first[1]});
+         s->costs.push_back((*e.second->GetFactor())[0]);
       }
-
-      primal_handle_ = std::async(std::launch::async, gaec_klj, std::move(graph), std::move(edgeValues));
-   }
-
-   static std::vector<char> gaec_klj(andres::graph::Graph<> g, std::vector<REAL> edge_values)
-   {
-      std::vector<char> labeling(g.numberOfEdges(), 0);
-      if(g.numberOfEdges() > 0) {
-         andres::graph::multicut::greedyAdditiveEdgeContraction(g, edge_values, labeling);
-         andres::graph::multicut::kernighanLin(g, edge_values, labeling, labeling);
-      }
-      return labeling;
+      return s;
    }
 
    void write_labeling_into_factors(const std::vector<char>& labeling) {
@@ -807,32 +848,16 @@ INDEX FindPositivePath(const GRAPH& g, BFS_STRUCT& mp, const REAL th, const INDE
       }
    }
 
-   // use GAEC and Kernighan&Lin algorithm of andres graph package to compute primal solution
+   // use GAEC and Kernighan&Lin to compute primal solution.
+   // Rounding runs in its own thread: write the last result into the factors, if there is one, and hand over current costs.
    void ComputePrimal()
    {
       if(CUT_TYPE == cut_type::multicut) {
-         if(!primal_handle_.valid()) { 
-            round();
-            return;
-         }
-
-         const auto primal_state = primal_handle_.wait_for(std::chrono::seconds(0));
-
-         if(primal_state == std::future_status::deferred) {
-            assert(false); // this should not happen, we launch immediately!
-            throw std::runtime_error("asynchronuous primal multicut rounding was deferred, but this should not happen");
-         } else if(primal_state == std::future_status::ready) {
-
-            std::cout << "collect multicut rounding result\n";
-            auto labeling = primal_handle_.get();
+         std::vector<char> labeling;
+         if(rounding_.collect(labeling)) {
             write_labeling_into_factors(labeling);
-
-            std::cout << "restart primal rounding\n";
-            round();
-
-         } else {
-            std::cout << "multicut rounding is currently running.\n";
          }
+         rounding_.submit(edge_cost_snapshot());
       } else if(CUT_TYPE == cut_type::maxcut) {
          assert(false);
       } else {
@@ -840,16 +865,72 @@ INDEX FindPositivePath(const GRAPH& g, BFS_STRUCT& mp, const REAL th, const INDE
       } 
    }
 
+   RoundingProgress rounding_progress() const { return rounding_.progress(); }
+
+   // labeling on the current edges from which rounding starts, e.g. a projected solution of a coarsened problem
+   void warm_start_rounding(std::vector<char> labeling) { rounding_.warm_start(std::move(labeling)); }
+
 protected:
 
-   decltype(std::async(std::launch::async, gaec_klj, andres::graph::Graph<>(0), std::vector<REAL>{})) primal_handle_;
+   multicut_rounding rounding_;
+
+   // position of i2 in sorted edge heads of i1
+   INDEX insert_edge_head(const INDEX i1, const INDEX i2)
+   {
+      assert(i1 < i2);
+      if(edge_heads_.size() <= i1) {
+         edge_heads_.resize(i1+1);
+         edge_tails_.resize(i1/64 + 1, 0);
+      }
+      auto& heads = edge_heads_[i1];
+      auto it = std::lower_bound(heads.begin(), heads.end(), i2);
+      assert(it == heads.end() || *it != i2);
+      const INDEX pos = it - heads.begin();
+      heads.insert(it, i2);
+      edge_tails_[i1/64] |= std::uint64_t(1) << (i1%64);
+      return pos;
+   }
+
+   // lexicographically preceding edge of edge with tail i1 at position pos, nullptr if none exists
+   UnaryFactorContainer* preceding_edge_factor(const INDEX i1, const INDEX pos) const
+   {
+      if(pos > 0) {
+         return GetUnaryFactor(i1, edge_heads_[i1][pos-1]);
+      }
+      // largest tail smaller than i1
+      INDEX w = i1/64;
+      std::uint64_t word = edge_tails_[w] & ((std::uint64_t(1) << (i1%64)) - 1);
+      while(word == 0) {
+         if(w == 0) { return nullptr; }
+         word = edge_tails_[--w];
+      }
+      const INDEX tail = 64*w + 63 - __builtin_clzll(word);
+      return GetUnaryFactor(tail, edge_heads_[tail].back());
+   }
+
+   // lexicographically succeeding edge of edge with tail i1 at position pos, nullptr if none exists
+   UnaryFactorContainer* succeeding_edge_factor(const INDEX i1, const INDEX pos) const
+   {
+      if(pos+1 < edge_heads_[i1].size()) {
+         return GetUnaryFactor(i1, edge_heads_[i1][pos+1]);
+      }
+      // smallest tail larger than i1
+      INDEX w = i1/64;
+      std::uint64_t word = (i1%64 == 63) ? 0 : edge_tails_[w] & ~((std::uint64_t(2) << (i1%64)) - 1);
+      while(word == 0) {
+         if(w+1 == edge_tails_.size()) { return nullptr; }
+         word = edge_tails_[++w];
+      }
+      const INDEX tail = 64*w + __builtin_ctzll(word);
+      return GetUnaryFactor(tail, edge_heads_[tail].front());
+   }
 
    //GlobalFactorContainer* globalFactor_;
-   // do zrobienia: replace this by unordered_map, provide hash function.
-   // possibly dont do this, but use sorting to provide ordering for LP
-   std::map<std::array<INDEX,2>, UnaryFactorContainer*> unaryFactors_; // actually unary factors in multicut are defined on edges. assume first index < second one
-   //std::unordered_map<std::array<INDEX,2>, UnaryFactorContainer*> unaryFactors_; // actually unary factors in multicut are defined on edges. assume first index < second one
+   flat_hash_map<std::uint64_t, UnaryFactorContainer*> unaryFactors_; // actually unary factors in multicut are defined on edges. assume first index < second one. Keys are packed node pairs
    std::vector<std::pair<std::array<INDEX,2>, UnaryFactorContainer*>> unaryFactorsVector_; // we store a second copy of unary factors for faster iterating
+   std::vector<std::vector<INDEX>> edge_heads_; // sorted second indices of edges with given first index, used for ordering edge factors
+   std::vector<std::uint64_t> edge_tails_; // bit i is set iff edge_heads_[i] is non-empty
+   csr_adjacency edge_index_; // edges refer to positions in unaryFactorsVector_
    // sort triplet factors as follows: Let indices be i=(i1,i2,i3) and j=(j1,j2,j3). Then i<j iff i1+i2+i3 < j1+j2+j3 or for ties sort lexicographically
    struct tripletComp {
       bool operator()(const std::tuple<INDEX,INDEX,INDEX> i, const std::tuple<INDEX,INDEX,INDEX> j) const
@@ -861,11 +942,14 @@ protected:
          else return i<j; // lexicographic comparison
       }
    };
-   std::unordered_map<std::array<INDEX,3>, TripletFactorContainer*> tripletFactors_; // triplet factors are defined on cycles of length three
+   flat_hash_map<std::array<INDEX,3>, TripletFactorContainer*> tripletFactors_; // triplet factors are defined on cycles of length three
    INDEX noNodes_ = 0;
    ConstantFactorContainer* constant_factor_;
 
    LP* lp_;
+   std::unique_ptr<multicut_multilevel_base> multilevel_; // only for solvers with multicut_multilevel_enabled
+   std::unique_ptr<TCLAP::SwitchArg> nativeRoundingArg_; // not held by copies
+   checkpoint::tightening_log tightening_log_;
 };
 
 
@@ -947,6 +1031,7 @@ public:
 
       auto* f = new odd_3_wheel_factor_container();
       this->lp_->AddFactor(f);
+      this->tightening_log_.record(BaseConstructor::odd_3_wheel_kind, {i0, i1, i2, i3});
       odd_3_wheel_factors_.insert(std::make_pair(std::array<INDEX,4>({i0,i1,i2,i3}), f));
 
       if(!this->HasTripletFactor(i0,i1,i2)) {
@@ -988,6 +1073,18 @@ public:
    {
       return odd_3_wheel_factors_.find(std::array<INDEX,4>({i0,i1,i2,i3}))->second; 
    }
+
+   void replay_tightening(const INDEX kind, const INDEX* begin, const INDEX* end)
+   {
+      if(kind == BaseConstructor::odd_3_wheel_kind) {
+         assert(end - begin == 4);
+         if(!has_odd_3_wheel_factor(begin[0], begin[1], begin[2], begin[3])) {
+            add_odd_3_wheel_factor(begin[0], begin[1], begin[2], begin[3]);
+         }
+      } else {
+         BaseConstructor::replay_tightening(kind, begin, end);
+      }
+   }
    /*
    TripletPlusSpokeFactorContainer* AddTripletPlusSpokeFactor(const INDEX n1, const INDEX n2, const INDEX centerNode, const INDEX spokeNode)
    {
@@ -1149,71 +1246,73 @@ public:
       assert(j<k); // if not, below computation is not valid
       // compute difference between cost such that exactly one edge incident to center node is 1 againt cost when when zero or two incident to it are 1
       if(std::min(j,k) == triplet[0] && std::max(j,k) == triplet[1]) { // jk is first edge
-         return std::min(0.0,std::min(cost[3],cost[0])) - std::min(cost[1],cost[2]);
+         return std::min(REAL(0.0),std::min(cost[3],cost[0])) - std::min(cost[1],cost[2]);
       } else if(std::min(j,k) == triplet[0] && std::max(j,k) == triplet[2]) { // jk is second edge
-         return std::min(0.0,std::min(cost[3],cost[1])) - std::min(cost[0],cost[2]);
+         return std::min(REAL(0.0),std::min(cost[3],cost[1])) - std::min(cost[0],cost[2]);
       } else { // jk is third edge
          assert(std::min(j,k) == triplet[1] && std::max(j,k) == triplet[2]);
-         return std::min(0.0,std::min(cost[3],cost[2])) - std::min(cost[0],cost[1]);
+         return std::min(REAL(0.0),std::min(cost[3],cost[2])) - std::min(cost[0],cost[1]);
       }
       assert(false);
    }
 
-   template<typename ADJ_LIST>
-   void ComputeTriangles(const INDEX i, const ADJ_LIST& adjacencyList, const REAL minTh, 
-         std::unordered_map<INDEX,INDEX>& origToCompressedNode, 
-         std::vector<INDEX>& compressedToOrigNode, 
-         std::vector<std::tuple<INDEX,INDEX,REAL>>& compressedEdges)
-   {
-      //std::unordered_map<INDEX,INDEX> origToCompressedNode {tripletByIndices_[i].size()}; // compresses node indices
-      origToCompressedNode.max_load_factor(0.7);
-      //std::vector<INDEX> compressedToOrigNode; // compressed nodes to original
-      //std::vector<std::tuple<INDEX,INDEX,REAL>> compressedEdges;
-      origToCompressedNode.clear();
-      compressedToOrigNode.clear();
-      compressedEdges.clear();
-
-      // find all triangles ijk
-      std::vector<INDEX> commonNodes(this->noNodes_); // for detecting triangles
-      for(INDEX j : adjacencyList[i]) {
-         auto commonNodesEnd = std::set_intersection(adjacencyList[i].begin(), adjacencyList[i].end(), adjacencyList[j].begin(), adjacencyList[j].end(), commonNodes.begin());
-         for(auto it=commonNodes.begin(); it!=commonNodesEnd; ++it) {
-            const INDEX k = *it; 
-            if(j<k) { // edge is encountered twice
-               const REAL th = ComputeTriangleTh(i,j,k);
-               if(th >= minTh) {
-                  // add j and k to compressed nodes
-                  if(origToCompressedNode.find(j) == origToCompressedNode.end()) {
-                     origToCompressedNode.insert(std::make_pair(j, origToCompressedNode.size()));
-                     compressedToOrigNode.push_back(j);
-                  }
-                  if(origToCompressedNode.find(k) == origToCompressedNode.end()) {
-                     origToCompressedNode.insert(std::make_pair(k, origToCompressedNode.size()));
-                     compressedToOrigNode.push_back(k);
-                  }
-                  const INDEX jc = origToCompressedNode[j];
-                  const INDEX kc = origToCompressedNode[k];
-                  assert(jc != kc);
-                  compressedEdges.push_back(std::make_tuple(jc,kc,th));
-               }
-            }
+   // buffers for the odd wheel search around one centre node, reused for all centre nodes searched by one thread
+   struct odd_wheel_scratch {
+      odd_wheel_scratch(const INDEX no_nodes, const INDEX max_degree)
+      : orig_to_compressed(no_nodes, std::numeric_limits<INDEX>::max()),
+      uf(std::max(INDEX(1), 2*max_degree))
+      {}
+
+      std::vector<INDEX> orig_to_compressed; // compresses node indices, max() for nodes not in compressed graph
+      std::vector<INDEX> compressed_to_orig; // compressed nodes to original
+      std::vector<std::tuple<INDEX,INDEX,REAL>> compressed_edges;
+      UnionFind uf; // large enough for the bipartite graph of every centre node
+   };
+
+   // all triangles ijk with threshold at least minTh, as edges (j,k) between compressed nodes
+   void ComputeTriangles(const INDEX i, const REAL minTh, odd_wheel_scratch& scratch)
+   {
+      for(const INDEX j : scratch.compressed_to_orig) {
+         scratch.orig_to_compressed[j] = std::numeric_limits<INDEX>::max();
+      }
+      scratch.compressed_to_orig.clear();
+      scratch.compressed_edges.clear();
+      auto compress = [&scratch](const INDEX j) {
+         if(scratch.orig_to_compressed[j] == std::numeric_limits<INDEX>::max()) {
+            scratch.orig_to_compressed[j] = scratch.compressed_to_orig.size();
+            scratch.compressed_to_orig.push_back(j);
          }
+         return scratch.orig_to_compressed[j];
+      };
+
+      const auto& edge_index = this->edge_index_;
+      for(auto* e=edge_index.neighbors_begin(i); e!=edge_index.neighbors_end(i); ++e) {
+         const INDEX j = e->node;
+         // every triangle is encountered with j<k only
+         edge_index.for_each_common_neighbor(i, j, [&](const INDEX k, const INDEX, const INDEX) {
+            const REAL th = ComputeTriangleTh(i,j,k);
+            if(th >= minTh) {
+               const INDEX jc = compress(j);
+               const INDEX kc = compress(k);
+               assert(jc != kc);
+               scratch.compressed_edges.push_back(std::make_tuple(jc,kc,th));
+            }
+         }, j+1);
       }
    }
 
-   template<typename ADJ_LIST>
-   REAL ComputeThreshold(const INDEX i, const ADJ_LIST& adjacencyList)
+   // largest threshold such that triangles with at least this threshold contain an odd cycle around i, -infinity if there is none with at least minTh
+   REAL ComputeThreshold(const INDEX i, const REAL minTh, odd_wheel_scratch& scratch)
    {
-      std::unordered_map<INDEX,INDEX> origToCompressedNode {tripletByIndices_[i].size()}; // compresses node indices
-      std::vector<INDEX> compressedToOrigNode; // compressed nodes to original
-      std::vector<std::tuple<INDEX,INDEX,REAL>> compressedEdges;
-      ComputeTriangles(i, adjacencyList, 0.0, origToCompressedNode, compressedToOrigNode, compressedEdges);
+      ComputeTriangles(i, minTh, scratch);
+      auto& compressedEdges = scratch.compressed_edges;
 
       std::sort(compressedEdges.begin(), compressedEdges.end(), [](auto a, auto b) { return std::get<2>(a) > std::get<2>(b); });
 
-      const INDEX noCompressedNodes = origToCompressedNode.size();
+      const INDEX noCompressedNodes = scratch.compressed_to_orig.size();
       const INDEX noBipartiteCompressedNodes = 2*noCompressedNodes;
-      UnionFind uf(noBipartiteCompressedNodes);
+      auto& uf = scratch.uf;
+      uf.reset(noBipartiteCompressedNodes);
       // construct bipartite graph based on triangles
       for(auto& e : compressedEdges) {
          const INDEX jc = std::get<0>(e);
@@ -1229,16 +1328,15 @@ public:
    }
 
    // returns nodes of odd wheel without center node
-   template<typename ADJ_LIST>
-   std::vector<INDEX> ComputeViolatedOddWheel(const INDEX i, const REAL minTh, const ADJ_LIST& adjacencyList)
+   std::vector<INDEX> ComputeViolatedOddWheel(const INDEX i, const REAL minTh, odd_wheel_scratch& scratch)
    {
-      std::unordered_map<INDEX,INDEX> origToCompressedNode {tripletByIndices_[i].size()}; // compresses node indices
-      std::vector<INDEX> compressedToOrigNode; // compressed nodes to original
-      std::vector<std::tuple<INDEX,INDEX,REAL>> compressedEdges;
-      ComputeTriangles(i, adjacencyList, minTh, origToCompressedNode, compressedToOrigNode, compressedEdges);
+      ComputeTriangles(i, minTh, scratch);
+      const auto& compressedEdges = scratch.compressed_edges;
+      const auto& compressedToOrigNode = scratch.compressed_to_orig;
 
-      const INDEX noCompressedNodes = origToCompressedNode.size();
+      const INDEX noCompressedNodes = compressedToOrigNode.size();
       const INDEX noBipartiteCompressedNodes = 2*noCompressedNodes;
+      if(noCompressedNodes == 0) { return std::vector<INDEX>(0); }
       std::vector<INDEX> no_outgoing_arcs(2*noCompressedNodes, 0);
       for(const auto e : compressedEdges) {
          const INDEX i = std::get<0>(e);
@@ -1250,7 +1348,8 @@ public:
       }
       Graph g(noBipartiteCompressedNodes,4*compressedEdges.size(), no_outgoing_arcs);
       BfsData mp(g);
-      UnionFind uf(noBipartiteCompressedNodes);
+      auto& uf = scratch.uf;
+      uf.reset(noBipartiteCompressedNodes);
       // construct bipartite graph based on triangles
       for(auto& e : compressedEdges) {
          assert(std::get<2>(e) >= minTh);
@@ -1272,7 +1371,6 @@ public:
             auto& pathNormalized = std::get<1>(path);
             pathNormalized.resize(pathNormalized.size()-1); // first and last node coincide
             for(INDEX k=0; k<pathNormalized.size(); ++k) { // note: last node is copy of first one
-               //assert(compressedToOrigNode.find(pathNormalized[k]%noCompressedNodes) != compressedToOrigNode.end());
                pathNormalized[k] = compressedToOrigNode[pathNormalized[k]%noCompressedNodes];
             }
 
@@ -1289,70 +1387,78 @@ public:
 
    INDEX FindOddWheels(const INDEX maxCuttingPlanesToAdd)
    {
-      // first prepare datastructures for threshold finding and violated constraint search
-
       // search for all triangles present in the graph, also in places where no triplet factor has been added
-      // Construct adjacency list
+      this->edge_index_.update();
+      const INDEX no_nodes = this->edge_index_.no_nodes();
+      INDEX max_degree = 0;
+      for(INDEX i=0; i<no_nodes; ++i) {
+         max_degree = std::max(max_degree, this->edge_index_.degree(i));
+      }
+
+      assert(maxCuttingPlanesToAdd > 0);
+      if(no_nodes == 0) { return 0; }
+      const INDEX n = std::min(no_nodes, maxCuttingPlanesToAdd) - 1;
+      if(n == 0) { return 0; }
+
+      // find the n nodes with largest guaranteed dual increase.
+      // For each node, compute cost difference of all triplets with it as one of its nodes, sort in descending order and
+      // populate union find datastructure successively with them, checking whether opposite nodes in bipartite graph are connected. If so, threshold is found.
+      // Every thread keeps the n largest thresholds it has found in a heap. Once it holds n of them, nodes with smaller threshold cannot be among the n best ones overall.
+      // The smallest threshold in a full heap is shared between threads and triangles below it are not considered anymore. Only nonnegative thresholds are of interest.
+      using threshold_type = std::tuple<INDEX,REAL>;
+      // ties are broken by node index, so that the selected nodes do not depend on the number of threads
+      auto sort_func = [](const threshold_type& a, const threshold_type& b) { return std::get<1>(a) > std::get<1>(b) || (std::get<1>(a) == std::get<1>(b) && std::get<0>(a) < std::get<0>(b)); };
+      std::atomic<REAL> min_threshold(0.0);
+      std::vector<std::vector<threshold_type>> threshold_per_thread(separation_threads());
+#pragma omp parallel
+      {
+         odd_wheel_scratch scratch(no_nodes, max_degree);
+         std::vector<threshold_type> threshold; // heap with smallest threshold at front
+#pragma omp for schedule(dynamic,64)
+         for(INDEX i=0; i<no_nodes; ++i) {
+            const REAL th = ComputeThreshold(i, min_threshold.load(std::memory_order_relaxed), scratch);
+            if(th < 0.0) { continue; }
+            if(threshold.size() < n) {
+               threshold.push_back(std::make_tuple(i,th));
+               std::push_heap(threshold.begin(), threshold.end(), sort_func);
+            } else if(sort_func(std::make_tuple(i,th), threshold.front())) {
+               std::pop_heap(threshold.begin(), threshold.end(), sort_func);
+               threshold.back() = std::make_tuple(i,th);
+               std::push_heap(threshold.begin(), threshold.end(), sort_func);
+            }
+            if(threshold.size() == n) {
+               const REAL th_n = std::get<1>(threshold.front());
+               REAL current = min_threshold.load(std::memory_order_relaxed);
+               while(current < th_n && !min_threshold.compare_exchange_weak(current, th_n, std::memory_order_relaxed)) {}
+            }
+         }
+         threshold_per_thread[separation_thread_no()] = std::move(threshold);
+      }
 
-      std::vector<INDEX> adjacency_list_count(this->noNodes_,0);
-      // first determine size for adjacency_list
-      for(auto& it : this->unaryFactorsVector_) {
-         const INDEX i = std::get<0>(it.first);
-         const INDEX j = std::get<1>(it.first);
-         adjacency_list_count[i]++;
-         adjacency_list_count[j]++; 
+      std::vector<threshold_type> threshold;
+      for(auto& t : threshold_per_thread) {
+         threshold.insert(threshold.end(), t.begin(), t.end());
       }
-      two_dim_variable_array<INDEX> adjacency_list(adjacency_list_count);
-      std::fill(adjacency_list_count.begin(), adjacency_list_count.end(), 0);
-      for(auto& it : this->unaryFactorsVector_) {
-         const INDEX i = std::get<0>(it.first);
-         const INDEX j = std::get<1>(it.first);
-         assert(i<j);
-         adjacency_list[i][adjacency_list_count[i]] = j;
-         adjacency_list_count[i]++;
-         adjacency_list[j][adjacency_list_count[j]] = i;
-         adjacency_list_count[j]++;
-      }
-
-      // Sort the adjacency list, for fast intersections later
-      // do zrobienia: parallelize
-      for(int i=0; i < adjacency_list.size(); i++) {
-         std::sort(adjacency_list[i].begin(), adjacency_list[i].end());
-      }
-
-      // find maximum threshold where still some cycle can be added for each node
-      std::vector<std::tuple<INDEX,REAL>> threshold(this->noNodes_);
-      // do zrobienia: parallelize
-      for(INDEX i=0; i<this->noNodes_; ++i) {
-         // compute cost difference of all triplets with i as one of its nodes. 
-         // sort in descending order.
-         // populate union find datastructure successively with them, checking whether opposite nodes in bipartite graph are connected. If so, threshold is found
-         threshold[i] = std::make_tuple(i, ComputeThreshold(i,adjacency_list));
-      }
-
-      //std::cout << "maximal odd wheel threshold = " << std::get<1>(*std::max_element(threshold.begin(), threshold.end(), [](auto a, auto b) { return std::get<1>(a) > std::get<1>(b); })) << "\n\n";
-      // find the maxCuttingPlanesToAdd nodes with largest guaranteed dual increase.
-      assert( threshold.size() > 0 && maxCuttingPlanesToAdd > 0);
-      const INDEX n = std::min(INDEX(threshold.size()), maxCuttingPlanesToAdd) - 1;
-      auto sort_func = [](auto a, auto b) { return std::get<1>(a) > std::get<1>(b); };
-      std::partial_sort(threshold.begin(), threshold.begin() + n, threshold.end(), sort_func);
-      //std::nth_element(threshold.begin(), threshold.begin() + n, threshold.end(), sort_func);
-      //std::sort(threshold.begin(), threshold.begin()+n, sort_func);
-
-      // go over all nodes with large threshold, compute optimum odd wheel and try to add it to lp
-      INDEX factorsAdded = 0;
-      // do zrobienia: parallelize
-      for(auto it=threshold.begin(); it!=threshold.begin()+n; ++it) {
-         const INDEX i = std::get<0>(*it);
-         const REAL th = std::get<1>(*it);
-         if(th >= 0.0) {
-            auto oddWheel = ComputeViolatedOddWheel(i,th, adjacency_list);
-            assert(oddWheel.size() > 0);
-            factorsAdded += EnforceOddWheel(i,oddWheel);
+      std::sort(threshold.begin(), threshold.end(), sort_func);
+      threshold.resize(std::min(INDEX(threshold.size()), n));
+
+      // compute optimum odd wheel for all nodes with large threshold in parallel and add them to lp in order of decreasing threshold
+      std::vector<std::vector<INDEX>> odd_wheels(threshold.size());
+#pragma omp parallel
+      {
+         odd_wheel_scratch scratch(no_nodes, max_degree);
+#pragma omp for schedule(dynamic)
+         for(INDEX c=0; c<threshold.size(); ++c) {
+            odd_wheels[c] = ComputeViolatedOddWheel(std::get<0>(threshold[c]), std::get<1>(threshold[c]), scratch);
          }
       }
-      return factorsAdded;
 
+      INDEX factorsAdded = 0;
+      for(INDEX c=0; c<threshold.size(); ++c) {
+         assert(odd_wheels[c].size() > 0);
+         factorsAdded += EnforceOddWheel(std::get<0>(threshold[c]), odd_wheels[c]);
+      }
+      return factorsAdded;
    }
 
    INDEX Tighten(const INDEX maxCuttingPlanesToAdd)
@@ -1374,7 +1480,7 @@ public:
    
 
 private:
-   std::unordered_map<std::array<INDEX,4>, odd_3_wheel_factor_container*> odd_3_wheel_factors_;
+   flat_hash_map<std::array<INDEX,4>, odd_3_wheel_factor_container*> odd_3_wheel_factors_;
 
    std::vector<std::vector<std::tuple<INDEX,INDEX,typename BaseConstructor::TripletFactorContainer*>>> tripletByIndices_; // of triplet factor with indices (i1,i2,i3) exists, then (i1,i2,i3) will be in the vector of index i1, i2 and i3
    // the format for TripletPlusSpoke is (node1,node2, centerNode, spokeNode) and we assume n1<n2
@@ -1404,6 +1510,19 @@ public:
    template<typename SOLVER>
    multicut_odd_bicycle_wheel_constructor(SOLVER& s) : MULTICUT_ODD_WHEEL_CONSTRUCTOR(s) {}
 
+   void replay_tightening(const INDEX kind, const INDEX* begin, const INDEX* end)
+   {
+      if(kind == BaseConstructor::odd_bicycle_3_wheel_kind) {
+         assert(end - begin == 5);
+         const std::array<INDEX,5> idx{begin[0], begin[1], begin[2], begin[3], begin[4]};
+         if(odd_bicycle_3_wheel_factors_.find(idx) == odd_bicycle_3_wheel_factors_.end()) {
+            add_odd_bicycle_3_wheel(idx);
+         }
+      } else {
+         BaseConstructor::replay_tightening(kind, begin, end);
+      }
+   }
+
    template<typename MSG_TYPE>
    void connect_odd_3_wheel_factor(odd_bicycle_3_wheel_factor_container* f, const std::array<INDEX,4> idx)
    {
@@ -1419,6 +1538,7 @@ public:
       assert(std::is_sorted(idx.begin(), idx.end()));
       auto* f = new odd_bicycle_3_wheel_factor_container();
       this->lp_->AddFactor(f);
+      this->tightening_log_.record(BaseConstructor::odd_bicycle_3_wheel_kind, idx.begin(), idx.end());
       odd_bicycle_3_wheel_factors_.insert(std::make_pair(idx, f));
 
       connect_odd_3_wheel_factor<odd_3_wheel_odd_bicycle_3_wheel_message_0123_container>({idx[0], idx[1], idx[2], idx[3]});
@@ -1601,7 +1721,7 @@ public:
    }
 private:
 
-   std::unordered_map<std::array<INDEX,5>, odd_bicycle_3_wheel_factor_container*> odd_bicycle_3_wheel_factors_;
+   flat_hash_map<std::array<INDEX,5>, odd_bicycle_3_wheel_factor_container*> odd_bicycle_3_wheel_factors_;
 
    //std::unordered_map<std::vector<std::tuple<INDEX,INDEX,typename BaseConstructor::odd_3_wheel_factor_container*>>> odd_3_wheel_factor_by_indices_; // if odd 3 wheel factor with indices (i1,i2,i3,i4) exists, then (i1,i2,i3,i4) will be in the hash indexed by all two-subsets of the indices.
 
@@ -1893,7 +2013,7 @@ private:
 struct multicut_triplet_tightening_criterion { 
 REAL operator()(const REAL cost_ij, const REAL cost_ik, const REAL cost_jk)
 {
-   const REAL lb = std::min(0.0, cost_ij) + std::min(0.0, cost_ik) + std::min(0.0, cost_jk);
+   const REAL lb = std::min(REAL(0.0), cost_ij) + std::min(REAL(0.0), cost_ik) + std::min(REAL(0.0), cost_jk);
    const REAL best_labeling = std::min({0.0, cost_ij+cost_ik, cost_ij+cost_jk, cost_ij+cost_jk, cost_ij+cost_ik+cost_jk});
    assert(lb <= best_labeling+eps);
    return best_labeling - lb; 
@@ -1920,8 +2040,8 @@ using multiway_cut_constructor = multiway_cut_constructor_base<
 struct asymmetric_multicut_triplet_tightening_criterion {
    REAL operator()(const REAL cost_ij, const REAL cost_ik, const REAL cost_jk)
 {
-   const REAL lb = std::min(0.0, cost_ij) + std::min(0.0, cost_ik) + std::min(0.0, cost_jk);
-   const REAL best_labeling = std::min({0.0, cost_ij+cost_ik, cost_ij+cost_jk, cost_ij+cost_jk, cost_ij+cost_ik+cost_jk, cost_ik, cost_jk});
+   const REAL lb = std::min(REAL(0.0), cost_ij) + std::min(REAL(0.0), cost_ik) + std::min(REAL(0.0), cost_jk);
+   const REAL best_labeling = std::min({REAL(0.0), cost_ij+cost_ik, cost_ij+cost_jk, cost_ij+cost_jk, cost_ij+cost_ik+cost_jk, cost_ik, cost_jk});
    assert(lb <= best_labeling+eps);
    return best_labeling - lb; 
 }
@@ -1964,7 +2084,7 @@ public:
    struct Edge : public std::array<INDEX,2> {
       Edge(const INDEX i, const INDEX j) : std::array<INDEX,2>({std::min(i,j), std::max(i,j)}) {}
    };
-   using CutId = std::vector<Edge>;
+   using CutId = std::vector<multicut_min_cut::edge>; // sorted edges
 
    template<typename SOLVER>
    LiftedMulticutConstructor(SOLVER& pd) : MULTICUT_CONSTRUCTOR(pd) {}
@@ -1988,56 +2108,61 @@ public:
    bool HasCutFactor(const CutId& cut) 
    {
       assert(std::is_sorted(cut.begin(), cut.end()));
-      return liftedMulticutFactors_.find(cut) != liftedMulticutFactors_.end();
+      return FindCutFactor(cut, multicut_min_cut::signature(cut)) != std::numeric_limits<INDEX>::max();
    }
 
    bool HasLiftedEdgeInCutFactor(const CutId& cut, const INDEX i1, const INDEX i2)
    {
-      assert(i1<i2);
       assert(HasCutFactor(cut));
-      const auto& edgeList = liftedMulticutFactors_[cut].second;
-      // speed this up by holding edge list sorted
-      return std::find(edgeList.begin(),edgeList.end(),Edge({i1,i2})) != edgeList.end();
+      return HasLiftedEdgeInCutFactor(FindCutFactor(cut, multicut_min_cut::signature(cut)), i1, i2);
    }
 
    // do zrobienia: provide AddCutFactor(const CutId& cut, const INDEX i1, const INDEX i2) as well
    LiftedMulticutCutFactorContainer* AddCutFactor(const CutId& cut)
    {
       assert(!HasCutFactor(cut));
-      //std::cout << "Add cut with edges ";
-      //for(auto i : cut) { std::cout << "(" << std::get<0>(i) << "," << std::get<1>(i) << ");"; } std::cout << "\n";
-      auto* f = new LiftedMulticutCutFactorContainer(cut.size());
-      MULTICUT_CONSTRUCTOR::lp_->AddFactor(f);
-      // connect the cut edges
-      for(INDEX e=0; e<cut.size(); ++e) {
-         auto* unaryFactor = MULTICUT_CONSTRUCTOR::GetUnaryFactor(cut[e][0],cut[e][1]);
-         auto* m = new CutEdgeLiftedMulticutFactorMessageContainer(CutEdgeLiftedMulticutFactorMessage(e),unaryFactor,f);
-         MULTICUT_CONSTRUCTOR::lp_->AddMessage(m);
-      }
-      liftedMulticutFactors_.insert(std::make_pair(cut,std::make_pair(f,std::vector<Edge>())));
-      return f;
+      return cutFactors_[AddCutFactor(cut, multicut_min_cut::signature(cut))].f;
    }
 
    LiftedMulticutCutFactorContainer* GetCutFactor(const CutId& cut)
    {
       assert(HasCutFactor(cut));
-      return liftedMulticutFactors_[cut].first;
+      return cutFactors_[FindCutFactor(cut, multicut_min_cut::signature(cut))].f;
    }
 
    void AddLiftedEdge(const CutId& cut, const INDEX i1, const INDEX i2)
    {
-      assert(!HasLiftedEdgeInCutFactor(cut,i1,i2));
       assert(HasCutFactor(cut));
-      assert(i1<i2);
-      //std::cout << "Add lifted edge (" << i1 << "," << i2 << ") to cut\n";
-      auto& c = liftedMulticutFactors_[cut];
-      auto* f = c.first;
-      auto& edgeList = c.second;
-      auto* unaryFactor = MULTICUT_CONSTRUCTOR::GetUnaryFactor(i1,i2);
-      f->GetFactor()->IncreaseLifted();
-      auto* m = new LiftedEdgeLiftedMulticutFactorMessageContainer(LiftedEdgeLiftedMulticutFactorMessage(edgeList.size() + cut.size()), unaryFactor, f);
-      MULTICUT_CONSTRUCTOR::lp_->AddMessage(m);
-      c.second.push_back(Edge({i1,i2}));
+      AddLiftedEdge(FindCutFactor(cut, multicut_min_cut::signature(cut)), i1, i2);
+   }
+
+   // cut factors are recorded with their sorted cut edges, lifted edges with the index of their cut factor
+   void replay_tightening(const INDEX kind, const INDEX* begin, const INDEX* end)
+   {
+      const bool prevMode = addingTighteningEdges;
+      addingTighteningEdges = true;
+      if(kind == MULTICUT_CONSTRUCTOR::cut_kind) {
+         assert((end - begin) % 2 == 0);
+         CutId cut;
+         for(const INDEX* e=begin; e!=end; e+=2) {
+            cut.push_back({e[0], e[1]});
+         }
+         const auto signature = multicut_min_cut::signature(cut);
+         if(FindCutFactor(cut, signature) == std::numeric_limits<INDEX>::max()) {
+            AddCutFactor(cut, signature);
+         }
+      } else if(kind == MULTICUT_CONSTRUCTOR::lifted_edge_kind) {
+         assert(end - begin == 3);
+         if(begin[0] >= cutFactors_.size()) {
+            throw std::runtime_error("tightening log refers to missing cut factor");
+         }
+         if(!HasLiftedEdgeInCutFactor(begin[0], begin[1], begin[2])) {
+            AddLiftedEdge(begin[0], begin[1], begin[2]);
+         }
+      } else {
+         MULTICUT_CONSTRUCTOR::replay_tightening(kind, begin, end);
+      }
+      addingTighteningEdges = prevMode;
    }
 
 
@@ -2050,7 +2175,7 @@ public:
       const INDEX noBaseConstraints = MULTICUT_CONSTRUCTOR::Tighten(0.8*maxCuttingPlanesToAdd);
       //return noBaseConstraints;
       INDEX noLiftingConstraints = 0;
-      std::cout << "number of cut constraints = " << liftedMulticutFactors_.size() << "\n";
+      std::cout << "number of cut constraints = " << cutFactors_.size() << "\n";
       if(noBaseConstraints < maxCuttingPlanesToAdd) {
          REAL th = FindViolatedCutsThreshold(maxCuttingPlanesToAdd - noBaseConstraints);
          if(th >= 0.0) {
@@ -2145,13 +2270,10 @@ public:
       return 0.1*maxTh;
    }
 
+   // lifted edges are violated together with the minimum cut of base edges with weight < -minDualIncrease separating their end nodes.
+   // Cuts are computed on the graph with contracted components of the remaining base edges. minCut_ keeps it, together with its flow and cuts, between tightening rounds as long as the components do not change.
    INDEX FindViolatedCuts(const INDEX minDualIncrease, const INDEX noConstraints)
    {
-      // update weight of base edges
-      //for(auto& e : baseEdges_) {
-      //   e.w = MULTICUT_CONSTRUCTOR::GetUnaryFactor(e.i,e.j)->operator[](0);
-      //}
-      //std::sort(baseEdges_.begin(), baseEdges_.end(), [](const MulticutEdge& e1, const MulticutEdge& e2) { return e1.weight() < e2.weight(); });
       UnionFind uf(MULTICUT_CONSTRUCTOR::noNodes_);
       for(const auto& e : baseEdges_) {
          if(e.weight() >= -minDualIncrease) {
@@ -2159,124 +2281,52 @@ public:
          }
       }
 
-      // build reduced graph with connected components as nodes and edge weights as number of edges with weight < -minDualIncrease
-
-      // union find indices are not contiguous. Make them so, to use them as identifiers for connected components
-      std::map<INDEX,INDEX> ufIndexToContiguous;
+      // number components consecutively in order of first occurrence, so that equal partitions are numbered equally
+      std::vector<INDEX> ufIndexToContiguous(MULTICUT_CONSTRUCTOR::noNodes_, std::numeric_limits<INDEX>::max());
+      std::vector<INDEX> component(MULTICUT_CONSTRUCTOR::noNodes_);
+      INDEX ccNodes = 0;
       for(INDEX i=0; i<MULTICUT_CONSTRUCTOR::noNodes_; ++i) {
          const INDEX ufIndex = uf.find(i);
-         if(ufIndexToContiguous.find(ufIndex) == ufIndexToContiguous.end()) {
-            ufIndexToContiguous.insert(std::make_pair(ufIndex,ufIndexToContiguous.size()));
+         if(ufIndexToContiguous[ufIndex] == std::numeric_limits<INDEX>::max()) {
+            ufIndexToContiguous[ufIndex] = ccNodes++;
          }
+         component[i] = ufIndexToContiguous[ufIndex];
       }
-      const INDEX ccNodes = ufIndexToContiguous.size();
 
-      std::map<INDEX,INDEX> origToCompressedNode; // union find index to compressed node indices // do zrobienia: use hash map
-      for(INDEX i=0; i<MULTICUT_CONSTRUCTOR::noNodes_; ++i) {
-         const INDEX ufIndex = uf.find(i);
-         const INDEX collapsedIndex = ufIndexToContiguous[ufIndex];
-         origToCompressedNode.insert(std::make_pair(i,collapsedIndex));
-      }
-      
-      INDEX ccEdges = 0;
-      std::map<Edge,std::vector<Edge>> ccToBaseEdges;
+      std::vector<multicut_min_cut::edge> cutEdges;
       for(const auto& e : baseEdges_) {
-         if(!uf.connected(e.i,e.j)) {
-            const INDEX i = ufIndexToContiguous[uf.find(e.i)];
-            const INDEX j = ufIndexToContiguous[uf.find(e.j)];
-            //if(ccEdgeCap.find({i,j}) == cc.EdgeCap.end()) {
-            //   ccEdgeCap.insert(std::make_pair(std::array<INDEX,2>(i,j),1));
-            //}
-            //ccEdgeCap[std::array<INDEX,2>(i,j)]++;
-            if(ccToBaseEdges.find(Edge(i,j)) == ccToBaseEdges.end()) {
-               ++ccEdges;
-               ccToBaseEdges.insert(std::make_pair(Edge(i,j),std::vector<Edge>()));
-            }
-            ccToBaseEdges[Edge(i,j)].push_back(Edge(e.i,e.j));
+         if(component[e.i] != component[e.j]) {
+            cutEdges.push_back({e.i, e.j});
          }
       }
-      BKMaxFlow::Graph<int,int,int> maxFlow(ccNodes, ccEdges); 
-      maxFlow.add_node(ccNodes);
-      for(auto& e : ccToBaseEdges) {
-         const INDEX i = e.first.operator[](0);
-         const INDEX j = e.first.operator[](1);
-         const INDEX cap = e.second.size();
-         maxFlow.add_edge(i,j,cap,cap);
-      }
+      minCut_.update(component, cutEdges); // flow is kept if components and cut edges are unchanged
       
       // note: this can possibly be made faster by caching the weight
       std::sort(liftedEdges_.begin(), liftedEdges_.end(), [](const MulticutEdge& e1, const MulticutEdge& e2) { return e1.weight() > e2.weight(); });
       INDEX factorsAdded = 0;
 
-      // note that currently possibly multiple max flow computations are performed, when lifted edges come from the same connected components. This is superfluous and searches could be remembered and reused.
-      const int capacityMax = baseEdges_.size()+1;
       for(const auto& liftedEdge : liftedEdges_) {
-         //spdlog::get("logger")->info() << "considering lifted edge " << liftedEdge.i << "," << liftedEdge.j;
          if(factorsAdded >= noConstraints) { 
-            //spdlog::get("logger")->info() << "maximal number of constraints to add reached";
             break; 
          }
          if(liftedEdge.weight() > minDualIncrease) {
-            const INDEX i = origToCompressedNode[liftedEdge.i];
-            const INDEX j = origToCompressedNode[liftedEdge.j];
-            if(!uf.connected(i,j)) {
-               // find minimum cut in unweighted graph containing only base edges with weight < eps
-               maxFlow.add_tweights(i,capacityMax,0);
-               maxFlow.add_tweights(j,0,capacityMax);
-               const INDEX noCutEdges = maxFlow.maxflow();
-               assert(noCutEdges > 0 && noCutEdges < baseEdges_.size()); // otherwise there is no path from i to j or all paths were collapsed
-               std::vector<Edge> minCut;
-               minCut.reserve(noCutEdges);
-               // now do a dfs from i on those vertices which are in the same segment as i. The edges from those to vertices in segment of j form a minimum cut.
-               std::stack<INDEX> q;
-               std::vector<bool> visited(ccNodes,false);
-               q.push(i);
-               //spdlog::get("logger")->info() << "finding max flow between node " << i << " and " << j;
-               while(!q.empty()) {
-                  const INDEX v = q.top();
-                  q.pop();
-                  if(visited[v]) {
-                     continue;
-                  }
-                  visited[v] = true;
-                  auto* a = maxFlow.get_first_arc(v);
-                  while(a != nullptr) {
-                     int v_test, w; // do zrobienia: use proper type
-                     maxFlow.get_arc_ends(a, v_test, w);
-                     assert(v != w);
-                     assert(v_test == v);
-                     if(maxFlow.what_segment(INDEX(v)) != maxFlow.what_segment(INDEX(w))) {
-                        // expand all edges that were collapsed into (v,w) in the original graph
-                           //spdlog::get("logger")->info() << "edge in mincut: " << v << "," << w;
-                        for(const auto& e : ccToBaseEdges[Edge(INDEX(v),INDEX(w))]) {
-                           //spdlog::get("logger")->info() << " expanded edge : " << e[0] << "," << e[1];
-                           minCut.push_back(Edge(e[0],e[1]));
-                        }
-                     } else if(!visited[INDEX(w)]) {
-                        q.push(INDEX(w));
-                     }
-                     a = a->next;
-                  }
+            const INDEX i = component[liftedEdge.i];
+            const INDEX j = component[liftedEdge.j];
+            if(i != j) {
+               // lifted edges between the same components share the cut, it is computed only once
+               const auto& minCut = minCut_.min_cut(i,j);
+               assert(minCut.edges.size() > 0 && minCut.edges.size() < baseEdges_.size()); // otherwise there is no path from i to j or all paths were collapsed
+
+               INDEX c = FindCutFactor(minCut.edges, minCut.signature);
+               if(c == std::numeric_limits<INDEX>::max()) {
+                  c = AddCutFactor(minCut.edges, minCut.signature);
                }
-               assert(minCut.size() == noCutEdges);
-               std::sort(minCut.begin(),minCut.end()); // unique form of cut
-
-               // check if minimum cut is already present
-               if(!HasCutFactor(minCut)) {
-                  auto* f = AddCutFactor(minCut);
-                  AddLiftedEdge(minCut,liftedEdge.i,liftedEdge.j);
+               const INDEX i1 = std::min(liftedEdge.i, liftedEdge.j);
+               const INDEX i2 = std::max(liftedEdge.i, liftedEdge.j);
+               if(!HasLiftedEdgeInCutFactor(c, i1, i2)) {
+                  AddLiftedEdge(c, i1, i2);
                   ++factorsAdded;
-               } else {
-                  auto* MinCutFactor = GetCutFactor(minCut);
-                  if(!HasLiftedEdgeInCutFactor(minCut,liftedEdge.i,liftedEdge.j)) {
-                     AddLiftedEdge(minCut,liftedEdge.i,liftedEdge.j);
-                     ++factorsAdded;
-                  }
                }
-
-               // restore original terminal weights
-               maxFlow.add_tweights(i,-capacityMax,0);
-               maxFlow.add_tweights(j,0,-capacityMax);
             }
          }
       }
@@ -2359,7 +2409,7 @@ public:
          liftedEdges_[e].f->SetAndPropagatePrimal(primal, l.begin());
       }
       // now go over all edges: additionally tightening edges will not have received primal value, set if now.
-      for(const auto& e : this->unaryFactors_) {
+      for(const auto& e : this->unaryFactorsVector_) {
          const auto* f = e.second;
          if(primal[f->GetPrimalOffset()] == unknownState) { // tightening edge
             std::array<unsigned char,1> l;
@@ -2390,7 +2440,80 @@ public:
    std::vector<std::vector<INDEX>> cutEdgesLiftedMulticutFactors_;
    std::vector<std::vector<INDEX>> liftedEdgesLiftedMulticutFactors_;
 
-   std::map<CutId,std::pair<LiftedMulticutCutFactorContainer*,std::vector<Edge>>> liftedMulticutFactors_;
+   // cut factors are looked up by the signature of their cut edges. Cuts with equal signatures are chained.
+   INDEX FindCutFactor(const CutId& cut, const std::size_t signature) const
+   {
+      assert(signature == multicut_min_cut::signature(cut));
+      auto it = cutFactorBySignature_.find(signature);
+      if(it == cutFactorBySignature_.end()) {
+         return std::numeric_limits<INDEX>::max();
+      }
+      for(INDEX c=it->second; c!=std::numeric_limits<INDEX>::max(); c=cutFactors_[c].nextWithSignature) {
+         if(cutFactors_[c].cut == cut) {
+            return c;
+         }
+      }
+      return std::numeric_limits<INDEX>::max();
+   }
+
+   INDEX AddCutFactor(const CutId& cut, const std::size_t signature)
+   {
+      assert(FindCutFactor(cut, signature) == std::numeric_limits<INDEX>::max());
+      auto* f = new LiftedMulticutCutFactorContainer(cut.size());
+      MULTICUT_CONSTRUCTOR::lp_->AddFactor(f);
+      {
+         std::vector<INDEX> cut_nodes;
+         cut_nodes.reserve(2*cut.size());
+         for(const auto& e : cut) {
+            cut_nodes.push_back(e[0]);
+            cut_nodes.push_back(e[1]);
+         }
+         MULTICUT_CONSTRUCTOR::tightening_log_.record(MULTICUT_CONSTRUCTOR::cut_kind, cut_nodes.begin(), cut_nodes.end());
+      }
+      // connect the cut edges
+      for(INDEX e=0; e<cut.size(); ++e) {
+         auto* unaryFactor = MULTICUT_CONSTRUCTOR::GetUnaryFactor(cut[e][0],cut[e][1]);
+         auto* m = new CutEdgeLiftedMulticutFactorMessageContainer(CutEdgeLiftedMulticutFactorMessage(e),unaryFactor,f);
+         MULTICUT_CONSTRUCTOR::lp_->AddMessage(m);
+      }
+      const INDEX c = cutFactors_.size();
+      auto it = cutFactorBySignature_.insert(std::make_pair(signature, c)).first;
+      const INDEX next = it->second != c ? it->second : std::numeric_limits<INDEX>::max();
+      it->second = c;
+      cutFactors_.push_back({cut, f, 0, next});
+      return c;
+   }
+
+   bool HasLiftedEdgeInCutFactor(const INDEX c, const INDEX i1, const INDEX i2) const
+   {
+      assert(i1<i2 && c<cutFactors_.size());
+      return liftedEdgesInCutFactors_.count({c,i1,i2}) > 0;
+   }
+
+   void AddLiftedEdge(const INDEX c, const INDEX i1, const INDEX i2)
+   {
+      assert(!HasLiftedEdgeInCutFactor(c,i1,i2));
+      //std::cout << "Add lifted edge (" << i1 << "," << i2 << ") to cut\n";
+      auto& cf = cutFactors_[c];
+      auto* unaryFactor = MULTICUT_CONSTRUCTOR::GetUnaryFactor(i1,i2);
+      cf.f->GetFactor()->IncreaseLifted();
+      MULTICUT_CONSTRUCTOR::tightening_log_.record(MULTICUT_CONSTRUCTOR::lifted_edge_kind, {c, i1, i2});
+      auto* m = new LiftedEdgeLiftedMulticutFactorMessageContainer(LiftedEdgeLiftedMulticutFactorMessage(cf.noLiftedEdges + cf.cut.size()), unaryFactor, cf.f);
+      MULTICUT_CONSTRUCTOR::lp_->AddMessage(m);
+      ++cf.noLiftedEdges;
+      liftedEdgesInCutFactors_.insert(std::make_pair(std::array<INDEX,3>({c,i1,i2}), char(1)));
+   }
+
+   struct CutFactor {
+      CutId cut;
+      LiftedMulticutCutFactorContainer* f;
+      INDEX noLiftedEdges;
+      INDEX nextWithSignature; // next cut factor with same signature
+   };
+   std::vector<CutFactor> cutFactors_;
+   flat_hash_map<std::size_t, INDEX> cutFactorBySignature_; // last added cut factor with given signature
+   flat_hash_map<std::array<INDEX,3>, char> liftedEdgesInCutFactors_; // cut factor index and lifted edge
+   multicut_min_cut minCut_; // for separating violated cuts
 };
 
 } // end namespace LP_MP
@@ -17,9 +17,38 @@ using multicut_triplet_labelings = labelings<
       >;
 using multicut_triplet_factor = labeling_factor< multicut_triplet_labelings, true >;
 
-using multicut_edge_triplet_message_0 = labeling_message< multicut_edge_labelings, multicut_triplet_labelings, 0 >;
-using multicut_edge_triplet_message_1 = labeling_message< multicut_edge_labelings, multicut_triplet_labelings, 1 >;
-using multicut_edge_triplet_message_2 = labeling_message< multicut_edge_labelings, multicut_triplet_labelings, 2 >;
+// Triplet factors are never updated themselves, all work is done when edge factors are updated.
+// Messages are received from triplets one by one and sent to all triplets of one message type in one call, computed in closed form instead of through the generic labeling lists.
+template<INDEX I>
+class multicut_edge_triplet_message : public labeling_message< multicut_edge_labelings, multicut_triplet_labelings, I >
+{
+public:
+   // edge I is cut in labelings (I+1)%3, (I+2)%3, 111 and not cut in labeling I and the implicit 000 labeling
+   template<typename RIGHT_FACTOR, typename MSG>
+   void ReceiveMessageFromRight(const RIGHT_FACTOR& r, MSG& msg)
+   {
+      array<REAL,1> m;
+      m[0] = std::min(std::min(r[(I+1)%3], r[(I+2)%3]), r[3]) - std::min(r[I], REAL(0.0));
+      msg -= m;
+   }
+
+   template<typename LEFT_FACTOR, typename MSG_ITERATOR, typename ITERATOR>
+   static void SendMessagesToRight(const LEFT_FACTOR& l, MSG_ITERATOR msg_begin, MSG_ITERATOR msg_end, ITERATOR omega_it)
+   {
+      const REAL cost = l[0]; // l may be changed by the messages sent
+      for(auto it=msg_begin; it!=msg_end; ++it, ++omega_it) {
+         if(*omega_it != 0.0) {
+            array<REAL,1> m;
+            m[0] = (*omega_it)*cost;
+            (*it) -= m;
+         }
+      }
+   }
+};
+
+using multicut_edge_triplet_message_0 = multicut_edge_triplet_message<0>;
+using multicut_edge_triplet_message_1 = multicut_edge_triplet_message<1>;
+using multicut_edge_triplet_message_2 = multicut_edge_triplet_message<2>;
 
 /*
 
@@ -0,0 +1,497 @@
+#ifndef LP_MP_MULTICUT_GAEC_KL_HXX
+#define LP_MP_MULTICUT_GAEC_KL_HXX
+
+#include "config.hxx"
+#include "union_find.hxx"
+
+#include <vector>
+#include <array>
+#include <tuple>
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <limits>
+#include <cmath>
+
+#ifdef LP_MP_PARALLEL
+#include <omp.h>
+#endif
+
+namespace LP_MP {
+
+// primal heuristics for multicut: greedy additive edge contraction (GAEC) and Kernighan&Lin type local search.
+// Edges are given as node pairs with costs for cutting them, labelings are 1 for cut and 0 for uncut edges.
+// Buffers are held by the class and reused when it is called repeatedly, e.g. by rounding during message passing.
+class multicut_gaec_kl {
+public:
+   // contraction rounds of locally dominant edges are run until fewer than this fraction of nodes is contracted
+   REAL min_matching_fraction = 0.05;
+   INDEX max_outer_iterations = 100;
+   // a sequence of moves is stopped when the best solution in it has not improved for so many moves
+   INDEX max_moves_without_improvement = 100;
+
+   static REAL cost(const std::vector<REAL>& costs, const std::vector<char>& labeling)
+   {
+      REAL c = 0.0;
+      for(INDEX e=0; e<labeling.size(); ++e) {
+         if(labeling[e]) {
+            c += costs[e];
+         }
+      }
+      return c;
+   }
+
+   // Edges with largest positive cost are contracted first, weights of parallel edges are added up, until no positive edge is left.
+   // Large graphs are first contracted in parallel: every node selects its largest positive edge and edges selected by both end nodes are contracted together.
+   // Contracting such a locally dominant edge before heavier edges elsewhere may deviate from sequential GAEC.
+   void gaec(const INDEX no_nodes, const std::vector<std::array<INDEX,2>>& edges, const std::vector<REAL>& costs, std::vector<char>& labeling)
+   {
+      assert(edges.size() == costs.size());
+      cur_edges_.resize(edges.size());
+#pragma omp parallel for
+      for(INDEX e=0; e<edges.size(); ++e) {
+         cur_edges_[e] = std::make_tuple(std::min(edges[e][0], edges[e][1]), std::max(edges[e][0], edges[e][1]), costs[e]);
+      }
+      contract(no_nodes);
+
+      labeling.resize(edges.size());
+#pragma omp parallel for
+      for(INDEX e=0; e<edges.size(); ++e) {
+         labeling[e] = node_map_[edges[e][0]] != node_map_[edges[e][1]];
+      }
+   }
+
+   // Improve labeling by alternating (i) sequences of single node moves to neighbouring components or into new ones, of which the best prefix is kept, and (ii) joining neighbouring components via GAEC on the component graph.
+   // Gains of moves are evaluated in parallel at the start of every sequence.
+   // f is called after every outer iteration, optimization stops if it returns false.
+   template<typename FUNC>
+   void kernighan_lin(const INDEX no_nodes, const std::vector<std::array<INDEX,2>>& edges, const std::vector<REAL>& costs, std::vector<char>& labeling, FUNC f)
+   {
+      assert(edges.size() == costs.size() && edges.size() == labeling.size());
+      build_adjacency(no_nodes, edges);
+      REAL c = cost(costs, labeling);
+      for(INDEX iter=0; iter<max_outer_iterations; ++iter) {
+         components(no_nodes, edges, labeling);
+         move_nodes(no_nodes, costs);
+         join_components(no_nodes, edges, costs);
+
+         next_labeling_.resize(edges.size());
+#pragma omp parallel for
+         for(INDEX e=0; e<edges.size(); ++e) {
+            next_labeling_[e] = comp_[edges[e][0]] != comp_[edges[e][1]];
+         }
+         const REAL next_c = cost(costs, next_labeling_);
+         if(!(next_c < c - eps)) { break; }
+         std::swap(labeling, next_labeling_);
+         c = next_c;
+         if(!f()) { break; }
+      }
+   }
+
+   void kernighan_lin(const INDEX no_nodes, const std::vector<std::array<INDEX,2>>& edges, const std::vector<REAL>& costs, std::vector<char>& labeling)
+   {
+      kernighan_lin(no_nodes, edges, costs, labeling, []() { return true; });
+   }
+
+private:
+   using weighted_edge = std::tuple<INDEX,INDEX,REAL>;
+
+   // contract graph given by cur_edges_. Afterwards node_map_ holds contracted node of every node
+   void contract(const INDEX no_nodes)
+   {
+      node_map_.resize(no_nodes);
+      std::iota(node_map_.begin(), node_map_.end(), 0);
+      INDEX no_cur_nodes = no_nodes;
+      merge_parallel_edges(no_cur_nodes);
+      while(contract_matching(no_cur_nodes)) {}
+      contract_greedily(no_cur_nodes);
+   }
+
+   // sort cur_edges_ by end nodes, add up costs of parallel edges and remove loops
+   void merge_parallel_edges(const INDEX no_cur_nodes)
+   {
+      bucket_offsets_.assign(no_cur_nodes+1, 0);
+      for(const auto& e : cur_edges_) {
+         if(std::get<0>(e) != std::get<1>(e)) {
+            bucket_offsets_[std::get<0>(e)+1]++;
+         }
+      }
+      std::partial_sum(bucket_offsets_.begin(), bucket_offsets_.end(), bucket_offsets_.begin());
+      tmp_edges_.resize(bucket_offsets_.back());
+      bucket_fill_.assign(bucket_offsets_.begin(), bucket_offsets_.end()-1);
+      for(const auto& e : cur_edges_) {
+         if(std::get<0>(e) != std::get<1>(e)) {
+            tmp_edges_[bucket_fill_[std::get<0>(e)]++] = e;
+         }
+      }
+
+      // bucket_fill_ holds number of distinct edges in bucket afterwards
+#pragma omp parallel for schedule(dynamic,256)
+      for(INDEX u=0; u<no_cur_nodes; ++u) {
+         auto begin = tmp_edges_.begin() + bucket_offsets_[u];
+         auto end = tmp_edges_.begin() + bucket_offsets_[u+1];
+         std::sort(begin, end, [](const weighted_edge& a, const weighted_edge& b) { return std::get<1>(a) < std::get<1>(b); });
+         INDEX n = 0;
+         for(auto it=begin; it!=end; ++it) {
+            if(n > 0 && std::get<1>(*(begin+n-1)) == std::get<1>(*it)) {
+               std::get<2>(*(begin+n-1)) += std::get<2>(*it);
+            } else {
+               *(begin+n) = *it;
+               ++n;
+            }
+         }
+         bucket_fill_[u] = n;
+      }
+
+      cur_edges_.clear();
+      for(INDEX u=0; u<no_cur_nodes; ++u) {
+         cur_edges_.insert(cur_edges_.end(), tmp_edges_.begin() + bucket_offsets_[u], tmp_edges_.begin() + bucket_offsets_[u] + bucket_fill_[u]);
+      }
+   }
+
+   // contract all edges which are the largest positive edge of both end nodes. Returns false if too few are found, then nothing is contracted
+   bool contract_matching(INDEX& no_cur_nodes)
+   {
+      if(cur_edges_.size() == 0) { return false; }
+
+      best_edge_.assign(no_cur_nodes, std::numeric_limits<INDEX>::max());
+      // edges are sorted by first node, hence the first node's best edge can be found within its bucket, the second node's needs incident edge lists
+      incident_offsets_.assign(no_cur_nodes+1, 0);
+      for(const auto& e : cur_edges_) {
+         incident_offsets_[std::get<1>(e)+1]++;
+      }
+      std::partial_sum(incident_offsets_.begin(), incident_offsets_.end(), incident_offsets_.begin());
+      incident_.resize(cur_edges_.size());
+      bucket_fill_.assign(incident_offsets_.begin(), incident_offsets_.end()-1);
+      for(INDEX e=0; e<cur_edges_.size(); ++e) {
+         incident_[bucket_fill_[std::get<1>(cur_edges_[e])]++] = e;
+      }
+      bucket_offsets_.assign(no_cur_nodes+1, 0);
+      for(const auto& e : cur_edges_) {
+         bucket_offsets_[std::get<0>(e)+1]++;
+      }
+      std::partial_sum(bucket_offsets_.begin(), bucket_offsets_.end(), bucket_offsets_.begin());
+
+      auto better = [this](const INDEX e, const INDEX f) {
+         return f == std::numeric_limits<INDEX>::max() || std::get<2>(cur_edges_[e]) > std::get<2>(cur_edges_[f]) || (std::get<2>(cur_edges_[e]) == std::get<2>(cur_edges_[f]) && e < f);
+      };
+#pragma omp parallel for schedule(dynamic,256)
+      for(INDEX u=0; u<no_cur_nodes; ++u) {
+         INDEX best = std::numeric_limits<INDEX>::max();
+         for(INDEX e=bucket_offsets_[u]; e<bucket_offsets_[u+1]; ++e) {
+            if(std::get<2>(cur_edges_[e]) > 0.0 && better(e, best)) { best = e; }
+         }
+         for(INDEX k=incident_offsets_[u]; k<incident_offsets_[u+1]; ++k) {
+            const INDEX e = incident_[k];
+            if(std::get<2>(cur_edges_[e]) > 0.0 && better(e, best)) { best = e; }
+         }
+         best_edge_[u] = best;
+      }
+
+      auto matched = [this](const INDEX u) {
+         const INDEX e = best_edge_[u];
+         return e != std::numeric_limits<INDEX>::max() && best_edge_[std::get<0>(cur_edges_[e])] == e && best_edge_[std::get<1>(cur_edges_[e])] == e;
+      };
+      INDEX no_matched = 0;
+#pragma omp parallel for reduction(+:no_matched)
+      for(INDEX u=0; u<no_cur_nodes; ++u) {
+         if(matched(u) && std::get<0>(cur_edges_[best_edge_[u]]) == u) {
+            ++no_matched;
+         }
+      }
+      if(no_matched == 0 || no_matched < min_matching_fraction * no_cur_nodes) { return false; }
+
+      // second node of contracted edge gets number of first one
+      new_id_.resize(no_cur_nodes);
+      INDEX no_new_nodes = 0;
+      for(INDEX u=0; u<no_cur_nodes; ++u) {
+         if(matched(u) && std::get<1>(cur_edges_[best_edge_[u]]) == u) {
+            new_id_[u] = new_id_[std::get<0>(cur_edges_[best_edge_[u]])];
+         } else {
+            new_id_[u] = no_new_nodes++;
+         }
+      }
+
+#pragma omp parallel for
+      for(INDEX e=0; e<cur_edges_.size(); ++e) {
+         const INDEX i = new_id_[std::get<0>(cur_edges_[e])];
+         const INDEX j = new_id_[std::get<1>(cur_edges_[e])];
+         std::get<0>(cur_edges_[e]) = std::min(i,j);
+         std::get<1>(cur_edges_[e]) = std::max(i,j);
+      }
+#pragma omp parallel for
+      for(INDEX v=0; v<node_map_.size(); ++v) {
+         node_map_[v] = new_id_[node_map_[v]];
+      }
+      no_cur_nodes = no_new_nodes;
+      merge_parallel_edges(no_cur_nodes);
+      return true;
+   }
+
+   // sequential GAEC with priority queue. Queue entries are outdated when the edge's cost has changed or one end node has been contracted
+   void contract_greedily(const INDEX no_cur_nodes)
+   {
+      if(adjacency_.size() < no_cur_nodes) {
+         adjacency_.resize(no_cur_nodes);
+      }
+      for(INDEX u=0; u<no_cur_nodes; ++u) {
+         adjacency_[u].clear();
+      }
+      queue_.clear();
+      for(const auto& e : cur_edges_) {
+         adjacency_[std::get<0>(e)][std::get<1>(e)] = std::get<2>(e);
+         adjacency_[std::get<1>(e)][std::get<0>(e)] = std::get<2>(e);
+         if(std::get<2>(e) > 0.0) {
+            queue_.push_back(e);
+         }
+      }
+      auto queue_comp = [](const weighted_edge& a, const weighted_edge& b) { return std::get<2>(a) < std::get<2>(b); };
+      std::make_heap(queue_.begin(), queue_.end(), queue_comp);
+
+      parent_.resize(no_cur_nodes);
+      std::iota(parent_.begin(), parent_.begin() + no_cur_nodes, 0);
+
+      while(!queue_.empty()) {
+         std::pop_heap(queue_.begin(), queue_.end(), queue_comp);
+         const auto e = queue_.back();
+         queue_.pop_back();
+         const INDEX i = std::get<0>(e);
+         const INDEX j = std::get<1>(e);
+         if(parent_[i] != i || parent_[j] != j) { continue; }
+         auto it = adjacency_[i].find(j);
+         if(it == adjacency_[i].end() || it->second != std::get<2>(e)) { continue; }
+
+         // merge smaller adjacency into larger one
+         const INDEX keep = adjacency_[i].size() >= adjacency_[j].size() ? i : j;
+         const INDEX other = keep == i ? j : i;
+         adjacency_[keep].erase(other);
+         for(const auto& n : adjacency_[other]) {
+            if(n.first == keep) { continue; }
+            REAL& c = adjacency_[keep][n.first];
+            c += n.second;
+            auto& adj_n = adjacency_[n.first];
+            adj_n.erase(other);
+            adj_n[keep] = c;
+            if(c > 0.0) {
+               queue_.push_back(std::make_tuple(keep, n.first, c));
+               std::push_heap(queue_.begin(), queue_.end(), queue_comp);
+            }
+         }
+         adjacency_[other].clear();
+         parent_[other] = keep;
+      }
+
+      for(INDEX u=0; u<no_cur_nodes; ++u) {
+         parent_[u] = root(u);
+      }
+#pragma omp parallel for
+      for(INDEX v=0; v<node_map_.size(); ++v) {
+         node_map_[v] = parent_[node_map_[v]];
+      }
+   }
+
+   INDEX root(INDEX u)
+   {
+      while(parent_[u] != u) {
+         parent_[u] = parent_[parent_[u]];
+         u = parent_[u];
+      }
+      return u;
+   }
+
+   void build_adjacency(const INDEX no_nodes, const std::vector<std::array<INDEX,2>>& edges)
+   {
+      adjacency_offsets_.assign(no_nodes+1, 0);
+      for(const auto& e : edges) {
+         adjacency_offsets_[e[0]+1]++;
+         adjacency_offsets_[e[1]+1]++;
+      }
+      std::partial_sum(adjacency_offsets_.begin(), adjacency_offsets_.end(), adjacency_offsets_.begin());
+      neighbors_.resize(2*edges.size());
+      bucket_fill_.assign(adjacency_offsets_.begin(), adjacency_offsets_.end()-1);
+      for(INDEX e=0; e<edges.size(); ++e) {
+         neighbors_[bucket_fill_[edges[e][0]]++] = {edges[e][1], e};
+         neighbors_[bucket_fill_[edges[e][1]]++] = {edges[e][0], e};
+      }
+   }
+
+   // components of uncut edges, numbered consecutively
+   void components(const INDEX no_nodes, const std::vector<std::array<INDEX,2>>& edges, const std::vector<char>& labeling)
+   {
+      UnionFind uf(std::max(no_nodes, INDEX(1)));
+      for(INDEX e=0; e<edges.size(); ++e) {
+         if(!labeling[e]) {
+            uf.merge(edges[e][0], edges[e][1]);
+         }
+      }
+      new_id_.assign(no_nodes, std::numeric_limits<INDEX>::max());
+      no_comps_ = 0;
+      comp_.resize(no_nodes);
+      for(INDEX v=0; v<no_nodes; ++v) {
+         const INDEX r = uf.find(v);
+         if(new_id_[r] == std::numeric_limits<INDEX>::max()) {
+            new_id_[r] = no_comps_++;
+         }
+         comp_[v] = new_id_[r];
+      }
+      comp_size_.assign(no_comps_ + no_nodes, 0); // moves may open up to no_nodes new components
+      for(INDEX v=0; v<no_nodes; ++v) {
+         comp_size_[comp_[v]]++;
+      }
+   }
+
+   // best move of v to a neighbouring component or a new one, with decrease of cost
+   std::tuple<REAL,INDEX> best_move(const INDEX v, const std::vector<REAL>& costs, std::vector<std::tuple<INDEX,REAL>>& comp_weight) const
+   {
+      comp_weight.clear();
+      for(INDEX k=adjacency_offsets_[v]; k<adjacency_offsets_[v+1]; ++k) {
+         comp_weight.push_back(std::make_tuple(comp_[neighbors_[k][0]], costs[neighbors_[k][1]]));
+      }
+      std::sort(comp_weight.begin(), comp_weight.end(), [](const auto& a, const auto& b) { return std::get<0>(a) < std::get<0>(b); });
+
+      const INDEX own = comp_[v];
+      REAL w_own = 0.0;
+      for(const auto& c : comp_weight) {
+         if(std::get<0>(c) == own) {
+            w_own += std::get<1>(c);
+         }
+      }
+      REAL best_gain = comp_size_[own] > 1 ? -w_own : -std::numeric_limits<REAL>::infinity();
+      INDEX best_target = std::numeric_limits<INDEX>::max(); // new component
+      for(auto it=comp_weight.begin(); it!=comp_weight.end();) {
+         const INDEX c = std::get<0>(*it);
+         REAL w = 0.0;
+         for(; it!=comp_weight.end() && std::get<0>(*it) == c; ++it) {
+            w += std::get<1>(*it);
+         }
+         if(c != own && w - w_own > best_gain) {
+            best_gain = w - w_own;
+            best_target = c;
+         }
+      }
+      return std::make_tuple(best_gain, best_target);
+   }
+
+   void move_nodes(const INDEX no_nodes, const std::vector<REAL>& costs)
+   {
+      gain_.resize(no_nodes);
+      target_.resize(no_nodes);
+#pragma omp parallel
+      {
+         std::vector<std::tuple<INDEX,REAL>> comp_weight;
+#pragma omp for schedule(dynamic,256)
+         for(INDEX v=0; v<no_nodes; ++v) {
+            std::tie(gain_[v], target_[v]) = best_move(v, costs, comp_weight);
+         }
+      }
+
+      using move_type = std::tuple<REAL,INDEX,INDEX>; // gain, node, stamp
+      auto move_comp = [](const move_type& a, const move_type& b) { return std::get<0>(a) < std::get<0>(b) || (std::get<0>(a) == std::get<0>(b) && std::get<1>(a) > std::get<1>(b)); };
+      move_queue_.clear();
+      stamp_.assign(no_nodes, 0);
+      moved_.assign(no_nodes, 0);
+      for(INDEX v=0; v<no_nodes; ++v) {
+         if(std::isfinite(gain_[v])) {
+            move_queue_.push_back(std::make_tuple(gain_[v], v, 0));
+         }
+      }
+      std::make_heap(move_queue_.begin(), move_queue_.end(), move_comp);
+
+      moves_.clear();
+      INDEX next_comp = no_comps_;
+      REAL gain = 0.0;
+      REAL best_gain = 0.0;
+      INDEX best_no_moves = 0;
+      while(!move_queue_.empty() && moves_.size() - best_no_moves < max_moves_without_improvement) {
+         std::pop_heap(move_queue_.begin(), move_queue_.end(), move_comp);
+         const auto m = move_queue_.back();
+         move_queue_.pop_back();
+         const INDEX v = std::get<1>(m);
+         if(moved_[v] || std::get<2>(m) != stamp_[v]) { continue; }
+
+         const INDEX target = target_[v] != std::numeric_limits<INDEX>::max() ? target_[v] : next_comp++;
+         moves_.push_back({v, comp_[v]});
+         comp_size_[comp_[v]]--;
+         comp_size_[target]++;
+         comp_[v] = target;
+         moved_[v] = 1;
+         gain += gain_[v];
+         if(gain > best_gain + eps) {
+            best_gain = gain;
+            best_no_moves = moves_.size();
+         }
+
+         for(INDEX k=adjacency_offsets_[v]; k<adjacency_offsets_[v+1]; ++k) {
+            const INDEX u = neighbors_[k][0];
+            if(moved_[u]) { continue; }
+            std::tie(gain_[u], target_[u]) = best_move(u, costs, comp_weight_);
+            ++stamp_[u];
+            if(std::isfinite(gain_[u])) {
+               move_queue_.push_back(std::make_tuple(gain_[u], u, stamp_[u]));
+               std::push_heap(move_queue_.begin(), move_queue_.end(), move_comp);
+            }
+         }
+      }
+
+      // undo moves after best prefix
+      while(moves_.size() > best_no_moves) {
+         const INDEX v = moves_.back()[0];
+         comp_size_[comp_[v]]--;
+         comp_[v] = moves_.back()[1];
+         comp_size_[comp_[v]]++;
+         moves_.pop_back();
+      }
+      no_comps_ = next_comp;
+   }
+
+   // join neighbouring components by GAEC on the graph of components
+   void join_components(const INDEX no_nodes, const std::vector<std::array<INDEX,2>>& edges, const std::vector<REAL>& costs)
+   {
+      cur_edges_.clear();
+      for(INDEX e=0; e<edges.size(); ++e) {
+         const INDEX ci = comp_[edges[e][0]];
+         const INDEX cj = comp_[edges[e][1]];
+         if(ci != cj) {
+            cur_edges_.push_back(std::make_tuple(std::min(ci,cj), std::max(ci,cj), costs[e]));
+         }
+      }
+      contract(no_comps_);
+#pragma omp parallel for
+      for(INDEX v=0; v<no_nodes; ++v) {
+         comp_[v] = node_map_[comp_[v]];
+      }
+   }
+
+   // gaec
+   std::vector<weighted_edge> cur_edges_;
+   std::vector<weighted_edge> tmp_edges_;
+   std::vector<INDEX> node_map_;
+   std::vector<INDEX> bucket_offsets_;
+   std::vector<INDEX> bucket_fill_;
+   std::vector<INDEX> incident_offsets_;
+   std::vector<INDEX> incident_;
+   std::vector<INDEX> best_edge_;
+   std::vector<INDEX> new_id_;
+   std::vector<std::unordered_map<INDEX,REAL>> adjacency_;
+   std::vector<weighted_edge> queue_;
+   std::vector<INDEX> parent_;
+
+   // local search
+   std::vector<INDEX> adjacency_offsets_;
+   std::vector<std::array<INDEX,2>> neighbors_; // neighbouring node and edge
+   std::vector<INDEX> comp_;
+   std::vector<INDEX> comp_size_;
+   INDEX no_comps_ = 0;
+   std::vector<REAL> gain_;
+   std::vector<INDEX> target_;
+   std::vector<INDEX> stamp_;
+   std::vector<char> moved_;
+   std::vector<std::tuple<REAL,INDEX,INDEX>> move_queue_;
+   std::vector<std::array<INDEX,2>> moves_; // node and its previous component
+   std::vector<std::tuple<INDEX,REAL>> comp_weight_;
+   std::vector<char> next_labeling_;
+};
+
+} // end namespace LP_MP
+
+#endif // LP_MP_MULTICUT_GAEC_KL_HXX
@@ -44,7 +44,7 @@ public:
          } else if(sortIndices[1] == i_) {
             msg[0] += -rightPot[i_] + std::min(-rightPot[sortIndices[0]], rightPot[sortIndices[2]]);
          } else {
-            msg[0] += -rightPot[i_] + std::max(rightPot[sortIndices[1]], 0.0);
+            msg[0] += -rightPot[i_] + std::max(rightPot[sortIndices[1]], REAL(0.0));
          }
       } else { // labeling 111 -> all reparametrized values <= 0
          if(sortIndices[0] == i_) {
@@ -0,0 +1,194 @@
+#ifndef LP_MP_MULTICUT_MIN_CUT_HXX
+#define LP_MP_MULTICUT_MIN_CUT_HXX
+
+#include "config.hxx"
+#include "flat_hash_map.hxx"
+#include "max_flow.hxx"
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <algorithm>
+#include <numeric>
+#include <stack>
+#include <limits>
+
+namespace LP_MP {
+
+// minimum cuts between pairs of connected components of a graph, counting the edges running between components.
+// Used for separating lifted multicut inequalities: a lifted edge whose end nodes lie in different components is violated together with the cut edges separating them.
+// The max flow graph is held between calls. As long as components and edges stay the same, neither flow nor search trees are recomputed:
+// terminals of the previous query are removed, leaving the previous flow as excess in the graph, and only the nodes whose terminal capacities changed are marked for tree reuse.
+// Removing a source-sink flow of value F changes the capacity of every cut by the same amount F, hence minimum cuts of the next query are not affected.
+// Cuts are additionally cached per pair of components, so tightening rounds on an unchanged graph do not compute any flow at all.
+class multicut_min_cut {
+public:
+   using edge = std::array<INDEX,2>;
+
+   struct cut {
+      std::vector<edge> edges; // sorted original edges, unique representation of the cut
+      std::size_t signature; // hash of edges
+   };
+
+   static std::size_t signature(const std::vector<edge>& edges)
+   {
+      std::size_t h = std::hash<std::size_t>()(edges.size());
+      for(const auto& e : edges) {
+         h = hash::hash_combine(h, hash::hash_array(e));
+      }
+      return h;
+   }
+
+   // component[i] is the component of node i, numbered consecutively in order of first occurrence. edges contains the original edges with end nodes in different components.
+   // Returns true if the graph has changed, in which case flow and cached cuts are discarded.
+   bool update(const std::vector<INDEX>& component, const std::vector<edge>& edges)
+   {
+      if(graph_ != nullptr && component == component_ && edges == edges_) {
+         return false;
+      }
+      component_ = component;
+      edges_ = edges;
+      no_components_ = component_.size() > 0 ? *std::max_element(component_.begin(), component_.end()) + 1 : 0;
+
+      // group original edges by the pair of components they connect
+      std::vector<INDEX> order(edges_.size());
+      std::iota(order.begin(), order.end(), 0);
+      auto component_edge = [this](const INDEX e) -> edge {
+         const INDEX c1 = component_[edges_[e][0]];
+         const INDEX c2 = component_[edges_[e][1]];
+         assert(c1 != c2);
+         return {std::min(c1,c2), std::max(c1,c2)};
+      };
+      std::sort(order.begin(), order.end(), [&](const INDEX e1, const INDEX e2) {
+            const auto c1 = component_edge(e1);
+            const auto c2 = component_edge(e2);
+            if(c1 != c2) { return c1 < c2; }
+            return edges_[e1] < edges_[e2];
+      });
+
+      component_edges_.clear();
+      component_edge_offsets_.clear();
+      expanded_edges_.clear();
+      component_edge_index_.clear();
+      for(INDEX k=0; k<order.size(); ++k) {
+         const auto ce = component_edge(order[k]);
+         if(component_edges_.empty() || component_edges_.back() != ce) {
+            component_edge_index_.insert(std::make_pair(pack_index_pair(ce[0], ce[1]), INDEX(component_edges_.size())));
+            component_edges_.push_back(ce);
+            component_edge_offsets_.push_back(expanded_edges_.size());
+         }
+         const auto& e = edges_[order[k]];
+         expanded_edges_.push_back({std::min(e[0],e[1]), std::max(e[0],e[1])});
+      }
+      component_edge_offsets_.push_back(expanded_edges_.size());
+
+      graph_.reset(new BKMaxFlow::Graph<int,int,int>(no_components_, component_edges_.size()));
+      graph_->add_node(no_components_);
+      for(INDEX k=0; k<component_edges_.size(); ++k) {
+         const int cap = component_edge_offsets_[k+1] - component_edge_offsets_[k];
+         graph_->add_edge(component_edges_[k][0], component_edges_[k][1], cap, cap);
+      }
+      capacity_max_ = edges_.size()+1;
+      source_ = std::numeric_limits<INDEX>::max();
+      sink_ = std::numeric_limits<INDEX>::max();
+      flow_computed_ = false;
+
+      cuts_.clear();
+      cut_cache_.clear();
+      return true;
+   }
+
+   INDEX no_components() const { return no_components_; }
+   INDEX component(const INDEX i) const { assert(i < component_.size()); return component_[i]; }
+
+   // minimum cut separating components c1 and c2. The reference is valid until the next call.
+   const cut& min_cut(const INDEX c1, const INDEX c2)
+   {
+      assert(c1 != c2 && c1 < no_components_ && c2 < no_components_);
+      const auto key = pack_index_pair(std::min(c1,c2), std::max(c1,c2));
+      auto it = cut_cache_.find(key);
+      if(it != cut_cache_.end()) {
+         return cuts_[it->second];
+      }
+
+      set_terminals(c1, c2);
+      const int flow = graph_->maxflow(flow_computed_);
+      flow_computed_ = true;
+      assert(flow > 0); // otherwise c1 and c2 are not connected
+
+      // the component side of c1 is explored by depth first search, edges to the sink side form the cut
+      cut c;
+      c.edges.reserve(flow);
+      visited_.assign(no_components_, false);
+      std::stack<INDEX> q;
+      q.push(c1);
+      while(!q.empty()) {
+         const INDEX v = q.top();
+         q.pop();
+         if(visited_[v]) {
+            continue;
+         }
+         visited_[v] = true;
+         for(auto* a = graph_->get_first_arc(v); a != nullptr; a = a->next) {
+            int v_test, w;
+            graph_->get_arc_ends(a, v_test, w);
+            assert(v_test == int(v) && int(v) != w);
+            if(graph_->what_segment(v) != graph_->what_segment(w)) {
+               const INDEX k = component_edge_index_.find(pack_index_pair(std::min(v,INDEX(w)), std::max(v,INDEX(w))))->second;
+               c.edges.insert(c.edges.end(), expanded_edges_.begin() + component_edge_offsets_[k], expanded_edges_.begin() + component_edge_offsets_[k+1]);
+            } else if(!visited_[w]) {
+               q.push(w);
+            }
+         }
+      }
+      assert(c.edges.size() == flow);
+      std::sort(c.edges.begin(), c.edges.end());
+      c.signature = signature(c.edges);
+
+      cut_cache_.insert(std::make_pair(key, INDEX(cuts_.size())));
+      cuts_.push_back(std::move(c));
+      return cuts_.back();
+   }
+
+private:
+   void set_terminals(const INDEX c1, const INDEX c2)
+   {
+      if(source_ != std::numeric_limits<INDEX>::max()) {
+         graph_->add_tweights(source_, -capacity_max_, 0);
+         graph_->add_tweights(sink_, 0, -capacity_max_);
+         graph_->mark_node(source_);
+         graph_->mark_node(sink_);
+      }
+      source_ = c1;
+      sink_ = c2;
+      graph_->add_tweights(source_, capacity_max_, 0);
+      graph_->add_tweights(sink_, 0, capacity_max_);
+      if(flow_computed_) {
+         graph_->mark_node(source_);
+         graph_->mark_node(sink_);
+      }
+   }
+
+   std::vector<INDEX> component_;
+   std::vector<edge> edges_;
+   INDEX no_components_ = 0;
+
+   std::vector<edge> component_edges_;
+   std::vector<std::size_t> component_edge_offsets_; // original edges of component edge k are expanded_edges_[component_edge_offsets_[k]], ..., expanded_edges_[component_edge_offsets_[k+1]-1]
+   std::vector<edge> expanded_edges_;
+   flat_hash_map<std::uint64_t, INDEX> component_edge_index_;
+
+   std::unique_ptr<BKMaxFlow::Graph<int,int,int>> graph_;
+   int capacity_max_ = 0;
+   INDEX source_ = std::numeric_limits<INDEX>::max();
+   INDEX sink_ = std::numeric_limits<INDEX>::max();
+   bool flow_computed_ = false; // search trees can only be reused after a first max flow computation
+
+   std::vector<cut> cuts_;
+   flat_hash_map<std::uint64_t, INDEX> cut_cache_; // packed component pair -> index into cuts_
+   std::vector<char> visited_;
+};
+
+} // end namespace LP_MP
+
+#endif // LP_MP_MULTICUT_MIN_CUT_HXX
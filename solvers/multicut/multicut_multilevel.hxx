@@ -0,0 +1,483 @@
+#ifndef LP_MP_MULTICUT_MULTILEVEL_HXX
+#define LP_MP_MULTICUT_MULTILEVEL_HXX
+
+#include "config.hxx"
+#include "union_find.hxx"
+#include "flat_hash_map.hxx"
+#include "multicut_gaec_kl.hxx"
+
+#include <vector>
+#include <array>
+#include <tuple>
+#include <queue>
+#include <string>
+#include <sstream>
+#include <stdexcept>
+#include <limits>
+#include <type_traits>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <iostream>
+
+#include "tclap/CmdLine.h"
+
+namespace LP_MP {
+
+// coarsening of a multicut instance by contracting strongly attractive edges.
+// Contraction proceeds in rounds: costs of parallel edges are added up, every node selects its incident edge of largest cost, and edges above the threshold selected by both end nodes are contracted.
+// Rounds are repeated until the number of nodes has shrunk to the given fraction or no edge can be contracted anymore.
+// The contracted edges form a spanning tree of every coarse node, along which paths between original nodes of the same coarse node are found.
+class multicut_coarsening {
+public:
+   using edge = std::array<INDEX,2>;
+
+   void coarsen(const INDEX no_nodes, const std::vector<edge>& edges, const std::vector<REAL>& costs, const REAL threshold, const REAL ratio)
+   {
+      assert(edges.size() == costs.size());
+      const INDEX target = std::max(INDEX(1), INDEX(std::ceil(ratio*no_nodes)));
+      UnionFind uf(no_nodes);
+      INDEX no_cur_nodes = no_nodes;
+      std::vector<edge> tree_edges;
+
+      // end nodes, summed cost, original edge of largest cost, which becomes a tree edge when the edge is contracted
+      std::vector<std::tuple<INDEX,INDEX,REAL,INDEX>> cur_edges;
+      cur_edges.reserve(edges.size());
+      for(INDEX e=0; e<edges.size(); ++e) {
+         if(edges[e][0] != edges[e][1]) {
+            cur_edges.push_back(std::make_tuple(std::min(edges[e][0],edges[e][1]), std::max(edges[e][0],edges[e][1]), costs[e], e));
+         }
+      }
+
+      std::vector<INDEX> best(no_nodes);
+      std::vector<REAL> best_cost(no_nodes);
+      while(no_cur_nodes > target) {
+         merge_parallel_edges(cur_edges, costs);
+         std::fill(best.begin(), best.end(), std::numeric_limits<INDEX>::max());
+         std::fill(best_cost.begin(), best_cost.end(), -std::numeric_limits<REAL>::infinity());
+         for(INDEX k=0; k<cur_edges.size(); ++k) {
+            const REAL c = std::get<2>(cur_edges[k]);
+            if(c <= threshold) { continue; }
+            for(const INDEX i : {std::get<0>(cur_edges[k]), std::get<1>(cur_edges[k])}) {
+               if(c > best_cost[i]) {
+                  best[i] = k;
+                  best_cost[i] = c;
+               }
+            }
+         }
+
+         // edges selected by both end nodes form a matching
+         INDEX no_contracted = 0;
+         for(INDEX k=0; k<cur_edges.size() && no_cur_nodes > target; ++k) {
+            const INDEX i = std::get<0>(cur_edges[k]);
+            const INDEX j = std::get<1>(cur_edges[k]);
+            if(best[i] == k && best[j] == k) {
+               uf.merge(i,j);
+               tree_edges.push_back(edges[std::get<3>(cur_edges[k])]);
+               --no_cur_nodes;
+               ++no_contracted;
+            }
+         }
+         if(no_contracted == 0) { break; }
+
+         for(auto& e : cur_edges) {
+            const INDEX i = uf.find(std::get<0>(e));
+            const INDEX j = uf.find(std::get<1>(e));
+            std::get<0>(e) = std::min(i,j);
+            std::get<1>(e) = std::max(i,j);
+         }
+         cur_edges.erase(std::remove_if(cur_edges.begin(), cur_edges.end(), [](const auto& e) { return std::get<0>(e) == std::get<1>(e); }), cur_edges.end());
+      }
+
+      // coarse nodes are numbered in order of first occurrence
+      node_map_.assign(no_nodes, std::numeric_limits<INDEX>::max());
+      std::vector<INDEX> root_coarse_node(no_nodes, std::numeric_limits<INDEX>::max());
+      no_coarse_nodes_ = 0;
+      for(INDEX i=0; i<no_nodes; ++i) {
+         const INDEX r = uf.find(i);
+         if(root_coarse_node[r] == std::numeric_limits<INDEX>::max()) {
+            root_coarse_node[r] = no_coarse_nodes_++;
+         }
+         node_map_[i] = root_coarse_node[r];
+      }
+
+      // coarse edges with summed costs. The original edge of largest absolute cost represents a coarse edge
+      coarse_edges_.clear();
+      coarse_costs_.clear();
+      representatives_.clear();
+      coarse_edge_index_.clear();
+      for(INDEX e=0; e<edges.size(); ++e) {
+         const INDEX c0 = node_map_[edges[e][0]];
+         const INDEX c1 = node_map_[edges[e][1]];
+         if(c0 == c1) { continue; }
+         const edge ce = {std::min(c0,c1), std::max(c0,c1)};
+         const edge oe = c0 < c1 ? edges[e] : edge{edges[e][1], edges[e][0]};
+         auto it = coarse_edge_index_.find(pack_index_pair(ce[0], ce[1]));
+         if(it == coarse_edge_index_.end()) {
+            coarse_edge_index_.insert(std::make_pair(pack_index_pair(ce[0], ce[1]), INDEX(coarse_edges_.size())));
+            coarse_edges_.push_back(ce);
+            coarse_costs_.push_back(costs[e]);
+            representatives_.push_back(std::make_pair(oe, costs[e]));
+         } else {
+            coarse_costs_[it->second] += costs[e];
+            if(std::abs(costs[e]) > std::abs(representatives_[it->second].second)) {
+               representatives_[it->second] = std::make_pair(oe, costs[e]);
+            }
+         }
+      }
+
+      build_spanning_trees(no_nodes, tree_edges);
+   }
+
+   INDEX no_nodes() const { return node_map_.size(); }
+   INDEX no_coarse_nodes() const { return no_coarse_nodes_; }
+   INDEX coarse_node(const INDEX i) const { assert(i < node_map_.size()); return node_map_[i]; }
+   const std::vector<edge>& coarse_edges() const { return coarse_edges_; }
+   const std::vector<REAL>& coarse_costs() const { return coarse_costs_; }
+
+   // original edge between coarse nodes c0 and c1, its first node lies in c0. If c0 and c1 are not adjacent, the roots of their spanning trees are returned.
+   edge representative(const INDEX c0, const INDEX c1) const
+   {
+      assert(c0 != c1 && c0 < no_coarse_nodes_ && c1 < no_coarse_nodes_);
+      auto it = coarse_edge_index_.find(pack_index_pair(std::min(c0,c1), std::max(c0,c1)));
+      if(it == coarse_edge_index_.end()) {
+         return {roots_[c0], roots_[c1]};
+      }
+      const edge e = representatives_[it->second].first;
+      return c0 < c1 ? e : edge{e[1], e[0]};
+   }
+
+   // appends the path of original nodes from i to j along contracted edges. i and j must lie in the same coarse node
+   void path(const INDEX i, const INDEX j, std::vector<INDEX>& p) const
+   {
+      assert(node_map_[i] == node_map_[j]);
+      std::vector<INDEX> back;
+      INDEX a = i;
+      INDEX b = j;
+      while(depth_[a] > depth_[b]) { p.push_back(a); a = parent_[a]; }
+      while(depth_[b] > depth_[a]) { back.push_back(b); b = parent_[b]; }
+      while(a != b) {
+         p.push_back(a); a = parent_[a];
+         back.push_back(b); b = parent_[b];
+      }
+      p.push_back(a);
+      p.insert(p.end(), back.rbegin(), back.rend());
+   }
+
+private:
+   // sort by end nodes, add up costs of parallel edges and keep the original edge of largest cost
+   static void merge_parallel_edges(std::vector<std::tuple<INDEX,INDEX,REAL,INDEX>>& cur_edges, const std::vector<REAL>& costs)
+   {
+      std::sort(cur_edges.begin(), cur_edges.end(), [](const auto& a, const auto& b) {
+            return std::make_tuple(std::get<0>(a), std::get<1>(a), std::get<3>(a)) < std::make_tuple(std::get<0>(b), std::get<1>(b), std::get<3>(b));
+      });
+      INDEX n = 0;
+      for(INDEX k=0; k<cur_edges.size(); ++k) {
+         if(n > 0 && std::get<0>(cur_edges[n-1]) == std::get<0>(cur_edges[k]) && std::get<1>(cur_edges[n-1]) == std::get<1>(cur_edges[k])) {
+            std::get<2>(cur_edges[n-1]) += std::get<2>(cur_edges[k]);
+            if(costs[std::get<3>(cur_edges[k])] > costs[std::get<3>(cur_edges[n-1])]) {
+               std::get<3>(cur_edges[n-1]) = std::get<3>(cur_edges[k]);
+            }
+         } else {
+            cur_edges[n++] = cur_edges[k];
+         }
+      }
+      cur_edges.resize(n);
+   }
+
+   void build_spanning_trees(const INDEX no_nodes, const std::vector<edge>& tree_edges)
+   {
+      std::vector<INDEX> offsets(no_nodes+1, 0);
+      for(const auto& e : tree_edges) {
+         ++offsets[e[0]+1];
+         ++offsets[e[1]+1];
+      }
+      std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+      std::vector<INDEX> fill(offsets.begin(), offsets.end()-1);
+      std::vector<INDEX> neighbors(offsets.back());
+      for(const auto& e : tree_edges) {
+         neighbors[fill[e[0]]++] = e[1];
+         neighbors[fill[e[1]]++] = e[0];
+      }
+
+      parent_.assign(no_nodes, std::numeric_limits<INDEX>::max());
+      depth_.assign(no_nodes, 0);
+      roots_.assign(no_coarse_nodes_, std::numeric_limits<INDEX>::max());
+      std::queue<INDEX> q;
+      for(INDEX r=0; r<no_nodes; ++r) {
+         if(roots_[node_map_[r]] != std::numeric_limits<INDEX>::max()) { continue; }
+         roots_[node_map_[r]] = r;
+         parent_[r] = r;
+         q.push(r);
+         while(!q.empty()) {
+            const INDEX i = q.front();
+            q.pop();
+            for(INDEX k=offsets[i]; k<offsets[i+1]; ++k) {
+               const INDEX j = neighbors[k];
+               if(parent_[j] == std::numeric_limits<INDEX>::max()) {
+                  assert(node_map_[j] == node_map_[r]);
+                  parent_[j] = i;
+                  depth_[j] = depth_[i] + 1;
+                  q.push(j);
+               }
+            }
+         }
+      }
+   }
+
+   std::vector<INDEX> node_map_;
+   INDEX no_coarse_nodes_ = 0;
+   std::vector<edge> coarse_edges_;
+   std::vector<REAL> coarse_costs_;
+   std::vector<std::pair<edge,REAL>> representatives_;
+   flat_hash_map<std::uint64_t, INDEX> coarse_edge_index_;
+
+   // spanning trees of coarse nodes
+   std::vector<INDEX> parent_; // roots are their own parents
+   std::vector<INDEX> depth_;
+   std::vector<INDEX> roots_; // root of every coarse node
+};
+
+// solvers for which the multilevel warm start is available, see multicut.h
+template<typename FMC>
+struct multicut_multilevel_enabled : std::false_type {};
+
+class multicut_multilevel_base {
+public:
+   virtual ~multicut_multilevel_base() {}
+   virtual void warm_start() = 0;
+};
+
+// Multilevel warm start of multicut problems, held by the multicut constructor and run before the first iteration.
+// The problem is coarsened, the coarse problem is solved by a solver of the same type, which may coarsen it further, and its state is projected back:
+// (i) every coarse triplet is expanded to a cycle in the original graph through the representative edges of its coarse edges and paths inside coarse nodes. The cycle is triangulated and added.
+// (ii) with messages between edges and triplets only, triplet potentials are linear in the edge labels. Such a triplet potential is moved onto the added triplets containing the representative edges,
+//      and subtracted from the representative edge factors. This is a reparametrization of the original problem, hence the lower bound stays valid.
+//      Triplets which received messages from odd wheels are not linear. Their cycles are added, their potentials are not projected.
+// (iii) a coarse labeling is computed by GAEC and Kernighan&Lin on the coarse costs. Its projection is registered as first primal solution and handed to primal rounding,
+//       which starts Kernighan&Lin from it if it is better than GAEC.
+// Mild coarsening works best: coarse problems close to the original one yield duals close to optimal ones for it, while strongly attractive edges, on which message passing is slow, are gone.
+// Experimental and off by default: early iterations improve, but the final lower bound may be worse than without warm start, e.g. on a 3600 node grid.
+// Coarse problems are solved with the tightening and rounding options of the original one. Without tightening they are tightened with default parameters, since otherwise no triplets are projected.
+template<typename SOLVER>
+class multicut_multilevel : public multicut_multilevel_base {
+public:
+   // coarse triplets expanding to longer cycles are not projected
+   INDEX max_cycle_length = 16;
+
+   multicut_multilevel(SOLVER& s)
+   : solver_(s),
+   levelsArg_("","multilevel","experimental: number of coarsened problems solved to initialize triplets, duals and primal rounding of the original one, default = 0. The final lower bound may be worse than without. Not to be combined with resumeFrom",false,0,"positive integer",s.get_cmd()),
+   iterationsArg_("","multilevelIterations","iterations on each coarsened problem, default = 100",false,100,"positive integer",s.get_cmd()),
+   ratioArg_("","multilevelCoarsening","fraction of nodes left after coarsening, default = 0.8",false,0.8,"real in (0,1)",s.get_cmd()),
+   thresholdArg_("","multilevelThreshold","only edges with larger cost are contracted, default = 0",false,0.0,"real",s.get_cmd())
+   {}
+
+   void warm_start()
+   {
+      const INDEX levels = levelsArg_.getValue();
+      if(levels == 0) { return; }
+      if(solver_.resuming()) {
+         // the checkpoint holds the dual state of the original problem only, factors added by the warm start would not match it
+         throw std::runtime_error("multilevel cannot be combined with resumeFrom");
+      }
+      auto& pc = solver_.template GetProblemConstructor<0>();
+      const auto s = pc.edge_cost_snapshot();
+      coarsening_.coarsen(s->no_nodes, s->edges, s->costs, thresholdArg_.getValue(), ratioArg_.getValue());
+      if(coarsening_.no_coarse_nodes() == s->no_nodes || coarsening_.coarse_edges().size() < 3) {
+         std::cout << "multilevel: no edges to contract\n";
+         return;
+      }
+      std::cout << "multilevel: coarsened " << s->no_nodes << " nodes and " << s->edges.size() << " edges to " << coarsening_.no_coarse_nodes() << " nodes and " << coarsening_.coarse_edges().size() << " edges\n";
+
+      SOLVER coarse(coarse_options(levels-1));
+      auto& coarse_pc = coarse.template GetProblemConstructor<0>();
+      for(INDEX e=0; e<coarsening_.coarse_edges().size(); ++e) {
+         const auto& ce = coarsening_.coarse_edges()[e];
+         coarse_pc.AddUnaryFactor(ce[0], ce[1], coarsening_.coarse_costs()[e]);
+      }
+      coarse.Solve();
+
+      project_triplets(pc, coarse_pc);
+
+      // the projected coarse labeling is an upper bound before the first iteration
+      const auto labeling = project_labeling(pc, coarse_labeling(coarse_pc));
+      pc.write_labeling_into_factors(labeling);
+      solver_.RegisterPrimal();
+      pc.warm_start_rounding(labeling);
+   }
+
+private:
+   std::vector<std::string> coarse_options(const INDEX levels) const
+   {
+      auto str = [](const auto x) {
+         std::stringstream ss;
+         ss.precision(std::numeric_limits<REAL>::max_digits10);
+         ss << x;
+         return ss.str();
+      };
+      std::vector<std::string> options = {"",
+         "--maxIter", str(iterationsArg_.getValue()),
+         "--multilevel", str(levels),
+         "--multilevelIterations", str(iterationsArg_.getValue()),
+         "--multilevelCoarsening", str(ratioArg_.getValue()),
+         "--multilevelThreshold", str(thresholdArg_.getValue())};
+      const auto forwarded = forwarded_options();
+      if(std::find(forwarded.begin(), forwarded.end(), "--tighten") == forwarded.end()) {
+         options.insert(options.end(), {"--tighten", "--tightenIteration", "10", "--tightenInterval", "20", "--tightenConstraintsPercentage", "0.1"});
+      }
+      options.insert(options.end(), forwarded.begin(), forwarded.end());
+      return options;
+   }
+
+   // tightening and rounding options given to the original solver, together with their values
+   std::vector<std::string> forwarded_options() const
+   {
+      auto forward = [](const std::string& name) { return name.compare(0, 7, "tighten") == 0 || name == "nativeRounding"; };
+      const auto& options = solver_.get_options();
+      auto& args = solver_.get_cmd().getArgList();
+      std::vector<std::string> forwarded;
+      for(INDEX i=1; i<options.size(); ++i) {
+         if(options[i].compare(0, 2, "--") != 0 || !forward(options[i].substr(2))) { continue; }
+         auto it = std::find_if(args.begin(), args.end(), [&](const TCLAP::Arg* a) { return a->getName() == options[i].substr(2); });
+         assert(it != args.end());
+         forwarded.push_back(options[i]);
+         if((*it)->isValueRequired() && i+1 < options.size()) {
+            forwarded.push_back(options[++i]);
+         }
+      }
+      return forwarded;
+   }
+
+   template<typename PROBLEM_CONSTRUCTOR>
+   void project_triplets(PROBLEM_CONSTRUCTOR& pc, const PROBLEM_CONSTRUCTOR& coarse_pc)
+   {
+      INDEX no_projected = 0;
+      INDEX no_nonlinear = 0;
+      INDEX no_too_long = 0;
+      std::vector<INDEX> cycle;
+      coarse_pc.for_each_triplet_factor([&](const std::array<INDEX,3>& idx, const auto* t) {
+            const auto& c = *t->GetFactor();
+            // labelings are 011, 101, 110, 111 on edges (i0,i1), (i0,i2), (i1,i2). Linear potentials are given by the cost of cutting each edge
+            const std::array<REAL,3> edge_cost = {c[3]-c[0], c[3]-c[1], c[3]-c[2]};
+            const REAL tolerance = eps * (1.0 + std::abs(c[3]));
+            const bool linear = std::abs(c[0] - edge_cost[1] - edge_cost[2]) <= tolerance
+               && std::abs(c[1] - edge_cost[0] - edge_cost[2]) <= tolerance
+               && std::abs(c[2] - edge_cost[0] - edge_cost[1]) <= tolerance;
+
+            const std::array<std::array<INDEX,2>,3> edges = {coarsening_.representative(idx[0], idx[1]), coarsening_.representative(idx[0], idx[2]), coarsening_.representative(idx[1], idx[2])};
+            cycle.clear();
+            coarsening_.path(edges[1][0], edges[0][0], cycle);
+            coarsening_.path(edges[0][1], edges[2][0], cycle);
+            coarsening_.path(edges[2][1], edges[1][1], cycle);
+            if(cycle.size() > max_cycle_length) {
+               ++no_too_long;
+               return;
+            }
+
+            // representatives of coarse edges added during tightening are not in the original graph
+            for(const auto& e : edges) {
+               if(!pc.HasUnaryFactor(std::min(e[0],e[1]), std::max(e[0],e[1]))) {
+                  pc.AddUnaryFactor(std::min(e[0],e[1]), std::max(e[0],e[1]), 0.0);
+               }
+            }
+            pc.AddCycle(cycle);
+            if(!linear) {
+               ++no_nonlinear;
+               return;
+            }
+            std::rotate(cycle.begin(), std::min_element(cycle.begin(), cycle.end()), cycle.end());
+            for(INDEX p=0; p<3; ++p) {
+               move_edge_cost(pc, cycle, edges[p], edge_cost[p]);
+            }
+            ++no_projected;
+      });
+      std::cout << "multilevel: projected " << no_projected << " triplets, added cycles of " << no_nonlinear << " triplets with non-linear potentials, skipped " << no_too_long << " triplets with cycles longer than " << max_cycle_length << "\n";
+   }
+
+   // move cost of cutting original edge e from its edge factor to the triplet of the triangulated cycle containing it.
+   // AddCycle triangulates cycle (c0,...,c_{n-1}) starting with its smallest node c0 by triplets (c0,c_{i-1},c_i), i=2,...,n-1.
+   template<typename PROBLEM_CONSTRUCTOR>
+   static void move_edge_cost(PROBLEM_CONSTRUCTOR& pc, const std::vector<INDEX>& cycle, const std::array<INDEX,2> e, const REAL cost)
+   {
+      const INDEX n = cycle.size();
+      const INDEX p0 = std::find(cycle.begin(), cycle.end(), e[0]) - cycle.begin();
+      const INDEX p1 = std::find(cycle.begin(), cycle.end(), e[1]) - cycle.begin();
+      assert(p0 < n && p1 < n);
+      const INDEX k = (p0+1)%n == p1 ? p0 : p1; // e = (c_k, c_{k+1})
+      const INDEX i = std::min(std::max(k+1, INDEX(2)), n-1);
+      std::array<INDEX,3> t = {cycle[0], cycle[i-1], cycle[i]};
+      std::sort(t.begin(), t.end());
+      const std::array<INDEX,2> se = {std::min(e[0],e[1]), std::max(e[0],e[1])};
+      const INDEX edge_no = se == std::array<INDEX,2>{t[0],t[1]} ? 0 : (se == std::array<INDEX,2>{t[0],t[2]} ? 1 : 2);
+      assert(edge_no < 2 || (se == std::array<INDEX,2>{t[1],t[2]}));
+
+      auto& triplet = *pc.GetTripletFactor(t[0], t[1], t[2])->GetFactor();
+      for(INDEX l=0; l<4; ++l) {
+         if(l != edge_no) { // edge edge_no is cut in all labelings except the edge_no-th one
+            triplet[l] += cost;
+         }
+      }
+      (*pc.GetUnaryFactor(se[0], se[1])->GetFactor())[0] -= cost;
+   }
+
+   // labeling of the coarse edges: Kernighan&Lin on the coarse costs, started from the better one of GAEC and the rounding of the reparametrized coarse problem
+   template<typename PROBLEM_CONSTRUCTOR>
+   std::vector<char> coarse_labeling(PROBLEM_CONSTRUCTOR& coarse_pc)
+   {
+      const auto& edges = coarsening_.coarse_edges();
+      const auto& costs = coarsening_.coarse_costs();
+      std::vector<char> labeling;
+      multicut_gaec_kl gaec_kl;
+      gaec_kl.gaec(coarsening_.no_coarse_nodes(), edges, costs, labeling);
+
+      coarse_pc.ComputePrimal();
+      coarse_pc.End();
+      UnionFind uf(coarsening_.no_coarse_nodes());
+      for(INDEX e=0; e<coarse_pc.NumOfUnaryFactors(); ++e) {
+         const auto ce = coarse_pc.GetEdge(e);
+         if(!coarse_pc.get_edge_label(ce[0], ce[1])) {
+            uf.merge(ce[0], ce[1]);
+         }
+      }
+      std::vector<char> rounded(edges.size());
+      for(INDEX e=0; e<edges.size(); ++e) {
+         rounded[e] = !uf.connected(edges[e][0], edges[e][1]);
+      }
+      if(multicut_gaec_kl::cost(costs, rounded) < multicut_gaec_kl::cost(costs, labeling)) {
+         labeling = std::move(rounded);
+      }
+
+      gaec_kl.kernighan_lin(coarsening_.no_coarse_nodes(), edges, costs, labeling);
+      return labeling;
+   }
+
+   // coarse labeling on all current edges: an edge is cut iff its end nodes lie in different coarse components
+   template<typename PROBLEM_CONSTRUCTOR>
+   std::vector<char> project_labeling(const PROBLEM_CONSTRUCTOR& pc, const std::vector<char>& coarse_labeling) const
+   {
+      UnionFind uf(coarsening_.no_coarse_nodes());
+      for(INDEX e=0; e<coarse_labeling.size(); ++e) {
+         if(!coarse_labeling[e]) {
+            uf.merge(coarsening_.coarse_edges()[e][0], coarsening_.coarse_edges()[e][1]);
+         }
+      }
+      std::vector<char> labeling(pc.NumOfUnaryFactors());
+      for(INDEX e=0; e<labeling.size(); ++e) {
+         const auto fe = pc.GetEdge(e);
+         labeling[e] = !uf.connected(coarsening_.coarse_node(fe[0]), coarsening_.coarse_node(fe[1]));
+      }
+      return labeling;
+   }
+
+   SOLVER& solver_;
+   TCLAP::ValueArg<INDEX> levelsArg_;
+   TCLAP::ValueArg<INDEX> iterationsArg_;
+   TCLAP::ValueArg<REAL> ratioArg_;
+   TCLAP::ValueArg<REAL> thresholdArg_;
+   multicut_coarsening coarsening_;
+};
+
+} // end namespace LP_MP
+
+#endif // LP_MP_MULTICUT_MULTILEVEL_HXX
@@ -36,7 +36,7 @@ public:
    constexpr static INDEX size() { return 9; }
    REAL LowerBound() const
    {
-      return std::min(0.0, *std::min_element(this->begin(), this->end()));
+      return std::min(REAL(0.0), *std::min_element(this->begin(), this->end()));
    }
    REAL EvaluatePrimal() const
    {
@@ -176,7 +176,7 @@ public:
    void ReceiveMessageFromRight(const RIGHT_FACTOR& r, G2& msg) 
    {
       assert(r.size() == 9);
-      const REAL x = std::min(r[tripletPlusSpokeEdge_],0.0); // this entry and label 0000 is not covered by the message, hence it has to be substracted
+      const REAL x = std::min(r[tripletPlusSpokeEdge_],REAL(0.0)); // this entry and label 0000 is not covered by the message, hence it has to be substracted
       msg[0] -= std::min(r[tripletPlusSpokeEdge_+4],r[8]) - x;
       msg[1] -= std::min({r[3],r[(tripletPlusSpokeEdge_+1)%3],r[(tripletPlusSpokeEdge_+2)%3]}) - x;
       msg[2] -= std::min({r[((tripletPlusSpokeEdge_+1)%3) + 4],r[((tripletPlusSpokeEdge_+2)%3) + 4],r[7]}) - x;
@@ -346,7 +346,7 @@ public:
    {
       assert(r.size() == 9);
       for(INDEX i=0; i<4; ++i) {
-         msg[i] -= std::min(r[i], r[i+4]) - std::min(r[8],0.0);
+         msg[i] -= std::min(r[i], r[i+4]) - std::min(r[8],REAL(0.0));
       }
    }
 
@@ -0,0 +1,282 @@
+#ifndef LP_MP_MULTICUT_ROUNDING_HXX
+#define LP_MP_MULTICUT_ROUNDING_HXX
+
+#include "config.hxx"
+#include "union_find.hxx"
+#include "multicut_gaec_kl.hxx"
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <limits>
+
+#include "andres/graph/graph.hxx"
+#include "andres/graph/multicut/kernighan-lin.hxx"
+#include "andres/graph/multicut/greedy-additive.hxx"
+
+namespace LP_MP {
+
+// state of primal rounding running asynchronously to message passing. Handed to visitors which have a function rounding_progress(const RoundingProgress&).
+class RoundingProgress {
+public:
+   INDEX jobsStarted = 0;
+   INDEX jobsFinished = 0;
+   INDEX jobsCancelled = 0; // stopped early because it was outdated by more recent costs
+   bool running = false;
+   INDEX localSearchIterations = 0; // of running job, or of last job if none is running
+   REAL cost = std::numeric_limits<REAL>::infinity(); // of last rounded solution w.r.t. the costs it was computed for
+};
+
+// GAEC + Kernighan&Lin rounding of multicut problems in a worker thread, running concurrently to message passing.
+// Costs are handed over as immutable snapshots. A running job is left to finish, unless cancel_age snapshots have been submitted since its own:
+// then it stops after its current Kernighan&Lin outer iteration, its labeling can still be collected, and the freshest snapshot is rounded next.
+// GAEC and Kernighan&Lin are those of the andres graph package, or optionally those of multicut_gaec_kl, whose buffers are kept between jobs.
+// Kernighan&Lin is started from the better one of GAEC on the current costs and the previous labeling, hence progress of cancelled jobs is not lost.
+class multicut_rounding {
+public:
+   struct snapshot {
+      INDEX no_nodes;
+      std::vector<std::array<INDEX,2>> edges; // edges of earlier snapshots come first, in the same order
+      std::vector<REAL> costs; // cost for cutting edge
+   };
+
+   multicut_rounding() {}
+   multicut_rounding(const multicut_rounding&) = delete;
+   multicut_rounding& operator=(const multicut_rounding&) = delete;
+
+   ~multicut_rounding()
+   {
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         stop_ = true;
+         cancel_ = true;
+      }
+      cv_.notify_all();
+      if(worker_.joinable()) {
+         worker_.join();
+      }
+   }
+
+   // does not block. Snapshots which have not been started yet are replaced.
+   void submit(std::shared_ptr<const snapshot> s)
+   {
+      assert(s->edges.size() == s->costs.size());
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         pending_ = std::move(s);
+         ++no_submitted_;
+         if(running_ && no_submitted_ - running_submission_ >= cancel_age_) {
+            cancel_ = true;
+         }
+         if(!worker_.joinable()) {
+            worker_ = std::thread([this]() { run(); });
+         }
+      }
+      cv_.notify_all();
+   }
+
+   // labeling from which the next job starts Kernighan&Lin, if it is better than GAEC. Edges not covered are labeled as in extend_previous_labeling.
+   void warm_start(std::vector<char> labeling)
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      warm_start_ = std::move(labeling);
+   }
+
+   // labeling of the last job, if it has finished or been cancelled since the last call. Does not block.
+   bool collect(std::vector<char>& labeling)
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if(!result_ready_) { return false; }
+      labeling = std::move(result_);
+      result_ready_ = false;
+      return true;
+   }
+
+   // wait until the last submitted snapshot is rounded and return its labeling, if not collected already
+   bool wait(std::vector<char>& labeling)
+   {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return !running_ && pending_ == nullptr; });
+      if(!result_ready_) { return false; }
+      labeling = std::move(result_);
+      result_ready_ = false;
+      return true;
+   }
+
+   // a running job is cancelled when the given number of newer snapshots has been submitted. With 1 every submission cancels the running job.
+   void set_cancel_age(const INDEX age)
+   {
+      assert(age >= 1);
+      std::lock_guard<std::mutex> lock(mutex_);
+      cancel_age_ = age;
+   }
+
+   // use multicut_gaec_kl instead of the andres graph package. Faster on large instances, but GAEC by matching rounds gives slightly worse labelings.
+   void use_native_gaec_kl(const bool native) { native_ = native; }
+
+   RoundingProgress progress() const
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      RoundingProgress p = progress_;
+      p.running = running_;
+      p.localSearchIterations = local_search_iterations_;
+      return p;
+   }
+
+private:
+   void run()
+   {
+      while(true) {
+         std::shared_ptr<const snapshot> s;
+         {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stop_ || pending_ != nullptr; });
+            if(stop_) { return; }
+            s = std::move(pending_);
+            pending_ = nullptr;
+            running_ = true;
+            running_submission_ = no_submitted_;
+            cancel_ = false;
+            local_search_iterations_ = 0;
+            ++progress_.jobsStarted;
+            if(!warm_start_.empty()) {
+               prev_labeling_ = std::move(warm_start_);
+               warm_start_.clear();
+            }
+         }
+
+         std::vector<char> labeling = round(*s);
+         const REAL c = cost(*s, labeling);
+         {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+            if(cancel_) {
+               ++progress_.jobsCancelled;
+            } else {
+               ++progress_.jobsFinished;
+            }
+            progress_.cost = c;
+            result_ = labeling;
+            result_ready_ = true;
+         }
+         cv_.notify_all();
+         prev_labeling_ = std::move(labeling);
+      }
+   }
+
+   static REAL cost(const snapshot& s, const std::vector<char>& labeling)
+   {
+      return multicut_gaec_kl::cost(s.costs, labeling);
+   }
+
+   // labeling of previous job on the edges of the current one. Edges added since are cut iff their endpoints lie in different components.
+   std::vector<char> extend_previous_labeling(const snapshot& s) const
+   {
+      assert(prev_labeling_.size() <= s.edges.size());
+      std::vector<char> labeling(prev_labeling_);
+      labeling.reserve(s.edges.size());
+      UnionFind uf(s.no_nodes);
+      for(INDEX e=0; e<prev_labeling_.size(); ++e) {
+         if(!prev_labeling_[e]) {
+            uf.merge(s.edges[e][0], s.edges[e][1]);
+         }
+      }
+      for(INDEX e=prev_labeling_.size(); e<s.edges.size(); ++e) {
+         labeling.push_back(uf.connected(s.edges[e][0], s.edges[e][1]) ? 0 : 1);
+      }
+      return labeling;
+   }
+
+   std::vector<char> round(const snapshot& s)
+   {
+      if(native_) {
+         return round_native(s);
+      }
+
+      std::vector<char> labeling(s.edges.size(), 0);
+      if(s.edges.size() == 0) { return labeling; }
+
+      andres::graph::Graph<> g(s.no_nodes);
+      for(const auto& e : s.edges) {
+         g.insertEdge(e[0], e[1]);
+      }
+
+      andres::graph::multicut::greedyAdditiveEdgeContraction(g, s.costs, labeling);
+      REAL c = cost(s, labeling);
+      if(prev_labeling_.size() > 0) {
+         auto prev = extend_previous_labeling(s);
+         const REAL prev_cost = cost(s, prev);
+         if(prev_cost < c) {
+            labeling = std::move(prev);
+            c = prev_cost;
+         }
+      }
+
+      // run Kernighan&Lin one outer iteration at a time to be able to stop when cancelled
+      andres::graph::multicut::KernighanLinSettings settings;
+      settings.numberOfOuterIterations = 1;
+      settings.verbose = false;
+      std::vector<char> next(labeling.size());
+      while(!cancel_) {
+         andres::graph::multicut::kernighanLin(g, s.costs, labeling, next, settings);
+         ++local_search_iterations_;
+         const REAL next_cost = cost(s, next);
+         if(!(next_cost < c)) { break; }
+         std::swap(labeling, next);
+         c = next_cost;
+      }
+      return labeling;
+   }
+
+   std::vector<char> round_native(const snapshot& s)
+   {
+      std::vector<char> labeling;
+      gaec_kl_.gaec(s.no_nodes, s.edges, s.costs, labeling);
+      if(prev_labeling_.size() > 0) {
+         auto prev = extend_previous_labeling(s);
+         if(cost(s, prev) < cost(s, labeling)) {
+            labeling = std::move(prev);
+         }
+      }
+
+      if(!cancel_) {
+         gaec_kl_.kernighan_lin(s.no_nodes, s.edges, s.costs, labeling, [this]() {
+               ++local_search_iterations_;
+               return !cancel_;
+         });
+      }
+      return labeling;
+   }
+
+   mutable std::mutex mutex_;
+   std::condition_variable cv_;
+   std::thread worker_; // started with first submitted snapshot
+
+   // guarded by mutex_
+   std::shared_ptr<const snapshot> pending_;
+   bool running_ = false;
+   bool stop_ = false;
+   std::vector<char> result_;
+   bool result_ready_ = false;
+   std::vector<char> warm_start_;
+   RoundingProgress progress_;
+   INDEX no_submitted_ = 0;
+   INDEX running_submission_ = 0; // number of the snapshot being rounded
+   INDEX cancel_age_ = 3;
+
+   std::atomic<bool> cancel_{false};
+   std::atomic<bool> native_{false};
+   std::atomic<INDEX> local_search_iterations_{0};
+
+   // only accessed by worker thread
+   std::vector<char> prev_labeling_;
+   multicut_gaec_kl gaec_kl_;
+};
+
+} // end namespace LP_MP
+
+#endif // LP_MP_MULTICUT_ROUNDING_HXX
@@ -31,7 +31,7 @@ public:
 
    REAL LowerBound() const
    {
-      return std::min(0.0, *std::min_element(this->begin(), this->end()));
+      return std::min(REAL(0.0), *std::min_element(this->begin(), this->end()));
    }
 
    // if one entry is unknown, set it to true. If one entry is true, set all other to false
@@ -130,7 +130,7 @@ public:
    void
    ReceiveMessageFromRight(const RIGHT_FACTOR& r, G2& msg) const
    {
-      msg[0] -= std::min({r[(i_+1)%3], r[(i_+2)%3], r[3]}) - std::min(r[i_],0.0);
+      msg[0] -= std::min({r[(i_+1)%3], r[(i_+2)%3], r[3]}) - std::min(r[i_], REAL(0.0));
    }
 
    template<typename RIGHT_FACTOR, typename G2, MessageSendingType MST_TMP = MST>
@@ -29,7 +29,7 @@ public:
       */
    }
    REAL LowerBound() const {
-      return std::min(pot_,0.0);
+      return std::min(pot_, REAL(0.0));
    }
 
    constexpr static INDEX size() { return 1; }
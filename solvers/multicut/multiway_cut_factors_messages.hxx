@@ -108,7 +108,7 @@ private:
 // Corresponds to the pairwise factor in graphical models
 class multi_terminal_factor : public pairwise_potts_factor {
 public:
-  multi_terminal_factor(const INDEX T) : pairwise_potts_factor(T, 0.0) {} 
+  multi_terminal_factor(const INDEX T) : pairwise_potts_factor(T, REAL(0.0)) {} 
 
   REAL LowerBound() const {
      cut_to_one_hot_encoding(msg1_begin(), msg1_end());
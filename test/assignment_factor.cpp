@@ -0,0 +1,186 @@
+#include "catch.hpp"
+#include <vector>
+#include <array>
+#include <random>
+#include <cmath>
+#include "config.hxx"
+#include "factors/assignment_factor.hxx"
+#include "lib/MinCost/MinCost.h"
+
+using namespace LP_MP;
+
+// optimal partial assignment with slack via min cost flow
+static REAL assignment_by_min_cost_flow(const INDEX n, const std::vector<std::array<INDEX,2>>& edges, const std::vector<REAL>& cost)
+{
+   MinCost<SIGNED_INDEX,REAL> mcf(2*n+2, edges.size() + 2*n + 1);
+   for(INDEX e=0; e<edges.size(); ++e) {
+      mcf.AddEdge(edges[e][0], n + edges[e][1], 1, 0, cost[e]);
+   }
+   for(INDEX i=0; i<n; ++i) {
+      mcf.AddEdge(i, 2*n+1, 1, 0, cost[edges.size() + i]);
+      mcf.AddNodeExcess(i, 1);
+   }
+   for(INDEX j=0; j<n; ++j) {
+      mcf.AddEdge(2*n, n + j, 1, 0, cost[edges.size() + n + j]);
+      mcf.AddNodeExcess(n + j, -1);
+   }
+   mcf.AddEdge(2*n, 2*n+1, n, 0, 0.0);
+   mcf.AddNodeExcess(2*n, n);
+   mcf.AddNodeExcess(2*n+1, -SIGNED_INDEX(n));
+   return mcf.Solve();
+}
+
+// random sparse assignment instance containing all diagonal edges, costs of assignment edges followed by slack costs of left and right nodes
+static void random_assignment_instance(const INDEX n, std::mt19937& gen, std::vector<std::array<INDEX,2>>& edges, std::vector<REAL>& cost)
+{
+   std::uniform_real_distribution<REAL> dist(-1.0, 1.0);
+   edges.clear();
+   for(INDEX i=0; i<n; ++i) {
+      for(INDEX j=0; j<n; ++j) {
+         if(i == j || gen() % 4 == 0) { edges.push_back({i,j}); }
+      }
+   }
+   cost.resize(edges.size() + 2*n);
+   for(auto& c : cost) { c = dist(gen); }
+   // slack costs are usually higher
+   for(INDEX k=edges.size(); k<cost.size(); ++k) { cost[k] += 0.5; }
+}
+
+TEST_CASE( "assignment factor", "[auction assignment factor]" ) {
+   std::mt19937 gen(1);
+   std::uniform_real_distribution<REAL> dist(-1.0, 1.0);
+
+   for(const INDEX n : {1, 5, 30, 100}) {
+      std::vector<std::array<INDEX,2>> edges;
+      std::vector<REAL> cost;
+      random_assignment_instance(n, gen, edges, cost);
+
+      AssignmentFactor f(n, n, edges, cost);
+      REQUIRE(f.size() == cost.size());
+      for(INDEX e=0; e<edges.size(); ++e) {
+         REQUIRE(f.left_node(e) == edges[e][0]);
+         REQUIRE(f.right_node(e) == edges[e][1]);
+      }
+
+      for(INDEX round=0; round<5; ++round) {
+         const REAL opt = assignment_by_min_cost_flow(n, edges, cost);
+         const REAL lb = f.LowerBound();
+         f.MaximizePotentialAndComputePrimal();
+         const REAL ub = f.EvaluatePrimal();
+         REQUIRE(lb <= opt + eps);
+         REQUIRE(opt <= ub + eps);
+         REQUIRE(ub - lb <= 1e-4);
+
+         // sending reduced costs keeps the lower bound
+         for(INDEX e=0; e<f.size(); ++e) {
+            REQUIRE(f.reduced_cost(e) >= 0.0);
+         }
+         for(INDEX e=0; e<f.size(); ++e) {
+            const REAL delta = -0.5*f.reduced_cost(e);
+            f.update_cost(e, delta);
+            cost[e] += delta;
+         }
+         REQUIRE(std::abs(f.LowerBound() - lb) <= 1e-4);
+
+         // a few cost changes, warm started re-solve
+         for(INDEX k=0; k<3; ++k) {
+            const INDEX e = gen() % f.size();
+            const REAL delta = dist(gen);
+            f.update_cost(e, delta);
+            cost[e] += delta;
+         }
+      }
+   }
+}
+
+TEST_CASE( "Hungarian assignment factor", "[incremental Hungarian assignment factor]" ) {
+   std::mt19937 gen(2);
+   std::uniform_real_distribution<REAL> dist(-1.0, 1.0);
+
+   for(const INDEX n : {1, 5, 30, 100}) {
+      std::vector<std::array<INDEX,2>> edges;
+      std::vector<REAL> cost;
+      random_assignment_instance(n, gen, edges, cost);
+
+      HungarianAssignmentFactor f(n, n, edges, cost);
+      f.max_augmenting_paths = 1;
+
+      for(INDEX round=0; round<5; ++round) {
+         const REAL opt = assignment_by_min_cost_flow(n, edges, cost);
+
+         // bounded number of augmenting paths per solve: lower bounds are valid and do not decrease
+         REAL prev_lb = -std::numeric_limits<REAL>::infinity();
+         while(f.no_unmatched_persons() > 0) {
+            const REAL lb = f.LowerBound();
+            REQUIRE(lb <= opt + eps);
+            REQUIRE(lb >= prev_lb - eps);
+            prev_lb = lb;
+         }
+
+         f.MaximizePotentialAndComputePrimal();
+         const REAL lb = f.LowerBound();
+         const REAL ub = f.EvaluatePrimal();
+         REQUIRE(std::abs(lb - opt) <= 1e-6);
+         REQUIRE(std::abs(ub - opt) <= 2*n*eps + 1e-6);
+
+         // sending reduced costs keeps the lower bound and the matching
+         for(INDEX e=0; e<f.size(); ++e) {
+            REQUIRE(f.reduced_cost(e) >= 0.0);
+         }
+         for(INDEX e=0; e<f.size(); ++e) {
+            const REAL delta = -0.5*f.reduced_cost(e);
+            f.update_cost(e, delta);
+            cost[e] += delta;
+         }
+         REQUIRE(std::abs(f.LowerBound() - lb) <= 1e-6);
+         REQUIRE(f.no_unmatched_persons() == 0);
+
+         // a few cost changes, incremental re-solve
+         for(INDEX k=0; k<3; ++k) {
+            const INDEX e = gen() % f.size();
+            const REAL delta = dist(gen);
+            f.update_cost(e, delta);
+            cost[e] += delta;
+         }
+      }
+   }
+}
+
+TEST_CASE( "Hungarian assignment factor cost change after early stop", "[incremental Hungarian assignment factor]" ) {
+   std::mt19937 gen(3);
+   std::uniform_real_distribution<REAL> dist(-1.0, 1.0);
+   const INDEX n = 100;
+   std::vector<std::array<INDEX,2>> edges;
+   std::vector<REAL> cost;
+   random_assignment_instance(n, gen, edges, cost);
+
+   HungarianAssignmentFactor f(n, n, edges, cost);
+   f.max_augmenting_paths = 1;
+
+   for(INDEX round=0; round<5; ++round) {
+      f.LowerBound();
+      REQUIRE(f.no_unmatched_persons() > 0);
+
+      // strongly decreased costs make the labels of the stopped solve infeasible, and the optimum drops below their dual objective.
+      // Labels must be reduced before further augmentations, otherwise the lower bound would exceed the optimum.
+      for(INDEX k=0; k<3; ++k) {
+         const INDEX e = gen() % f.size();
+         f.update_cost(e, -100.0);
+         cost[e] -= 100.0;
+      }
+      const REAL opt = assignment_by_min_cost_flow(n, edges, cost);
+      REQUIRE(f.LowerBound() <= opt + eps);
+
+      // solving to the end from the reduced labels gives the optimum
+      f.MaximizePotentialAndComputePrimal();
+      REQUIRE(std::abs(f.LowerBound() - opt) <= 1e-6);
+      REQUIRE(std::abs(f.EvaluatePrimal() - opt) <= 2*n*eps + 1e-6);
+
+      // perturbing all costs unmatches persons for the next early stopped solve
+      for(INDEX e=0; e<f.size(); ++e) {
+         const REAL delta = dist(gen);
+         f.update_cost(e, delta);
+         cost[e] += delta;
+      }
+   }
+}
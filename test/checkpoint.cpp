@@ -0,0 +1,96 @@
+#include "catch.hpp"
+#include <vector>
+#include <cstdio>
+#include "checkpoint.hxx"
+#include "cereal/types/vector.hpp"
+
+using namespace LP_MP;
+
+// stands in for the LP: holds dual state of some factors
+struct checkpoint_test_lp {
+   std::vector<std::vector<REAL>> duals;
+
+   void save_checkpoint(cereal::BinaryOutputArchive& ar) const { ar(duals); }
+   void load_checkpoint(cereal::BinaryInputArchive& ar) { ar(duals); }
+};
+
+TEST_CASE( "checkpoint", "[checkpoint]" ) {
+   const std::string filename = "checkpoint_test.lpmp";
+   checkpoint_test_lp lp;
+   lp.duals = { {0.5, -1.0}, {}, std::vector<REAL>(1000, 2.0) };
+   checkpoint::solver_state state;
+   state.iteration = 42;
+   state.lower_bound = -3.5;
+   state.primal_cost = 7.25;
+   state.solution = "0 1 1 0\n";
+   checkpoint::write(filename, state, lp);
+
+   SECTION( "round trip" ) {
+      checkpoint_test_lp read_lp;
+      const auto read_state = checkpoint::read(filename, read_lp);
+      REQUIRE(read_state.iteration == state.iteration);
+      REQUIRE(read_state.lower_bound == state.lower_bound);
+      REQUIRE(read_state.primal_cost == state.primal_cost);
+      REQUIRE(read_state.solution == state.solution);
+      REQUIRE(read_lp.duals == lp.duals);
+   }
+
+   SECTION( "temporary file is renamed" ) {
+      std::ifstream tmp(filename + ".tmp");
+      REQUIRE(!tmp);
+   }
+
+   SECTION( "other files are rejected" ) {
+      const std::string text_file = "checkpoint_test.txt";
+      { std::ofstream f(text_file); f << "MARKOV\n"; }
+      checkpoint_test_lp read_lp;
+      REQUIRE_THROWS(checkpoint::read(text_file, read_lp));
+      std::remove(text_file.c_str());
+   }
+
+   std::remove(filename.c_str());
+}
+
+TEST_CASE( "tightening log", "[checkpoint]" ) {
+   checkpoint::tightening_log log;
+   log.record(0, {1, 2}); // not recording outside of tightening
+   REQUIRE(log.size() == 0);
+
+   log.start();
+   log.record(0, {1, 2});
+   const std::vector<INDEX> cut = {0, 3, 4, 7, 5, 6};
+   log.record(2, cut.begin(), cut.end());
+   log.record(1, {});
+   log.stop();
+   log.record(0, {3, 4});
+   REQUIRE(log.size() == 3);
+
+   const std::string filename = "checkpoint_tightening_test.lpmp";
+   checkpoint_test_lp lp;
+   lp.duals = { {1.0, 2.0} };
+   checkpoint::solver_state state;
+   state.tightening_logs = { checkpoint::tightening_log(), log };
+   state.tightening_rounds = { {1, 1}, {1, 3} };
+   checkpoint::write(filename, state, lp);
+
+   checkpoint_test_lp read_lp;
+   std::vector<INDEX> kinds;
+   std::vector<std::vector<INDEX>> data;
+   const auto read_state = checkpoint::read(filename, read_lp, [&](const checkpoint::solver_state& s) {
+         REQUIRE(read_lp.duals.empty()); // factors are added again before their state is read
+         REQUIRE(s.tightening_logs.size() == 2);
+         REQUIRE(s.tightening_logs[0].size() == 0);
+         s.tightening_logs[1].for_each(0, s.tightening_logs[1].size(), [&](const INDEX kind, const INDEX* begin, const INDEX* end) {
+               kinds.push_back(kind);
+               data.push_back(std::vector<INDEX>(begin, end));
+         });
+   });
+   REQUIRE(read_state.tightening_rounds == state.tightening_rounds);
+   REQUIRE(kinds == std::vector<INDEX>({0, 2, 1}));
+   REQUIRE(data[0] == std::vector<INDEX>({1, 2}));
+   REQUIRE(data[1] == cut);
+   REQUIRE(data[2].empty());
+   REQUIRE(read_lp.duals == lp.duals);
+
+   std::remove(filename.c_str());
+}
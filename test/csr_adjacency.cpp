@@ -0,0 +1,67 @@
+#include "catch.hpp"
+#include <vector>
+#include <array>
+#include <deque>
+#include <random>
+#include <algorithm>
+#include "config.hxx"
+#include "graph.hxx"
+
+using namespace LP_MP;
+
+TEST_CASE( "csr adjacency", "[csr adjacency]" ) {
+   // random graph, edges added in several batches with updates in between
+   const INDEX n = 50;
+   std::mt19937 gen(1);
+   std::vector<std::array<INDEX,2>> edges;
+   for(INDEX i=0; i<n; ++i) {
+      for(INDEX j=i+1; j<n; ++j) {
+         if(gen() % 4 == 0) { edges.push_back({i,j}); }
+      }
+   }
+   std::shuffle(edges.begin(), edges.end(), gen);
+   std::vector<std::vector<INDEX>> adjacency(n, std::vector<INDEX>(n, std::numeric_limits<INDEX>::max()));
+
+   csr_adjacency index;
+   for(INDEX e=0; e<edges.size(); ++e) {
+      index.add_edge(edges[e][0], edges[e][1], e);
+      adjacency[edges[e][0]][edges[e][1]] = e;
+      adjacency[edges[e][1]][edges[e][0]] = e;
+      if(e % 97 == 0 || e+1 == edges.size()) { index.update(); }
+   }
+   REQUIRE(index.up_to_date());
+   REQUIRE(index.no_edges() == edges.size());
+
+   SECTION( "neighbours are sorted and complete" ) {
+      for(INDEX i=0; i<index.no_nodes(); ++i) {
+         REQUIRE(std::is_sorted(index.neighbors_begin(i), index.neighbors_end(i), [](const auto& a, const auto& b) { return a.node < b.node; }));
+         INDEX degree = 0;
+         for(auto* it=index.neighbors_begin(i); it!=index.neighbors_end(i); ++it) {
+            REQUIRE(adjacency[i][it->node] == it->edge);
+            ++degree;
+         }
+         REQUIRE(degree == std::count_if(adjacency[i].begin(), adjacency[i].end(), [](const INDEX e) { return e != std::numeric_limits<INDEX>::max(); }));
+         REQUIRE(degree == index.degree(i));
+      }
+   }
+
+   SECTION( "common neighbours" ) {
+      for(const auto& e : edges) {
+         const INDEX i = e[0];
+         const INDEX j = e[1];
+         std::vector<INDEX> common;
+         index.for_each_common_neighbor(i, j, [&](const INDEX k, const INDEX e_ik, const INDEX e_jk) {
+            REQUIRE(adjacency[i][k] == e_ik);
+            REQUIRE(adjacency[j][k] == e_jk);
+            common.push_back(k);
+         }, j+1);
+         std::vector<INDEX> expected;
+         for(INDEX k=j+1; k<n; ++k) {
+            if(adjacency[i][k] != std::numeric_limits<INDEX>::max() && adjacency[j][k] != std::numeric_limits<INDEX>::max()) {
+               expected.push_back(k);
+            }
+         }
+         REQUIRE(common == expected);
+      }
+   }
+}
@@ -0,0 +1,93 @@
+#include "catch.hpp"
+#include <vector>
+#include <string>
+#include <random>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include "fast_parsing.hxx"
+
+using namespace LP_MP;
+
+static REAL parse_real_string(const std::string& s)
+{
+   const char* p = s.data();
+   REAL x;
+   REQUIRE(Parsing::parse_real(p, s.data() + s.size(), x));
+   REQUIRE(p == s.data() + s.size());
+   return x;
+}
+
+TEST_CASE( "fast parsing", "[fast parsing]" ) {
+
+   SECTION( "reals agree with strtod" ) {
+      for(const std::string s : {"0", "-0", "1", "+1", "-1.5", "0.1", ".25", "-.25", "3.", "1e3", "1E-3", "-2.5e+10", "0.000001234", "123456789012345678901234567890", "1.7976931348623157e308", "4.9e-324", "1e-400"}) {
+         REQUIRE(parse_real_string(s) == REAL(std::strtod(s.c_str(), nullptr)));
+      }
+      REQUIRE(parse_real_string("inf") == std::numeric_limits<REAL>::infinity());
+      REQUIRE(parse_real_string("-Inf") == -std::numeric_limits<REAL>::infinity());
+
+      std::mt19937 gen(1);
+      std::uniform_real_distribution<double> dist(-1000.0, 1000.0);
+      std::uniform_int_distribution<int> precision(1, 20);
+      for(INDEX k=0; k<10000; ++k) {
+         std::ostringstream ss;
+         if(k % 2 == 0) { ss << std::fixed; } else { ss << std::scientific; }
+         ss << std::setprecision(precision(gen)) << dist(gen);
+         REQUIRE(parse_real_string(ss.str()) == REAL(std::strtod(ss.str().c_str(), nullptr)));
+      }
+   }
+
+   SECTION( "malformed numbers are rejected" ) {
+      for(const std::string s : {"", "-", ".", "e5", "1e", "1e+", "abc"}) {
+         const char* p = s.data();
+         REAL x;
+         INDEX i;
+         REQUIRE(!Parsing::parse_real(p, s.data() + s.size(), x));
+         REQUIRE(p == s.data());
+         if(s.empty() || !Parsing::is_digit(s[0])) { REQUIRE(!Parsing::parse_index(p, s.data() + s.size(), i)); }
+      }
+   }
+
+   SECTION( "indices" ) {
+      const std::string s = "0 17\t4294967295 x";
+      const char* p = s.data();
+      const char* end = s.data() + s.size();
+      INDEX i;
+      REQUIRE(Parsing::parse_index(p, end, i));
+      REQUIRE(i == 0);
+      REQUIRE(Parsing::mand_blanks(p, end));
+      REQUIRE(Parsing::parse_index(p, end, i));
+      REQUIRE(i == 17);
+      REQUIRE(Parsing::mand_blanks(p, end));
+      REQUIRE(Parsing::parse_index(p, end, i));
+      REQUIRE(i == 4294967295);
+      REQUIRE(!Parsing::at_line_end(p, end));
+   }
+
+   SECTION( "chunks start at line boundaries" ) {
+      std::string text;
+      for(INDEX l=0; l<1000; ++l) {
+         text += "line " + std::to_string(l) + std::string(l % 13, ' ') + "\n";
+      }
+      text += "last line without newline";
+      const char* begin = text.data();
+      const char* end = text.data() + text.size();
+
+      for(const INDEX no_chunks : {1, 2, 7, 64, 5000}) {
+         const auto boundaries = Parsing::split_lines(begin, end, no_chunks);
+         REQUIRE(boundaries.size() == no_chunks+1);
+         REQUIRE(boundaries.front() == begin);
+         REQUIRE(boundaries.back() == end);
+         INDEX no_lines = 0;
+         for(INDEX c=0; c<no_chunks; ++c) {
+            REQUIRE(boundaries[c] <= boundaries[c+1]);
+            REQUIRE((boundaries[c] == begin || boundaries[c] == end || *(boundaries[c]-1) == '\n'));
+            for(const char* l = boundaries[c]; l != boundaries[c+1]; l = Parsing::next_line(l, boundaries[c+1])) {
+               ++no_lines;
+            }
+         }
+         REQUIRE(no_lines == 1001);
+      }
+   }
+}
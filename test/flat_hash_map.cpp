@@ -0,0 +1,57 @@
+#include "catch.hpp"
+#include <vector>
+#include <array>
+#include <random>
+#include <unordered_map>
+#include "flat_hash_map.hxx"
+
+using namespace LP_MP;
+
+TEST_CASE( "flat hash map", "[flat hash map]" ) {
+   std::mt19937 gen(1);
+   std::uniform_int_distribution<INDEX> dist(0, 1000);
+
+   SECTION( "packed keys" ) {
+      flat_hash_map<std::uint64_t, INDEX> m;
+      std::unordered_map<std::uint64_t, INDEX> reference;
+      for(INDEX k=0; k<10000; ++k) {
+         const INDEX i = dist(gen);
+         const INDEX j = dist(gen);
+         const auto inserted = m.insert(std::make_pair(pack_index_pair(i,j), k));
+         const auto inserted_reference = reference.insert(std::make_pair(pack_index_pair(i,j), k));
+         REQUIRE(inserted.second == inserted_reference.second);
+         REQUIRE(inserted.first->second == inserted_reference.first->second);
+      }
+      REQUIRE(m.size() == reference.size());
+      for(const auto& e : reference) {
+         REQUIRE(m.find(e.first) != m.end());
+         REQUIRE(m.find(e.first)->second == e.second);
+      }
+      INDEX no_elements = 0;
+      for(const auto& e : m) {
+         REQUIRE(reference.find(e.first)->second == e.second);
+         ++no_elements;
+      }
+      REQUIRE(no_elements == m.size());
+      REQUIRE(m.find(pack_index_pair(1001,0)) == m.end());
+      REQUIRE(pack_index_pair(1,2) != pack_index_pair(2,1));
+   }
+
+   SECTION( "array keys" ) {
+      flat_hash_map<std::array<INDEX,3>, INDEX> m;
+      REQUIRE(m.find({0,1,2}) == m.end());
+      for(INDEX i=0; i<30; ++i) {
+         for(INDEX j=i+1; j<30; ++j) {
+            m[{i,j,j+1}] = i+j;
+         }
+      }
+      REQUIRE(m.size() == 30*29/2);
+      const auto& cm = m;
+      for(INDEX i=0; i<30; ++i) {
+         for(INDEX j=i+1; j<30; ++j) {
+            REQUIRE(cm.find({i,j,j+1})->second == i+j);
+            REQUIRE(cm.count({j,i,j+1}) == 0);
+         }
+      }
+   }
+}
@@ -0,0 +1,83 @@
+#include "catch.hpp"
+#include <vector>
+#include <string>
+#include <cstdio>
+#include "config.hxx"
+#include "hdf5_stream.hxx"
+
+using namespace LP_MP;
+
+TEST_CASE( "hdf5 stream", "[hdf5 stream]" ) {
+   const std::string filename = "hdf5_stream_test.h5";
+   const std::size_t n = 1000;
+
+   // edges stored as in andres graphs: 2 x n, first end nodes followed by second ones. Costs as one-dimensional dataset.
+   std::vector<std::size_t> edges(2*n);
+   std::vector<double> costs(n);
+   for(std::size_t e=0; e<n; ++e) {
+      edges[e] = e;
+      edges[n+e] = 3*e+1;
+      costs[e] = 0.5*e;
+   }
+   {
+      hid_t file = H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+      REQUIRE(file >= 0);
+      hsize_t edge_dims[2] = {2, n};
+      hid_t space = H5Screate_simple(2, edge_dims, NULL);
+      hid_t dataset = H5Dcreate(file, "edges", H5T_NATIVE_ULONG, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+      H5Dwrite(dataset, H5T_NATIVE_ULONG, H5S_ALL, H5S_ALL, H5P_DEFAULT, edges.data());
+      H5Dclose(dataset);
+      H5Sclose(space);
+      hsize_t cost_dims[1] = {n};
+      space = H5Screate_simple(1, cost_dims, NULL);
+      dataset = H5Dcreate(file, "costs", H5T_NATIVE_DOUBLE, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+      H5Dwrite(dataset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, costs.data());
+      H5Dclose(dataset);
+      H5Sclose(space);
+      space = H5Screate(H5S_SCALAR);
+      dataset = H5Dcreate(file, "scalar", H5T_NATIVE_DOUBLE, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+      H5Dclose(dataset);
+      H5Sclose(space);
+      H5Fclose(file);
+   }
+
+   hid_t file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+   REQUIRE(file >= 0);
+   for(const bool read_ahead : {false, true}) {
+      hdf5_stream<std::size_t> edge_stream(file, "edges", 128, read_ahead);
+      hdf5_stream<float> cost_stream(file, "costs", 128, read_ahead);
+      REQUIRE(edge_stream.rows() == 2);
+      REQUIRE(edge_stream.columns() == n);
+      REQUIRE(cost_stream.rows() == 1);
+      REQUIRE(cost_stream.columns() == n);
+
+      for(INDEX pass=0; pass<2; ++pass) {
+         std::vector<std::size_t> edge_block;
+         std::vector<float> cost_block;
+         std::size_t e = 0;
+         while(const std::size_t b = edge_stream.next(edge_block)) {
+            REQUIRE(b <= 128);
+            REQUIRE(edge_block.size() == 2*b);
+            REQUIRE(cost_stream.next(cost_block) == b);
+            for(std::size_t k=0; k<b; ++k, ++e) {
+               REQUIRE(edge_block[k] == edges[e]);
+               REQUIRE(edge_block[b+k] == edges[n+e]);
+               REQUIRE(cost_block[k] == float(costs[e]));
+            }
+         }
+         REQUIRE(e == n);
+         REQUIRE(cost_stream.next(cost_block) == 0);
+         edge_stream.rewind();
+         cost_stream.rewind();
+      }
+   }
+
+   // failing to open a stream leaves no HDF5 objects open but the file itself
+   REQUIRE(H5Fget_obj_count(file, H5F_OBJ_ALL) == 1);
+   REQUIRE_THROWS(hdf5_stream<double>(file, "missing", 128));
+   REQUIRE_THROWS(hdf5_stream<double>(file, "scalar", 128));
+   REQUIRE(H5Fget_obj_count(file, H5F_OBJ_ALL) == 1);
+
+   H5Fclose(file);
+   std::remove(filename.c_str());
+}
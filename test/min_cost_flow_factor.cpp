@@ -0,0 +1,70 @@
+#include "catch.hpp"
+#include <vector>
+#include <random>
+#include <array>
+#include <cmath>
+#include "config.hxx"
+#include "factors/min_cost_flow_factor_cs2.hxx"
+
+using namespace LP_MP;
+
+// assignment problem with slack edges as built for graph matching
+static MinCostFlowFactorCS2 build_assignment(const INDEX n, const std::vector<std::array<INDEX,2>>& assignment, const std::vector<REAL>& cost)
+{
+   std::vector<MinCostFlowFactorCS2::Edge> edges;
+   for(INDEX a=0; a<assignment.size(); ++a) {
+      edges.push_back({assignment[a][0], n + assignment[a][1], 0, 1, cost[a]});
+   }
+   std::vector<SIGNED_INDEX> demands;
+   for(INDEX i=0; i<n; ++i) {
+      edges.push_back({i, 2*n + 1, 0, 1, cost[assignment.size() + i]});
+      demands.push_back(1);
+   }
+   for(INDEX i=0; i<n; ++i) {
+      edges.push_back({2*n, n + i, 0, 1, cost[assignment.size() + n + i]});
+      demands.push_back(-1);
+   }
+   edges.push_back({2*n, 2*n + 1, 0, n, 0.0});
+   demands.push_back(n);
+   demands.push_back(-SIGNED_INDEX(n));
+   return MinCostFlowFactorCS2(edges, demands, edges.size()-1);
+}
+
+TEST_CASE( "min cost flow factor", "[incremental min cost flow factor]" ) {
+   std::mt19937 gen(1);
+   std::uniform_real_distribution<REAL> dist(-1.0, 1.0);
+   const INDEX n = 20;
+
+   std::vector<std::array<INDEX,2>> assignment;
+   for(INDEX i=0; i<n; ++i) {
+      for(INDEX j=0; j<n; ++j) {
+         if(i == j || gen() % 3 == 0) { assignment.push_back({i,j}); }
+      }
+   }
+   const INDEX no_edges = assignment.size() + 2*n;
+   std::vector<REAL> cost(no_edges);
+   for(auto& c : cost) { c = dist(gen); }
+
+   auto f = build_assignment(n, assignment, cost);
+   REQUIRE(f.size() == no_edges);
+
+   for(INDEX round=0; round<20; ++round) {
+      // only a few costs change per round, some of them several times
+      for(INDEX k=0; k<5; ++k) {
+         const INDEX e = gen() % no_edges;
+         const REAL delta = dist(gen);
+         f.update_cost(e, delta);
+         cost[e] += delta;
+         REQUIRE(std::abs(f[e] - cost[e]) <= eps);
+      }
+
+      // repaired flow is as good as the one computed from scratch
+      auto fresh = build_assignment(n, assignment, cost);
+      REQUIRE(std::abs(f.LowerBound() - fresh.LowerBound()) <= eps);
+
+      auto* mcf = f.GetMinCostFlowSolver();
+      for(INDEX e=0; e<no_edges; ++e) {
+         REQUIRE(std::abs(mcf->GetCost(e) - cost[e]) <= eps);
+      }
+   }
+}
@@ -0,0 +1,156 @@
+#include "catch.hpp"
+#include <vector>
+#include <array>
+#include <random>
+#include "config.hxx"
+#include "union_find.hxx"
+#include "solvers/multicut/multicut_gaec_kl.hxx"
+
+using namespace LP_MP;
+
+namespace {
+
+// an edge may only be cut if its end nodes are not connected by uncut edges
+static bool multicut_feasible(const INDEX no_nodes, const std::vector<std::array<INDEX,2>>& edges, const std::vector<char>& labeling)
+{
+   UnionFind uf(no_nodes);
+   for(INDEX e=0; e<edges.size(); ++e) {
+      if(!labeling[e]) { uf.merge(edges[e][0], edges[e][1]); }
+   }
+   for(INDEX e=0; e<edges.size(); ++e) {
+      if(labeling[e] && uf.connected(edges[e][0], edges[e][1])) { return false; }
+   }
+   return true;
+}
+
+// minimum over all partitions of the nodes, enumerated as restricted growth strings
+static REAL multicut_optimum(const INDEX no_nodes, const std::vector<std::array<INDEX,2>>& edges, const std::vector<REAL>& costs)
+{
+   std::vector<INDEX> part(no_nodes, 0);
+   std::vector<INDEX> max_prefix(no_nodes, 0);
+   REAL best = std::numeric_limits<REAL>::infinity();
+   while(true) {
+      REAL c = 0.0;
+      for(INDEX e=0; e<edges.size(); ++e) {
+         if(part[edges[e][0]] != part[edges[e][1]]) { c += costs[e]; }
+      }
+      best = std::min(best, c);
+      // next restricted growth string
+      INDEX i = no_nodes-1;
+      while(i > 0 && part[i] == max_prefix[i-1] + 1) { --i; }
+      if(i == 0) { return best; }
+      part[i]++;
+      for(INDEX j=i; j<no_nodes; ++j) {
+         if(j > i) { part[j] = 0; }
+         max_prefix[j] = std::max(max_prefix[j-1], part[j]);
+      }
+   }
+}
+
+} // end anonymous namespace
+
+TEST_CASE( "multicut gaec and kernighan lin", "[multicut gaec kl]" ) {
+   multicut_gaec_kl engine;
+
+   SECTION("two cliques") {
+      // positive costs within cliques {0,...,4} and {5,...,9}, negative between them
+      std::vector<std::array<INDEX,2>> edges;
+      std::vector<REAL> costs;
+      for(INDEX i=0; i<10; ++i) {
+         for(INDEX j=i+1; j<10; ++j) {
+            edges.push_back({i,j});
+            costs.push_back((i < 5) == (j < 5) ? 1.0 : -0.5);
+         }
+      }
+      std::vector<char> labeling;
+      engine.gaec(10, edges, costs, labeling);
+      REQUIRE(multicut_feasible(10, edges, labeling));
+      engine.kernighan_lin(10, edges, costs, labeling);
+      REQUIRE(multicut_feasible(10, edges, labeling));
+      REQUIRE(multicut_gaec_kl::cost(costs, labeling) == Approx(-12.5));
+   }
+
+   SECTION("optimal on small graphs") {
+      std::mt19937 gen(3);
+      std::uniform_real_distribution<REAL> dist(-1.0, 1.0);
+      for(INDEX trial=0; trial<50; ++trial) {
+         const INDEX n = 5;
+         std::vector<std::array<INDEX,2>> edges;
+         std::vector<REAL> costs;
+         for(INDEX i=0; i<n; ++i) {
+            for(INDEX j=i+1; j<n; ++j) {
+               edges.push_back({i,j});
+               costs.push_back(dist(gen));
+            }
+         }
+         std::vector<char> labeling;
+         engine.gaec(n, edges, costs, labeling);
+         engine.kernighan_lin(n, edges, costs, labeling);
+         REQUIRE(multicut_feasible(n, edges, labeling));
+         REQUIRE(multicut_gaec_kl::cost(costs, labeling) == Approx(multicut_optimum(n, edges, costs)).margin(eps));
+      }
+   }
+
+   SECTION("random graphs") {
+      std::mt19937 gen(1);
+      std::uniform_real_distribution<REAL> dist(-1.0, 1.0);
+      INDEX no_optimal = 0;
+      for(INDEX trial=0; trial<20; ++trial) {
+         const INDEX n = 8;
+         std::vector<std::array<INDEX,2>> edges;
+         std::vector<REAL> costs;
+         for(INDEX i=0; i<n; ++i) {
+            for(INDEX j=i+1; j<n; ++j) {
+               if(gen() % 2 == 0) {
+                  edges.push_back({i,j});
+                  costs.push_back(dist(gen));
+               }
+            }
+         }
+
+         std::vector<char> labeling;
+         engine.gaec(n, edges, costs, labeling);
+         REQUIRE(multicut_feasible(n, edges, labeling));
+         const REAL gaec_cost = multicut_gaec_kl::cost(costs, labeling);
+
+         INDEX iterations = 0;
+         engine.kernighan_lin(n, edges, costs, labeling, [&]() { ++iterations; return true; });
+         REQUIRE(multicut_feasible(n, edges, labeling));
+         const REAL kl_cost = multicut_gaec_kl::cost(costs, labeling);
+         REQUIRE(kl_cost <= gaec_cost + eps);
+         if(kl_cost <= multicut_optimum(n, edges, costs) + eps) { ++no_optimal; }
+
+         // buffers reused from previous calls do not change the result
+         multicut_gaec_kl fresh_engine;
+         std::vector<char> fresh_labeling;
+         fresh_engine.gaec(n, edges, costs, fresh_labeling);
+         fresh_engine.kernighan_lin(n, edges, costs, fresh_labeling);
+         REQUIRE(fresh_labeling == labeling);
+      }
+      // Kernighan&Lin is a local search, it may end in a local optimum now and then
+      REQUIRE(no_optimal >= 18);
+   }
+
+   SECTION("grid") {
+      // large enough for contraction rounds of locally dominant edges
+      const INDEX dim = 100;
+      std::mt19937 gen(2);
+      std::uniform_real_distribution<REAL> dist(-1.0, 2.0);
+      std::vector<std::array<INDEX,2>> edges;
+      std::vector<REAL> costs;
+      for(INDEX i=0; i<dim; ++i) {
+         for(INDEX j=0; j<dim; ++j) {
+            if(i+1 < dim) { edges.push_back({i*dim + j, (i+1)*dim + j}); costs.push_back(dist(gen)); }
+            if(j+1 < dim) { edges.push_back({i*dim + j, i*dim + j + 1}); costs.push_back(dist(gen)); }
+         }
+      }
+      std::vector<char> labeling;
+      engine.gaec(dim*dim, edges, costs, labeling);
+      REQUIRE(multicut_feasible(dim*dim, edges, labeling));
+      const REAL gaec_cost = multicut_gaec_kl::cost(costs, labeling);
+      REQUIRE(gaec_cost < 0.0);
+      engine.kernighan_lin(dim*dim, edges, costs, labeling);
+      REQUIRE(multicut_feasible(dim*dim, edges, labeling));
+      REQUIRE(multicut_gaec_kl::cost(costs, labeling) <= gaec_cost);
+   }
+}
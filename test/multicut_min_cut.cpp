@@ -0,0 +1,81 @@
+#include "catch.hpp"
+#include <vector>
+#include <array>
+#include <random>
+#include "config.hxx"
+#include "union_find.hxx"
+#include "solvers/multicut/multicut_min_cut.hxx"
+
+using namespace LP_MP;
+
+// removing the cut edges must disconnect the two components
+static bool separates(const std::vector<INDEX>& component, const std::vector<std::array<INDEX,2>>& edges, const std::vector<std::array<INDEX,2>>& cut, const INDEX c1, const INDEX c2)
+{
+   const INDEX no_components = *std::max_element(component.begin(), component.end()) + 1;
+   UnionFind uf(no_components);
+   for(const auto& e : edges) {
+      const std::array<INDEX,2> s = {std::min(e[0],e[1]), std::max(e[0],e[1])};
+      if(!std::binary_search(cut.begin(), cut.end(), s)) {
+         uf.merge(component[e[0]], component[e[1]]);
+      }
+   }
+   return !uf.connected(c1,c2);
+}
+
+TEST_CASE( "multicut min cut", "[multicut min cut]" ) {
+   std::mt19937 gen(1);
+   const INDEX dim = 8;
+   const INDEX no_nodes = dim*dim;
+
+   // grid graph, nodes are grouped into components by random contraction of some edges
+   std::vector<std::array<INDEX,2>> grid_edges;
+   for(INDEX i=0; i<dim; ++i) {
+      for(INDEX j=0; j<dim; ++j) {
+         if(i+1 < dim) { grid_edges.push_back({i*dim + j, (i+1)*dim + j}); }
+         if(j+1 < dim) { grid_edges.push_back({i*dim + j, i*dim + j + 1}); }
+      }
+   }
+
+   multicut_min_cut min_cut;
+   for(INDEX trial=0; trial<10; ++trial) {
+      UnionFind uf(no_nodes);
+      for(const auto& e : grid_edges) {
+         if(gen() % 3 == 0) { uf.merge(e[0], e[1]); }
+      }
+      std::vector<INDEX> component(no_nodes);
+      std::vector<INDEX> contiguous(no_nodes, std::numeric_limits<INDEX>::max());
+      INDEX no_components = 0;
+      for(INDEX i=0; i<no_nodes; ++i) {
+         if(contiguous[uf.find(i)] == std::numeric_limits<INDEX>::max()) {
+            contiguous[uf.find(i)] = no_components++;
+         }
+         component[i] = contiguous[uf.find(i)];
+      }
+      std::vector<std::array<INDEX,2>> edges;
+      for(const auto& e : grid_edges) {
+         if(component[e[0]] != component[e[1]]) { edges.push_back(e); }
+      }
+
+      REQUIRE(min_cut.update(component, edges));
+      REQUIRE(!min_cut.update(component, edges));
+      REQUIRE(min_cut.no_components() == no_components);
+
+      for(INDEX q=0; q<20; ++q) {
+         const INDEX c1 = gen() % no_components;
+         const INDEX c2 = gen() % no_components;
+         if(c1 == c2) { continue; }
+         const auto cut = min_cut.min_cut(c1,c2);
+         REQUIRE(std::is_sorted(cut.edges.begin(), cut.edges.end()));
+         REQUIRE(cut.signature == multicut_min_cut::signature(cut.edges));
+         REQUIRE(separates(component, edges, cut.edges, c1, c2));
+
+         // flow and search trees reused from earlier queries give cuts of minimum size
+         multicut_min_cut fresh_min_cut;
+         fresh_min_cut.update(component, edges);
+         REQUIRE(fresh_min_cut.min_cut(c1,c2).edges.size() == cut.edges.size());
+
+         // cached
+         REQUIRE(min_cut.min_cut(c2,c1).edges == cut.edges);
+      }
+   }
+}
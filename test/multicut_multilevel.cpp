@@ -0,0 +1,71 @@
+#include "catch.hpp"
+#include <vector>
+#include <array>
+#include <random>
+#include <cmath>
+#include "config.hxx"
+#include "union_find.hxx"
+#include "solvers/multicut/multicut_multilevel.hxx"
+
+using namespace LP_MP;
+
+TEST_CASE( "multicut coarsening", "[multicut multilevel]" ) {
+   std::mt19937 gen(1);
+   std::uniform_real_distribution<REAL> dist(-1.0, 1.0);
+   const INDEX dim = 10;
+   const INDEX no_nodes = dim*dim;
+
+   std::vector<std::array<INDEX,2>> edges;
+   std::vector<REAL> costs;
+   for(INDEX i=0; i<dim; ++i) {
+      for(INDEX j=0; j<dim; ++j) {
+         if(i+1 < dim) { edges.push_back({i*dim + j, (i+1)*dim + j}); costs.push_back(dist(gen)); }
+         if(j+1 < dim) { edges.push_back({i*dim + j, i*dim + j + 1}); costs.push_back(dist(gen)); }
+      }
+   }
+
+   for(const REAL ratio : {0.9, 0.5, 0.1}) {
+      multicut_coarsening c;
+      c.coarsen(no_nodes, edges, costs, 0.0, ratio);
+      REQUIRE(c.no_nodes() == no_nodes);
+      REQUIRE(c.no_coarse_nodes() < no_nodes);
+      REQUIRE(c.no_coarse_nodes() >= INDEX(std::ceil(ratio*no_nodes)));
+
+      // coarse costs add up original costs between coarse nodes
+      std::vector<REAL> coarse_costs(c.coarse_edges().size(), 0.0);
+      for(INDEX e=0; e<edges.size(); ++e) {
+         const INDEX c0 = c.coarse_node(edges[e][0]);
+         const INDEX c1 = c.coarse_node(edges[e][1]);
+         if(c0 == c1) { continue; }
+         const std::array<INDEX,2> ce = {std::min(c0,c1), std::max(c0,c1)};
+         const INDEX k = std::find(c.coarse_edges().begin(), c.coarse_edges().end(), ce) - c.coarse_edges().begin();
+         REQUIRE(k < c.coarse_edges().size());
+         coarse_costs[k] += costs[e];
+      }
+      for(INDEX k=0; k<coarse_costs.size(); ++k) {
+         REQUIRE(std::abs(coarse_costs[k] - c.coarse_costs()[k]) < eps);
+         const auto& ce = c.coarse_edges()[k];
+         const auto r = c.representative(ce[1], ce[0]);
+         REQUIRE(c.coarse_node(r[0]) == ce[1]);
+         REQUIRE(c.coarse_node(r[1]) == ce[0]);
+         REQUIRE(std::find(edges.begin(), edges.end(), std::array<INDEX,2>{std::min(r[0],r[1]), std::max(r[0],r[1])}) != edges.end());
+      }
+
+      // paths inside coarse nodes consist of original edges of positive cost
+      for(INDEX q=0; q<50; ++q) {
+         const INDEX i = gen() % no_nodes;
+         const INDEX j = gen() % no_nodes;
+         if(c.coarse_node(i) != c.coarse_node(j)) { continue; }
+         std::vector<INDEX> p;
+         c.path(i, j, p);
+         REQUIRE(p.front() == i);
+         REQUIRE(p.back() == j);
+         for(INDEX k=0; k+1<p.size(); ++k) {
+            REQUIRE(c.coarse_node(p[k]) == c.coarse_node(i));
+            const INDEX e = std::find(edges.begin(), edges.end(), std::array<INDEX,2>{std::min(p[k],p[k+1]), std::max(p[k],p[k+1])}) - edges.begin();
+            REQUIRE(e < edges.size());
+            REQUIRE(costs[e] > 0.0);
+         }
+      }
+   }
+}
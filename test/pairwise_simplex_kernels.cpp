@@ -0,0 +1,108 @@
+#include "catch.hpp"
+#include <vector>
+#include <random>
+#include <array>
+#include <limits>
+#include "config.hxx"
+#include "factors/pairwise_simplex_kernels.hxx"
+
+using namespace LP_MP;
+using namespace LP_MP::pairwise_simplex_kernels;
+
+// padded table as held by PairwiseSimplexFactor: padding of pairwise is +infinity, padding of msg2 is 0.
+// With integer costs ties occur, such that argmin must pick the same minimizer as the scalar code.
+struct padded_pairwise {
+   padded_pairwise(const INDEX _dim1, const INDEX _dim2, std::mt19937& gen, const bool integer_costs)
+      : dim1(_dim1), dim2(_dim2), stride(padded_size(_dim2)),
+      pairwise(_dim1*stride, std::numeric_limits<REAL>::infinity()), msg1(_dim1), msg2(stride, 0.0)
+   {
+      std::uniform_real_distribution<REAL> dist(-1.0, 1.0);
+      auto draw = [&]() { return integer_costs ? REAL(INDEX(gen() % 3)) : dist(gen); };
+      for(INDEX x1=0; x1<dim1; ++x1) {
+         for(INDEX x2=0; x2<dim2; ++x2) {
+            pairwise[x1*stride + x2] = draw();
+         }
+         msg1[x1] = draw();
+      }
+      for(INDEX x2=0; x2<dim2; ++x2) {
+         msg2[x2] = draw();
+      }
+   }
+
+   // scalar loops as in the unvectorized factor, over the unpadded entries only
+   REAL value(const INDEX x1, const INDEX x2) const { return (pairwise[x1*stride + x2] + msg1[x1]) + msg2[x2]; }
+
+   std::vector<REAL> min_marginal_1_scalar() const
+   {
+      std::vector<REAL> m(dim1, std::numeric_limits<REAL>::infinity());
+      for(INDEX x1=0; x1<dim1; ++x1) {
+         for(INDEX x2=0; x2<dim2; ++x2) {
+            m[x1] = std::min(m[x1], value(x1,x2));
+         }
+      }
+      return m;
+   }
+
+   std::vector<REAL> min_marginal_2_scalar() const
+   {
+      std::vector<REAL> m(dim2, std::numeric_limits<REAL>::infinity());
+      for(INDEX x1=0; x1<dim1; ++x1) {
+         for(INDEX x2=0; x2<dim2; ++x2) {
+            m[x2] = std::min(m[x2], value(x1,x2));
+         }
+      }
+      return m;
+   }
+
+   std::array<INDEX,2> argmin_scalar() const
+   {
+      REAL best = std::numeric_limits<REAL>::infinity();
+      std::array<INDEX,2> x{0,0};
+      for(INDEX x1=0; x1<dim1; ++x1) {
+         for(INDEX x2=0; x2<dim2; ++x2) {
+            if(best >= value(x1,x2)) {
+               best = value(x1,x2);
+               x = {x1,x2};
+            }
+         }
+      }
+      return x;
+   }
+
+   const INDEX dim1, dim2, stride;
+   std::vector<REAL> pairwise, msg1, msg2;
+};
+
+TEST_CASE( "pairwise simplex kernels", "[vectorized pairwise simplex factor]" ) {
+   std::mt19937 gen(1);
+
+   REQUIRE(padded_size(0) == 0);
+   for(const INDEX n : {1, 2, 3, 5, 7, 9, 13, 17, 31}) {
+      REQUIRE(padded_size(n) % simd_width == 0);
+      REQUIRE(padded_size(n) >= n);
+      REQUIRE(padded_size(n) < n + simd_width);
+   }
+
+   // dimensions which are not multiples of the vector width, hence rows end in padding
+   for(const bool integer_costs : {false, true}) {
+      for(const INDEX dim1 : {1, 3, 8, 13}) {
+         for(const INDEX dim2 : {1, 2, 3, 5, 7, 9, 17, 31}) {
+            const padded_pairwise p(dim1, dim2, gen, integer_costs);
+
+            std::vector<REAL> m1(dim1);
+            min_marginal_1(p.pairwise.data(), p.msg1.data(), p.msg2.data(), dim1, p.stride, m1);
+            REQUIRE(m1 == p.min_marginal_1_scalar());
+
+            std::vector<REAL> m2(dim2);
+            min_marginal_2(p.pairwise.data(), p.msg1.data(), p.msg2.data(), dim1, dim2, p.stride, m2);
+            REQUIRE(m2 == p.min_marginal_2_scalar());
+
+            const auto scalar_m1 = p.min_marginal_1_scalar();
+            const REAL lb = *std::min_element(scalar_m1.begin(), scalar_m1.end());
+            REQUIRE(lower_bound(p.pairwise.data(), p.msg1.data(), p.msg2.data(), dim1, p.stride) == lb);
+
+            REQUIRE(argmin(p.pairwise.data(), p.msg1.data(), p.msg2.data(), dim1, dim2, p.stride) == p.argmin_scalar());
+         }
+      }
+   }
+}
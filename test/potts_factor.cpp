@@ -1,5 +1,9 @@
 #include "catch.hpp"
 #include <array>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <sstream>
 #include "factors/simplex_factor.hxx"
 
 using namespace LP_MP;
@@ -70,3 +74,113 @@ TEST_CASE( "pairwise Potts", "[Potts factor]" ) {
 
 
 }
+
+TEST_CASE( "sparse pairwise factor", "[sparse pairwise factor]" ) {
+   std::mt19937 gen(1);
+   std::uniform_real_distribution<REAL> dist(-1.0, 1.0);
+
+   // small and large label spaces are handled by different kernels
+   for(const INDEX dim1 : {7, 30}) {
+   for(const INDEX density : {0, 1, 3, 10}) {
+      const INDEX dim2 = dim1 - 2;
+      pairwise_sparse_cost c;
+      c.default_cost = density % 2 == 0 ? 0.0 : 0.3;
+      for(INDEX x1=0; x1<dim1; ++x1) {
+         for(INDEX x2=0; x2<dim2; ++x2) {
+            // density 10 makes every entry explicit
+            if(gen() % 10 < density) {
+               c.entries.push_back(std::make_tuple(x1, x2, dist(gen)));
+            }
+         }
+      }
+
+      pairwise_sparse_factor sparse(dim1, dim2, c);
+      PairwiseSimplexFactor dense(dim1, dim2, c);
+      // from a quarter of explicit entries on the cost is held in a dense table
+      REQUIRE(sparse.dense() == (4*c.entries.size() >= dim1*dim2 && c.entries.size() > 0));
+      if(density == 10) { REQUIRE(sparse.dense()); }
+      if(density <= 1) { REQUIRE(!sparse.dense()); }
+      if(!sparse.dense()) {
+         REQUIRE(sparse.no_entries() == c.entries.size());
+      }
+
+      // explicit entries can be added after construction
+      sparse.cost(dim1-1, 0) = 2.0;
+      dense.cost(dim1-1, 0) = 2.0;
+      sparse.cost(0, dim2-1) = -2.0;
+      dense.cost(0, dim2-1) = -2.0;
+
+      for(INDEX round=0; round<5; ++round) {
+         for(INDEX x1=0; x1<dim1; ++x1) {
+            for(INDEX x2=0; x2<dim2; ++x2) {
+               REQUIRE(std::abs(sparse(x1,x2) - dense(x1,x2)) <= eps);
+            }
+         }
+         REQUIRE(std::abs(sparse.LowerBound() - dense.LowerBound()) <= eps);
+
+         std::vector<REAL> m_sparse(dim1), m_dense(dim1);
+         sparse.min_marginal_1(m_sparse);
+         dense.min_marginal_1(m_dense);
+         for(INDEX x1=0; x1<dim1; ++x1) {
+            REQUIRE(std::abs(m_sparse[x1] - m_dense[x1]) <= eps);
+         }
+
+         m_sparse.resize(dim2); m_dense.resize(dim2);
+         sparse.min_marginal_2(m_sparse);
+         dense.min_marginal_2(m_dense);
+         for(INDEX x2=0; x2<dim2; ++x2) {
+            REQUIRE(std::abs(m_sparse[x2] - m_dense[x2]) <= eps);
+         }
+
+         sparse.MaximizePotentialAndComputePrimal();
+         REQUIRE(std::abs(sparse.EvaluatePrimal() - sparse.LowerBound()) <= eps);
+
+         for(INDEX x1=0; x1<dim1; ++x1) {
+            const REAL delta = dist(gen);
+            sparse.msg1(x1) += delta;
+            dense.msg1(x1) += delta;
+         }
+         for(INDEX x2=0; x2<dim2; ++x2) {
+            const REAL delta = dist(gen);
+            sparse.msg2(x2) += delta;
+            dense.msg2(x2) += delta;
+         }
+      }
+   }
+   }
+}
+
+TEST_CASE( "pairwise simplex factor dual state", "[pairwise simplex factor]" ) {
+   const INDEX dim1 = 3;
+   const INDEX dim2 = 5;
+   PairwiseSimplexFactor p(dim1, dim2);
+   for(INDEX x1=0; x1<dim1; ++x1) {
+      for(INDEX x2=0; x2<dim2; ++x2) {
+         p.cost(x1,x2) = REAL(x1*dim2 + x2);
+      }
+      p.msg1(x1) = -REAL(x1);
+   }
+   for(INDEX x2=0; x2<dim2; ++x2) {
+      p.msg2(x2) = 0.5*REAL(x2);
+   }
+
+   std::stringstream ss;
+   {
+      cereal::BinaryOutputArchive ar(ss);
+      p.serialize_dual(ar);
+   }
+   // padding of rows is not part of the dual state
+   REQUIRE(ss.str().size() == sizeof(REAL)*(dim1*dim2 + dim1 + dim2));
+
+   PairwiseSimplexFactor q(dim1, dim2);
+   {
+      cereal::BinaryInputArchive ar(ss);
+      q.serialize_dual(ar);
+   }
+   for(INDEX x1=0; x1<dim1; ++x1) {
+      for(INDEX x2=0; x2<dim2; ++x2) {
+         REQUIRE(q(x1,x2) == p(x1,x2));
+      }
+   }
+   REQUIRE(q.LowerBound() == p.LowerBound());
+}
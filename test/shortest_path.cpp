@@ -1,17 +1,17 @@
 #include "catch.hpp"
 #include <vector>
-#include "solvers/multicut/multicut.h"
-#include "solvers/multicut/multicut_constructor.hxx"
+#include <array>
+#include <deque>
+#include <random>
+#include <algorithm>
+#include "config.hxx"
+#include "graph.hxx"
 
 using namespace LP_MP;
 
 TEST_CASE( "shortest path search in multicut factor", "[shortest path]" ) {
 
-   using mc_constructor = MulticutConstructor<FMC_MULTICUT<MessageSendingType::SRMP>, 0, 1, 0, 2>;
-   using graph = mc_constructor::Graph2;
-   using bfs_data = mc_constructor::BfsData2; 
-   
-   graph g(4,8, std::vector<INDEX>{2,2,2,2});
+   Graph g(4,8, std::vector<INDEX>{2,2,2,2});
 
    g.add_arc(0,1,1.0);
    g.add_arc(1,0,1.0);
@@ -26,20 +26,114 @@ TEST_CASE( "shortest path search in multicut factor", "[shortest path]" ) {
    g.add_arc(0,3,2.0);
 
    g.sort();
-   bfs_data sp(g);
+   BfsData sp(g);
 
    auto c1 = sp.FindPath(0,2,g);
-   assert(std::get<1>(c1).size() == 3);
    REQUIRE(std::get<1>(c1).size() == 3);
 
    auto c2 = sp.FindPath(0,1,g, 0.5);
-   assert(std::get<1>(c2).size() == 2);
-   assert(std::get<0>(c2) == 1.0);
    REQUIRE(std::get<1>(c2).size() == 2);
+   REQUIRE(std::get<0>(c2) == 1.0);
 
    auto c3 = sp.FindPath(0,1,g, 1.5);
-   assert(std::get<1>(c3).size() == 4);
-   assert(std::get<0>(c3) == 2.0);
    REQUIRE(std::get<1>(c3).size() == 4);
+   REQUIRE(std::get<0>(c3) == 2.0);
 
+   auto c4 = sp.FindPaths(0, {1,2,3}, g, 1.5);
+   REQUIRE(c4.size() == 3);
+   REQUIRE(std::get<1>(c4[0]) == std::vector<INDEX>({0,3,2,1}));
+   REQUIRE(std::get<1>(c4[1]) == std::vector<INDEX>({0,3,2}));
+   REQUIRE(std::get<1>(c4[2]) == std::vector<INDEX>({0,3}));
+}
+
+TEST_CASE( "shortest paths on random graphs", "[shortest path]" ) {
+   const INDEX n = 200;
+   const INDEX no_edges = 500;
+   std::mt19937 gen(1);
+   std::uniform_int_distribution<INDEX> node_dist(0, n-1);
+   std::uniform_real_distribution<REAL> cost_dist(0.0, 1.0);
+   std::vector<std::tuple<INDEX,INDEX,REAL>> edges;
+   std::vector<INDEX> no_outgoing_arcs(n, 0);
+   while(edges.size() < no_edges) {
+      const INDEX i = node_dist(gen);
+      const INDEX j = node_dist(gen);
+      if(i != j) {
+         edges.push_back(std::make_tuple(i, j, cost_dist(gen)));
+         no_outgoing_arcs[i]++;
+         no_outgoing_arcs[j]++;
+      }
+   }
+   Graph g(n, 2*no_edges, no_outgoing_arcs);
+   for(const auto& e : edges) {
+      g.add_edge(std::get<0>(e), std::get<1>(e), std::get<2>(e));
+   }
+   g.sort();
+
+   // distances of breadth first search from i in graph thresholded by th
+   auto reference_distances = [&](const INDEX i, const REAL th) {
+      std::vector<INDEX> dist(n, std::numeric_limits<INDEX>::max());
+      std::deque<INDEX> q({i});
+      dist[i] = 0;
+      while(!q.empty()) {
+         const INDEX k = q.front();
+         q.pop_front();
+         for(const auto& e : edges) {
+            if(std::get<2>(e) < th) { continue; }
+            for(const INDEX l : {std::get<0>(e) == k ? std::get<1>(e) : n, std::get<1>(e) == k ? std::get<0>(e) : n}) {
+               if(l < n && dist[l] == std::numeric_limits<INDEX>::max()) {
+                  dist[l] = dist[k] + 1;
+                  q.push_back(l);
+               }
+            }
+         }
+      }
+      return dist;
+   };
+   // path must start and end at given nodes, use arcs with cost >= th only and have cost equal to its minimum arc cost
+   auto check_path = [&](const std::vector<INDEX>& path, const REAL cost, const INDEX i, const INDEX j, const REAL th) {
+      REQUIRE(path.front() == i);
+      REQUIRE(path.back() == j);
+      REAL min_cost = std::numeric_limits<REAL>::infinity();
+      for(INDEX k=0; k+1<path.size(); ++k) {
+         REAL arc_cost = -std::numeric_limits<REAL>::infinity();
+         for(const auto& e : edges) {
+            if((std::get<0>(e) == path[k] && std::get<1>(e) == path[k+1]) || (std::get<1>(e) == path[k] && std::get<0>(e) == path[k+1])) {
+               arc_cost = std::max(arc_cost, std::get<2>(e));
+            }
+         }
+         REQUIRE(arc_cost >= th);
+         min_cost = std::min(min_cost, arc_cost);
+      }
+      REQUIRE(cost <= min_cost);
+      REQUIRE(cost >= th);
+   };
+
+   BfsData sp(g);
+   for(const REAL th : {0.0, 0.3, 0.6}) {
+      for(INDEX i=0; i<n; i+=7) {
+         const auto dist = reference_distances(i, th);
+         std::vector<INDEX> end_nodes;
+         for(INDEX j=i+1; j<n; j+=5) {
+            end_nodes.push_back(j);
+            const auto path = sp.FindPath(i, j, g, th);
+            if(dist[j] == std::numeric_limits<INDEX>::max()) {
+               REQUIRE(std::get<1>(path).size() == 0);
+            } else {
+               REQUIRE(std::get<1>(path).size() == dist[j]+1);
+               check_path(std::get<1>(path), std::get<0>(path), i, j, th);
+            }
+         }
+         const auto paths = sp.FindPaths(i, end_nodes, g, th);
+         REQUIRE(paths.size() == end_nodes.size());
+         for(INDEX k=0; k<end_nodes.size(); ++k) {
+            const INDEX j = end_nodes[k];
+            if(dist[j] == std::numeric_limits<INDEX>::max()) {
+               REQUIRE(std::get<1>(paths[k]).size() == 0);
+            } else {
+               REQUIRE(std::get<1>(paths[k]).size() == dist[j]+1);
+               check_path(std::get<1>(paths[k]), std::get<0>(paths[k]), i, j, th);
+            }
+         }
+      }
+   }
 }
@@ -0,0 +1,47 @@
+#include "catch.hpp"
+#include <vector>
+#include <tuple>
+#include <cstdio>
+#include "snapshot.hxx"
+
+using namespace LP_MP;
+
+struct snapshot_test_input {
+   INDEX n;
+   std::vector<std::vector<REAL>> tables;
+   std::vector<std::tuple<INDEX,INDEX,REAL>> edges;
+
+   template<class ARCHIVE> void serialize(ARCHIVE& ar) { ar(n, tables, edges); }
+};
+
+TEST_CASE( "snapshot", "[snapshot]" ) {
+   const std::string filename = "snapshot_test.lpmp";
+   snapshot_test_input input;
+   input.n = 3;
+   input.tables = { {1.0, 2.0, 3.0}, {}, std::vector<REAL>(100000, -0.5) };
+   input.edges = { std::make_tuple(0,1,0.25), std::make_tuple(1,2,-4.0) };
+   snapshot::write(filename, "test", input);
+
+   SECTION( "round trip" ) {
+      REQUIRE(snapshot::is_snapshot(filename));
+      snapshot_test_input read_input;
+      snapshot::read(filename, "test", read_input);
+      REQUIRE(read_input.n == input.n);
+      REQUIRE(read_input.tables == input.tables);
+      REQUIRE(read_input.edges == input.edges);
+   }
+
+   SECTION( "wrong format is rejected" ) {
+      snapshot_test_input read_input;
+      REQUIRE_THROWS(snapshot::read(filename, "other", read_input));
+   }
+
+   SECTION( "text files are no snapshots" ) {
+      const std::string text_file = "snapshot_test.txt";
+      { std::ofstream f(text_file); f << "MARKOV\n"; }
+      REQUIRE(!snapshot::is_snapshot(text_file));
+      std::remove(text_file.c_str());
+   }
+
+   std::remove(filename.c_str());
+}
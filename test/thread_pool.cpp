@@ -0,0 +1,87 @@
+#include "catch.hpp"
+#include <vector>
+#include <atomic>
+#include <numeric>
+#include <algorithm>
+#include "thread_pool.hxx"
+#include "numa.hxx"
+
+using namespace LP_MP;
+
+TEST_CASE( "thread pool", "[thread pool]" ) {
+   thread_pool pool(4);
+   const INDEX n = 10000;
+
+   SECTION( "every element is visited exactly once" ) {
+      std::vector<std::atomic<INDEX>> visited(n);
+      std::atomic<INDEX> invalid_thread_no(0); // Catch assertions are not thread safe, check in the main thread
+      for(INDEX r=0; r<10; ++r) {
+         pool.parallel_for(n, [&](const INDEX begin, const INDEX end, const INDEX thread_no) {
+               if(thread_no >= pool.size()) { ++invalid_thread_no; }
+               for(INDEX i=begin; i<end; ++i) { ++visited[i]; }
+         }, 8);
+      }
+      REQUIRE(invalid_thread_no == 0);
+      for(INDEX i=0; i<n; ++i) {
+         REQUIRE(visited[i] == 10);
+      }
+   }
+
+   SECTION( "unevenly sized chunks" ) {
+      std::vector<INDEX> chunk_boundaries = {0, 1, 2, 3, 5000, 5001, n};
+      std::atomic<INDEX> sum(0);
+      pool.run_chunks(chunk_boundaries, [&](const INDEX begin, const INDEX end, const INDEX) {
+            sum += end - begin;
+      });
+      REQUIRE(sum == n);
+   }
+}
+
+TEST_CASE( "thread pool with thread groups", "[thread pool]" ) {
+   const INDEX no_threads = 4;
+   std::vector<std::atomic<INDEX>> initialized(no_threads);
+   thread_pool pool(no_threads, {0,0,1,1}, [&](const INDEX t) { ++initialized[t]; });
+
+   SECTION( "every worker thread is initialized once" ) {
+      pool.parallel_for(1000, [](const INDEX, const INDEX, const INDEX) {});
+      REQUIRE(initialized[0] == 0); // the calling thread is not initialized by the pool
+      for(INDEX t=1; t<no_threads; ++t) {
+         while(initialized[t] == 0) { std::this_thread::yield(); } // idle threads need not have started yet
+         REQUIRE(initialized[t] == 1);
+      }
+   }
+
+   SECTION( "initial thread of chunks" ) {
+      const INDEX no_chunks = 10;
+      for(const bool reverse : {false, true}) {
+         std::vector<INDEX> chunk_boundaries(no_chunks+1);
+         std::iota(chunk_boundaries.begin(), chunk_boundaries.end(), 0);
+         INDEX prev_thread = reverse ? no_threads-1 : 0;
+         for(INDEX c=0; c<no_chunks; ++c) {
+            const INDEX t = pool.initial_thread(c, no_chunks, reverse);
+            REQUIRE(t < no_threads);
+            // chunks are assigned contiguously
+            if(reverse) { REQUIRE(t <= prev_thread); } else { REQUIRE(t >= prev_thread); }
+            prev_thread = t;
+         }
+         std::atomic<INDEX> sum(0);
+         pool.run_chunks(chunk_boundaries, [&](const INDEX begin, const INDEX end, const INDEX) { sum += end - begin; }, reverse);
+         REQUIRE(sum == no_chunks);
+      }
+      REQUIRE(pool.initial_thread(0, 1) == 0);
+   }
+}
+
+TEST_CASE( "numa", "[numa]" ) {
+   REQUIRE(numa::parse_list("0-3,8,10-11\n") == std::vector<INDEX>({0,1,2,3,8,10,11}));
+   REQUIRE(numa::topology::get().no_nodes() >= 1);
+
+   std::vector<double> x(10000, 1.0);
+   std::vector<std::uintptr_t> pages;
+   numa::add_pages(pages, x.data(), sizeof(double)*x.size());
+   REQUIRE(pages.size() >= sizeof(double)*x.size() / numa::page_size());
+   REQUIRE(std::is_sorted(pages.begin(), pages.end()));
+   // moving to the first node must not alter data
+   numa::move_pages(pages, std::vector<INDEX>(pages.size(), 0));
+   REQUIRE(std::size_t(std::count(x.begin(), x.end(), 1.0)) == x.size());
+}